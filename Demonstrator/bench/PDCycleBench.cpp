@@ -0,0 +1,408 @@
+//!*****************************************************************************
+//!  \file      PDCycleBench.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Benchmark of the process data cycle. Drives Max14819 and
+//!             IOLMasterPortMax14819 against the simulated shield in virtual
+//!             time and counts what every operation costs on the SPI bus.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-16
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!**** Header-Files ************************************************************
+#include "HardwareSim.h"
+#include "SimDevice.h"
+#include "Max14819.h"
+#include "IOLMasterPortMax14819.h"
+#include "IOLGenericDevice.h"
+#include "IOLink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+//!**** Macros ******************************************************************
+#ifndef BENCH_COMMIT
+#define BENCH_COMMIT "unknown"
+#endif
+
+constexpr uint32_t DEFAULT_ITERATIONS = 1000u;
+constexpr uint32_t BEGIN_DIVISOR = 50u;		// begin takes 1.3s of bus time, run it less often
+
+//!**** Data types **************************************************************
+
+//!*****************************************************************************
+//!  Hardware which forwards to another hardware and counts the bus accesses.
+//!  A syscall is one SPI transfer (one ioctl as with HardwareSpidev) or one
+//!  sleep, time and GPIO reads are served without a syscall.
+//!*****************************************************************************
+class CountingHardware:
+	public HardwareBase
+{
+public:
+	struct Counters {
+		uint64_t transactions;
+		uint64_t frames;
+		uint64_t bytes;
+		uint64_t syscalls;
+	};
+
+	explicit CountingHardware(HardwareBase * hardware)
+	:hardware_(hardware),
+	verbose_(false)
+	{
+		clear();
+	}
+
+	virtual void begin() { hardware_->begin(); }
+
+	virtual void IO_Write(PinNames pinnumber, uint8_t state) { hardware_->IO_Write(pinnumber, state); }
+	virtual void IO_PinMode(PinNames pinnumber, PinMode mode) { hardware_->IO_PinMode(pinnumber, mode); }
+	virtual uint8_t IO_Read(PinNames pinnumber) { return hardware_->IO_Read(pinnumber); }
+	virtual uint8_t IO_WaitForInterrupt(PinNames pinnumber, uint64_t deadline_ns) {
+		counters_.syscalls++;
+		return hardware_->IO_WaitForInterrupt(pinnumber, deadline_ns);
+	}
+
+	virtual void Serial_Write(char const * buf) {
+		if (verbose_) {
+			hardware_->Serial_Write(buf);
+		}
+	}
+	virtual void Serial_Write(int number) {
+		if (verbose_) {
+			hardware_->Serial_Write(number);
+		}
+	}
+
+	virtual void SPI_Write(uint8_t channel, uint8_t * data, uint8_t length) {
+		counters_.transactions++;
+		counters_.frames++;
+		counters_.bytes += length;
+		counters_.syscalls++;
+		hardware_->SPI_Write(channel, data, length);
+	}
+	virtual void SPI_WriteFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount) {
+		counters_.transactions++;
+		counters_.frames += frameCount;
+		counters_.bytes += uint64_t(frameLength) * frameCount;
+		counters_.syscalls++;
+		hardware_->SPI_WriteFrames(channel, data, frameLength, frameCount);
+	}
+
+	virtual uint8_t * NV_Map(char const * name, uint16_t length) { return hardware_->NV_Map(name, length); }
+
+	virtual void wait_for(uint32_t delay_ms) {
+		counters_.syscalls++;
+		hardware_->wait_for(delay_ms);
+	}
+	virtual void wait_until_ns(uint64_t deadline_ns) {
+		counters_.syscalls++;
+		hardware_->wait_until_ns(deadline_ns);
+	}
+	virtual uint64_t get_time_ns() { return hardware_->get_time_ns(); }
+	virtual uint8_t hasVirtualTime() { return hardware_->hasVirtualTime(); }
+
+	void clear() { memset(&counters_, 0, sizeof(counters_)); }
+	Counters const & read() const { return counters_; }
+	void setVerbose(bool verbose) { verbose_ = verbose; }
+
+private:
+	HardwareBase * hardware_;
+	bool verbose_;
+	Counters counters_;
+};
+
+//!*****************************************************************************
+//!  Results of one operation: counters summed over all iterations and the
+//!  latency of every iteration in host time (wall) and bus time (simulated)
+//!*****************************************************************************
+struct BenchResult {
+	char const * name;
+	uint32_t iterations;
+	uint32_t errors;
+	CountingHardware::Counters counters;
+	std::vector<uint64_t> wall_ns;
+	std::vector<uint64_t> bus_ns;
+};
+
+//!**** Function prototypes *****************************************************
+static uint64_t percentile(std::vector<uint64_t> & values, uint32_t permille);
+static void printText(std::vector<BenchResult> & results);
+static void printJson(std::vector<BenchResult> & results, uint32_t iterations);
+
+//!**** Data ********************************************************************
+static CountingHardware * counter;
+
+//!**** Implementation **********************************************************
+
+//!*****************************************************************************
+//!function :      run
+//!*****************************************************************************
+//!  \brief        Runs an operation several times and measures every call. The
+//!                operation returns its error code, preparation between the
+//!                calls is not measured.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   char const*  name of the operation
+//!				   uint32_t     number of iterations
+//!				   Op           operation, returns 0 if success
+//!				   Prepare      called before every iteration, not measured
+//!
+//!  \return       results
+//!
+//!*****************************************************************************
+template <typename Op, typename Prepare>
+static BenchResult run(char const * name, uint32_t iterations, Op op, Prepare prepare)
+{
+	BenchResult result;
+	result.name = name;
+	result.iterations = iterations;
+	result.errors = 0;
+	memset(&result.counters, 0, sizeof(result.counters));
+	result.wall_ns.reserve(iterations);
+	result.bus_ns.reserve(iterations);
+
+	for (uint32_t i = 0; i < iterations; i++) {
+		prepare();
+		counter->clear();
+		uint64_t busStart = counter->get_time_ns();
+		std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+
+		if (op() != SUCCESS) {
+			result.errors++;
+		}
+
+		std::chrono::steady_clock::time_point wallEnd = std::chrono::steady_clock::now();
+		uint64_t busEnd = counter->get_time_ns();
+		result.wall_ns.push_back(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(wallEnd - wallStart).count()));
+		result.bus_ns.push_back(busEnd - busStart);
+
+		CountingHardware::Counters const & c = counter->read();
+		result.counters.transactions += c.transactions;
+		result.counters.frames += c.frames;
+		result.counters.bytes += c.bytes;
+		result.counters.syscalls += c.syscalls;
+	}
+	return result;
+}
+
+static void nothing()
+{
+}
+
+//!*****************************************************************************
+//!  Usage: bench [-n iterations] [--json] [--verbose]
+//!    -n         iterations of the cyclic operations (default 1000)
+//!    --json     machine readable output on stdout
+//!    --verbose  show the messages of the driver
+//!*****************************************************************************
+int main(int argc, char *argv[])
+{
+	uint32_t iterations = DEFAULT_ITERATIONS;
+	bool json = false;
+	bool verbose = false;
+
+	for (int i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) {
+			iterations = uint32_t(strtoul(argv[++i], nullptr, 0));
+		}
+		else if (strcmp(argv[i], "--json") == 0) {
+			json = true;
+		}
+		else if (strcmp(argv[i], "--verbose") == 0) {
+			verbose = true;
+		}
+		else {
+			fprintf(stderr, "Usage: %s [-n iterations] [--json] [--verbose]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (iterations == 0) {
+		iterations = 1;
+	}
+	uint32_t beginIterations = (iterations / BEGIN_DIVISOR > 0) ? iterations / BEGIN_DIVISOR : 1;
+
+	// Simulated shield in virtual time, a distance sensor on port 0 and a
+	// smartlight on port 1
+	HardwareSim sim(true);
+	SimDistanceSensor sensor;
+	SimSmartLight light;
+	sim.attachDevice(0, &sensor);
+	sim.attachDevice(1, &light);
+	CountingHardware counting(&sim);
+	counting.setVerbose(verbose);
+	counter = &counting;
+
+	max14819::Max14819 driver(max14819::DRIVER01, &counting);
+	IOLMasterPortMax14819 port0(&driver, max14819::PORT0PORT);
+	IOLMasterPortMax14819 port1(&driver, max14819::PORT1PORT);
+
+	std::vector<BenchResult> results;
+
+	results.push_back(run("begin", beginIterations,
+			[&]() { return port0.begin(); }, nothing));
+
+	results.push_back(run("wakeUpRequest", iterations,
+			[&]() { uint32_t comSpeed = 0; return driver.wakeUpRequest(max14819::PORT0PORT, &comSpeed); }, nothing));
+
+	// Bring the device back to operate for the process data
+	port0.begin();
+	port1.begin();
+
+	results.push_back(run("readDirectParameterPage", iterations,
+			[&]() { uint8_t value = 0; return port0.readDirectParameterPage(IOL::PAGE::MIN_CYCLE_TIME, &value); }, nothing));
+
+	// A new port object has no cached page, the whole page 1 is read in one burst
+	results.push_back(run("readDirectParameterPage1", iterations,
+			[&]() {
+				IOLMasterPortMax14819 port(&driver, max14819::PORT0PORT);
+				IOL::DirectParameterPage1 page;
+				return port.readDirectParameterPage1(&page);
+			}, nothing));
+
+	results.push_back(run("readPD", iterations,
+			[&]() { uint8_t data[4]; return port0.readPD(data, sizeof(data)); }, nothing));
+
+	// ISDU over the OD octet of the process data M-sequence, one string and
+	// the whole identification as one batch
+	IOLGenericDevice device(&port0);
+	results.push_back(run("readISDU", beginIterations,
+			[&]() { char text[IDENT_TEXT_SIZE]; return device.readProductName(text, sizeof(text)); }, nothing));
+
+	results.push_back(run("readIdentification", beginIterations,
+			[&]() { IOLIdentification ident; return device.readIdentification(&ident); }, nothing));
+
+	// A new device object with the persistent cache, as after a restart. Only
+	// the SerialNumber of the key is read, the first iteration fills the cache
+	IOLDeviceCache cache(counter);
+	results.push_back(run("readIdentificationCached", beginIterations,
+			[&]() {
+				IOLGenericDevice cachedDevice(&port0);
+				IOLIdentification ident;
+				cachedDevice.setCache(&cache);
+				return cachedDevice.readIdentification(&ident);
+			}, nothing));
+
+	// Data Storage of a replaced sensor: the first call uploads, then every
+	// iteration changes a parameter of the device and downloads the set
+	IOLDataStorage dataStorage(counter, 0);
+	dataStorage.clear();
+	dataStorage.synchronize(&port0);
+	uint8_t const factorySetting[] = { 0x01, 0xF4 };
+	results.push_back(run("dataStorageDownload", beginIterations,
+			[&]() { return dataStorage.synchronize(&port0); },
+			[&]() { sensor.setParameter(0x003Cu, factorySetting, sizeof(factorySetting), 1); }));
+
+	results.push_back(run("dataStorageCheck", beginIterations,
+			[&]() { return dataStorage.synchronize(&port0); }, nothing));
+
+	// The same batch multiplexed onto the process data of the cycle timer,
+	// 3.0 ms leave the master time to write the next message in each cycle
+	port0.enableCyclicPD(4, 0x1E);
+	results.push_back(run("readIdentificationCyclic", beginIterations,
+			[&]() { IOLIdentification ident; return device.readIdentification(&ident); }, nothing));
+	port0.disableCyclicPD();
+
+	// writePD does not wait for the answer, let the previous transfer end
+	// (13 octets at 38400 baud), the next call collects its answer and
+	// sends at once
+	uint8_t dataLED[10] = { 0x11, 0x01, 0, 0x02, 0, 0, 0, 0, IOL::MC::PDOUT_VALID, 0 };
+	results.push_back(run("writePD", iterations,
+			[&]() { return port1.writePD(sizeof(dataLED), dataLED, 1, IOL::M_TYPE_2_X); },
+			[&]() { counter->wait_for(5); }));
+
+	if (json) {
+		printJson(results, iterations);
+	}
+	else {
+		printText(results);
+	}
+	return 0;
+}
+
+//!*****************************************************************************
+//!function :      percentile
+//!*****************************************************************************
+//!  \brief        Nearest-rank percentile, sorts the values
+//!
+//!  \type         local
+//!
+//!  \param[in]	   vector     measured values
+//!				   uint32_t   percentile in 1/1000
+//!
+//!  \return       value
+//!
+//!*****************************************************************************
+static uint64_t percentile(std::vector<uint64_t> & values, uint32_t permille)
+{
+	if (values.empty()) {
+		return 0;
+	}
+	std::sort(values.begin(), values.end());
+	size_t rank = (values.size() * permille + 999u) / 1000u;
+	return values[(rank > 0) ? rank - 1 : 0];
+}
+
+static void printText(std::vector<BenchResult> & results)
+{
+	printf("%-26s %8s %6s %8s %8s %8s %8s %10s %10s %10s %12s %12s %12s\n",
+			"operation", "iter", "errors", "spi_tx", "frames", "bytes", "syscalls",
+			"wall_p50", "wall_p99", "wall_p999", "bus_p50", "bus_p99", "bus_p999");
+	for (size_t i = 0; i < results.size(); i++) {
+		BenchResult & r = results[i];
+		double n = double(r.iterations);
+		printf("%-26s %8u %6u %8.1f %8.1f %8.1f %8.1f %10llu %10llu %10llu %12llu %12llu %12llu\n",
+				r.name, r.iterations, r.errors,
+				double(r.counters.transactions) / n, double(r.counters.frames) / n,
+				double(r.counters.bytes) / n, double(r.counters.syscalls) / n,
+				(unsigned long long)percentile(r.wall_ns, 500), (unsigned long long)percentile(r.wall_ns, 990),
+				(unsigned long long)percentile(r.wall_ns, 999), (unsigned long long)percentile(r.bus_ns, 500),
+				(unsigned long long)percentile(r.bus_ns, 990), (unsigned long long)percentile(r.bus_ns, 999));
+	}
+	printf("counts per call, times in ns (wall: host, bus: simulated)\n");
+}
+
+static void printJson(std::vector<BenchResult> & results, uint32_t iterations)
+{
+	printf("{\"commit\":\"%s\",\"iterations\":%u,\"results\":[", BENCH_COMMIT, iterations);
+	for (size_t i = 0; i < results.size(); i++) {
+		BenchResult & r = results[i];
+		double n = double(r.iterations);
+		printf("%s\n{\"name\":\"%s\",\"iterations\":%u,\"errors\":%u,"
+				"\"spi_transactions\":%.2f,\"spi_frames\":%.2f,\"spi_bytes\":%.2f,\"syscalls\":%.2f,",
+				(i == 0) ? "" : ",", r.name, r.iterations, r.errors,
+				double(r.counters.transactions) / n, double(r.counters.frames) / n,
+				double(r.counters.bytes) / n, double(r.counters.syscalls) / n);
+		printf("\"wall_ns\":{\"p50\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu},",
+				(unsigned long long)percentile(r.wall_ns, 500), (unsigned long long)percentile(r.wall_ns, 990),
+				(unsigned long long)percentile(r.wall_ns, 999), (unsigned long long)percentile(r.wall_ns, 1000));
+		printf("\"bus_ns\":{\"p50\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu}}",
+				(unsigned long long)percentile(r.bus_ns, 500), (unsigned long long)percentile(r.bus_ns, 990),
+				(unsigned long long)percentile(r.bus_ns, 999), (unsigned long long)percentile(r.bus_ns, 1000));
+	}
+	printf("\n]}\n");
+}
@@ -120,11 +120,28 @@ uint16_t BalluffBus0023::readDistance() {
 	uint8_t data[4];
 	uint16_t distance = 0;
 	if(port->readPD(data, 4)!= ERROR){
-		distance = (uint16_t)(((data[1] << 8) | data[2]) >> 1);
+		distance = decodeDistance(data);
 	}
 	return distance;
 }
 
+//!*****************************************************************************
+//!  function :    decodeDistance
+//!*****************************************************************************
+//!  \brief        Distance of a process data answer, for consumers of the
+//!                process data ring of the port
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pData               answer of 4 octets (OD, PD and CKS)
+//!
+//!  \return       distance
+//!
+//!*****************************************************************************
+uint16_t BalluffBus0023::decodeDistance(uint8_t const *pData) {
+	return (uint16_t)(((pData[1] << 8) | pData[2]) >> 1);
+}
+
 //!*****************************************************************************
 //!  function :    readSwitchState
 //!*****************************************************************************
@@ -53,6 +53,8 @@ public:
 
 	uint16_t readDistance();
 
+	static uint16_t decodeDistance(uint8_t const *pData);
+
 	void readSwitchState();
 
 	void writeDetPoint1();
@@ -35,15 +35,28 @@
 #include "IOLMasterPort.h"
 #include "IOLMasterPortMax14819.h"
 #include "IOLGenericDevice.h"
+#include "IOLBusScheduler.h"
+#include "IOLEventDispatcher.h"
+#include "IOLMasterService.h"
+#include "IOLPDLog.h"
+#include "IOLSyncGroup.h"
 #include "IOLink.h"
 
 #ifdef ARDUINO
+	#include <signal.h>
 	#include <stdio.h>
 #else
+	#include <chrono>
+	#include <csignal>
 	#include <cstdio>
+	#include <thread>
 #endif	
 
 //!**** Macros *****************************************************************
+constexpr uint8_t DEMO_CYCLE_TIME = 0x80u | 42u;   // 32ms + 42 * 1.6ms = 99.2ms, paces Demo_loop
+constexpr uint32_t PORT_POLL_US = 100u;             // Poll interval of the port state machines during bring-up
+constexpr uint32_t LOG_POLL_MS = 20u;               // Poll interval of the process data logger
+constexpr uint32_t SAMPLE_POLL_US = 1000u;          // Poll interval of the loop for the next sample of port0
 
 //!**** Data types *************************************************************
 IOLMasterPortMax14819 port0;
@@ -52,8 +65,36 @@ IOLMasterPortMax14819 port2;
 IOLMasterPortMax14819 port3;
 BalluffBus0023 BUS0023;
 HardwareBase * hardware;
+max14819::Max14819 *pDriver01;
+max14819::Max14819 *pDriver23;
+IOLDeviceCache *pDeviceCache;
+IOLDataStorage *pDataStorages[4];
+IOLEventDispatcher *pDispatcher;
+IOLPDRing pdRings[4];
+IOLPDTiming pdTimings[4];
+PDCursor logCursors[4];
+PDCursor loopCursor;
+IOLMasterService *pServices[2];
+IOLBusScheduler *pScheduler;
+IOLSyncGroup *pSyncGroup;
+static uint8_t isServiceRunning = 0;
+static uint8_t isTraceEn = 0;
+#ifndef ARDUINO
+IOLPDLog pdLog;
+static char const *pdLogPath = nullptr;
+static uint8_t isPDLogOpen = 0;
+#endif
+static volatile sig_atomic_t statisticsRequest = 0;
 //!**** Function prototypes ****************************************************
 void printDataMatlab(uint16_t level, uint32_t measureNr);
+void startPorts(IOLMasterPortMax14819 **ports, uint8_t count);
+void printPortTimings(uint8_t portNr, IOLMasterPortMax14819 *port, uint64_t startTime);
+void printStatistics();
+void printIdentification(uint8_t portNr, IOLMasterPortMax14819 *port);
+void synchronizeDataStorage(uint8_t portNr, IOLMasterPortMax14819 *port);
+void printEvent(void *pContext, uint8_t portNr, EventRecord const &record);
+void logProcessData();
+uint8_t readProcessData(uint8_t portNr, uint8_t *pData, uint8_t sizeData);
 //!**** Data *******************************************************************
 
 //!**** Implementation *********************************************************
@@ -67,8 +108,26 @@ void Demo_setup(HardwareBase *hardware_loc)
 	hardware->begin();
 	
     // Create drivers
-    max14819::Max14819 *pDriver01 = new max14819::Max14819(max14819::DRIVER01, hardware);
-    max14819::Max14819 *pDriver23 = new max14819::Max14819(max14819::DRIVER23, hardware);
+    pDriver01 = new max14819::Max14819(max14819::DRIVER01, hardware);
+    pDriver23 = new max14819::Max14819(max14819::DRIVER23, hardware);
+    pDriver01->enableTrace(isTraceEn);
+    pDriver23->enableTrace(isTraceEn);
+
+    // Events of all ports are printed outside of the cycle context
+    pDispatcher = new IOLEventDispatcher();
+    pDispatcher->addRing(0, pDriver01->readEventRing(max14819::PORT0PORT));
+    pDispatcher->addRing(1, pDriver01->readEventRing(max14819::PORT1PORT));
+    pDispatcher->addRing(2, pDriver23->readEventRing(max14819::PORT2PORT));
+    pDispatcher->addRing(3, pDriver23->readEventRing(max14819::PORT3PORT));
+    // Transmit and receive errors repeat every cycle of a faulty port, only
+    // the device and chip events are printed
+    pDispatcher->subscribe(uint8_t(EVENT_SOURCE_DEVICE | EVENT_SOURCE_STATUS | EVENT_SOURCE_CHANNEL), printEvent, nullptr);
+#ifndef ARDUINO
+    pDispatcher->start();
+#endif
+
+    // Identification of known devices survives restarts
+    pDeviceCache = new IOLDeviceCache(hardware);
 
     // Create ports
 	port0 = IOLMasterPortMax14819(pDriver01, max14819::PORT0PORT);
@@ -78,13 +137,81 @@ void Demo_setup(HardwareBase *hardware_loc)
 
 	BUS0023 = BalluffBus0023(&port0);
 
-    // Start IO-Link communication
-	BUS0023.begin();
-    //port0.begin();
-    port1.begin();
-    port2.begin();
-    port3.begin();
+    // Every process data answer is published and timed, the logger prints
+    // the distances of port0 at its own pace or copies the samples of all
+    // ports to the binary log
+    IOLMasterPortMax14819 *ports[] = {&port0, &port1, &port2, &port3};
+    for (uint8_t i = 0; i < sizeof(ports) / sizeof(ports[0]); i++) {
+        ports[i]->setPDRing(&pdRings[i]);
+        ports[i]->setPDTiming(&pdTimings[i]);
+    }
+    pdRings[0].attach(&logCursors[0]);
+#ifndef ARDUINO
+    if (pdLogPath != nullptr) {
+        if (pdLog.open(pdLogPath, PD_LOG_RECORDS, hardware->get_time_ns()) == SUCCESS) {
+            for (uint8_t i = 1; i < sizeof(ports) / sizeof(ports[0]); i++) {
+                pdRings[i].attach(&logCursors[i]);
+            }
+            isPDLogOpen = 1;
+        }
+        else {
+            hardware->Serial_Write("Process data log not opened, printing the distances");
+        }
+    }
+    std::thread([]() {
+        while (1) {
+            logProcessData();
+            std::this_thread::sleep_for(std::chrono::milliseconds(LOG_POLL_MS));
+        }
+    }).detach();
+#endif
+
+    // Start IO-Link communication on all ports in parallel
+    startPorts(ports, sizeof(ports) / sizeof(ports[0]));
+
+    // Identification and Data Storage over ISDU, before the cycle timers own
+    // the transmit FIFOs
+    for (uint8_t i = 0; i < sizeof(ports) / sizeof(ports[0]); i++) {
+        printIdentification(i, ports[i]);
+        synchronizeDataStorage(i, ports[i]);
+    }
+
+    // Distance and buttons are sampled at the same instant, the loop starts
+    // the requests of all three ports with one trigger write per chip
+    pSyncGroup = new IOLSyncGroup(0, DEMO_CYCLE_TIME);
+    pSyncGroup->addPort(&port0, 4);
+    pSyncGroup->addPort(&port2, 3);
+    pSyncGroup->addPort(&port3, 3);
+    port1.setCycleTime(DEMO_CYCLE_TIME);
+
+    // The distance sensor gets the bus before the buttons, the smartlight
+    // update of the loop waits for both
+    pScheduler = new IOLBusScheduler(hardware);
+    pScheduler->addPort(&port0, BUS_CLASS_HIGH);
+    pScheduler->addPort(&port2, BUS_CLASS_NORMAL);
+    pScheduler->addPort(&port3, BUS_CLASS_NORMAL);
+    pScheduler->addPort(&port1, BUS_CLASS_LOW);
+    pSyncGroup->setScheduler(pScheduler);
 
+    // One service thread per chip collects the answers of the triggers,
+    // the loop takes the process data from the rings. The smartlight on
+    // port1 is written by the loop and not served. A virtual clock serves
+    // one thread only, there the loop reads over the bus itself.
+    pServices[0] = new IOLMasterService(pDriver01);
+    pServices[0]->addPort(&port0);
+    pServices[1] = new IOLMasterService(pDriver23);
+    pServices[1]->addPort(&port2);
+    pServices[1]->addPort(&port3);
+    pServices[0]->setScheduler(pScheduler);
+    pServices[1]->setScheduler(pScheduler);
+#ifndef ARDUINO
+    if (hardware->hasVirtualTime() == 0) {
+        pdRings[0].attach(&loopCursor);
+        pServices[0]->start();
+        pServices[1]->start();
+        isServiceRunning = 1;
+    }
+#endif
 }
 
 // The loop function is called in an endless loop
@@ -96,7 +223,6 @@ void Demo_loop()
 	uint16_t testVal = 0;
 	uint16_t level = 0;
 	uint8_t data[4];
-	char buf[64];
 
 	// Level mode for smartlight
 	uint8_t dataLED[10];
@@ -114,25 +240,31 @@ void Demo_loop()
 	// Default levels for demonstrator
 	uint16_t TANK_MAX_LVL = 210;
 	uint16_t TANK_WARNING_LVL = 100;
-	uint32_t measureNr = 0;
 	constexpr uint16_t TANK_EMPTY_LVL = 50;
 	
 
     while(1){
-        hardware->wait_for(100);
-        // Read process data and convert them if there is no error
-		distance = BUS0023.readDistance();
-		hardware->Serial_Write("Messung");
-		sprintf(buf, "%d", distance);
-		hardware->Serial_Write(buf);
+        printStatistics();
+#ifdef ARDUINO
+        // No consumer threads, events and measurements are printed once per loop
+        pDispatcher->dispatch();
+        logProcessData();
+#endif
+
+        // Start the requests of the next cycle
+        hardware->wait_until_ns(pSyncGroup->readNextTime());
+        pSyncGroup->fire();
+
+        // Read process data (waits for the answer of port0) and convert them if there is no error,
+        // the measurement is printed by the logger
+		distance = 0;
+		if (readProcessData(0, data, 4) == SUCCESS) {
+			distance = BalluffBus0023::decodeDistance(data);
+		}
 		level = (uint16_t)(500 - distance / 10);
 
         // When there is a valid level
         if((level < 250) && (level > 0)){
-            //Serial.println(level);
-            measureNr++;
-            printDataMatlab(level, measureNr);
-
            if(level <= TANK_EMPTY_LVL){
                // Smartlight color red
                dataLED[0] = 0b00100010;						               dataLED[5] = (uint8_t)(testVal&0xFF);		// Level Value, Lower Byte
@@ -181,16 +313,17 @@ void Demo_loop()
                dataLED[6] = 2;						// Blink frequency 1Hz
                dataLED[7] = 0;						// Buzzer Volume zero						
            }
-            port1.writePD(10, dataLED, 2, IOL::M_TYPE_2_X);
+            IOLBusScheduler::Job job(pScheduler, &port1, hardware->get_time_ns());
+            port1.writePD(10, dataLED, 1, IOL::M_TYPE_2_X);     // no process data input, the answer is the CKS
         }
-        port2.readPD(data, 3);
+        readProcessData(2, data, 3);
         //Serial.println(data[2]&0x01, DEC);
         if((data[2]&0x01)== 1){
            if(level >TANK_WARNING_LVL){
                TANK_MAX_LVL = level;
            }
         }
-        port3.readPD(data, 3);
+        readProcessData(3, data, 3);
         //Serial.println(data[2]&0x01, DEC);
         if((data[2]&0x01)== 1){
             if((level > TANK_EMPTY_LVL) && (level < TANK_MAX_LVL))
@@ -199,8 +332,277 @@ void Demo_loop()
     }
 }
 
+// Resumes the ports which are still in operate, powers down all others
+// together and runs wakeup and identification of all ports in parallel with
+// their state machines, the boot delays overlap
+void startPorts(IOLMasterPortMax14819 **ports, uint8_t count) {
+	uint64_t startTime = hardware->get_time_ns();
+	uint8_t done = 0;
+
+	// Take over devices left in operate by the previous run, power cycle the others
+	for (uint8_t i = 0; i < count; i++) {
+		if (ports[i]->resume() == SUCCESS) {
+			done = uint8_t(done | (1u << i));
+		}
+		else {
+			ports[i]->start();
+		}
+	}
+
+	// Handle every port until it is operational or failed, a failed port
+	// would be restarted by further portHandler calls
+	while (done != (1u << count) - 1u) {
+		for (uint8_t i = 0; i < count; i++) {
+			if ((done & (1u << i)) != 0) {
+				continue;
+			}
+			ports[i]->portHandler();
+			PortState state = ports[i]->readPortState();
+			if ((state == PORT_OPERATE) || (state == PORT_FALLBACK) || (state == PORT_INACTIVE)) {
+				done = uint8_t(done | (1u << i));
+			}
+		}
+		hardware->wait_for_us(PORT_POLL_US);
+	}
+
+	for (uint8_t i = 0; i < count; i++) {
+		printPortTimings(i, ports[i], startTime);
+	}
+}
+
+void printPortTimings(uint8_t portNr, IOLMasterPortMax14819 *port, uint64_t startTime) {
+	char buf[256];
+	constexpr uint64_t NS_PER_US = 1000u;
+	constexpr uint64_t NS_PER_MS = 1000000u;
+	uint64_t powerOff = port->readStateTime(PORT_POWER_OFF);
+	uint64_t bootup = port->readStateTime(PORT_BOOTUP);
+	uint64_t wakeup = port->readStateTime(PORT_WAKEUP);
+	uint64_t startup = port->readStateTime(PORT_STARTUP);
+	uint64_t preoperate = port->readStateTime(PORT_PREOPERATE);
+	uint64_t operate = port->readStateTime(PORT_OPERATE);
+
+	if ((port->readPortState() == PORT_OPERATE) && (powerOff == 0)) {
+		sprintf(buf, "Port %d: resumed after %lu us", portNr,
+				(unsigned long)((operate - startTime) / NS_PER_US));
+		hardware->Serial_Write(buf);
+		return;
+	}
+	if (port->readPortState() != PORT_OPERATE) {
+		sprintf(buf, "Port %d: no device, gave up after %lu ms", portNr,
+				(unsigned long)((hardware->get_time_ns() - startTime) / NS_PER_MS));
+		hardware->Serial_Write(buf);
+		return;
+	}
+	sprintf(buf, "Port %d: power off %lu ms, bootup %lu ms, wakeup %lu ms, startup %lu us, preoperate %lu us, total %lu ms",
+			portNr,
+			(unsigned long)((bootup - powerOff) / NS_PER_MS),
+			(unsigned long)((wakeup - bootup) / NS_PER_MS),
+			(unsigned long)((startup - wakeup) / NS_PER_MS),
+			(unsigned long)((preoperate - startup) / NS_PER_US),
+			(unsigned long)((operate - preoperate) / NS_PER_US),
+			(unsigned long)((operate - startTime) / NS_PER_MS));
+	hardware->Serial_Write(buf);
+}
+
+void printIdentification(uint8_t portNr, IOLMasterPortMax14819 *port) {
+	char buf[8 * IDENT_TEXT_SIZE];
+	IOLIdentification ident;
+	IOLGenericDevice device(port);
+
+	device.setCache(pDeviceCache);
+	if (port->readPortState() != PORT_OPERATE) {
+		return;
+	}
+	if (device.readIdentification(&ident) == ERROR) {
+		sprintf(buf, "Port %d: identification failed", portNr);
+		hardware->Serial_Write(buf);
+		return;
+	}
+	sprintf(buf, "Port %d: %s %s (%s), serial %s, HW %s, FW %s", portNr,
+			ident.vendorName, ident.productName, ident.productID,
+			ident.serialNumber, ident.hardwareRev, ident.firmwareRev);
+	hardware->Serial_Write(buf);
+}
+
+void synchronizeDataStorage(uint8_t portNr, IOLMasterPortMax14819 *port) {
+	char buf[64];
+	static char const * const actions[] = {"unchanged", "uploaded", "downloaded"};
+
+	pDataStorages[portNr] = new IOLDataStorage(hardware, portNr);
+	if ((port->readPortState() != PORT_OPERATE) || (pDataStorages[portNr]->isAvailable() == 0)) {
+		return;
+	}
+	if (pDataStorages[portNr]->synchronize(port) == ERROR) {
+		sprintf(buf, "Port %d: data storage failed", portNr);
+	}
+	else {
+		sprintf(buf, "Port %d: data storage %s, %d parameters", portNr,
+				actions[pDataStorages[portNr]->readLastAction()], pDataStorages[portNr]->readTransferCount());
+	}
+	hardware->Serial_Write(buf);
+}
+
+void printEvent(void *pContext, uint8_t portNr, EventRecord const &record) {
+	char text[64];
+	char buf[160];
+	(void)pContext;
+	IOLEventDispatcher::format(record, text, sizeof(text));
+	sprintf(buf, "Port %d: %s", portNr, text);
+	hardware->Serial_Write(buf);
+}
+
+// Process data of a port. While the service threads own the ports the
+// sample is taken from the ring, port0 waits for the sample of the cycle.
+// Otherwise the process data is read over the bus.
+uint8_t readProcessData(uint8_t portNr, uint8_t *pData, uint8_t sizeData) {
+	IOLMasterPortMax14819 *ports[] = {&port0, &port1, &port2, &port3};
+	PDSample sample;
+	uint8_t result = PENDING;
+
+	if (isServiceRunning == 0) {
+		return ports[portNr]->readPD(pData, sizeData);
+	}
+	if (portNr == 0) {
+		while (result == PENDING) {
+			// Only the newest sample counts, the older ones were logged
+			while (pdRings[0].read(&loopCursor, &sample) == SUCCESS) {
+				result = SUCCESS;
+			}
+			if (result == PENDING) {
+				hardware->wait_for_us(SAMPLE_POLL_US);
+			}
+		}
+	}
+	else if (pdRings[portNr].readLatest(&sample) == PENDING) {
+		return ERROR;
+	}
+	if ((sample.isValid == 0) || (sample.size != sizeData)) {
+		return ERROR;
+	}
+	for (uint8_t i = 0; i < sizeData; i++) {
+		pData[i] = sample.data[i];
+	}
+	return SUCCESS;
+}
+
+// Print the distances of port0 published since the last call, samples
+// overwritten before the logger got to them are counted in logCursors.
+// With a binary log the samples of all ports are copied to it instead.
+void logProcessData() {
+	static uint32_t measureNr = 0;
+	PDSample sample;
+	char buf[64];
+#ifndef ARDUINO
+	if (isPDLogOpen != 0) {
+		for (uint8_t i = 0; i < sizeof(pdRings) / sizeof(pdRings[0]); i++) {
+			while (pdRings[i].read(&logCursors[i], &sample) == SUCCESS) {
+				pdLog.append(i, sample);
+			}
+		}
+		return;
+	}
+#endif
+	while (pdRings[0].read(&logCursors[0], &sample) == SUCCESS) {
+		uint16_t distance = ((sample.isValid != 0) && (sample.size == 4)) ? BalluffBus0023::decodeDistance(sample.data) : 0;
+		uint16_t level = (uint16_t)(500 - distance / 10);
+		hardware->Serial_Write("Messung");
+		sprintf(buf, "%d", distance);
+		hardware->Serial_Write(buf);
+		if ((level < 250) && (level > 0)) {
+			measureNr++;
+			printDataMatlab(level, measureNr);
+		}
+	}
+}
+
 void printDataMatlab(uint16_t level, uint32_t measureNr) {
 	char buf[256];
 	sprintf(buf, "%d;0;0;0;0;0;0;0;0;%d", measureNr, level);
 	hardware->Serial_Write(buf);
 }
+
+// Record the last SPI frames of both drivers, call before Demo_setup
+void Demo_enableTrace() {
+	isTraceEn = 1;
+}
+
+// Log the process data of all ports to a memory mapped ring file instead
+// of printing the distances, call before Demo_setup. The path must stay
+// valid, tools/PDLogConvert prints the file.
+void Demo_enablePDLog(char const *path) {
+#ifndef ARDUINO
+	pdLogPath = path;
+#else
+	(void)path;
+#endif
+}
+
+// Let the loop print the SPI statistics of both drivers at the next cycle,
+// can be called from a signal handler
+void Demo_requestStatistics() {
+	statisticsRequest = 1;
+}
+
+void printStatistics() {
+	if (statisticsRequest == 0) {
+		return;
+	}
+	IOLMasterPortMax14819 *ports[] = {&port0, &port1, &port2, &port3};
+	BusPortStats stats;
+	SyncStats syncStats;
+	char buf[192];
+	statisticsRequest = 0;
+	// The counters and the trace are read lock free, the chip threads keep running
+	pDriver01->printStatistics();
+	pDriver23->printStatistics();
+	sprintf(buf, "Events dropped: %lu", (unsigned long)pDispatcher->readDropCount());
+	hardware->Serial_Write(buf);
+	uint32_t overruns = 0;
+	for (uint8_t i = 0; i < sizeof(logCursors) / sizeof(logCursors[0]); i++) {
+		overruns += logCursors[i].overruns;
+	}
+	sprintf(buf, "Samples not logged: %lu", (unsigned long)overruns);
+	hardware->Serial_Write(buf);
+#ifndef ARDUINO
+	if (isPDLogOpen != 0) {
+		sprintf(buf, "Samples logged: %llu", (unsigned long long)pdLog.readAppendCount());
+		hardware->Serial_Write(buf);
+	}
+#endif
+	pSyncGroup->readStats(&syncStats);
+	sprintf(buf, "Synchronized cycles: %lu, trigger writes %lu, skew %lu ns, max skew %lu ns",
+			(unsigned long)syncStats.cycles, (unsigned long)syncStats.writes,
+			(unsigned long)syncStats.lastSkew_ns, (unsigned long)syncStats.maxSkew_ns);
+	hardware->Serial_Write(buf);
+	for (uint8_t i = 0; i < sizeof(ports) / sizeof(ports[0]); i++) {
+		if (pScheduler->readStats(ports[i], &stats) == SUCCESS) {
+			sprintf(buf, "Port %u: class %u, cycle %lu us, cost %lu us, jobs %lu, deadline misses %lu, max lateness %lu us",
+					unsigned(i), unsigned(stats.busClass), (unsigned long)stats.cycle_us, (unsigned long)stats.cost_us,
+					(unsigned long)stats.jobs, (unsigned long)stats.misses, (unsigned long)stats.maxLateness_us);
+			hardware->Serial_Write(buf);
+		}
+	}
+	for (uint8_t i = 0; i < sizeof(ports) / sizeof(ports[0]); i++) {
+		IOLHistogram &latency = pdTimings[i].readLatency();
+		IOLHistogram &jitter = pdTimings[i].readJitter();
+		uint64_t rx_ns = pdTimings[i].readLastRxTime();
+		if (rx_ns == 0) {
+			continue;
+		}
+		if (latency.readCount() == 0) {
+			// Cycle timer ports only have an estimated request start
+			sprintf(buf, "Port %u: periods %lu, latency not measured, jitter p50 %lu p99 %lu max %lu us, age %lu us",
+					unsigned(i), (unsigned long)jitter.readCount(),
+					(unsigned long)jitter.readPercentile(500000u), (unsigned long)jitter.readPercentile(990000u), (unsigned long)jitter.readMax(),
+					(unsigned long)((hardware->get_time_ns() - rx_ns) / 1000u));
+			hardware->Serial_Write(buf);
+			continue;
+		}
+		sprintf(buf, "Port %u: exchanges %lu, latency p50 %lu p99 %lu max %lu us, jitter p50 %lu p99 %lu max %lu us, age %lu us",
+				unsigned(i), (unsigned long)latency.readCount(),
+				(unsigned long)latency.readPercentile(500000u), (unsigned long)latency.readPercentile(990000u), (unsigned long)latency.readMax(),
+				(unsigned long)jitter.readPercentile(500000u), (unsigned long)jitter.readPercentile(990000u), (unsigned long)jitter.readMax(),
+				(unsigned long)((hardware->get_time_ns() - rx_ns) / 1000u));
+		hardware->Serial_Write(buf);
+	}
+}
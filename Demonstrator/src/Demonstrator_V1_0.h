@@ -33,6 +33,9 @@
 //add your includes for the project Demonstrator_V1_0 here
 void Demo_setup(HardwareBase *hardware_loc);
 void Demo_loop();
+void Demo_enableTrace();
+void Demo_enablePDLog(char const *path);
+void Demo_requestStatistics();
 
 //end of add your includes here
 
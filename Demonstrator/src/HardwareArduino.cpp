@@ -44,6 +44,8 @@
 //!**** Implementation **********************************************************
 
 HardwareArduino::HardwareArduino()
+:lastMicros_(0),
+microsOverflows_(0)
 {
     // Define all SPI signals for the Geckoboard as inputs. if not, MOSI cant be thrown to 0V
     pinMode(50, in);
@@ -124,6 +126,24 @@ void HardwareArduino::IO_PinMode(PinNames pinname, PinMode mode)
 	}
 }
 
+//!*****************************************************************************
+//!function :      IO_Read
+//!*****************************************************************************
+//!  \brief        Reads the logical value of a pin
+//!
+//!  \type         local
+//!
+//!  \param[in]	   PinNames   name of the Pin
+//!
+//!  \return       logical value of the pin (0 or 1)
+//!
+//!*****************************************************************************
+uint8_t HardwareArduino::IO_Read(PinNames pinname)
+{
+    uint8_t pinnumber = get_pinnumber(pinname);
+	return uint8_t(digitalRead(pinnumber));
+}
+
 //!*****************************************************************************
 //!function :      Serial_Write
 //!*****************************************************************************
@@ -212,6 +232,57 @@ void HardwareArduino::wait_for(uint32_t delay_ms)
     delay(delay_ms);
 }
 
+//!*****************************************************************************
+//!function :      wait_until_ns
+//!*****************************************************************************
+//!  \brief        delay until the given point in time
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint64_t    deadline in nanoseconds (see get_time_ns)
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareArduino::wait_until_ns(uint64_t deadline_ns)
+{
+    uint64_t now = get_time_ns();
+    while (now < deadline_ns) {
+        uint64_t remaining_us = (deadline_ns - now + 999u) / 1000u;
+        if (remaining_us > 2000u) {
+            delay(uint32_t(remaining_us / 1000u) - 1u);
+        }
+        else {
+            delayMicroseconds(uint32_t(remaining_us));
+        }
+        now = get_time_ns();
+    }
+}
+
+//!*****************************************************************************
+//!function :      get_time_ns
+//!*****************************************************************************
+//!  \brief        returns a monotonic timestamp with microsecond resolution.
+//!                The overflow of micros() is counted, so this must be called
+//!                at least every 71 minutes.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       time since startup in nanoseconds
+//!
+//!*****************************************************************************
+uint64_t HardwareArduino::get_time_ns()
+{
+    uint32_t now = micros();
+    if (now < lastMicros_) {
+        microsOverflows_++;
+    }
+    lastMicros_ = now;
+    return ((uint64_t(microsOverflows_) << 32) + now) * 1000u;
+}
+
 //!*****************************************************************************
 //!function :      get_pinnumber
 //!*****************************************************************************
@@ -54,6 +54,7 @@ public:
 
 	virtual void IO_Write(PinNames pinname, uint8_t state);
 	virtual void IO_PinMode(PinNames pinname, PinMode mode); //pinMode
+	virtual uint8_t IO_Read(PinNames pinname);
 
 	virtual void Serial_Write(char const * buf);
 	virtual void Serial_Write(int number);
@@ -61,8 +62,13 @@ public:
 	virtual void SPI_Write(uint8_t channel, uint8_t * data, uint8_t length);
 
 	virtual void wait_for(uint32_t delay_ms);
+	virtual void wait_until_ns(uint64_t deadline_ns);
+	virtual uint64_t get_time_ns();
 
 private:
+	uint32_t lastMicros_;
+	uint32_t microsOverflows_;
+
 	uint8_t get_pinnumber(PinNames pinname);
 };
 
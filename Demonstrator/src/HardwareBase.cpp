@@ -47,3 +47,285 @@ HardwareBase::HardwareBase()
 HardwareBase::~HardwareBase()
 {
 }
+
+//!*****************************************************************************
+//!function :      IO_WaitForInterrupt
+//!*****************************************************************************
+//!  \brief        Waits until the low-active interrupt pin gets asserted or
+//!                the deadline is reached. The default polls the pin every
+//!                50 microseconds, hardware with edge interrupts should
+//!                override this.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   PinNames   name of the interrupt pin
+//!				   uint64_t   deadline in nanoseconds (see get_time_ns)
+//!
+//!  \return       1 if the interrupt pin is asserted, 0 on timeout
+//!
+//!*****************************************************************************
+uint8_t HardwareBase::IO_WaitForInterrupt(PinNames pinname, uint64_t deadline_ns)
+{
+	while (IO_Read(pinname) != 0) {
+		uint64_t now = get_time_ns();
+		if (now >= deadline_ns) {
+			return 0;
+		}
+		wait_until_ns((deadline_ns - now > 50000u) ? now + 50000u : deadline_ns);
+	}
+	return 1;
+}
+
+//!*****************************************************************************
+//!function :      wait_for_us
+//!*****************************************************************************
+//!  \brief        delay the thread for the given time
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint32_t    delay time in microseconds
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareBase::wait_for_us(uint32_t delay_us)
+{
+	wait_until_ns(get_time_ns() + uint64_t(delay_us) * 1000u);
+}
+
+//!*****************************************************************************
+//!function :      hasVirtualTime
+//!*****************************************************************************
+//!  \brief        Tells if the clock only advances when a thread waits. Such
+//!                a clock serves one thread, several waiting threads would
+//!                move it for each other.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       1 for a virtual clock, 0 for the real time
+//!
+//!*****************************************************************************
+uint8_t HardwareBase::hasVirtualTime()
+{
+	return 0;
+}
+
+//!*****************************************************************************
+//!function :      NV_Read
+//!*****************************************************************************
+//!  \brief        Reads a block from non-volatile storage, which survives a
+//!                restart of the master. The default has no storage.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   char const* name of the block
+//!				   uint8_t*    buffer for the data
+//!				   uint16_t    length of the block in bytes
+//!
+//!  \return       0 if the whole block was read, 1 if not
+//!
+//!*****************************************************************************
+uint8_t HardwareBase::NV_Read(char const * name, uint8_t * data, uint16_t length)
+{
+	(void)name;
+	(void)data;
+	(void)length;
+	return 1;
+}
+
+//!*****************************************************************************
+//!function :      NV_Write
+//!*****************************************************************************
+//!  \brief        Writes a block to non-volatile storage. The default has no
+//!                storage.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   char const*    name of the block
+//!				   uint8_t const* data to store
+//!				   uint16_t       length of the block in bytes
+//!
+//!  \return       0 if success, 1 if not
+//!
+//!*****************************************************************************
+uint8_t HardwareBase::NV_Write(char const * name, uint8_t const * data, uint16_t length)
+{
+	(void)name;
+	(void)data;
+	(void)length;
+	return 1;
+}
+
+//!*****************************************************************************
+//!function :      NV_Map
+//!*****************************************************************************
+//!  \brief        Maps a block of non-volatile storage into memory. Writes to
+//!                the block are kept without an NV_Write, a new block is
+//!                filled with zeros. The default has no storage.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   char const* name of the block
+//!				   uint16_t    length of the block in bytes
+//!
+//!  \return       pointer to the block, nullptr if not available
+//!
+//!*****************************************************************************
+uint8_t * HardwareBase::NV_Map(char const * name, uint16_t length)
+{
+	(void)name;
+	(void)length;
+	return nullptr;
+}
+
+//!*****************************************************************************
+//!function :      SPI_WriteFrames
+//!*****************************************************************************
+//!  \brief        Writes several frames of the same length to the specified
+//!                SPI-Connection. Every frame gets its own chipselect cycle.
+//!                Hardware which is able to chain transfers should override
+//!                this, the default sends every frame with SPI_Write.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    channel number
+//!				   uint8_t*   pointer to the frames, received data is stored
+//!				              at the same place
+//!				   uint8_t    length of one frame in bytes
+//!				   uint8_t    number of frames
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareBase::SPI_WriteFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount)
+{
+	for (uint8_t i = 0; i < frameCount; i++) {
+		SPI_Write(channel, data + i * frameLength, frameLength);
+	}
+}
+
+//!*****************************************************************************
+//!function :      SPITransaction
+//!*****************************************************************************
+//!  \brief        Constructor for an empty transaction on the given channel
+//!
+//!  \type         local
+//!
+//!  \param[in]	   HardwareBase*  hardware used to send the frames
+//!				   uint8_t        SPI channel (chipselect) of the chip
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+HardwareBase::SPITransaction::SPITransaction(HardwareBase * hardware, uint8_t channel)
+:hardware_(hardware),
+channel_(channel),
+frameCount_(0)
+{
+}
+
+//!*****************************************************************************
+//!function :      ~SPITransaction
+//!*****************************************************************************
+//!  \brief        Destructor, sends frames which are still queued
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+HardwareBase::SPITransaction::~SPITransaction()
+{
+	flush();
+}
+
+//!*****************************************************************************
+//!function :      write
+//!*****************************************************************************
+//!  \brief        Queues a write frame. The transaction is flushed if it is
+//!                full.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    command byte (register address and flags)
+//!				   uint8_t    data byte
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareBase::SPITransaction::write(uint8_t command, uint8_t data)
+{
+	if (frameCount_ >= SPI_MAX_FRAMES) {
+		flush();
+	}
+	buf_[frameCount_ * SPI_FRAME_SIZE] = command;
+	buf_[frameCount_ * SPI_FRAME_SIZE + 1] = data;
+	pResults_[frameCount_] = nullptr;
+	frameCount_++;
+}
+
+//!*****************************************************************************
+//!function :      read
+//!*****************************************************************************
+//!  \brief        Queues a read frame. The received byte is stored in
+//!                *pResult when the transaction is flushed.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    command byte (register address and flags)
+//!				   uint8_t*   destination of the received byte
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareBase::SPITransaction::read(uint8_t command, uint8_t * pResult)
+{
+	if (frameCount_ >= SPI_MAX_FRAMES) {
+		flush();
+	}
+	buf_[frameCount_ * SPI_FRAME_SIZE] = command;
+	buf_[frameCount_ * SPI_FRAME_SIZE + 1] = 0x00;
+	pResults_[frameCount_] = pResult;
+	frameCount_++;
+}
+
+//!*****************************************************************************
+//!function :      flush
+//!*****************************************************************************
+//!  \brief        Sends all queued frames in one bus transfer and scatters the
+//!                received bytes of the read frames.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareBase::SPITransaction::flush()
+{
+	if (frameCount_ == 0) {
+		return;
+	}
+
+#ifndef ARDUINO
+	std::lock_guard<std::mutex> lock(hardware_->busMutex_);
+#endif
+	if (frameCount_ == 1) {
+		hardware_->SPI_Write(channel_, buf_, SPI_FRAME_SIZE);
+	}
+	else {
+		hardware_->SPI_WriteFrames(channel_, buf_, SPI_FRAME_SIZE, frameCount_);
+	}
+
+	for (uint8_t i = 0; i < frameCount_; i++) {
+		if (pResults_[i] != nullptr) {
+			*pResults_[i] = buf_[i * SPI_FRAME_SIZE + 1];
+		}
+	}
+	frameCount_ = 0;
+}
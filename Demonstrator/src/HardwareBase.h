@@ -31,6 +31,9 @@
 
 //!**** Header-Files ************************************************************
 #include <cstdint>
+#ifndef ARDUINO
+#include <mutex>
+#endif
 //!**** Macros ******************************************************************
 
 //!**** Data types **************************************************************
@@ -52,6 +55,11 @@ public:
 
 	enum PinMode { out, in_pullup, in };
 
+	// Size of one register frame (command, data) and the number of frames one
+	// SPITransaction can hold before it has to be flushed to the bus
+	static constexpr uint8_t SPI_FRAME_SIZE = 2;
+	static constexpr uint8_t SPI_MAX_FRAMES = 72;
+
 	enum PinNames {port01CS, port23CS, port01IRQ, port23IRQ, port0DI, port1DI, port2DI, port3DI,	
 	port0LedGreen, port0LedRed, port0LedRxErr, port0LedRxRdy,
 	port1LedGreen, port1LedRed, port1LedRxErr, port1LedRxRdy,
@@ -63,16 +71,53 @@ public:
 
 	virtual void IO_Write(PinNames pinnumber, uint8_t state) = 0;
 	virtual void IO_PinMode(PinNames pinnumber, PinMode mode) = 0; //pinMode
+	virtual uint8_t IO_Read(PinNames pinnumber) = 0;
+	virtual uint8_t IO_WaitForInterrupt(PinNames pinnumber, uint64_t deadline_ns);
 
 	virtual void Serial_Write(char const * buf) = 0;
 	virtual void Serial_Write(int number) = 0;
 
 	virtual void SPI_Write(uint8_t channel, uint8_t * data, uint8_t length) = 0;
+	virtual void SPI_WriteFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount);
 
 	virtual void wait_for(uint32_t delay_ms) = 0;
+	virtual void wait_for_us(uint32_t delay_us);
+	virtual void wait_until_ns(uint64_t deadline_ns) = 0;
+	virtual uint64_t get_time_ns() = 0;
+	virtual uint8_t hasVirtualTime();
+
+	virtual uint8_t NV_Read(char const * name, uint8_t * data, uint16_t length);
+	virtual uint8_t NV_Write(char const * name, uint8_t const * data, uint16_t length);
+	virtual uint8_t * NV_Map(char const * name, uint16_t length);
+
+	//!*************************************************************************
+	//!  Queues register frames for one chipselect and sends them with a single
+	//!  SPI_WriteFrames call. The received data byte of every read frame is
+	//!  written back to the buffer given in read().
+	//!*************************************************************************
+	class SPITransaction {
+	public:
+		SPITransaction(HardwareBase * hardware, uint8_t channel);
+		~SPITransaction();
+
+		void write(uint8_t command, uint8_t data);
+		void read(uint8_t command, uint8_t * pResult);
+		void flush();
+
+	private:
+		HardwareBase * hardware_;
+		uint8_t channel_;
+		uint8_t frameCount_;
+		uint8_t buf_[SPI_MAX_FRAMES * SPI_FRAME_SIZE];
+		uint8_t * pResults_[SPI_MAX_FRAMES];
+	};
 
-private:
-
+protected:
+#ifndef ARDUINO
+	// Bus arbiter: the chipselects share one SPI bus, a flush owns it for
+	// the transfer only and never while a chip waits for its device
+	std::mutex busMutex_;
+#endif
 };
 
 #endif //_HARDWAREBASE_H
\ No newline at end of file
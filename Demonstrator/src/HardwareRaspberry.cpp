@@ -30,7 +30,10 @@
 
 //!**** Header-Files ************************************************************
 #include "HardwareRaspberry.h"
+#include <errno.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <iostream>				// Needed for File-IO
@@ -40,9 +43,15 @@
 
 #include <fcntl.h>   			// Needed for SPI port
 #include <sys/ioctl.h>			// Needed for SPI port
+#include <sys/mman.h>			// Needed for NV_Map
+#include <sys/stat.h>			// Needed for NV_Map and NV_Write
 #include <linux/spi/spidev.h>	// Needed for SPI port
 
 #include <wiringPiSPI.h>		// Needed for SPI communication
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 //int wiringPiSPIGetFd     (int channel) ;
 //int wiringPiSPIDataRW    (int channel, unsigned char *data, int len) ;
 //int wiringPiSPISetupMode (int channel, int speed, int mode) ;
@@ -52,11 +61,35 @@
 #define LOW 0
 #define HIGH 1
 
+constexpr int SPI_SPEED = 500000;		// SPI clock in Hz
+constexpr uint32_t SPIN_TAIL_NS = 20000;	// default busy wait before a deadline
+constexpr char const * STATE_DIRECTORY = "/var/lib/iolmaster";	// default directory of the NV blocks
+
 //!**** Data types **************************************************************
 
 //!**** Function prototypes *****************************************************
 
 //!**** Data ********************************************************************
+// Edge counters of the two max14819 interrupt pins, incremented by the
+// wiringPi interrupt threads
+static std::mutex irqMutex;
+static std::condition_variable irqCondition;
+static uint32_t irqCount[2] = {0, 0};
+static bool irqIsRegistered[2] = {false, false};
+
+static void irq01Handler(void)
+{
+	std::lock_guard<std::mutex> lock(irqMutex);
+	irqCount[0]++;
+	irqCondition.notify_all();
+}
+
+static void irq23Handler(void)
+{
+	std::lock_guard<std::mutex> lock(irqMutex);
+	irqCount[1]++;
+	irqCondition.notify_all();
+}
 
 //!**** Implementation **********************************************************
 
@@ -64,17 +97,57 @@
 
 
 HardwareRaspberry::HardwareRaspberry()
+:spinTail_ns_(SPIN_TAIL_NS),
+stateDirectory_(STATE_DIRECTORY)
+{
+	init(true);
+}
+
+//!*****************************************************************************
+//!function :      HardwareRaspberry
+//!*****************************************************************************
+//!  \brief        Constructor for derived classes which bring their own SPI
+//!                implementation
+//!
+//!  \type         local
+//!
+//!  \param[in]	   bool       true if the SPI gets initialized with wiringPi
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+HardwareRaspberry::HardwareRaspberry(bool setupSPI)
+:spinTail_ns_(SPIN_TAIL_NS),
+stateDirectory_(STATE_DIRECTORY)
+{
+	init(setupSPI);
+}
+
+//!*****************************************************************************
+//!function :      init
+//!*****************************************************************************
+//!  \brief        Initializes wiringPi and optional the wiringPi SPI
+//!
+//!  \type         local
+//!
+//!  \param[in]	   bool       true if the SPI gets initialized with wiringPi
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareRaspberry::init(bool setupSPI)
 {
 	// Init Wiring Pi
 	wiringPiSetup();
 
 	// Init SPI
-	Serial_Write("Init_SPI starts");
-	wiringPiSPISetup(0, 500000);
-	wiringPiSPISetup(1, 500000);
+	if (setupSPI) {
+		Serial_Write("Init_SPI starts");
+		wiringPiSPISetup(0, SPI_SPEED);
+		wiringPiSPISetup(1, SPI_SPEED);
 
-	Serial_Write("Init_SPI finished");
-	wait_for(1*1000);
+		Serial_Write("Init_SPI finished");
+	}
 }
 
 
@@ -154,6 +227,199 @@ void HardwareRaspberry::IO_PinMode(PinNames pinname, PinMode mode)
 	}
 }
 
+//!*****************************************************************************
+//!function :      IO_Read
+//!*****************************************************************************
+//!  \brief        Reads the logical value of a pin
+//!
+//!  \type         local
+//!
+//!  \param[in]	   PinNames   name of the Pin
+//!
+//!  \return       logical value of the pin (0 or 1)
+//!
+//!*****************************************************************************
+uint8_t HardwareRaspberry::IO_Read(PinNames pinname)
+{
+	uint8_t pinnumber = get_pinnumber(pinname);
+	return (digitalRead(pinnumber) == LOW) ? LOW : HIGH;
+}
+
+//!*****************************************************************************
+//!function :      IO_WaitForInterrupt
+//!*****************************************************************************
+//!  \brief        Waits for the falling edge of a max14819 interrupt pin.
+//!                Returns immediately if the pin is already asserted.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   PinNames   name of the interrupt pin
+//!				   uint64_t   deadline in nanoseconds (see get_time_ns)
+//!
+//!  \return       1 if the interrupt pin is asserted, 0 on timeout
+//!
+//!*****************************************************************************
+uint8_t HardwareRaspberry::IO_WaitForInterrupt(PinNames pinname, uint64_t deadline_ns)
+{
+	uint8_t index;
+	switch (pinname) {
+		case port01IRQ:	index = 0; break;
+		case port23IRQ:	index = 1; break;
+		default:		return HardwareBase::IO_WaitForInterrupt(pinname, deadline_ns);
+	}
+
+	std::unique_lock<std::mutex> lock(irqMutex);
+	if (!irqIsRegistered[index]) {
+		wiringPiISR(get_pinnumber(pinname), INT_EDGE_FALLING, (index == 0) ? irq01Handler : irq23Handler);
+		irqIsRegistered[index] = true;
+	}
+
+	// Take the edge counter before sampling the level, so an edge between
+	// the two does not get lost
+	uint32_t count = irqCount[index];
+	if (IO_Read(pinname) == LOW) {
+		return 1;
+	}
+	// steady_clock is CLOCK_MONOTONIC, the same clock as get_time_ns
+	std::chrono::steady_clock::time_point deadline{std::chrono::nanoseconds(deadline_ns)};
+	irqCondition.wait_until(lock, deadline, [&] { return irqCount[index] != count; });
+
+	return (IO_Read(pinname) == LOW) ? 1 : 0;
+}
+
+//!*****************************************************************************
+//!function :      NV_Read
+//!*****************************************************************************
+//!  \brief        Reads a block from the file <state directory>/iolmaster-<name>
+//!
+//!  \type         local
+//!
+//!  \param[in]	   char const* name of the block
+//!				   uint8_t*    buffer for the data
+//!				   uint16_t    length of the block in bytes
+//!
+//!  \return       0 if the whole block was read, 1 if not
+//!
+//!*****************************************************************************
+uint8_t HardwareRaspberry::NV_Read(char const * name, uint8_t * data, uint16_t length)
+{
+	char path[256];
+	snprintf(path, sizeof(path), "%s/iolmaster-%s", stateDirectory_, name);
+
+	std::ifstream file(path, std::ios::binary);
+	if (!file.read(reinterpret_cast<char *>(data), length)) {
+		return 1;
+	}
+	// A block of another length belongs to another program version
+	return (file.peek() == std::ifstream::traits_type::eof()) ? 0 : 1;
+}
+
+//!*****************************************************************************
+//!function :      NV_Write
+//!*****************************************************************************
+//!  \brief        Writes a block to the file <state directory>/iolmaster-<name>.
+//!                The block is written to a temporary file first, synced to
+//!                the storage and renamed, so neither a crash nor a power
+//!                loss leaves a half written block. The directory is created
+//!                if it is missing.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   char const*    name of the block
+//!				   uint8_t const* data to store
+//!				   uint16_t       length of the block in bytes
+//!
+//!  \return       0 if success, 1 if not
+//!
+//!*****************************************************************************
+uint8_t HardwareRaspberry::NV_Write(char const * name, uint8_t const * data, uint16_t length)
+{
+	char path[256];
+	char tmpPath[260];
+	snprintf(path, sizeof(path), "%s/iolmaster-%s", stateDirectory_, name);
+	snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+
+	mkdir(stateDirectory_, 0755);	// fails harmlessly if it exists
+	int fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		return 1;
+	}
+	uint16_t written = 0;
+	while (written < length) {
+		ssize_t count = write(fd, &data[written], length - written);
+		if (count <= 0) {
+			close(fd);
+			return 1;
+		}
+		written = uint16_t(written + count);
+	}
+	if ((fsync(fd) != 0) || (close(fd) != 0) || (rename(tmpPath, path) != 0)) {
+		return 1;
+	}
+	// The rename itself is only durable once the directory is synced
+	int dirFd = open(stateDirectory_, O_RDONLY | O_DIRECTORY);
+	if (dirFd >= 0) {
+		fsync(dirFd);
+		close(dirFd);
+	}
+	return 0;
+}
+
+//!*****************************************************************************
+//!function :      NV_Map
+//!*****************************************************************************
+//!  \brief        Maps the file <state directory>/iolmaster-<name> shared
+//!                into memory, the kernel writes the changes back. A file of
+//!                another length belongs to another program version and is
+//!                cleared. The block stays mapped until the program ends.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   char const* name of the block
+//!				   uint16_t    length of the block in bytes
+//!
+//!  \return       pointer to the block, nullptr if not available
+//!
+//!*****************************************************************************
+uint8_t * HardwareRaspberry::NV_Map(char const * name, uint16_t length)
+{
+	char path[256];
+	struct stat status;
+	snprintf(path, sizeof(path), "%s/iolmaster-%s", stateDirectory_, name);
+
+	mkdir(stateDirectory_, 0755);	// fails harmlessly if it exists
+	int fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		return nullptr;
+	}
+	if ((fstat(fd, &status) != 0)
+			|| ((status.st_size != length) && ((ftruncate(fd, 0) != 0) || (ftruncate(fd, length) != 0)))) {
+		close(fd);
+		return nullptr;
+	}
+	void * block = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	return (block != MAP_FAILED) ? static_cast<uint8_t *>(block) : nullptr;
+}
+
+//!*****************************************************************************
+//!function :      set_state_directory
+//!*****************************************************************************
+//!  \brief        Sets the directory of the NV blocks, default is
+//!                /var/lib/iolmaster, which survives a reboot.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   char const* directory, must stay valid
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareRaspberry::set_state_directory(char const * directory)
+{
+	stateDirectory_ = directory;
+}
+
 //!*****************************************************************************
 //!function :      Serial_Write
 //!*****************************************************************************
@@ -209,6 +475,50 @@ void HardwareRaspberry::SPI_Write(uint8_t channel, uint8_t * data, uint8_t lengt
 	//printf("received %x,%x\n", data[0], data[1]);
 }
 
+//!*****************************************************************************
+//!function :      SPI_WriteFrames
+//!*****************************************************************************
+//!  \brief        Writes several frames to the specified SPI-Connection with
+//!                one SPI_IOC_MESSAGE ioctl. The chipselect is released
+//!                between the frames.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    channel number
+//!				   uint8_t*   pointer to the frames
+//!				   uint8_t    length of one frame in bytes
+//!				   uint8_t    number of frames
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareRaspberry::SPI_WriteFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount)
+{
+	struct spi_ioc_transfer transfer[SPI_MAX_FRAMES];
+	int fd = wiringPiSPIGetFd(channel);
+
+	while (frameCount > 0) {
+		uint8_t count = (frameCount > SPI_MAX_FRAMES) ? SPI_MAX_FRAMES : frameCount;
+
+		memset(transfer, 0, sizeof(transfer[0]) * count);
+		for (uint8_t i = 0; i < count; i++) {
+			transfer[i].tx_buf = (unsigned long)(data + i * frameLength);
+			transfer[i].rx_buf = (unsigned long)(data + i * frameLength);
+			transfer[i].len = frameLength;
+			transfer[i].speed_hz = SPI_SPEED;
+			transfer[i].bits_per_word = 8;
+			// Release chipselect between the frames, not after the last one
+			transfer[i].cs_change = (i + 1 < count) ? 1 : 0;
+		}
+		if (ioctl(fd, SPI_IOC_MESSAGE(count), transfer) < 0) {
+			printf("SPI_WriteFrames: ioctl failed\n");
+		}
+
+		data += count * frameLength;
+		frameCount = uint8_t(frameCount - count);
+	}
+}
+
 //!*****************************************************************************
 //!function :      wait_for
 //!*****************************************************************************
@@ -223,9 +533,75 @@ void HardwareRaspberry::SPI_Write(uint8_t channel, uint8_t * data, uint8_t lengt
 //!*****************************************************************************
 void HardwareRaspberry::wait_for(uint32_t delay_ms)
 {
-	//printf("Sleep_in\n");
-	usleep(delay_ms*1000);
-	//printf("Sleep_out\n");
+	wait_until_ns(get_time_ns() + uint64_t(delay_ms) * 1000000u);
+}
+
+//!*****************************************************************************
+//!function :      wait_until_ns
+//!*****************************************************************************
+//!  \brief        delay the thread until the given point in time. Sleeps with
+//!                clock_nanosleep and busy waits the last microseconds to
+//!                hide the wakeup latency of the scheduler.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint64_t    deadline in nanoseconds (see get_time_ns)
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareRaspberry::wait_until_ns(uint64_t deadline_ns)
+{
+	if (deadline_ns > get_time_ns() + spinTail_ns_) {
+		struct timespec wakeup;
+		uint64_t sleepUntil = deadline_ns - spinTail_ns_;
+		wakeup.tv_sec = time_t(sleepUntil / 1000000000u);
+		wakeup.tv_nsec = long(sleepUntil % 1000000000u);
+		// Sleep again after a signal, any other error is left to the spin
+		// loop. clock_nanosleep returns the error number, it does not set errno.
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, nullptr) == EINTR) {
+		}
+	}
+	while (get_time_ns() < deadline_ns) {
+		// spin the remaining time
+	}
+}
+
+//!*****************************************************************************
+//!function :      get_time_ns
+//!*****************************************************************************
+//!  \brief        returns a monotonic timestamp
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       CLOCK_MONOTONIC in nanoseconds
+//!
+//!*****************************************************************************
+uint64_t HardwareRaspberry::get_time_ns()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return uint64_t(now.tv_sec) * 1000000000u + uint64_t(now.tv_nsec);
+}
+
+//!*****************************************************************************
+//!function :      set_spin_tail
+//!*****************************************************************************
+//!  \brief        sets the time wait_until_ns busy waits before a deadline,
+//!                0 disables the busy wait
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint32_t    busy wait time in microseconds
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareRaspberry::set_spin_tail(uint32_t spin_us)
+{
+	spinTail_ns_ = spin_us * 1000u;
 }
 
 //!*****************************************************************************
@@ -56,15 +56,34 @@ public:
 
 	virtual void IO_Write(PinNames pinnumber, uint8_t state);
 	virtual void IO_PinMode(PinNames pinnumber, PinMode mode); //pinMode
+	virtual uint8_t IO_Read(PinNames pinnumber);
+	virtual uint8_t IO_WaitForInterrupt(PinNames pinnumber, uint64_t deadline_ns);
 
 	virtual void Serial_Write(char const * buf);
 	virtual void Serial_Write(int number);
 
 	virtual void SPI_Write(uint8_t channel, uint8_t * data, uint8_t length);
+	virtual void SPI_WriteFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount);
 
 	virtual void wait_for(uint32_t delay_ms);
+	virtual void wait_until_ns(uint64_t deadline_ns);
+	virtual uint64_t get_time_ns();
+
+	virtual uint8_t NV_Read(char const * name, uint8_t * data, uint16_t length);
+	virtual uint8_t NV_Write(char const * name, uint8_t const * data, uint16_t length);
+	virtual uint8_t * NV_Map(char const * name, uint16_t length);
+
+	void set_spin_tail(uint32_t spin_us);
+	void set_state_directory(char const * directory);
+
+protected:
+	explicit HardwareRaspberry(bool setupSPI);
 
 private:
+	uint32_t spinTail_ns_;
+	char const * stateDirectory_;
+
+	void init(bool setupSPI);
 
 	uint8_t get_pinnumber(PinNames pinname);
 
@@ -0,0 +1,830 @@
+#ifndef ARDUINO
+//!*****************************************************************************
+//!  \file      HardwareSim.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Hardware abstraction which simulates the IO-Link master shield:
+//!             two MAX14819 on the register level with virtual IO-Link
+//!             devices (SimDevice) on the four ports. The demonstrator runs
+//!             unmodified on any Linux machine.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-09
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!**** Header-Files ************************************************************
+#include "HardwareSim.h"
+#include "Max14819.h"
+#include "IOLink.h"
+#include <stdio.h>
+#include <time.h>
+
+using namespace max14819;
+
+//!**** Macros ******************************************************************
+constexpr uint8_t SIM_REV_ID = 0x02u;				// content of RevID
+constexpr uint32_t SIM_SPI_SPEED = 500000u;			// SPI clock of the virtual bus in Hz
+constexpr uint64_t SIM_SPI_CS_NS = 4000u;			// chipselect overhead per frame in virtual time
+constexpr uint64_t ESTCOM_SUCCESS_NS = 2000000u;	// duration of a successful EstCom sequence
+constexpr uint64_t ESTCOM_FAIL_NS = 65000000u;		// duration of EstCom with all three retries failed
+constexpr uint32_t RESPONSE_BITS = 11u;				// response time of the device in bit times
+constexpr uint32_t MIN_CYCLE_US = 400u;				// shortest period of the cycle timer
+constexpr uint64_t REALTIME_POLL_NS = 1000000u;		// longest sleep in real time, catches writes of other threads
+constexpr uint64_t NO_EVENT = ~uint64_t(0);
+
+//!**** Data types **************************************************************
+
+//!**** Function prototypes *****************************************************
+
+//!**** Data ********************************************************************
+
+//!**** Implementation **********************************************************
+
+HardwareSim::HardwareSim(bool virtualTime)
+:virtualTime_(virtualTime),
+simTime_ns_(0)
+{
+	for (uint8_t i = 0; i < CHIP_COUNT; i++) {
+		for (uint8_t reg = 0; reg < REG_COUNT; reg++) {
+			chip_[i].reg[reg] = 0;
+		}
+		for (uint8_t port = 0; port < PORT_COUNT; port++) {
+			chip_[i].port[port].device = nullptr;
+			resetPort(chip_[i], port, 0);
+		}
+	}
+}
+
+HardwareSim::~HardwareSim()
+{
+}
+
+void HardwareSim::begin(){
+
+}
+
+//!*****************************************************************************
+//!function :      attachDevice
+//!*****************************************************************************
+//!  \brief        Connects a virtual device to a port of the shield. The
+//!                device has to live as long as the hardware.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t      port number 0..3 (port 0/1 on DRIVER01,
+//!				                port 2/3 on DRIVER23)
+//!				   SimDevice*   device, nullptr for an empty port
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSim::attachDevice(uint8_t portNr, SimDevice * device)
+{
+	if (portNr >= CHIP_COUNT * PORT_COUNT) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mutex_);
+	chip_[portNr / PORT_COUNT].port[portNr % PORT_COUNT].device = device;
+}
+
+//!*****************************************************************************
+//!function :      NV_Map
+//!*****************************************************************************
+//!  \brief        The simulation keeps the blocks in memory, they survive a
+//!                restart of the master on the same simulation but not the
+//!                end of the program. Mapping a block with another length
+//!                replaces it.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   char const* name of the block
+//!				   uint16_t    length of the block in bytes
+//!
+//!  \return       pointer to the block
+//!
+//!*****************************************************************************
+uint8_t * HardwareSim::NV_Map(char const * name, uint16_t length)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::vector<uint8_t> & block = nvBlocks_[name];
+	if (block.size() != length) {
+		block.assign(length, 0);
+	}
+	return block.data();
+}
+
+void HardwareSim::IO_Write(PinNames pinnumber, uint8_t state)
+{
+	// LEDs and chipselects have no effect on the simulation
+	(void)pinnumber;
+	(void)state;
+}
+
+void HardwareSim::IO_PinMode(PinNames pinnumber, PinMode mode)
+{
+	(void)pinnumber;
+	(void)mode;
+}
+
+//!*****************************************************************************
+//!function :      IO_Read
+//!*****************************************************************************
+//!  \brief        Reads the state of a pin. The interrupt pins follow the
+//!                simulated chips, all other inputs are pulled up.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   PinNames   name of the pin
+//!
+//!  \return       logical value of the pin
+//!
+//!*****************************************************************************
+uint8_t HardwareSim::IO_Read(PinNames pinnumber)
+{
+	if ((pinnumber != port01IRQ) && (pinnumber != port23IRQ)) {
+		return 1;
+	}
+	std::lock_guard<std::mutex> lock(mutex_);
+	advance(now_ns());
+	return (isIrqAsserted((pinnumber == port01IRQ) ? 0 : 1) != 0) ? 0 : 1;
+}
+
+//!*****************************************************************************
+//!function :      IO_WaitForInterrupt
+//!*****************************************************************************
+//!  \brief        Waits until the low-active interrupt pin gets asserted or
+//!                the deadline is reached. Sleeps until the next event of the
+//!                simulation instead of polling, in virtual time the clock
+//!                jumps to the event.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   PinNames   name of the interrupt pin
+//!				   uint64_t   deadline in nanoseconds (see get_time_ns)
+//!
+//!  \return       1 if the interrupt pin is asserted, 0 on timeout
+//!
+//!*****************************************************************************
+uint8_t HardwareSim::IO_WaitForInterrupt(PinNames pinnumber, uint64_t deadline_ns)
+{
+	if ((pinnumber != port01IRQ) && (pinnumber != port23IRQ)) {
+		return HardwareBase::IO_WaitForInterrupt(pinnumber, deadline_ns);
+	}
+	uint8_t chipNr = (pinnumber == port01IRQ) ? 0 : 1;
+
+	while (1) {
+		uint64_t wakeup;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			uint64_t now = now_ns();
+			advance(now);
+			if (isIrqAsserted(chipNr) != 0) {
+				return 1;
+			}
+			if (now >= deadline_ns) {
+				return 0;
+			}
+			wakeup = nextEvent_ns();
+			if (wakeup > deadline_ns) {
+				wakeup = deadline_ns;
+			}
+			if (virtualTime_) {
+				simTime_ns_ = (wakeup > simTime_ns_) ? wakeup : simTime_ns_;
+				continue;
+			}
+			if (wakeup > now + REALTIME_POLL_NS) {
+				wakeup = now + REALTIME_POLL_NS;
+			}
+		}
+		wait_until_ns(wakeup);
+	}
+}
+
+//!*****************************************************************************
+//!function :      Serial_Write
+//!*****************************************************************************
+//!  \brief        Writes a string to the console
+//!
+//!  \type         local
+//!
+//!  \param[in]	   char const* string to write
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSim::Serial_Write(char const * buf)
+{
+	printf("%s\n", buf);
+}
+
+void HardwareSim::Serial_Write(int number)
+{
+	printf("%d\n", number);
+}
+
+void HardwareSim::SPI_Write(uint8_t channel, uint8_t * data, uint8_t length)
+{
+	SPI_WriteFrames(channel, data, length, 1);
+}
+
+//!*****************************************************************************
+//!function :      SPI_WriteFrames
+//!*****************************************************************************
+//!  \brief        Executes register frames (command, data) on the chip of the
+//!                channel. The data byte of a read frame is replaced by the
+//!                register value. In virtual time every frame takes its
+//!                transfer time on the bus.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    channel number, 0 DRIVER01, 1 DRIVER23
+//!				   uint8_t*   pointer to the frames
+//!				   uint8_t    length of one frame in bytes
+//!				   uint8_t    number of frames
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSim::SPI_WriteFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount)
+{
+	if ((channel >= CHIP_COUNT) || (frameLength < SPI_FRAME_SIZE)) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (uint8_t i = 0; i < frameCount; i++) {
+		uint8_t * frame = data + i * frameLength;
+		if (virtualTime_) {
+			simTime_ns_ += uint64_t(frameLength) * 8u * 1000000000u / SIM_SPI_SPEED + SIM_SPI_CS_NS;
+		}
+		uint64_t now = now_ns();
+		advance(now);
+
+		uint8_t reg = uint8_t(frame[0] & MAX_REG);
+		if ((frame[0] & 0x80u) != 0) {
+			frame[1] = readRegister(channel, reg, now);
+		}
+		else {
+			writeRegister(channel, reg, frame[1], now);
+		}
+		frame[0] = 0;
+	}
+}
+
+void HardwareSim::wait_for(uint32_t delay_ms)
+{
+	wait_until_ns(get_time_ns() + uint64_t(delay_ms) * NS_PER_MS);
+}
+
+//!*****************************************************************************
+//!function :      wait_until_ns
+//!*****************************************************************************
+//!  \brief        delay the thread until the given point in time. In virtual
+//!                time the clock is set to the deadline.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint64_t    deadline in nanoseconds (see get_time_ns)
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSim::wait_until_ns(uint64_t deadline_ns)
+{
+	if (virtualTime_) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (deadline_ns > simTime_ns_) {
+			simTime_ns_ = deadline_ns;
+		}
+		return;
+	}
+	struct timespec wakeup;
+	wakeup.tv_sec = time_t(deadline_ns / 1000000000u);
+	wakeup.tv_nsec = long(deadline_ns % 1000000000u);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, nullptr) != 0) {
+	}
+}
+
+uint64_t HardwareSim::get_time_ns()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return now_ns();
+}
+
+uint8_t HardwareSim::hasVirtualTime()
+{
+	return virtualTime_ ? 1 : 0;
+}
+
+//!*****************************************************************************
+//!function :      now_ns
+//!*****************************************************************************
+//!  \brief        Current time of the simulation, the caller holds the mutex
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       time in nanoseconds
+//!
+//!*****************************************************************************
+uint64_t HardwareSim::now_ns()
+{
+	if (virtualTime_) {
+		return simTime_ns_;
+	}
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return uint64_t(now.tv_sec) * 1000000000u + uint64_t(now.tv_nsec);
+}
+
+//!*****************************************************************************
+//!function :      advance
+//!*****************************************************************************
+//!  \brief        Executes all events of the chips up to the given time in
+//!                their order: end of EstCom, end of a transfer and the ticks
+//!                of the cycle timers.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint64_t   time in nanoseconds
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSim::advance(uint64_t time_ns)
+{
+	uint64_t event;
+	while ((event = nextEvent_ns()) <= time_ns) {
+		for (uint8_t i = 0; i < CHIP_COUNT; i++) {
+			SimChip & chip = chip_[i];
+			for (uint8_t port = 0; port < PORT_COUNT; port++) {
+				SimPort & p = chip.port[port];
+				if ((p.isEstCom != 0) && (p.estComDone_ns == event)) {
+					p.isEstCom = 0;
+					chip.reg[CQCtrlA + port] = uint8_t((chip.reg[CQCtrlA + port] & ~(ComRt0 | ComRt1)) | p.estComResult);
+				}
+				if ((p.isTransfer != 0) && (p.transferDone_ns == event)) {
+					finishTransfer(chip, port, event);
+				}
+				if ((p.isCyclic != 0) && (p.nextCycle_ns == event)) {
+					uint32_t cycle_us = IOL::cycleTimeToUs(chip.reg[CyclTmrA + port]);
+					p.nextCycle_ns += uint64_t((cycle_us > MIN_CYCLE_US) ? cycle_us : MIN_CYCLE_US) * NS_PER_US;
+					if (p.isTransfer != 0) {
+						// Previous answer still running, the cycle is lost
+						chip.reg[CQErrA + port] |= TCyclErr;
+					}
+					else {
+						sendMessage(chip, port, event);
+					}
+				}
+			}
+		}
+	}
+}
+
+//!*****************************************************************************
+//!function :      nextEvent_ns
+//!*****************************************************************************
+//!  \brief        Time of the next event of all chips
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       time in nanoseconds, NO_EVENT if nothing is running
+//!
+//!*****************************************************************************
+uint64_t HardwareSim::nextEvent_ns()
+{
+	uint64_t next = NO_EVENT;
+	for (uint8_t i = 0; i < CHIP_COUNT; i++) {
+		for (uint8_t port = 0; port < PORT_COUNT; port++) {
+			SimPort & p = chip_[i].port[port];
+			if ((p.isEstCom != 0) && (p.estComDone_ns < next)) {
+				next = p.estComDone_ns;
+			}
+			if ((p.isTransfer != 0) && (p.transferDone_ns < next)) {
+				next = p.transferDone_ns;
+			}
+			if ((p.isCyclic != 0) && (p.nextCycle_ns < next)) {
+				next = p.nextCycle_ns;
+			}
+		}
+	}
+	return next;
+}
+
+//!*****************************************************************************
+//!function :      resetPort
+//!*****************************************************************************
+//!  \brief        Channel reset (ChanStat Rst): default values of the channel
+//!                registers, empty FIFOs and L+ off
+//!
+//!  \type         local
+//!
+//!  \param[in]	   SimChip&   chip of the port
+//!				   uint8_t    0 port A, 1 port B
+//!				   uint64_t   time in nanoseconds
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSim::resetPort(SimChip & chip, uint8_t port, uint64_t time_ns)
+{
+	(void)time_ns;
+	static const uint8_t CHANNEL_REGS[] = { CQCtrlA, CQErrA, MsgCtrlA, ChanStatA, CQCfgA, CyclTmrA,
+			DeviceDlyA, TrigAssgnA, LCnfgA, IOStCfgA };
+	for (uint8_t i = 0; i < sizeof(CHANNEL_REGS); i++) {
+		chip.reg[CHANNEL_REGS[i] + port] = 0;
+	}
+
+	SimPort & p = chip.port[port];
+	p.txFifo.clear();
+	p.rxFifo.clear();
+	p.isKept = 0;
+	p.isEstCom = 0;
+	p.estComResult = 0;
+	p.estComDone_ns = 0;
+	p.isTransfer = 0;
+	p.sendPending = 0;
+	p.sizeAnswer = 0;
+	p.sizeReceived = 0;
+	p.transferDone_ns = 0;
+	p.isCyclic = 0;
+	p.nextCycle_ns = 0;
+	if (p.device != nullptr) {
+		p.device->powerOff();
+	}
+}
+
+//!*****************************************************************************
+//!function :      readRegister
+//!*****************************************************************************
+//!  \brief        Register read of the SPI interface, including the side
+//!                effects of FIFO and clear-on-read registers
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    chip number
+//!				   uint8_t    register address
+//!				   uint64_t   time in nanoseconds
+//!
+//!  \return       register value
+//!
+//!*****************************************************************************
+uint8_t HardwareSim::readRegister(uint8_t chipNr, uint8_t reg, uint64_t time_ns)
+{
+	(void)time_ns;
+	SimChip & chip = chip_[chipNr];
+	uint8_t port = uint8_t(reg & 0x01u);
+	uint8_t value = chip.reg[reg];
+
+	switch (reg) {
+	case TxRxDataA:
+	case TxRxDataB:
+		value = 0;
+		if (!chip.port[port].rxFifo.empty()) {
+			value = chip.port[port].rxFifo.front();
+			chip.port[port].rxFifo.pop_front();
+		}
+		break;
+	case Interrupt:
+	case CQErrA:
+	case CQErrB:
+		// clear on read
+		chip.reg[reg] = 0;
+		break;
+	case RxFIFOLvlA:
+	case RxFIFOLvlB:
+		value = uint8_t(chip.port[port].rxFifo.size());
+		break;
+	case CQCtrlA:
+	case CQCtrlB:
+		if (chip.port[port].isEstCom != 0) {
+			value |= EstCom;
+		}
+		break;
+	case RevID:
+		value = SIM_REV_ID;
+		break;
+	default:
+		break;
+	}
+	return value;
+}
+
+//!*****************************************************************************
+//!function :      writeRegister
+//!*****************************************************************************
+//!  \brief        Register write of the SPI interface, starts the actions of
+//!                the command bits
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    chip number
+//!				   uint8_t    register address
+//!				   uint8_t    value
+//!				   uint64_t   time in nanoseconds
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSim::writeRegister(uint8_t chipNr, uint8_t reg, uint8_t data, uint64_t time_ns)
+{
+	SimChip & chip = chip_[chipNr];
+	uint8_t port = uint8_t(reg & 0x01u);
+	SimPort & p = chip.port[port];
+
+	switch (reg) {
+	case TxRxDataA:
+	case TxRxDataB:
+		if (p.txFifo.size() < MAX_MSG_LENGTH + 2u) {
+			p.txFifo.push_back(data);
+		}
+		else {
+			chip.reg[Interrupt] |= uint8_t(TxErrorA << port);
+		}
+		break;
+	case Interrupt:
+	case RxFIFOLvlA:
+	case RxFIFOLvlB:
+	case CQErrA:
+	case CQErrB:
+	case Status:
+	case RevID:
+		// read only
+		break;
+	case CQCtrlA:
+	case CQCtrlB:
+		writeCQCtrl(chip, port, data, time_ns);
+		break;
+	case Trigger:
+		// Starts the kept message of every port assigned to a written
+		// trigger, the register reads back 0
+		for (uint8_t i = 0; i < PORT_COUNT; i++) {
+			uint8_t assign = chip.reg[TrigAssgnA + i];
+			if (((assign & TrigEn) == 0) || ((uint8_t(assign >> 4) & data & 0x0Fu) == 0)) {
+				continue;
+			}
+			if (chip.port[i].isTransfer == 0) {
+				sendMessage(chip, i, time_ns);
+			}
+			else {
+				chip.port[i].sendPending++;
+			}
+		}
+		break;
+	case ChanStatA:
+	case ChanStatB:
+		if ((data & Rst) != 0) {
+			resetPort(chip, port, time_ns);
+		}
+		chip.reg[reg] = uint8_t(data & ~Rst);
+		break;
+	case LCnfgA:
+	case LCnfgB:
+		if (p.device != nullptr) {
+			if ((data & LEn) != 0) {
+				p.device->powerOn(time_ns);
+			}
+			else {
+				p.device->powerOff();
+			}
+		}
+		chip.reg[reg] = data;
+		break;
+	default:
+		chip.reg[reg] = data;
+		break;
+	}
+}
+
+//!*****************************************************************************
+//!function :      writeCQCtrl
+//!*****************************************************************************
+//!  \brief        Write of CQCtrlA/B. FIFO resets and CQSend are executed
+//!                once, EstCom runs until the sequence is over, CycleTmrEn
+//!                starts and stops the cycle timer.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   SimChip&   chip of the port
+//!				   uint8_t    0 port A, 1 port B
+//!				   uint8_t    value
+//!				   uint64_t   time in nanoseconds
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSim::writeCQCtrl(SimChip & chip, uint8_t port, uint8_t data, uint64_t time_ns)
+{
+	SimPort & p = chip.port[port];
+	chip.reg[CQCtrlA + port] = uint8_t(data & (ComRt1 | ComRt0 | CycleTmrEn));
+
+	if ((data & TxFifoRst) != 0) {
+		p.txFifo.clear();
+		p.isKept = 0;
+	}
+	if ((data & RxFifoRst) != 0) {
+		p.rxFifo.clear();
+	}
+	if ((data & EstCom) != 0) {
+		// Wakeup and try COM3, COM2 and COM1
+		p.isEstCom = 1;
+		p.estComResult = 0;
+		chip.reg[CQCtrlA + port] &= uint8_t(~(ComRt1 | ComRt0));
+		if ((p.device != nullptr) && (p.device->wakeUp(time_ns) != 0)) {
+			switch (p.device->readBaudrate()) {
+			case 4800:
+				p.estComResult = ComRt0;
+				break;
+			case 38400:
+				p.estComResult = ComRt1;
+				break;
+			default:
+				p.estComResult = ComRt1 | ComRt0;
+				break;
+			}
+			p.estComDone_ns = time_ns + ESTCOM_SUCCESS_NS;
+		}
+		else {
+			p.estComDone_ns = time_ns + ESTCOM_FAIL_NS;
+		}
+	}
+	if ((data & CycleTmrEn) != 0) {
+		if (p.isCyclic == 0) {
+			p.isCyclic = 1;
+			p.nextCycle_ns = time_ns;
+		}
+	}
+	else {
+		p.isCyclic = 0;
+	}
+	if ((data & CQSend) != 0) {
+		if (p.isTransfer == 0) {
+			sendMessage(chip, port, time_ns);
+		}
+		else {
+			p.sendPending++;
+		}
+	}
+}
+
+//!*****************************************************************************
+//!function :      sendMessage
+//!*****************************************************************************
+//!  \brief        Takes the next message (size of answer, size of message,
+//!                message) from the transmit FIFO or the kept message and
+//!                lets the device answer it. The answer arrives after the
+//!                transfer time on the C/Q line.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   SimChip&   chip of the port
+//!				   uint8_t    0 port A, 1 port B
+//!				   uint64_t   time in nanoseconds
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSim::sendMessage(SimChip & chip, uint8_t port, uint64_t time_ns)
+{
+	SimPort & p = chip.port[port];
+	Message msg;
+
+	if ((p.txFifo.size() >= 2) && (p.txFifo.size() >= 2u + p.txFifo[1])) {
+		msg.sizeAnswer = p.txFifo[0];
+		msg.sizeMsg = p.txFifo[1];
+		p.txFifo.pop_front();
+		p.txFifo.pop_front();
+		for (uint8_t i = 0; (i < msg.sizeMsg) && (i < sizeof(msg.data)); i++) {
+			msg.data[i] = p.txFifo.front();
+			p.txFifo.pop_front();
+		}
+		if ((chip.reg[MsgCtrlA + port] & TxKeepMsg) != 0) {
+			p.keptMsg = msg;
+			p.isKept = 1;
+		}
+	}
+	else if (p.isKept != 0) {
+		msg = p.keptMsg;
+	}
+	else {
+		chip.reg[Interrupt] |= uint8_t(TxErrorA << port);
+		chip.reg[CQErrA + port] |= TSizeErr;
+		return;
+	}
+
+	// Device answers only in communication mode and with a correct message
+	uint8_t answer[sizeof(p.answer)];
+	uint8_t sizeReceived = 0;
+	if ((p.device != nullptr) && (msg.sizeMsg <= sizeof(msg.data))) {
+		sizeReceived = p.device->handleMessage(msg.data, msg.sizeMsg, answer);
+	}
+	if (sizeReceived > msg.sizeAnswer) {
+		sizeReceived = msg.sizeAnswer;
+	}
+	for (uint8_t i = 0; i < sizeReceived; i++) {
+		p.answer[i] = answer[i];
+	}
+
+	uint32_t baudrate = 38400u;
+	switch (chip.reg[CQCtrlA + port] & (ComRt1 | ComRt0)) {
+	case ComRt0:
+		baudrate = 4800u;
+		break;
+	case (ComRt1 | ComRt0):
+		baudrate = 230400u;
+		break;
+	default:
+		break;
+	}
+	uint32_t bits = (uint32_t(msg.sizeMsg) + msg.sizeAnswer) * 11u + RESPONSE_BITS;
+
+	p.isTransfer = 1;
+	p.sizeAnswer = msg.sizeAnswer;
+	p.sizeReceived = sizeReceived;
+	p.transferDone_ns = time_ns + uint64_t(bits) * 1000000000u / baudrate;
+}
+
+//!*****************************************************************************
+//!function :      finishTransfer
+//!*****************************************************************************
+//!  \brief        End of a transfer: the answer goes to the receive FIFO with
+//!                its length in front. A missing or short answer sets RxError.
+//!                A CQSend received during the transfer starts the next one.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   SimChip&   chip of the port
+//!				   uint8_t    0 port A, 1 port B
+//!				   uint64_t   time in nanoseconds
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSim::finishTransfer(SimChip & chip, uint8_t port, uint64_t time_ns)
+{
+	SimPort & p = chip.port[port];
+	p.isTransfer = 0;
+	if (p.sendPending != 0) {
+		p.sendPending--;
+		sendMessage(chip, port, time_ns);
+	}
+
+	if (p.sizeReceived == 0) {
+		chip.reg[Interrupt] |= uint8_t(RxErrorA << port);
+		chip.reg[CQErrA + port] |= RSizeErr;
+		return;
+	}
+	if (p.rxFifo.size() + p.sizeReceived + 1u > RX_FIFO_SIZE) {
+		// Overrun, the answer is lost
+		chip.reg[Interrupt] |= uint8_t(RxErrorA << port);
+		return;
+	}
+	p.rxFifo.push_back(p.sizeReceived);
+	for (uint8_t i = 0; i < p.sizeReceived; i++) {
+		p.rxFifo.push_back(p.answer[i]);
+	}
+	chip.reg[Interrupt] |= uint8_t(RxDataRdyA << port);
+	if (p.sizeReceived < p.sizeAnswer) {
+		chip.reg[Interrupt] |= uint8_t(RxErrorA << port);
+		chip.reg[CQErrA + port] |= RSizeErr;
+	}
+}
+
+//!*****************************************************************************
+//!function :      isIrqAsserted
+//!*****************************************************************************
+//!  \brief        State of the IRQ output of a chip
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    chip number
+//!
+//!  \return       1 if an enabled interrupt is pending
+//!
+//!*****************************************************************************
+uint8_t HardwareSim::isIrqAsserted(uint8_t chipNr)
+{
+	return ((chip_[chipNr].reg[Interrupt] & chip_[chipNr].reg[InterruptEn]) != 0) ? 1 : 0;
+}
+#endif
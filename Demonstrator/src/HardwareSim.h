@@ -0,0 +1,141 @@
+//!*****************************************************************************
+//!  \file      HardwareSim.h
+//!*****************************************************************************
+//!
+//!  \brief		Hardware abstraction which simulates the IO-Link master shield:
+//!             two MAX14819 on the register level with virtual IO-Link
+//!             devices (SimDevice) on the four ports. The demonstrator runs
+//!             unmodified on any Linux machine.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-09
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef _HARDWARESIM_H
+#define _HARDWARESIM_H
+
+//!**** Header-Files ************************************************************
+#include "HardwareBase.h"
+#include "SimDevice.h"
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+//!**** Macros ******************************************************************
+
+//!**** Data types **************************************************************
+
+//!**** Function prototypes *****************************************************
+
+//!**** Data ********************************************************************
+
+//!**** Implementation **********************************************************
+
+
+class HardwareSim:
+	public HardwareBase
+{
+
+
+public:
+	// Virtual time runs only when the driver waits, a demo runs as fast as
+	// the host allows and is reproducible. Otherwise the simulation follows
+	// the monotonic clock of the host.
+	explicit HardwareSim(bool virtualTime = false);
+	~HardwareSim();
+
+	virtual void begin();
+
+	virtual void IO_Write(PinNames pinnumber, uint8_t state);
+	virtual void IO_PinMode(PinNames pinnumber, PinMode mode); //pinMode
+	virtual uint8_t IO_Read(PinNames pinnumber);
+	virtual uint8_t IO_WaitForInterrupt(PinNames pinnumber, uint64_t deadline_ns);
+
+	virtual void Serial_Write(char const * buf);
+	virtual void Serial_Write(int number);
+
+	virtual void SPI_Write(uint8_t channel, uint8_t * data, uint8_t length);
+	virtual void SPI_WriteFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount);
+
+	virtual void wait_for(uint32_t delay_ms);
+	virtual void wait_until_ns(uint64_t deadline_ns);
+	virtual uint64_t get_time_ns();
+	virtual uint8_t hasVirtualTime();
+
+	virtual uint8_t * NV_Map(char const * name, uint16_t length);
+
+	void attachDevice(uint8_t portNr, SimDevice * device);
+
+private:
+	static constexpr uint8_t CHIP_COUNT = 2;
+	static constexpr uint8_t PORT_COUNT = 2;	// ports per chip
+	static constexpr uint8_t REG_COUNT = 32;
+
+	struct Message {
+		uint8_t sizeAnswer;
+		uint8_t sizeMsg;
+		uint8_t data[64];
+	};
+
+	struct SimPort {
+		SimDevice * device;
+		std::deque<uint8_t> txFifo;
+		std::deque<uint8_t> rxFifo;
+		Message keptMsg;
+		uint8_t isKept;
+		uint8_t isEstCom;
+		uint8_t estComResult;		// ComRt bits after the sequence, 0 if failed
+		uint64_t estComDone_ns;
+		uint8_t isTransfer;
+		uint8_t sendPending;		// CQSend during a transfer, sent after it
+		uint8_t answer[40];
+		uint8_t sizeAnswer;			// requested answer size
+		uint8_t sizeReceived;		// bytes answered by the device
+		uint64_t transferDone_ns;
+		uint8_t isCyclic;
+		uint64_t nextCycle_ns;
+	};
+
+	struct SimChip {
+		uint8_t reg[REG_COUNT];
+		SimPort port[PORT_COUNT];
+	};
+
+	bool virtualTime_;
+	uint64_t simTime_ns_;
+	std::mutex mutex_;
+	SimChip chip_[CHIP_COUNT];
+	std::map<std::string, std::vector<uint8_t> > nvBlocks_;
+
+	uint64_t now_ns();
+	void advance(uint64_t time_ns);
+	uint64_t nextEvent_ns();
+	void resetPort(SimChip & chip, uint8_t port, uint64_t time_ns);
+	uint8_t readRegister(uint8_t chipNr, uint8_t reg, uint64_t time_ns);
+	void writeRegister(uint8_t chipNr, uint8_t reg, uint8_t data, uint64_t time_ns);
+	void writeCQCtrl(SimChip & chip, uint8_t port, uint8_t data, uint64_t time_ns);
+	void sendMessage(SimChip & chip, uint8_t port, uint64_t time_ns);
+	void finishTransfer(SimChip & chip, uint8_t port, uint64_t time_ns);
+	uint8_t isIrqAsserted(uint8_t chipNr);
+};
+
+#endif //_HARDWARESIM_H
@@ -0,0 +1,175 @@
+#ifndef ARDUINO
+
+//!*****************************************************************************
+//!  \file      HardwareSpidev.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Raspberry Pi hardware layer using the Linux spidev driver directly
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-02
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!	
+//!*****************************************************************************
+
+//!**** Header-Files ************************************************************
+#include "HardwareSpidev.h"
+
+//!**** Macros ******************************************************************
+
+//!**** Data types **************************************************************
+
+//!**** Function prototypes *****************************************************
+
+//!**** Data ********************************************************************
+
+//!**** Implementation **********************************************************
+
+//!*****************************************************************************
+//!function :      HardwareSpidev
+//!*****************************************************************************
+//!  \brief        Opens the spidev devices for both chipselects and sets the
+//!                SPI parameters
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t       SPI bus number
+//!				   uint32_t      SPI clock in Hz
+//!				   uint8_t       SPI mode (0..3)
+//!				   char const *  device path without bus and channel,
+//!				                 "/dev/spidev" opens /dev/spidev<bus>.<channel>
+//!				   SpidevIO *    file access, nullptr for the kernel
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+HardwareSpidev::HardwareSpidev(uint8_t bus, uint32_t speed_hz, uint8_t mode, char const * devicePrefix, SpidevIO * io)
+:HardwareRaspberry(false),
+bus_(io)
+{
+	Serial_Write("Init_SPI starts");
+	bus_.open(bus, devicePrefix);
+	SPI_SetMode(mode);
+	SPI_SetSpeed(speed_hz);
+	Serial_Write("Init_SPI finished");
+}
+
+
+HardwareSpidev::~HardwareSpidev()
+{
+}
+
+//!*****************************************************************************
+//!function :      SPI_Write
+//!*****************************************************************************
+//!  \brief        Writes some data to the specified SPI-Connection
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    channel number
+//!				   uint8_t*   pointer to the data structure
+//!				   uint8_t    length of the data in bytes
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSpidev::SPI_Write(uint8_t channel, uint8_t * data, uint8_t length)
+{
+	SPI_WriteFrames(channel, data, length, 1);
+}
+
+//!*****************************************************************************
+//!function :      SPI_WriteFrames
+//!*****************************************************************************
+//!  \brief        Writes several frames to the specified SPI-Connection with
+//!                one SPI_IOC_MESSAGE ioctl. The chipselect is released and
+//!                the frame delay is inserted between the frames.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    channel number
+//!				   uint8_t*   pointer to the frames
+//!				   uint8_t    length of one frame in bytes
+//!				   uint8_t    number of frames
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSpidev::SPI_WriteFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount)
+{
+	bus_.writeFrames(channel, data, frameLength, frameCount);
+}
+
+//!*****************************************************************************
+//!function :      SPI_SetSpeed
+//!*****************************************************************************
+//!  \brief        Sets the SPI clock of both chipselects, between two
+//!                transfers of the bus
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint32_t   SPI clock in Hz
+//!
+//!  \return       0 if success
+//!
+//!*****************************************************************************
+uint8_t HardwareSpidev::SPI_SetSpeed(uint32_t speed_hz)
+{
+	std::lock_guard<std::mutex> lock(busMutex_);
+	return bus_.setSpeed(speed_hz);
+}
+
+//!*****************************************************************************
+//!function :      SPI_SetMode
+//!*****************************************************************************
+//!  \brief        Sets the SPI mode (clock polarity and phase) of both
+//!                chipselects, between two transfers of the bus
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    SPI mode 0..3
+//!
+//!  \return       0 if success
+//!
+//!*****************************************************************************
+uint8_t HardwareSpidev::SPI_SetMode(uint8_t mode)
+{
+	std::lock_guard<std::mutex> lock(busMutex_);
+	return bus_.setMode(mode);
+}
+
+//!*****************************************************************************
+//!function :      SPI_SetFrameDelay
+//!*****************************************************************************
+//!  \brief        Sets the delay between two register frames of a batched
+//!                transfer
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint16_t   delay in microseconds
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void HardwareSpidev::SPI_SetFrameDelay(uint16_t delay_us)
+{
+	std::lock_guard<std::mutex> lock(busMutex_);
+	bus_.setFrameDelay(delay_us);
+}
+#endif
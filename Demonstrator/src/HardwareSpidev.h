@@ -0,0 +1,70 @@
+
+//!*****************************************************************************
+//!  \file      HardwareSpidev.h
+//!*****************************************************************************
+//!
+//!  \brief		Raspberry Pi hardware layer using the Linux spidev driver directly
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-02
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!	
+//!*****************************************************************************
+#ifndef _HARDWARESPIDEV_H
+#define _HARDWARESPIDEV_H
+
+//!**** Header-Files ************************************************************
+#include "HardwareRaspberry.h"
+#include "SpidevBus.h"
+#include <cstdint>
+//!**** Macros ******************************************************************
+
+//!**** Data types **************************************************************
+
+//!**** Function prototypes *****************************************************
+
+//!**** Data ********************************************************************
+
+//!**** Implementation **********************************************************
+
+//!*****************************************************************************
+//!  SPI access through /dev/spidev<bus>.<channel> (see SpidevBus) instead of
+//!  wiringPiSPI. The GPIOs are still handled by HardwareRaspberry.
+//!*****************************************************************************
+class HardwareSpidev:
+	public HardwareRaspberry
+{
+
+
+public:
+	HardwareSpidev(uint8_t bus = 0, uint32_t speed_hz = 500000, uint8_t mode = 0, char const * devicePrefix = "/dev/spidev", SpidevIO * io = nullptr);
+	~HardwareSpidev();
+
+	virtual void SPI_Write(uint8_t channel, uint8_t * data, uint8_t length);
+	virtual void SPI_WriteFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount);
+
+	uint8_t SPI_SetSpeed(uint32_t speed_hz);
+	uint8_t SPI_SetMode(uint8_t mode);
+	void SPI_SetFrameDelay(uint16_t delay_us);
+
+private:
+	SpidevBus bus_;
+};
+
+#endif //_HARDWARESPIDEV_H
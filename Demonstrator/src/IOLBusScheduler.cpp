@@ -0,0 +1,401 @@
+//!*****************************************************************************
+//!  \file      IOLBusScheduler.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Deadline aware scheduler of the SPI bus across the ports of
+//!             both MAX14819. Every port has a priority class, a cycle time
+//!             and a cost estimated from its M-sequence, COM speed and SPI
+//!             frames. Waiting ports get the bus by class first, earliest
+//!             deadline next, a fast sensor never waits behind an update
+//!             of a slow actuator. Late jobs are counted per port.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-31
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLBusScheduler.h"
+#include "IOLink.h"
+
+//!***** Macros *****************************************************************
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLBusScheduler
+//!*****************************************************************************
+//!  \brief        Constructor, no ports yet and the bus is free
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *hardware            clock of the jobs
+//!  \param[in]	   spiClock_hz          clock of the SPI bus, for the cost
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLBusScheduler::IOLBusScheduler(HardwareBase *hardware, uint32_t spiClock_hz)
+:hardware_(hardware),
+spiClock_hz_(spiClock_hz),
+slots_(),
+slotCount_(0),
+owner_(SCHED_NO_PORT)
+#ifndef ARDUINO
+,mutex_(),
+released_()
+#endif
+{
+}
+
+//!*****************************************************************************
+//!  function :    addPort
+//!*****************************************************************************
+//!  \brief        Schedule the jobs of a port. Only called before the
+//!                threads using the scheduler start and after the port
+//!                reached operate, the cost depends on its COM speed.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pPort               port in operate
+//!  \param[in]	   busClass             priority class of the port
+//!
+//!  \return       0 if added, 1 if the list is full or the port known
+//!
+//!*****************************************************************************
+uint8_t IOLBusScheduler::addPort(IOLMasterPortMax14819 *pPort, BusClass busClass) {
+    if ((pPort == nullptr) || (slotCount_ >= SCHED_MAX_PORTS) || (findSlot(pPort) != SCHED_NO_PORT)) {
+        return ERROR;
+    }
+    Slot &slot = slots_[slotCount_++];
+    slot.pPort = pPort;
+    slot.stats = BusPortStats();
+    slot.stats.busClass = busClass;
+    slot.release_ns = 0;
+    slot.isWaiting = 0;
+    return updatePort(pPort);
+}
+
+//!*****************************************************************************
+//!  function :    updatePort
+//!*****************************************************************************
+//!  \brief        Take over the cycle time and the M-sequence of a port
+//!                again, e.g. after enableCyclicPD or setCycleTime.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pPort               scheduled port
+//!
+//!  \return       0 if updated, 1 if the port is not scheduled
+//!
+//!*****************************************************************************
+uint8_t IOLBusScheduler::updatePort(IOLMasterPortMax14819 *pPort) {
+    uint8_t i = findSlot(pPort);
+
+    if (i == SCHED_NO_PORT) {
+        return ERROR;
+    }
+    // The port takes its chip, read it before the scheduler is locked
+    uint32_t cycle_us = pPort->readCycleTime_us();
+    uint32_t frames = uint32_t(pPort->readMSequenceSize()) + SCHED_FRAME_OVERHEAD;
+    uint32_t spi_us = uint32_t((uint64_t(frames) * HardwareBase::SPI_FRAME_SIZE * 8u * 1000000u) / spiClock_hz_);
+    uint32_t cost_us = pPort->readTransferTime_us() + spi_us;
+
+#ifndef ARDUINO
+    std::lock_guard<std::mutex> lock(mutex_);
+#endif
+    slots_[i].stats.cycle_us = cycle_us;
+    slots_[i].stats.cost_us = cost_us;
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    isBefore
+//!*****************************************************************************
+//!  \brief        Order of two jobs: the higher class first, the earlier
+//!                deadline (release plus cycle time) within a class.
+//!                Unknown ports go last.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pPortA              port of the first job
+//!  \param[in]	   releaseA_ns          first job is due at
+//!  \param[in]	   *pPortB              port of the second job
+//!  \param[in]	   releaseB_ns          second job is due at
+//!
+//!  \return       1 if the first job runs before the second
+//!
+//!*****************************************************************************
+uint8_t IOLBusScheduler::isBefore(IOLMasterPortMax14819 *pPortA, uint64_t releaseA_ns, IOLMasterPortMax14819 *pPortB, uint64_t releaseB_ns) {
+    uint8_t a = findSlot(pPortA);
+    uint8_t b = findSlot(pPortB);
+
+    if ((a == SCHED_NO_PORT) || (b == SCHED_NO_PORT)) {
+        return uint8_t((a != SCHED_NO_PORT) || ((b == SCHED_NO_PORT) && (releaseA_ns < releaseB_ns)));
+    }
+#ifndef ARDUINO
+    std::lock_guard<std::mutex> lock(mutex_);
+#endif
+    if (slots_[a].stats.busClass != slots_[b].stats.busClass) {
+        return uint8_t(slots_[a].stats.busClass < slots_[b].stats.busClass);
+    }
+    return uint8_t(readDeadline(slots_[a], releaseA_ns) < readDeadline(slots_[b], releaseB_ns));
+}
+
+//!*****************************************************************************
+//!  function :    acquire
+//!*****************************************************************************
+//!  \brief        Wait until the port gets the bus. While the bus is held
+//!                the waiting jobs queue up, the release hands it to the
+//!                first of them (see isBefore). A due job is accounted when
+//!                it starts.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pPort               scheduled port
+//!  \param[in]	   release_ns           the job is due at (see get_time_ns)
+//!
+//!  \return       0 if the bus is held, 1 if the port is not scheduled
+//!
+//!*****************************************************************************
+uint8_t IOLBusScheduler::acquire(IOLMasterPortMax14819 *pPort, uint64_t release_ns) {
+    uint8_t i = findSlot(pPort);
+
+    if (i == SCHED_NO_PORT) {
+        return ERROR;
+    }
+#ifndef ARDUINO
+    std::unique_lock<std::mutex> lock(mutex_);
+#endif
+    slots_[i].release_ns = release_ns;
+    slots_[i].isWaiting = 1;
+#ifndef ARDUINO
+    while ((owner_ != SCHED_NO_PORT) || (findNext() != i)) {
+        released_.wait(lock);
+    }
+#endif
+    slots_[i].isWaiting = 0;
+    owner_ = i;
+    account(slots_[i]);
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    release
+//!*****************************************************************************
+//!  \brief        Free the bus taken with acquire
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pPort               port holding the bus
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLBusScheduler::release(IOLMasterPortMax14819 *pPort) {
+    uint8_t i = findSlot(pPort);
+
+#ifndef ARDUINO
+    std::lock_guard<std::mutex> lock(mutex_);
+#endif
+    if ((i != SCHED_NO_PORT) && (owner_ == i)) {
+        owner_ = SCHED_NO_PORT;
+#ifndef ARDUINO
+        released_.notify_all();
+#endif
+    }
+}
+
+//!*****************************************************************************
+//!  function :    readStats
+//!*****************************************************************************
+//!  \brief        Copy the schedule and the counters of a port
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pPort               scheduled port
+//!  \param[out]   *pStats              schedule and counters
+//!
+//!  \return       0 if copied, 1 if the port is not scheduled
+//!
+//!*****************************************************************************
+uint8_t IOLBusScheduler::readStats(IOLMasterPortMax14819 *pPort, BusPortStats *pStats) {
+    uint8_t i = findSlot(pPort);
+
+    if (i == SCHED_NO_PORT) {
+        return ERROR;
+    }
+#ifndef ARDUINO
+    std::lock_guard<std::mutex> lock(mutex_);
+#endif
+    *pStats = slots_[i].stats;
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    findSlot
+//!*****************************************************************************
+//!  \brief        Returns the slot of a port. The list only grows before the
+//!                threads start, it is read without locking.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pPort               port
+//!
+//!  \return       index of the slot, SCHED_NO_PORT if not scheduled
+//!
+//!*****************************************************************************
+uint8_t IOLBusScheduler::findSlot(IOLMasterPortMax14819 *pPort) {
+    for (uint8_t i = 0; i < slotCount_; i++) {
+        if (slots_[i].pPort == pPort) {
+            return i;
+        }
+    }
+    return SCHED_NO_PORT;
+}
+
+//!*****************************************************************************
+//!  function :    findNext
+//!*****************************************************************************
+//!  \brief        Returns the waiting job to get the bus next, the caller
+//!                holds the scheduler
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       index of the slot, SCHED_NO_PORT if none is waiting
+//!
+//!*****************************************************************************
+uint8_t IOLBusScheduler::findNext() {
+    uint8_t next = SCHED_NO_PORT;
+
+    for (uint8_t i = 0; i < slotCount_; i++) {
+        if (slots_[i].isWaiting == 0) {
+            continue;
+        }
+        if ((next == SCHED_NO_PORT)
+                || (slots_[i].stats.busClass < slots_[next].stats.busClass)
+                || ((slots_[i].stats.busClass == slots_[next].stats.busClass)
+                    && (readDeadline(slots_[i], slots_[i].release_ns) < readDeadline(slots_[next], slots_[next].release_ns)))) {
+            next = i;
+        }
+    }
+    return next;
+}
+
+//!*****************************************************************************
+//!  function :    readDeadline
+//!*****************************************************************************
+//!  \brief        Returns the deadline of a job, it has to finish within the
+//!                cycle it was released in
+//!
+//!  \type         local
+//!
+//!  \param[in]	   &slot                slot of the port
+//!  \param[in]	   release_ns           the job is due at
+//!
+//!  \return       deadline in nanoseconds (see get_time_ns)
+//!
+//!*****************************************************************************
+uint64_t IOLBusScheduler::readDeadline(Slot const &slot, uint64_t release_ns) {
+    uint64_t cycle_ns = uint64_t(slot.stats.cycle_us) * max14819::NS_PER_US;
+
+    return (release_ns > UINT64_MAX - cycle_ns) ? UINT64_MAX : release_ns + cycle_ns;
+}
+
+//!*****************************************************************************
+//!  function :    account
+//!*****************************************************************************
+//!  \brief        Count a job starting now. A job of the future is not due
+//!                and not counted, a due job misses its deadline if its
+//!                cost does not fit into the rest of its cycle.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   &slot                slot of the port, the caller holds
+//!                                     the scheduler
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLBusScheduler::account(Slot &slot) {
+    uint64_t now = hardware_->get_time_ns();
+
+    if (slot.release_ns > now) {
+        return;
+    }
+    uint64_t lateness_us = (now - slot.release_ns) / max14819::NS_PER_US;
+
+    slot.stats.jobs++;
+    if (lateness_us > slot.stats.maxLateness_us) {
+        slot.stats.maxLateness_us = (lateness_us > UINT32_MAX) ? UINT32_MAX : uint32_t(lateness_us);
+    }
+    if (lateness_us + slot.stats.cost_us > slot.stats.cycle_us) {
+        slot.stats.misses++;
+    }
+}
+
+//!*****************************************************************************
+//!  function :    Job
+//!*****************************************************************************
+//!  \brief        Constructor, waits until the port gets the bus
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pScheduler          scheduler, nullptr to run unscheduled
+//!  \param[in]	   *pPort               port of the job
+//!  \param[in]	   release_ns           the job is due at (see get_time_ns)
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLBusScheduler::Job::Job(IOLBusScheduler *pScheduler, IOLMasterPortMax14819 *pPort, uint64_t release_ns)
+:pScheduler_(pScheduler),
+pPort_(pPort)
+{
+    if ((pScheduler_ != nullptr) && (pScheduler_->acquire(pPort_, release_ns) == ERROR)) {
+        pScheduler_ = nullptr;
+    }
+}
+
+//!*****************************************************************************
+//!  function :    ~Job
+//!*****************************************************************************
+//!  \brief        Destructor, frees the bus for the next job
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLBusScheduler::Job::~Job() {
+    if (pScheduler_ != nullptr) {
+        pScheduler_->release(pPort_);
+    }
+}
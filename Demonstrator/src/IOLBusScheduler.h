@@ -0,0 +1,136 @@
+//!*****************************************************************************
+//!  \file      IOLBusScheduler.h
+//!*****************************************************************************
+//!
+//!  \brief		Deadline aware scheduler of the SPI bus across the ports of
+//!             both MAX14819. Every port has a priority class, a cycle time
+//!             and a cost estimated from its M-sequence, COM speed and SPI
+//!             frames. Waiting ports get the bus by class first, earliest
+//!             deadline next, a fast sensor never waits behind an update
+//!             of a slow actuator. Late jobs are counted per port.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-31
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLBUSSCHEDULER_H_INCLUDED
+#define IOLBUSSCHEDULER_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include "HardwareBase.h"
+#include "IOLMasterPortMax14819.h"
+
+#include <cstdint>
+#ifndef ARDUINO
+#include <condition_variable>
+#include <mutex>
+#endif
+//!***** Macros *****************************************************************
+constexpr uint8_t SCHED_MAX_PORTS       = 4u;       // ports of both chips
+constexpr uint8_t SCHED_NO_PORT         = 0xFFu;
+constexpr uint32_t SCHED_SPI_CLOCK_HZ   = 500000u;  // default SPI clock, see HardwareSpidev
+constexpr uint8_t SCHED_FRAME_OVERHEAD  = 4u;       // register frames of a job besides the FIFO octets
+
+//!***** Data types *************************************************************
+// Priority class of a port, a lower class waits for all higher ones
+enum BusClass {
+    BUS_CLASS_HIGH,         // fast sensors, cycle times of a few milliseconds
+    BUS_CLASS_NORMAL,
+    BUS_CLASS_LOW           // slow actuators and parameter traffic
+};
+
+// Schedule and counters of a port
+struct BusPortStats {
+    BusClass busClass;
+    uint32_t cycle_us;      // target cycle time
+    uint32_t cost_us;       // line time of the M-sequence and SPI time of a job
+    uint32_t jobs;          // due jobs which got the bus
+    uint32_t misses;        // jobs started too late to finish within their cycle
+    uint32_t maxLateness_us;// longest wait of a due job for the bus
+};
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+class IOLBusScheduler {
+public:
+    explicit IOLBusScheduler(HardwareBase *hardware, uint32_t spiClock_hz = SCHED_SPI_CLOCK_HZ);
+
+    uint8_t addPort(IOLMasterPortMax14819 *pPort, BusClass busClass);
+
+    uint8_t updatePort(IOLMasterPortMax14819 *pPort);
+
+    uint8_t isBefore(IOLMasterPortMax14819 *pPortA, uint64_t releaseA_ns, IOLMasterPortMax14819 *pPortB, uint64_t releaseB_ns);
+
+    uint8_t acquire(IOLMasterPortMax14819 *pPort, uint64_t release_ns);
+
+    void release(IOLMasterPortMax14819 *pPort);
+
+    uint8_t readStats(IOLMasterPortMax14819 *pPort, BusPortStats *pStats);
+
+    //!*************************************************************************
+    //!  Holds the bus for one job of a port, released at the end of the
+    //!  scope. Without scheduler or for an unknown port it does nothing.
+    //!*************************************************************************
+    class Job {
+    public:
+        Job(IOLBusScheduler *pScheduler, IOLMasterPortMax14819 *pPort, uint64_t release_ns);
+        ~Job();
+
+    private:
+        IOLBusScheduler *pScheduler_;
+        IOLMasterPortMax14819 *pPort_;
+
+        Job(Job const &);
+        Job & operator=(Job const &);
+    };
+
+private:
+    struct Slot {
+        IOLMasterPortMax14819 *pPort;
+        BusPortStats stats;
+        uint64_t release_ns;    // the waiting job is due at
+        uint8_t isWaiting;
+    };
+
+    HardwareBase *hardware_;
+    uint32_t spiClock_hz_;
+    Slot slots_[SCHED_MAX_PORTS];
+    uint8_t slotCount_;
+    uint8_t owner_;             // slot holding the bus, SCHED_NO_PORT if free
+#ifndef ARDUINO
+    std::mutex mutex_;
+    std::condition_variable released_;
+#endif
+
+    uint8_t findSlot(IOLMasterPortMax14819 *pPort);
+    uint8_t findNext();
+    uint64_t readDeadline(Slot const &slot, uint64_t release_ns);
+    void account(Slot &slot);
+
+    // Not copyable, the waiting threads refer to the object
+    IOLBusScheduler(IOLBusScheduler const &);
+    IOLBusScheduler & operator=(IOLBusScheduler const &);
+};
+
+#endif //IOLBUSSCHEDULER_H_INCLUDED
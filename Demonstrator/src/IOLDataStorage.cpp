@@ -0,0 +1,558 @@
+//!*****************************************************************************
+//!  \file      IOLDataStorage.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Data Storage of the master. The parameter set of a device is
+//!             uploaded into a store per port and downloaded into a
+//!             replaced device of the same type. The Parameter_Checksum of
+//!             the device decides if a transfer is needed at all, the
+//!             transfers are batched on the ISDU channel.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-20
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLDataStorage.h"
+#include "IOLink.h"
+
+#include <stdio.h>
+#include <string.h>
+//!***** Macros *****************************************************************
+constexpr uint32_t DS_MAGIC     = 0x53444C49u;     // "ILDS"
+constexpr uint32_t DS_VERSION   = 1u;
+constexpr uint8_t DS_LIST_SIZE  = DS_MAX_PARAMETERS * IOL::DS::ENTRY_SIZE + 2u;    // Index_List and termination
+constexpr uint32_t CRC32_POLY   = 0xEDB88320u;      // CRC-32 of a stored value, reflected
+
+//!***** Data types *************************************************************
+// Mapped block of a port. The records follow each other in data: index MSB
+// and LSB, subindex, size, CRC-32 of the value MSB first, value.
+struct IOLDataStorage::Store {
+    uint32_t magic;                     // DS_MAGIC, the store is cleared otherwise
+    uint32_t version;                   // DS_VERSION
+    uint32_t size;                      // sizeof(Store)
+    uint32_t parameterChecksum;         // Parameter_Checksum of the device after the upload
+    uint32_t deviceID;
+    uint16_t vendorID;
+    uint16_t dataSize;                  // octets of the records
+    uint8_t count;                      // records
+    uint8_t isValid;                    // cleared while the records are rewritten
+    uint8_t data[DS_IMAGE_SIZE];
+};
+
+//!***** Function prototypes ****************************************************
+static uint32_t crc32(uint8_t const *pData, uint8_t size);
+static uint32_t readUint32(uint8_t const *pData);
+static void writeUint32(uint8_t *pData, uint32_t value);
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLDataStorage
+//!*****************************************************************************
+//!  \brief        Constructor, maps the store of the port. A new block or one
+//!                written by another program version is cleared.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *hardware            hardware with the NV storage
+//!  \param[in]	   portNr               port of the master
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLDataStorage::IOLDataStorage(HardwareBase *hardware, uint8_t portNr)
+:pStore_(nullptr),
+lastAction_(DS_ACTION_NONE),
+transferCount_(0),
+storeCount_(0),
+image_(),
+stage_()
+{
+    char name[24];
+
+    if (hardware != nullptr) {
+        sprintf(name, "data-storage-%u", unsigned(portNr));
+        pStore_ = reinterpret_cast<Store *>(hardware->NV_Map(name, uint16_t(sizeof(Store))));
+    }
+    if ((pStore_ == nullptr)
+            || ((pStore_->magic == DS_MAGIC) && (pStore_->version == DS_VERSION) && (pStore_->size == sizeof(Store)))) {
+        return;
+    }
+
+    pStore_->magic = 0;
+    clear();
+    pStore_->version = DS_VERSION;
+    pStore_->size = sizeof(Store);
+    pStore_->magic = DS_MAGIC;
+}
+
+//!*****************************************************************************
+//!  function :    isAvailable
+//!*****************************************************************************
+//!  \brief        Returns if the hardware has NV storage for the store
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       1 if the Data Storage can be used
+//!
+//!*****************************************************************************
+uint8_t IOLDataStorage::isAvailable() {
+    return (pStore_ != nullptr) ? 1 : 0;
+}
+
+//!*****************************************************************************
+//!  function :    synchronize
+//!*****************************************************************************
+//!  \brief        Bring the store and the device in line after the port
+//!                entered operate, see IO-Link Specification 11.4:
+//!                - an empty store takes the parameters of the device
+//!                - a device of another type is refused, see clear
+//!                - a device with DS_UPLOAD_FLAG is uploaded
+//!                - a device with another Parameter_Checksum is downloaded,
+//!                  e.g. a replaced device with its factory settings
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *port                port of the device, in operate
+//!
+//!  \return       0 if the store and the device match, see readLastAction
+//!
+//!*****************************************************************************
+uint8_t IOLDataStorage::synchronize(IOLMasterPort *port) {
+    IOL::DirectParameterPage1 page;
+    uint8_t state = 0;
+    uint32_t checksum = 0;
+
+    lastAction_ = DS_ACTION_NONE;
+    transferCount_ = 0;
+    storeCount_ = 0;
+    if ((pStore_ == nullptr) || (port->readDirectParameterPage1(&page) == ERROR)
+            || (readDeviceState(port, &state, &checksum) == ERROR)
+            || ((state & IOL::DS::STATE_MASK) == IOL::DS::STATE_LOCKED)) {
+        return ERROR;
+    }
+    if (pStore_->isValid == 0) {
+        return upload(port);
+    }
+    if ((pStore_->vendorID != page.vendorID) || (pStore_->deviceID != page.deviceID)) {
+        return ERROR;
+    }
+    if ((state & IOL::DS::STATE_UPLOAD_FLAG) != 0) {
+        return upload(port);
+    }
+    if (checksum == pStore_->parameterChecksum) {
+        return SUCCESS;
+    }
+    return download(port);
+}
+
+//!*****************************************************************************
+//!  function :    upload
+//!*****************************************************************************
+//!  \brief        Store the parameter set of the device. Nothing is read if
+//!                the Parameter_Checksum matches the store, otherwise the
+//!                parameters of the Index_List are read in batches and only
+//!                the records with a new CRC are rewritten.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *port                port of the device, in operate
+//!
+//!  \return       0 if the store holds the parameters of the device
+//!
+//!*****************************************************************************
+uint8_t IOLDataStorage::upload(IOLMasterPort *port) {
+    IOL::DirectParameterPage1 page;
+    IOLIsdu::Request requests[DS_READ_BATCH];
+    uint8_t list[DS_LIST_SIZE];
+    uint8_t checksumData[4];
+    uint8_t command = IOL::DS::CMD_UPLOAD_START;
+    uint8_t state = 0;
+    uint32_t checksum = 0;
+    uint16_t size = 0;
+    uint16_t valueSize = 0;
+    uint8_t entries = 0;
+    uint8_t retValue = SUCCESS;
+
+    lastAction_ = DS_ACTION_NONE;
+    transferCount_ = 0;
+    storeCount_ = 0;
+    if ((pStore_ == nullptr) || (port->readDirectParameterPage1(&page) == ERROR)
+            || (readDeviceState(port, &state, &checksum) == ERROR)) {
+        return ERROR;
+    }
+
+    // The store is current, only the DS_UPLOAD_FLAG is cleared
+    if ((pStore_->isValid != 0) && (pStore_->vendorID == page.vendorID) && (pStore_->deviceID == page.deviceID)
+            && (pStore_->parameterChecksum == checksum)) {
+        if ((state & IOL::DS::STATE_UPLOAD_FLAG) == 0) {
+            return SUCCESS;
+        }
+        if (writeCommand(port, IOL::DS::CMD_UPLOAD_START) == ERROR) {
+            return ERROR;
+        }
+        return writeCommand(port, IOL::DS::CMD_UPLOAD_END);
+    }
+
+    IOLIsdu::Request start[] = {
+        {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_COMMAND, 1, &command, 1, ERROR, 0},
+        {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_INDEX_LIST, 0, list, sizeof(list), ERROR, 0}
+    };
+    if (port->transferISDU(start, sizeof(start) / sizeof(start[0])) == ERROR) {
+        writeCommand(port, IOL::DS::CMD_BREAK);
+        return ERROR;
+    }
+    while (uint16_t((entries + 1) * IOL::DS::ENTRY_SIZE) <= start[1].size) {
+        if ((list[entries * IOL::DS::ENTRY_SIZE] == 0) && (list[entries * IOL::DS::ENTRY_SIZE + 1] == 0)) {
+            break;
+        }
+        entries++;
+    }
+
+    for (uint8_t first = 0; (first < entries) && (retValue == SUCCESS); first = uint8_t(first + DS_READ_BATCH)) {
+        uint8_t count = ((entries - first) < DS_READ_BATCH) ? uint8_t(entries - first) : DS_READ_BATCH;
+
+        for (uint8_t i = 0; i < count; i++) {
+            uint8_t const *pEntry = &list[(first + i) * IOL::DS::ENTRY_SIZE];
+            IOLIsdu::Request request = {uint16_t((pEntry[0] << 8) | pEntry[1]), pEntry[2], 0,
+                                        &stage_[i * IOL::ISDU::MAX_DATA_SIZE], IOL::ISDU::MAX_DATA_SIZE, ERROR, 0};
+            requests[i] = request;
+        }
+        retValue = port->transferISDU(requests, count);
+        transferCount_ = uint8_t(transferCount_ + count);
+
+        for (uint8_t i = 0; (i < count) && (retValue == SUCCESS); i++) {
+            IOLIsdu::Request const &request = requests[i];
+            valueSize = uint16_t(valueSize + request.size);
+            if (valueSize > DS_STORE_SIZE) {
+                retValue = ERROR;
+                break;
+            }
+            uint8_t *pRecord = &image_[size];
+            pRecord[0] = uint8_t(request.index >> 8);
+            pRecord[1] = uint8_t(request.index);
+            pRecord[2] = request.subindex;
+            pRecord[3] = request.size;
+            writeUint32(&pRecord[4], crc32(request.pData, request.size));
+            memcpy(&pRecord[DS_RECORD_HEADER], request.pData, request.size);
+            size = uint16_t(size + DS_RECORD_HEADER + request.size);
+        }
+    }
+    if (retValue == ERROR) {
+        writeCommand(port, IOL::DS::CMD_BREAK);
+        return ERROR;
+    }
+
+    // The end of the upload clears the DS_UPLOAD_FLAG of the device
+    command = IOL::DS::CMD_UPLOAD_END;
+    IOLIsdu::Request end[] = {
+        {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_COMMAND, 1, &command, 1, ERROR, 0},
+        {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_CHECKSUM, 0, checksumData, sizeof(checksumData), ERROR, 0}
+    };
+    if ((port->transferISDU(end, sizeof(end) / sizeof(end[0])) == ERROR) || (end[1].size != sizeof(checksumData))) {
+        return ERROR;
+    }
+
+    commit(size, entries, page, readUint32(checksumData));
+    lastAction_ = DS_ACTION_UPLOAD;
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    download
+//!*****************************************************************************
+//!  \brief        Write the stored parameter set into the device. The
+//!                commands and all writes are queued back to back, the
+//!                Parameter_Checksum of the device must match the store
+//!                afterwards.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *port                port of the device, in operate
+//!
+//!  \return       0 if the device took the stored parameters
+//!
+//!*****************************************************************************
+uint8_t IOLDataStorage::download(IOLMasterPort *port) {
+    IOL::DirectParameterPage1 page;
+    IOLIsdu::Request requests[DS_MAX_PARAMETERS + 3];
+    uint8_t commands[] = {IOL::DS::CMD_DOWNLOAD_START, IOL::DS::CMD_DOWNLOAD_END};
+    uint8_t checksumData[4] = {0, 0, 0, 0};
+    uint16_t position = 0;
+    uint8_t count = 0;
+    uint8_t retValue = SUCCESS;
+
+    lastAction_ = DS_ACTION_NONE;
+    transferCount_ = 0;
+    storeCount_ = 0;
+    if ((pStore_ == nullptr) || (pStore_->isValid == 0) || (port->readDirectParameterPage1(&page) == ERROR)
+            || (pStore_->vendorID != page.vendorID) || (pStore_->deviceID != page.deviceID)) {
+        return ERROR;
+    }
+    // The block comes from disk, a damaged or foreign one must not overrun
+    // requests or data before the CRC of a record can be checked
+    if ((pStore_->count > DS_MAX_PARAMETERS) || (pStore_->dataSize > DS_IMAGE_SIZE)) {
+        return ERROR;
+    }
+
+    IOLIsdu::Request start = {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_COMMAND, 1, &commands[0], 1, ERROR, 0};
+    requests[count++] = start;
+    for (uint8_t i = 0; i < pStore_->count; i++) {
+        uint8_t *pRecord = &pStore_->data[position];
+
+        // A damaged record is not written into the device
+        if ((uint32_t(position) + DS_RECORD_HEADER > pStore_->dataSize)
+                || (uint32_t(position) + DS_RECORD_HEADER + pRecord[3] > pStore_->dataSize)) {
+            return ERROR;
+        }
+        if (crc32(&pRecord[DS_RECORD_HEADER], pRecord[3]) != readUint32(&pRecord[4])) {
+            return ERROR;
+        }
+        IOLIsdu::Request request = {uint16_t((pRecord[0] << 8) | pRecord[1]), pRecord[2], 1,
+                                    &pRecord[DS_RECORD_HEADER], pRecord[3], ERROR, 0};
+        requests[count++] = request;
+        position = uint16_t(position + DS_RECORD_HEADER + pRecord[3]);
+    }
+    IOLIsdu::Request end = {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_COMMAND, 1, &commands[1], 1, ERROR, 0};
+    IOLIsdu::Request checksum = {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_CHECKSUM, 0, checksumData, sizeof(checksumData), ERROR, 0};
+    requests[count++] = end;
+    requests[count++] = checksum;
+
+    // The ISDU queue takes ISDU_QUEUE_SIZE requests at once
+    for (uint8_t first = 0; (first < count) && (retValue == SUCCESS); first = uint8_t(first + ISDU_QUEUE_SIZE)) {
+        uint8_t batch = ((count - first) < ISDU_QUEUE_SIZE) ? uint8_t(count - first) : ISDU_QUEUE_SIZE;
+        retValue = port->transferISDU(&requests[first], batch);
+    }
+    transferCount_ = pStore_->count;
+    if (retValue == ERROR) {
+        writeCommand(port, IOL::DS::CMD_BREAK);
+        return ERROR;
+    }
+    if (readUint32(checksumData) != pStore_->parameterChecksum) {
+        return ERROR;
+    }
+    lastAction_ = DS_ACTION_DOWNLOAD;
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    clear
+//!*****************************************************************************
+//!  \brief        Drop the stored parameter set, e.g. before a device of
+//!                another type is connected. The next synchronize uploads.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLDataStorage::clear() {
+    if (pStore_ == nullptr) {
+        return;
+    }
+    pStore_->isValid = 0;
+    pStore_->count = 0;
+    pStore_->dataSize = 0;
+    pStore_->parameterChecksum = 0;
+    pStore_->vendorID = 0;
+    pStore_->deviceID = 0;
+}
+
+//!*****************************************************************************
+//!  function :    readLastAction
+//!*****************************************************************************
+//!  \brief        Returns what the last synchronize, upload or download did
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       action, DS_ACTION_NONE after an error
+//!
+//!*****************************************************************************
+DSAction IOLDataStorage::readLastAction() {
+    return lastAction_;
+}
+
+//!*****************************************************************************
+//!  function :    readTransferCount
+//!*****************************************************************************
+//!  \brief        Returns the parameters read or written over ISDU by the
+//!                last synchronize, upload or download
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       number of parameters
+//!
+//!*****************************************************************************
+uint8_t IOLDataStorage::readTransferCount() {
+    return transferCount_;
+}
+
+//!*****************************************************************************
+//!  function :    readStoreCount
+//!*****************************************************************************
+//!  \brief        Returns the records rewritten in the store by the last
+//!                upload, records with an unchanged CRC are kept
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       number of records
+//!
+//!*****************************************************************************
+uint8_t IOLDataStorage::readStoreCount() {
+    return storeCount_;
+}
+
+//!*****************************************************************************
+//!  function :    readDeviceState
+//!*****************************************************************************
+//!  \brief        Read State_Property and Parameter_Checksum in one batch
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *port                port of the device
+//!  \param[out]   *pState              State_Property
+//!  \param[out]   *pChecksum           Parameter_Checksum
+//!
+//!  \return       0 if the device supports Data Storage
+//!
+//!*****************************************************************************
+uint8_t IOLDataStorage::readDeviceState(IOLMasterPort *port, uint8_t *pState, uint32_t *pChecksum) {
+    uint8_t checksumData[4];
+    IOLIsdu::Request requests[] = {
+        {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_STATE, 0, pState, 1, ERROR, 0},
+        {IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_CHECKSUM, 0, checksumData, sizeof(checksumData), ERROR, 0}
+    };
+
+    if ((port->transferISDU(requests, sizeof(requests) / sizeof(requests[0])) == ERROR)
+            || (requests[0].size != 1) || (requests[1].size != sizeof(checksumData))) {
+        return ERROR;
+    }
+    *pChecksum = readUint32(checksumData);
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    writeCommand
+//!*****************************************************************************
+//!  \brief        Write a DS_Command
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *port                port of the device
+//!  \param[in]	   command              DS_Command, see IOL::DS
+//!
+//!  \return       0 if success
+//!
+//!*****************************************************************************
+uint8_t IOLDataStorage::writeCommand(IOLMasterPort *port, uint8_t command) {
+    return port->writeISDU(IOL::INDEX::DATA_STORAGE, IOL::DS::SUB_COMMAND, &command, 1);
+}
+
+//!*****************************************************************************
+//!  function :    commit
+//!*****************************************************************************
+//!  \brief        Take the records of the upload into the store. With the
+//!                same parameters in the same order only the records with a
+//!                new CRC are written. The store is invalid while it is
+//!                written, an interrupted commit leads to a new upload.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   size                 octets of the records in image_
+//!  \param[in]	   count                records in image_
+//!  \param[in]	   page                 direct parameter page 1 of the device
+//!  \param[in]	   checksum             Parameter_Checksum of the device
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLDataStorage::commit(uint16_t size, uint8_t count, IOL::DirectParameterPage1 const &page, uint32_t checksum) {
+    uint8_t isSameLayout = ((pStore_->isValid != 0) && (pStore_->count == count) && (pStore_->dataSize == size)) ? 1 : 0;
+
+    for (uint16_t position = 0; (position < size) && (isSameLayout != 0); position = uint16_t(position + DS_RECORD_HEADER + image_[position + 3])) {
+        if (memcmp(&image_[position], &pStore_->data[position], 4) != 0) {
+            isSameLayout = 0;
+        }
+    }
+
+    pStore_->isValid = 0;
+    for (uint16_t position = 0; position < size; position = uint16_t(position + DS_RECORD_HEADER + image_[position + 3])) {
+        if ((isSameLayout == 0) || (memcmp(&image_[position + 4], &pStore_->data[position + 4], 4) != 0)) {
+            memcpy(&pStore_->data[position], &image_[position], DS_RECORD_HEADER + image_[position + 3]);
+            storeCount_++;
+        }
+    }
+    pStore_->count = count;
+    pStore_->dataSize = size;
+    pStore_->vendorID = page.vendorID;
+    pStore_->deviceID = page.deviceID;
+    pStore_->parameterChecksum = checksum;
+    pStore_->isValid = 1;
+}
+
+//!*****************************************************************************
+//!  function :    crc32
+//!*****************************************************************************
+//!  \brief        CRC-32 of a stored value
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pData               value
+//!  \param[in]	   size                 size of the value
+//!
+//!  \return       CRC-32
+//!
+//!*****************************************************************************
+static uint32_t crc32(uint8_t const *pData, uint8_t size) {
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (uint8_t i = 0; i < size; i++) {
+        crc ^= pData[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = ((crc & 1u) != 0) ? ((crc >> 1) ^ CRC32_POLY) : (crc >> 1);
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t readUint32(uint8_t const *pData) {
+    return (uint32_t(pData[0]) << 24) | (uint32_t(pData[1]) << 16) | (uint32_t(pData[2]) << 8) | pData[3];
+}
+
+static void writeUint32(uint8_t *pData, uint32_t value) {
+    pData[0] = uint8_t(value >> 24);
+    pData[1] = uint8_t(value >> 16);
+    pData[2] = uint8_t(value >> 8);
+    pData[3] = uint8_t(value);
+}
@@ -0,0 +1,96 @@
+//!*****************************************************************************
+//!  \file      IOLDataStorage.h
+//!*****************************************************************************
+//!
+//!  \brief		Data Storage of the master. The parameter set of a device is
+//!             uploaded into a store per port and downloaded into a
+//!             replaced device of the same type. The Parameter_Checksum of
+//!             the device decides if a transfer is needed at all, the
+//!             transfers are batched on the ISDU channel.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-20
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLDATASTORAGE_H_INCLUDED
+#define IOLDATASTORAGE_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include "HardwareBase.h"
+#include "IOLMasterPort.h"
+
+#include <cstdint>
+//!***** Macros *****************************************************************
+constexpr uint16_t DS_STORE_SIZE    = 2048u;    // parameter octets of a device, limit of IO-Link
+constexpr uint8_t DS_MAX_PARAMETERS = 32u;      // Index_List entries kept, more fail the upload
+constexpr uint8_t DS_RECORD_HEADER  = 8u;       // index, subindex, size and CRC-32 of a stored value
+constexpr uint16_t DS_IMAGE_SIZE    = DS_STORE_SIZE + DS_MAX_PARAMETERS * DS_RECORD_HEADER;
+constexpr uint8_t DS_READ_BATCH     = 8u;       // parameter reads transferred back to back
+
+//!***** Data types *************************************************************
+// Last action of synchronize, upload or download
+enum DSAction {
+    DS_ACTION_NONE,         // the store matches the device
+    DS_ACTION_UPLOAD,       // the parameters of the device were stored
+    DS_ACTION_DOWNLOAD      // the stored parameters were written to the device
+};
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+class IOLDataStorage {
+public:
+    IOLDataStorage(HardwareBase *hardware, uint8_t portNr);
+
+    uint8_t isAvailable();
+
+    uint8_t synchronize(IOLMasterPort *port);
+
+    uint8_t upload(IOLMasterPort *port);
+
+    uint8_t download(IOLMasterPort *port);
+
+    void clear();
+
+    DSAction readLastAction();
+
+    uint8_t readTransferCount();
+
+    uint8_t readStoreCount();
+
+private:
+    struct Store;
+
+    Store *pStore_;
+    DSAction lastAction_;
+    uint8_t transferCount_;             // parameters transferred over ISDU by the last call
+    uint8_t storeCount_;                // records rewritten in the store by the last upload
+    uint8_t image_[DS_IMAGE_SIZE];      // records of the upload, compared with the store
+    uint8_t stage_[DS_READ_BATCH * IOL::ISDU::MAX_DATA_SIZE];  // values of one batch of reads
+
+    uint8_t readDeviceState(IOLMasterPort *port, uint8_t *pState, uint32_t *pChecksum);
+    uint8_t writeCommand(IOLMasterPort *port, uint8_t command);
+    void commit(uint16_t size, uint8_t count, IOL::DirectParameterPage1 const &page, uint32_t checksum);
+};
+
+#endif //IOLDATASTORAGE_H_INCLUDED
@@ -0,0 +1,319 @@
+//!*****************************************************************************
+//!  \file      IOLDeviceCache.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Persistent cache of the identification and the static
+//!             parameters of the devices, keyed by VendorID, DeviceID and
+//!             SerialNumber. The table lives in a block mapped with
+//!             NV_Map, so a restarted master or a replugged device finds
+//!             the values of a known device without ISDU reads.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-18
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLDeviceCache.h"
+#include "IOLink.h"
+
+#include <string.h>
+//!***** Macros *****************************************************************
+constexpr char const *CACHE_BLOCK_NAME = "device-cache";
+constexpr uint32_t CACHE_MAGIC        = 0x43444C49u;   // "ILDC"
+constexpr uint32_t CACHE_VERSION      = 1u;
+constexpr uint8_t CACHE_RECORD_FREE   = 0xFFu;          // size of an unused record
+
+//!***** Data types *************************************************************
+// Layout of the mapped block. Values are written before their size, a record
+// interrupted by a crash stays free.
+struct CacheRecord {
+    uint16_t index;
+    uint8_t subindex;
+    uint8_t size;                       // size of the value, CACHE_RECORD_FREE if unused
+    uint8_t data[CACHE_VALUE_SIZE];
+};
+
+struct CacheEntry {
+    uint32_t deviceID;
+    uint32_t lastUse;                   // useCount of the table when the device was seen
+    uint16_t vendorID;
+    uint8_t isUsed;
+    char serialNumber[CACHE_SERIAL_SIZE];
+    CacheRecord records[CACHE_RECORD_COUNT];
+};
+
+struct IOLDeviceCache::Table {
+    uint32_t magic;                     // CACHE_MAGIC, the table is cleared otherwise
+    uint32_t version;                   // CACHE_VERSION
+    uint32_t size;                      // sizeof(Table)
+    uint32_t useCount;                  // devices opened so far
+    CacheEntry entries[CACHE_ENTRY_COUNT];
+};
+
+static_assert(sizeof(CacheEntry) * CACHE_ENTRY_COUNT < 0xFF00u, "cache table does not fit the NV_Map length");
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLDeviceCache
+//!*****************************************************************************
+//!  \brief        Constructor, maps the table. A new block or one written by
+//!                another program version is cleared.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *hardware            hardware with the NV storage
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLDeviceCache::IOLDeviceCache(HardwareBase *hardware)
+:pTable_(nullptr)
+{
+    if (hardware != nullptr) {
+        pTable_ = reinterpret_cast<Table *>(hardware->NV_Map(CACHE_BLOCK_NAME, uint16_t(sizeof(Table))));
+    }
+    if ((pTable_ == nullptr)
+            || ((pTable_->magic == CACHE_MAGIC) && (pTable_->version == CACHE_VERSION) && (pTable_->size == sizeof(Table)))) {
+        return;
+    }
+
+    pTable_->magic = 0;
+    pTable_->useCount = 0;
+    for (uint8_t i = 0; i < CACHE_ENTRY_COUNT; i++) {
+        pTable_->entries[i].isUsed = 0;
+    }
+    pTable_->version = CACHE_VERSION;
+    pTable_->size = sizeof(Table);
+    pTable_->magic = CACHE_MAGIC;
+}
+
+//!*****************************************************************************
+//!  function :    isAvailable
+//!*****************************************************************************
+//!  \brief        Returns if the hardware has NV storage for the table
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       1 if the cache can be used
+//!
+//!*****************************************************************************
+uint8_t IOLDeviceCache::isAvailable() {
+    return (pTable_ != nullptr) ? 1 : 0;
+}
+
+//!*****************************************************************************
+//!  function :    open
+//!*****************************************************************************
+//!  \brief        Find the entry of a device. An unknown device gets a free
+//!                entry, or the one of the device not seen for the longest
+//!                time.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   vendorID             VendorID of the direct parameter page
+//!  \param[in]	   deviceID             DeviceID of the direct parameter page
+//!  \param[in]	   *serialNumber        SerialNumber, empty if the device has
+//!                                     none
+//!
+//!  \return       entry, CACHE_NO_ENTRY if the cache is not available
+//!
+//!*****************************************************************************
+uint8_t IOLDeviceCache::open(uint16_t vendorID, uint32_t deviceID, char const *serialNumber) {
+    uint8_t entry = CACHE_NO_ENTRY;
+
+    if (pTable_ == nullptr) {
+        return CACHE_NO_ENTRY;
+    }
+
+    for (uint8_t i = 0; i < CACHE_ENTRY_COUNT; i++) {
+        CacheEntry const &candidate = pTable_->entries[i];
+        if ((candidate.isUsed != 0) && (candidate.vendorID == vendorID) && (candidate.deviceID == deviceID)
+                && (strncmp(candidate.serialNumber, serialNumber, CACHE_SERIAL_SIZE - 1) == 0)) {
+            entry = i;
+            break;
+        }
+    }
+
+    if (entry == CACHE_NO_ENTRY) {
+        entry = 0;
+        for (uint8_t i = 0; i < CACHE_ENTRY_COUNT; i++) {
+            if (pTable_->entries[i].isUsed == 0) {
+                entry = i;
+                break;
+            }
+            if (pTable_->entries[i].lastUse < pTable_->entries[entry].lastUse) {
+                entry = i;
+            }
+        }
+
+        CacheEntry &device = pTable_->entries[entry];
+        device.isUsed = 0;
+        device.vendorID = vendorID;
+        device.deviceID = deviceID;
+        strncpy(device.serialNumber, serialNumber, CACHE_SERIAL_SIZE - 1);
+        device.serialNumber[CACHE_SERIAL_SIZE - 1] = '\0';
+        for (uint8_t i = 0; i < CACHE_RECORD_COUNT; i++) {
+            device.records[i].size = CACHE_RECORD_FREE;
+        }
+        device.isUsed = 1;
+    }
+
+    pTable_->useCount++;
+    pTable_->entries[entry].lastUse = pTable_->useCount;
+    return entry;
+}
+
+//!*****************************************************************************
+//!  function :    readParameter
+//!*****************************************************************************
+//!  \brief        Copy a cached value
+//!
+//!  \type         local
+//!
+//!  \param[in]	   entry                entry of the device, see open
+//!  \param[in]	   index                index of the parameter
+//!  \param[in]	   subindex             subindex, 0 for the whole parameter
+//!  \param[out]   *pData               buffer for the value
+//!  \param[in,out] *pSize              size of the buffer, size of the value
+//!
+//!  \return       0 if the value is cached
+//!
+//!*****************************************************************************
+uint8_t IOLDeviceCache::readParameter(uint8_t entry, uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t *pSize) {
+    if ((pTable_ == nullptr) || (entry >= CACHE_ENTRY_COUNT)) {
+        return ERROR;
+    }
+    for (uint8_t i = 0; i < CACHE_RECORD_COUNT; i++) {
+        CacheRecord const &record = pTable_->entries[entry].records[i];
+        if ((record.size == CACHE_RECORD_FREE) || (record.index != index) || (record.subindex != subindex)) {
+            continue;
+        }
+        if (record.size > *pSize) {
+            return ERROR;
+        }
+        memcpy(pData, record.data, record.size);
+        *pSize = record.size;
+        return SUCCESS;
+    }
+    return ERROR;
+}
+
+//!*****************************************************************************
+//!  function :    storeParameter
+//!*****************************************************************************
+//!  \brief        Cache a value read from the device. Values longer than
+//!                CACHE_VALUE_SIZE are not cached, neither are values of a
+//!                device with all records in use.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   entry                entry of the device, see open
+//!  \param[in]	   index                index of the parameter
+//!  \param[in]	   subindex             subindex, 0 for the whole parameter
+//!  \param[in]	   *pData               value
+//!  \param[in]	   size                 size of the value
+//!
+//!  \return       0 if the value is cached
+//!
+//!*****************************************************************************
+uint8_t IOLDeviceCache::storeParameter(uint8_t entry, uint16_t index, uint8_t subindex, uint8_t const *pData, uint8_t size) {
+    CacheRecord *pRecord = nullptr;
+
+    if ((pTable_ == nullptr) || (entry >= CACHE_ENTRY_COUNT) || (size > CACHE_VALUE_SIZE)) {
+        return ERROR;
+    }
+    for (uint8_t i = 0; i < CACHE_RECORD_COUNT; i++) {
+        CacheRecord &record = pTable_->entries[entry].records[i];
+        if ((record.size != CACHE_RECORD_FREE) && (record.index == index) && (record.subindex == subindex)) {
+            pRecord = &record;
+            break;
+        }
+        if ((record.size == CACHE_RECORD_FREE) && (pRecord == nullptr)) {
+            pRecord = &record;
+        }
+    }
+    if (pRecord == nullptr) {
+        return ERROR;
+    }
+
+    pRecord->size = CACHE_RECORD_FREE;
+    pRecord->index = index;
+    pRecord->subindex = subindex;
+    memcpy(pRecord->data, pData, size);
+    pRecord->size = size;
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    invalidateParameter
+//!*****************************************************************************
+//!  \brief        Drop a cached value after it was written. Subindex 0 is
+//!                the whole parameter, it overlaps all subindices.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   entry                entry of the device, see open
+//!  \param[in]	   index                index of the parameter
+//!  \param[in]	   subindex             subindex, 0 for the whole parameter
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLDeviceCache::invalidateParameter(uint8_t entry, uint16_t index, uint8_t subindex) {
+    if ((pTable_ == nullptr) || (entry >= CACHE_ENTRY_COUNT)) {
+        return;
+    }
+    for (uint8_t i = 0; i < CACHE_RECORD_COUNT; i++) {
+        CacheRecord &record = pTable_->entries[entry].records[i];
+        if ((record.index == index) && ((subindex == 0) || (record.subindex == 0) || (record.subindex == subindex))) {
+            record.size = CACHE_RECORD_FREE;
+        }
+    }
+}
+
+//!*****************************************************************************
+//!  function :    invalidate
+//!*****************************************************************************
+//!  \brief        Drop all cached values of a device, e.g. after the device
+//!                reported a parameter change. The entry stays known.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   entry                entry of the device, see open
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLDeviceCache::invalidate(uint8_t entry) {
+    if ((pTable_ == nullptr) || (entry >= CACHE_ENTRY_COUNT)) {
+        return;
+    }
+    for (uint8_t i = 0; i < CACHE_RECORD_COUNT; i++) {
+        pTable_->entries[entry].records[i].size = CACHE_RECORD_FREE;
+    }
+}
@@ -0,0 +1,76 @@
+//!*****************************************************************************
+//!  \file      IOLDeviceCache.h
+//!*****************************************************************************
+//!
+//!  \brief		Persistent cache of the identification and the static
+//!             parameters of the devices, keyed by VendorID, DeviceID and
+//!             SerialNumber. The table lives in a block mapped with
+//!             NV_Map, so a restarted master or a replugged device finds
+//!             the values of a known device without ISDU reads.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-18
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLDEVICECACHE_H_INCLUDED
+#define IOLDEVICECACHE_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include "HardwareBase.h"
+
+#include <cstdint>
+//!***** Macros *****************************************************************
+constexpr uint8_t CACHE_ENTRY_COUNT  = 16u;     // devices in the cache, the least recently used is replaced
+constexpr uint8_t CACHE_RECORD_COUNT = 16u;     // parameters cached per device
+constexpr uint8_t CACHE_VALUE_SIZE   = 64u;     // longest cached value, longer ones are read every time
+constexpr uint8_t CACHE_SERIAL_SIZE  = 17u;     // SerialNumber of up to 16 octets and NUL
+constexpr uint8_t CACHE_NO_ENTRY     = 0xFFu;
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+class IOLDeviceCache {
+public:
+    explicit IOLDeviceCache(HardwareBase *hardware);
+
+    uint8_t isAvailable();
+
+    uint8_t open(uint16_t vendorID, uint32_t deviceID, char const *serialNumber);
+
+    uint8_t readParameter(uint8_t entry, uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t *pSize);
+
+    uint8_t storeParameter(uint8_t entry, uint16_t index, uint8_t subindex, uint8_t const *pData, uint8_t size);
+
+    void invalidateParameter(uint8_t entry, uint16_t index, uint8_t subindex);
+
+    void invalidate(uint8_t entry);
+
+private:
+    struct Table;
+
+    Table *pTable_;
+};
+
+#endif //IOLDEVICECACHE_H_INCLUDED
@@ -0,0 +1,249 @@
+//!*****************************************************************************
+//!  \file      IOLEvent.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Event reader of the master. When a device sets the event
+//!             flag in the CKS, the StatusCode and the used slots of its
+//!             event memory are read over the diagnosis channel and the
+//!             events are confirmed. Like the ISDU engine it is advanced
+//!             one M-sequence at a time, the transport is up to the port.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-18
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLEvent.h"
+
+//!***** Macros *****************************************************************
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLEvent
+//!*****************************************************************************
+//!  \brief        Constructor, the reader starts idle with an empty queue
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLEvent::IOLEvent()
+:state_(EVENT_IDLE),
+slots_(0),
+slot_(0),
+octet_(0),
+details_(),
+queue_(),
+queueHead_(0),
+queueCount_(0)
+{
+}
+
+//!*****************************************************************************
+//!  function :    reset
+//!*****************************************************************************
+//!  \brief        Stop reading and drop the queued events. Used when the
+//!                communication to the device is lost.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLEvent::reset() {
+    state_ = EVENT_IDLE;
+    queueHead_ = 0;
+    queueCount_ = 0;
+}
+
+//!*****************************************************************************
+//!  function :    trigger
+//!*****************************************************************************
+//!  \brief        The device set the event flag, start reading its event
+//!                memory. Ignored while the memory is read, the flag stays
+//!                set until the confirmation.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLEvent::trigger() {
+    if (state_ == EVENT_IDLE) {
+        state_ = EVENT_STATUS;
+    }
+}
+
+//!*****************************************************************************
+//!  function :    isBusy
+//!*****************************************************************************
+//!  \brief        Returns if the reader needs the on-request channel
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       1 if the event memory is being read
+//!
+//!*****************************************************************************
+uint8_t IOLEvent::isBusy() {
+    return (state_ != EVENT_IDLE) ? 1 : 0;
+}
+
+//!*****************************************************************************
+//!  function :    nextMessage
+//!*****************************************************************************
+//!  \brief        Master command and OD octets of the next M-sequence. The
+//!                reader only advances with handleAnswer, a message without
+//!                answer is built and sent again.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   odSize               OD octets of the M-sequence
+//!  \param[out]   *pOd                 OD octets for the write direction
+//!
+//!  \return       master command, bit 7 set for the read direction
+//!
+//!*****************************************************************************
+uint8_t IOLEvent::nextMessage(uint8_t odSize, uint8_t *pOd) {
+    switch (state_) {
+    case EVENT_SLOT:
+        return uint8_t(IOL::MC::DIAG_READ | (1u + slot_ * IOL::EVENT::SLOT_SIZE + octet_));
+    case EVENT_CONFIRM:
+        // Any value confirms the events
+        for (uint8_t i = 0; i < odSize; i++) {
+            pOd[i] = 0;
+        }
+        pOd[0] = 0xFFu;
+        return uint8_t(IOL::MC::DIAG_WRITE | IOL::EVENT::STATUS_CODE);
+    default:
+        return uint8_t(IOL::MC::DIAG_READ | IOL::EVENT::STATUS_CODE);
+    }
+}
+
+//!*****************************************************************************
+//!  function :    handleAnswer
+//!*****************************************************************************
+//!  \brief        The device answered the message of nextMessage. A
+//!                StatusCode without details carries no event code, it is
+//!                confirmed right away.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pOd                 OD octets of the answer, not used in
+//!                                     the write direction
+//!  \param[out]   *pEvent              event of a completed slot
+//!
+//!  \return       0 if the answer completed an event, 1 otherwise
+//!
+//!*****************************************************************************
+uint8_t IOLEvent::handleAnswer(uint8_t const *pOd, IOL::Event *pEvent) {
+    uint8_t retValue = ERROR;
+
+    switch (state_) {
+    case EVENT_STATUS:
+        slots_ = ((pOd[0] & IOL::EVENT::STATUS_DETAILS) != 0) ? uint8_t(pOd[0] & IOL::EVENT::STATUS_SLOTS) : 0;
+        slot_ = 0;
+        nextSlot();
+        break;
+
+    case EVENT_SLOT:
+        details_[octet_++] = pOd[0];
+        if (octet_ < IOL::EVENT::SLOT_SIZE) {
+            break;
+        }
+        // Slot complete, a full queue drops the newest events
+        pEvent->qualifier = details_[0];
+        pEvent->code = uint16_t((details_[1] << 8) | details_[2]);
+        retValue = SUCCESS;
+        if (queueCount_ < EVENT_QUEUE_SIZE) {
+            queue_[(queueHead_ + queueCount_) % EVENT_QUEUE_SIZE] = *pEvent;
+            queueCount_++;
+        }
+        slots_ = uint8_t(slots_ & ~(1u << slot_));
+        nextSlot();
+        break;
+
+    case EVENT_CONFIRM:
+        state_ = EVENT_IDLE;
+        break;
+
+    default:
+        break;
+    }
+    return retValue;
+}
+
+//!*****************************************************************************
+//!  function :    read
+//!*****************************************************************************
+//!  \brief        Take the oldest event read from the device
+//!
+//!  \type         local
+//!
+//!  \param[out]   *pEvent              event
+//!
+//!  \return       0 if an event was taken, 1 if the queue is empty
+//!
+//!*****************************************************************************
+uint8_t IOLEvent::read(IOL::Event *pEvent) {
+    if (queueCount_ == 0) {
+        return ERROR;
+    }
+    *pEvent = queue_[queueHead_];
+    queueHead_ = uint8_t((queueHead_ + 1) % EVENT_QUEUE_SIZE);
+    queueCount_--;
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    nextSlot
+//!*****************************************************************************
+//!  \brief        Continue with the next used slot, or confirm after the last
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLEvent::nextSlot() {
+    while ((slot_ < IOL::EVENT::SLOT_COUNT) && ((slots_ & (1u << slot_)) == 0)) {
+        slot_++;
+    }
+    octet_ = 0;
+    state_ = (slot_ < IOL::EVENT::SLOT_COUNT) ? EVENT_SLOT : EVENT_CONFIRM;
+}
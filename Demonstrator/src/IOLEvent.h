@@ -0,0 +1,86 @@
+//!*****************************************************************************
+//!  \file      IOLEvent.h
+//!*****************************************************************************
+//!
+//!  \brief		Event reader of the master. When a device sets the event
+//!             flag in the CKS, the StatusCode and the used slots of its
+//!             event memory are read over the diagnosis channel and the
+//!             events are confirmed. Like the ISDU engine it is advanced
+//!             one M-sequence at a time, the transport is up to the port.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-18
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLEVENT_H_INCLUDED
+#define IOLEVENT_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include "IOLink.h"
+
+#include <cstdint>
+//!***** Macros *****************************************************************
+constexpr uint8_t EVENT_QUEUE_SIZE = 12u;           // events read but not taken with read
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+class IOLEvent {
+public:
+    IOLEvent();
+
+    void reset();
+
+    void trigger();
+
+    uint8_t isBusy();
+
+    uint8_t nextMessage(uint8_t odSize, uint8_t *pOd);
+
+    uint8_t handleAnswer(uint8_t const *pOd, IOL::Event *pEvent);
+
+    uint8_t read(IOL::Event *pEvent);
+
+private:
+    enum State {
+        EVENT_IDLE,             // no event flag seen
+        EVENT_STATUS,           // reading the StatusCode
+        EVENT_SLOT,             // reading the octets of the used slots
+        EVENT_CONFIRM           // writing the StatusCode to free the memory
+    };
+
+    State state_;
+    uint8_t slots_;             // slots still to read, bit 0 is slot 1
+    uint8_t slot_;              // slot being read
+    uint8_t octet_;             // next octet of the slot
+    uint8_t details_[IOL::EVENT::SLOT_SIZE];
+    IOL::Event queue_[EVENT_QUEUE_SIZE];
+    uint8_t queueHead_;
+    uint8_t queueCount_;
+
+    void nextSlot();
+};
+
+#endif //IOLEVENT_H_INCLUDED
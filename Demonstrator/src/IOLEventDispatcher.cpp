@@ -0,0 +1,342 @@
+//!*****************************************************************************
+//!  \file      IOLEventDispatcher.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Consumer of the event rings. Drains the rings of all ports,
+//!             decodes the records and passes them to the subscribers of
+//!             their source. On Linux a thread of its own polls the rings,
+//!             so the producers in the cycle context never wait for it.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-23
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLEventDispatcher.h"
+#include "IOLink.h"
+#include "Max14819.h"
+
+#include <stdio.h>
+
+#ifndef ARDUINO
+	#include <chrono>
+#endif
+
+using namespace max14819;
+
+//!***** Macros *****************************************************************
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+static uint8_t appendFlag(char *pText, uint8_t size, uint8_t length, uint8_t value, uint8_t flag, char const *name);
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLEventDispatcher
+//!*****************************************************************************
+//!  \brief        Constructor, no rings and no subscribers
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLEventDispatcher::IOLEventDispatcher()
+:rings_(),
+ringCount_(0),
+subscribers_(),
+subscriberCount_(0)
+#ifndef ARDUINO
+,thread_(),
+isRunning_(false)
+#endif
+{
+}
+
+//!*****************************************************************************
+//!  function :    ~IOLEventDispatcher
+//!*****************************************************************************
+//!  \brief        Destructor, stops the thread
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLEventDispatcher::~IOLEventDispatcher() {
+#ifndef ARDUINO
+    stop();
+#endif
+}
+
+//!*****************************************************************************
+//!  function :    addRing
+//!*****************************************************************************
+//!  \brief        Drain the ring of a port. Only called before start, the
+//!                thread reads the list without locking.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   portNr               number passed to the subscribers
+//!  \param[in]	   *pRing               event ring of the port
+//!
+//!  \return       0 if added, 1 if the list is full
+//!
+//!*****************************************************************************
+uint8_t IOLEventDispatcher::addRing(uint8_t portNr, IOLEventRing *pRing) {
+    if ((pRing == nullptr) || (ringCount_ >= DISPATCH_MAX_RINGS)) {
+        return ERROR;
+    }
+    rings_[ringCount_].portNr = portNr;
+    rings_[ringCount_].pRing = pRing;
+    ringCount_++;
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    subscribe
+//!*****************************************************************************
+//!  \brief        Pass the records of the given sources to a handler. Only
+//!                called before start.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   sourceMask           EVENT_SOURCE_x bits
+//!  \param[in]	   handler              called for each matching record
+//!  \param[in]	   *pContext            passed to the handler
+//!
+//!  \return       0 if subscribed, 1 if the list is full
+//!
+//!*****************************************************************************
+uint8_t IOLEventDispatcher::subscribe(uint8_t sourceMask, EventHandler handler, void *pContext) {
+    if ((handler == nullptr) || (subscriberCount_ >= DISPATCH_MAX_SUBSCRIBERS)) {
+        return ERROR;
+    }
+    subscribers_[subscriberCount_].sourceMask = sourceMask;
+    subscribers_[subscriberCount_].handler = handler;
+    subscribers_[subscriberCount_].pContext = pContext;
+    subscriberCount_++;
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    dispatch
+//!*****************************************************************************
+//!  \brief        Drain all rings once and pass the records to the
+//!                subscribers. Called by the thread, or from the main loop
+//!                where there are no threads.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       number of records taken
+//!
+//!*****************************************************************************
+uint16_t IOLEventDispatcher::dispatch() {
+    EventRecord record;
+    uint16_t count = 0;
+
+    for (uint8_t i = 0; i < ringCount_; i++) {
+        while (rings_[i].pRing->pop(&record) == SUCCESS) {
+            count++;
+            for (uint8_t j = 0; j < subscriberCount_; j++) {
+                if ((subscribers_[j].sourceMask & record.source) != 0) {
+                    subscribers_[j].handler(subscribers_[j].pContext, rings_[i].portNr, record);
+                }
+            }
+        }
+    }
+    return count;
+}
+
+//!*****************************************************************************
+//!  function :    readDropCount
+//!*****************************************************************************
+//!  \brief        Returns the records dropped by all rings
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       number of dropped records
+//!
+//!*****************************************************************************
+uint32_t IOLEventDispatcher::readDropCount() {
+    uint32_t drops = 0;
+
+    for (uint8_t i = 0; i < ringCount_; i++) {
+        drops += rings_[i].pRing->readDropCount();
+    }
+    return drops;
+}
+
+#ifndef ARDUINO
+//!*****************************************************************************
+//!  function :    start
+//!*****************************************************************************
+//!  \brief        Start the thread draining the rings. A period of about the
+//!                cycle time keeps the rings far from full.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   period_us            sleep between two drains
+//!
+//!  \return       0 if started, 1 if already running
+//!
+//!*****************************************************************************
+uint8_t IOLEventDispatcher::start(uint32_t period_us) {
+    if (isRunning_.load() || thread_.joinable()) {
+        return ERROR;
+    }
+    isRunning_.store(true);
+    thread_ = std::thread(&IOLEventDispatcher::run, this, period_us);
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    stop
+//!*****************************************************************************
+//!  \brief        Stop the thread, the records still in the rings are
+//!                dispatched before it ends
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLEventDispatcher::stop() {
+    isRunning_.store(false);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+//!*****************************************************************************
+//!  function :    run
+//!*****************************************************************************
+//!  \brief        Thread function, polls the rings until stop
+//!
+//!  \type         local
+//!
+//!  \param[in]	   period_us            sleep between two drains
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLEventDispatcher::run(uint32_t period_us) {
+    while (isRunning_.load()) {
+        if (dispatch() == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(period_us));
+        }
+    }
+    dispatch();
+}
+#endif
+
+//!*****************************************************************************
+//!  function :    format
+//!*****************************************************************************
+//!  \brief        Decode a record into a line of text
+//!
+//!  \type         local
+//!
+//!  \param[in]	   record               event record
+//!  \param[out]   *pText               text, always terminated
+//!  \param[in]	   size                 size of the text buffer
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLEventDispatcher::format(EventRecord const &record, char *pText, uint8_t size) {
+    int length = 0;
+    uint8_t value = record.value;
+
+    if (size == 0) {
+        return;
+    }
+    switch (record.source) {
+    case EVENT_SOURCE_DEVICE:
+        snprintf(pText, size, "device event qualifier 0x%02X code 0x%04X", value, record.code);
+        return;
+    case EVENT_SOURCE_INTERRUPT:
+        length = snprintf(pText, size, "interrupt");
+        length = appendFlag(pText, size, uint8_t(length), value, uint8_t(TxErrorA | TxErrorB), "TxError");
+        length = appendFlag(pText, size, uint8_t(length), value, uint8_t(RxErrorA | RxErrorB), "RxError");
+        return;
+    case EVENT_SOURCE_STATUS:
+        length = snprintf(pText, size, "status");
+        length = appendFlag(pText, size, uint8_t(length), value, ThShdn, "ThShdn");
+        length = appendFlag(pText, size, uint8_t(length), value, TempWarn, "TempWarn");
+        length = appendFlag(pText, size, uint8_t(length), value, VCCUV, "VCCUV");
+        length = appendFlag(pText, size, uint8_t(length), value, VCCWarn, "VCCWarn");
+        length = appendFlag(pText, size, uint8_t(length), value, uint8_t(ThShdnCOR | ThWarnCOR | VCCUVCOR | VCCWarnCOR), "changed");
+        return;
+    case EVENT_SOURCE_CHANNEL:
+        length = snprintf(pText, size, "channel");
+        length = appendFlag(pText, size, uint8_t(length), value, CQFault, "CQFault");
+        length = appendFlag(pText, size, uint8_t(length), value, UVL, "UVL");
+        length = appendFlag(pText, size, uint8_t(length), value, LCLim, "LCLim");
+        length = appendFlag(pText, size, uint8_t(length), value, uint8_t(CQFaultCOR | LCLimCOR), "changed");
+        return;
+    default:
+        snprintf(pText, size, "unknown source 0x%02X", record.source);
+        return;
+    }
+}
+
+//!*****************************************************************************
+//!  function :    appendFlag
+//!*****************************************************************************
+//!  \brief        Append the name of a flag if one of its bits is set
+//!
+//!  \type         local
+//!
+//!  \param[in,out] *pText              text, always terminated
+//!  \param[in]	   size                 size of the text buffer
+//!  \param[in]	   length               length of the text so far
+//!  \param[in]	   value                decoded value
+//!  \param[in]	   flag                 bits of the flag
+//!  \param[in]	   *name                name of the flag
+//!
+//!  \return       length of the text
+//!
+//!*****************************************************************************
+static uint8_t appendFlag(char *pText, uint8_t size, uint8_t length, uint8_t value, uint8_t flag, char const *name) {
+    if (((value & flag) == 0) || (length >= size - 1u)) {
+        return length;
+    }
+    int added = snprintf(&pText[length], size - length, " %s", name);
+    if (added < 0) {
+        return length;
+    }
+    return uint8_t(((length + added) < size) ? (length + added) : (size - 1u));
+}
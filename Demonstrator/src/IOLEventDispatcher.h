@@ -0,0 +1,106 @@
+//!*****************************************************************************
+//!  \file      IOLEventDispatcher.h
+//!*****************************************************************************
+//!
+//!  \brief		Consumer of the event rings. Drains the rings of all ports,
+//!             decodes the records and passes them to the subscribers of
+//!             their source. On Linux a thread of its own polls the rings,
+//!             so the producers in the cycle context never wait for it.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-23
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLEVENTDISPATCHER_H_INCLUDED
+#define IOLEVENTDISPATCHER_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include "IOLEventRing.h"
+
+#include <cstdint>
+#ifndef ARDUINO
+#include <atomic>
+#include <thread>
+#endif
+//!***** Macros *****************************************************************
+constexpr uint8_t DISPATCH_MAX_RINGS       = 8u;    // ports drained by one dispatcher
+constexpr uint8_t DISPATCH_MAX_SUBSCRIBERS = 8u;
+constexpr uint32_t DISPATCH_PERIOD_US      = 1000u; // default poll period of the thread
+
+//!***** Data types *************************************************************
+// Subscriber, called in the context of the dispatcher
+typedef void (*EventHandler)(void *pContext, uint8_t portNr, EventRecord const &record);
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+class IOLEventDispatcher {
+public:
+    IOLEventDispatcher();
+
+    ~IOLEventDispatcher();
+
+    uint8_t addRing(uint8_t portNr, IOLEventRing *pRing);
+
+    uint8_t subscribe(uint8_t sourceMask, EventHandler handler, void *pContext);
+
+    uint16_t dispatch();
+
+    uint32_t readDropCount();
+
+#ifndef ARDUINO
+    uint8_t start(uint32_t period_us = DISPATCH_PERIOD_US);
+
+    void stop();
+#endif
+
+    static void format(EventRecord const &record, char *pText, uint8_t size);
+
+private:
+    struct Ring {
+        uint8_t portNr;
+        IOLEventRing *pRing;
+    };
+    struct Subscriber {
+        uint8_t sourceMask;
+        EventHandler handler;
+        void *pContext;
+    };
+
+    Ring rings_[DISPATCH_MAX_RINGS];
+    uint8_t ringCount_;
+    Subscriber subscribers_[DISPATCH_MAX_SUBSCRIBERS];
+    uint8_t subscriberCount_;
+#ifndef ARDUINO
+    std::thread thread_;
+    std::atomic<bool> isRunning_;
+
+    void run(uint32_t period_us);
+#endif
+
+    // Not copyable, the thread refers to the object
+    IOLEventDispatcher(IOLEventDispatcher const &);
+    IOLEventDispatcher & operator=(IOLEventDispatcher const &);
+};
+
+#endif //IOLEVENTDISPATCHER_H_INCLUDED
@@ -0,0 +1,131 @@
+//!*****************************************************************************
+//!  \file      IOLEventRing.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Bounded single producer, single consumer ring of event
+//!             records. The cycle context of a port pushes device events,
+//!             interrupt causes and chip status without locking, the
+//!             consumer (see IOLEventDispatcher) pops them. A full ring
+//!             drops the new record and counts it.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-23
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLEventRing.h"
+#include "IOLink.h"
+
+//!***** Macros *****************************************************************
+static_assert((EVENT_RING_SIZE & (EVENT_RING_SIZE - 1u)) == 0, "EVENT_RING_SIZE must be a power of two");
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLEventRing
+//!*****************************************************************************
+//!  \brief        Constructor, the ring starts empty
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLEventRing::IOLEventRing()
+:records_(),
+head_(0),
+tail_(0),
+drops_(0)
+{
+}
+
+//!*****************************************************************************
+//!  function :    push
+//!*****************************************************************************
+//!  \brief        Append a record, only called by the producer. Never waits,
+//!                a full ring drops the record.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   record               event record
+//!
+//!  \return       0 if appended, 1 if the ring is full
+//!
+//!*****************************************************************************
+uint8_t IOLEventRing::push(EventRecord const &record) {
+    uint16_t tail = tail_.load(std::memory_order_relaxed);
+
+    if (uint16_t(tail - head_.load(std::memory_order_acquire)) >= EVENT_RING_SIZE) {
+        drops_.fetch_add(1, std::memory_order_relaxed);
+        return ERROR;
+    }
+    records_[tail & (EVENT_RING_SIZE - 1u)] = record;
+    tail_.store(uint16_t(tail + 1u), std::memory_order_release);
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    pop
+//!*****************************************************************************
+//!  \brief        Take the oldest record, only called by the consumer
+//!
+//!  \type         local
+//!
+//!  \param[out]   *pRecord             event record
+//!
+//!  \return       0 if a record was taken, 1 if the ring is empty
+//!
+//!*****************************************************************************
+uint8_t IOLEventRing::pop(EventRecord *pRecord) {
+    uint16_t head = head_.load(std::memory_order_relaxed);
+
+    if (head == tail_.load(std::memory_order_acquire)) {
+        return ERROR;
+    }
+    *pRecord = records_[head & (EVENT_RING_SIZE - 1u)];
+    head_.store(uint16_t(head + 1u), std::memory_order_release);
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    readDropCount
+//!*****************************************************************************
+//!  \brief        Returns the records dropped because the consumer fell
+//!                behind
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       number of dropped records
+//!
+//!*****************************************************************************
+uint32_t IOLEventRing::readDropCount() {
+    return drops_.load(std::memory_order_relaxed);
+}
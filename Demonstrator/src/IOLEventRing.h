@@ -0,0 +1,80 @@
+//!*****************************************************************************
+//!  \file      IOLEventRing.h
+//!*****************************************************************************
+//!
+//!  \brief		Bounded single producer, single consumer ring of event
+//!             records. The cycle context of a port pushes device events,
+//!             interrupt causes and chip status without locking, the
+//!             consumer (see IOLEventDispatcher) pops them. A full ring
+//!             drops the new record and counts it.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-23
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLEVENTRING_H_INCLUDED
+#define IOLEVENTRING_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <atomic>
+#include <cstdint>
+//!***** Macros *****************************************************************
+constexpr uint16_t EVENT_RING_SIZE = 64u;       // records per port, power of two
+
+// Source of an event record, bit of the subscription mask
+constexpr uint8_t EVENT_SOURCE_DEVICE    = 0x01u;   // event memory of the device: EventQualifier and EventCode
+constexpr uint8_t EVENT_SOURCE_INTERRUPT = 0x02u;   // StatusInt, TxError and RxError of the Interrupt register
+constexpr uint8_t EVENT_SOURCE_STATUS    = 0x04u;   // Status register of the chip
+constexpr uint8_t EVENT_SOURCE_CHANNEL   = 0x08u;   // ChanStat register of the port
+constexpr uint8_t EVENT_SOURCE_ALL       = 0x0Fu;
+
+//!***** Data types *************************************************************
+// Compact record, decoded by the consumer
+struct EventRecord {
+    uint64_t time_ns;           // pushed at (see get_time_ns)
+    uint8_t source;             // EVENT_SOURCE_x
+    uint8_t value;              // EventQualifier or register value
+    uint16_t code;              // EventCode, 0 for the chip sources
+};
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+class IOLEventRing {
+public:
+    IOLEventRing();
+
+    uint8_t push(EventRecord const &record);
+
+    uint8_t pop(EventRecord *pRecord);
+
+    uint32_t readDropCount();
+
+private:
+    EventRecord records_[EVENT_RING_SIZE];
+    std::atomic<uint16_t> head_;        // next record to pop, written by the consumer
+    std::atomic<uint16_t> tail_;        // next record to push, written by the producer
+    std::atomic<uint32_t> drops_;       // records lost to a full ring
+};
+
+#endif //IOLEVENTRING_H_INCLUDED
@@ -45,6 +45,49 @@
 IOLGenericDevice::IOLGenericDevice(IOLMasterPort * port)
 {
 	this->port = port;
+	pCache = nullptr;
+	cacheEntry = CACHE_NO_ENTRY;
+	cacheOperateTime = 0;
+	pDataStorage = nullptr;
+}
+
+//!*****************************************************************************
+//!  function :    setCache
+//!*****************************************************************************
+//!  \brief        Use a persistent cache for the identification strings and
+//!                the parameters read with readCachedISDU. Known devices are
+//!                then identified with a single SerialNumber read per
+//!                operate entry.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *cache               cache shared by the devices, nullptr
+//!                                     to read everything from the device
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLGenericDevice::setCache(IOLDeviceCache * cache) {
+	pCache = cache;
+	cacheEntry = CACHE_NO_ENTRY;
+}
+
+//!*****************************************************************************
+//!  function :    setDataStorage
+//!*****************************************************************************
+//!  \brief        Keep the parameters of the device in a Data Storage. A
+//!                parameter change reported by the device is uploaded by
+//!                eventHandler.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *dataStorage         store of the port, nullptr for none
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLGenericDevice::setDataStorage(IOLDataStorage * dataStorage) {
+	pDataStorage = dataStorage;
 }
 
 //!*****************************************************************************
@@ -82,7 +125,9 @@ void IOLGenericDevice::end() {
 //!*****************************************************************************
 //!  function :    eventHandler
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Take the events read by the port. A DS_UPLOAD_REQ reports
+//!                a parameter changed on the device, the cached values of
+//!                the device are dropped and the Data Storage is uploaded.
 //!
 //!  \type         local
 //!
@@ -92,7 +137,21 @@ void IOLGenericDevice::end() {
 //!
 //!*****************************************************************************
 void IOLGenericDevice::eventHandler() {
+	IOL::Event event;
+	uint8_t isUploadRequest = 0;
 
+	while (port->readEvent(&event) == SUCCESS) {
+		if (event.code != IOL::EVENT::DS_UPLOAD_REQ) {
+			continue;
+		}
+		if (pCache != nullptr) {
+			pCache->invalidate(cacheEntry);
+		}
+		isUploadRequest = 1;
+	}
+	if ((isUploadRequest != 0) && (pDataStorage != nullptr)) {
+		pDataStorage->upload(port);
+	}
 }
 
 //!*****************************************************************************
@@ -242,33 +301,48 @@ void IOLGenericDevice::readDI() {
 //!*****************************************************************************
 //!  function :    writeSpecISDU
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Write a device specific parameter over ISDU
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[in]	   index                index of the parameter
+//!  \param[in]	   subindex             subindex, 0 for the whole parameter
+//!  \param[in]	   *pData               value
+//!  \param[in]	   size                 size of the value
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::writeSpecISDU() {
+uint8_t IOLGenericDevice::writeSpecISDU(uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t size) {
+    uint8_t retValue = port->writeISDU(index, subindex, pData, size);
 
+    // Also after an error, the device may have taken a part of the value
+    if ((pCache != nullptr) && (index == IOL::INDEX::SYSTEM_COMMAND)) {
+        pCache->invalidate(cacheEntry);
+    }
+    else if (pCache != nullptr) {
+        pCache->invalidateParameter(cacheEntry, index, subindex);
+    }
+    return retValue;
 }
 
 //!*****************************************************************************
 //!  function :    readSpecISDU
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read a device specific parameter over ISDU
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[in]	   index                index of the parameter
+//!  \param[in]	   subindex             subindex, 0 for the whole parameter
+//!  \param[out]   *pData               buffer for the value
+//!  \param[in,out] *pSize              size of the buffer, size of the value
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readSpecISDU() {
-
+uint8_t IOLGenericDevice::readSpecISDU(uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t *pSize) {
+    return port->readISDU(index, subindex, pData, pSize);
 }
 
 //!*****************************************************************************
@@ -338,129 +412,304 @@ void IOLGenericDevice::readPDOutputDescriptor() {
 //!*****************************************************************************
 //!  function :    readVendorName
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the vendor name (index 0x10)
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pText               buffer for the string
+//!  \param[in]	   size                 size of the buffer including NUL
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readVendorName() {
-
+uint8_t IOLGenericDevice::readVendorName(char *pText, uint8_t size) {
+    return readText(IOL::INDEX::VENDOR_NAME, pText, size);
 }
 
 //!*****************************************************************************
 //!  function :    readVendorText
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the vendor text (index 0x11)
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pText               buffer for the string
+//!  \param[in]	   size                 size of the buffer including NUL
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readVendorText() {
-
+uint8_t IOLGenericDevice::readVendorText(char *pText, uint8_t size) {
+    return readText(IOL::INDEX::VENDOR_TEXT, pText, size);
 }
 
 //!*****************************************************************************
 //!  function :    readProductName
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the product name (index 0x12)
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pText               buffer for the string
+//!  \param[in]	   size                 size of the buffer including NUL
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readProductName() {
-
+uint8_t IOLGenericDevice::readProductName(char *pText, uint8_t size) {
+    return readText(IOL::INDEX::PRODUCT_NAME, pText, size);
 }
 
 //!*****************************************************************************
 //!  function :    readProductID
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the product ID (index 0x13)
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pText               buffer for the string
+//!  \param[in]	   size                 size of the buffer including NUL
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readProductID() {
-
+uint8_t IOLGenericDevice::readProductID(char *pText, uint8_t size) {
+    return readText(IOL::INDEX::PRODUCT_ID, pText, size);
 }
 
 //!*****************************************************************************
 //!  function :    readProductText
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the product text (index 0x14)
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pText               buffer for the string
+//!  \param[in]	   size                 size of the buffer including NUL
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readProductText() {
-
+uint8_t IOLGenericDevice::readProductText(char *pText, uint8_t size) {
+    return readText(IOL::INDEX::PRODUCT_TEXT, pText, size);
 }
 
 //!*****************************************************************************
 //!  function :    readSerialNumber
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the serial number (index 0x15)
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pText               buffer for the string
+//!  \param[in]	   size                 size of the buffer including NUL
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readSerialNumber() {
-
+uint8_t IOLGenericDevice::readSerialNumber(char *pText, uint8_t size) {
+    return readText(IOL::INDEX::SERIAL_NUMBER, pText, size);
 }
 
 //!*****************************************************************************
 //!  function :    readHardwareRev
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the hardware revision (index 0x16)
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pText               buffer for the string
+//!  \param[in]	   size                 size of the buffer including NUL
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readHardwareRev() {
-
+uint8_t IOLGenericDevice::readHardwareRev(char *pText, uint8_t size) {
+    return readText(IOL::INDEX::HARDWARE_REVISION, pText, size);
 }
 
 //!*****************************************************************************
 //!  function :    readFirmwareRev
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the firmware revision (index 0x17)
+//!
+//!  \type         local
+//!
+//!  \param[out]   *pText               buffer for the string
+//!  \param[in]	   size                 size of the buffer including NUL
+//!
+//!  \return       0 if success
+//!
+//!*****************************************************************************
+uint8_t IOLGenericDevice::readFirmwareRev(char *pText, uint8_t size) {
+    return readText(IOL::INDEX::FIRMWARE_REVISION, pText, size);
+}
+
+//!*****************************************************************************
+//!  function :    readIdentification
+//!*****************************************************************************
+//!  \brief        Read all identification strings in one batch. The requests
+//!                are transferred back to back, the ISDU channel is busy in
+//!                every cycle until the last response. With a cache only the
+//!                strings not cached yet are requested.
+//!
+//!  \type         local
+//!
+//!  \param[out]   *pIdent              identification strings
+//!
+//!  \return       0 if all strings were read
+//!
+//!*****************************************************************************
+uint8_t IOLGenericDevice::readIdentification(IOLIdentification *pIdent) {
+    char *texts[] = {pIdent->vendorName, pIdent->vendorText, pIdent->productName, pIdent->productID,
+                     pIdent->productText, pIdent->serialNumber, pIdent->hardwareRev, pIdent->firmwareRev};
+    constexpr uint8_t TEXT_COUNT = sizeof(texts) / sizeof(texts[0]);
+    IOLIsdu::Request requests[TEXT_COUNT];
+    uint8_t textOfRequest[TEXT_COUNT];
+    uint8_t count = 0;
+    uint8_t retValue = SUCCESS;
+
+    if (openCache() == SUCCESS) {
+        eventHandler();
+    }
+    for (uint8_t i = 0; i < TEXT_COUNT; i++) {
+        uint16_t index = uint16_t(IOL::INDEX::VENDOR_NAME + i);
+        uint8_t length = IDENT_TEXT_SIZE - 1;
+
+        if ((cacheEntry != CACHE_NO_ENTRY)
+                && (pCache->readParameter(cacheEntry, index, 0, reinterpret_cast<uint8_t *>(texts[i]), &length) == SUCCESS)) {
+            texts[i][length] = '\0';
+            continue;
+        }
+        requests[count].index = index;
+        requests[count].subindex = 0;
+        requests[count].isWrite = 0;
+        requests[count].pData = reinterpret_cast<uint8_t *>(texts[i]);
+        requests[count].size = IDENT_TEXT_SIZE - 1;
+        textOfRequest[count++] = i;
+    }
+    if (count == 0) {
+        return SUCCESS;
+    }
+
+    retValue = port->transferISDU(requests, count);
+    for (uint8_t i = 0; i < count; i++) {
+        IOLIsdu::Request const &request = requests[i];
+        if ((request.status == SUCCESS) && (cacheEntry != CACHE_NO_ENTRY)) {
+            pCache->storeParameter(cacheEntry, request.index, 0, request.pData, request.size);
+        }
+        texts[textOfRequest[i]][(request.status == SUCCESS) ? request.size : 0] = '\0';
+    }
+    return retValue;
+}
+
+//!*****************************************************************************
+//!  function :    readText
+//!*****************************************************************************
+//!  \brief        Read a string parameter over ISDU and terminate it
+//!
+//!  \type         local
+//!
+//!  \param[in]	   index                index of the parameter
+//!  \param[out]   *pText               buffer for the string
+//!  \param[in]	   size                 size of the buffer including NUL
+//!
+//!  \return       0 if success
+//!
+//!*****************************************************************************
+uint8_t IOLGenericDevice::readText(uint16_t index, char *pText, uint8_t size) {
+    uint8_t length = uint8_t(size - 1);
+
+    if (size == 0) {
+        return ERROR;
+    }
+    if (readCachedISDU(index, 0, reinterpret_cast<uint8_t *>(pText), &length) == ERROR) {
+        pText[0] = '\0';
+        return ERROR;
+    }
+    pText[length] = '\0';
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    openCache
+//!*****************************************************************************
+//!  \brief        Find the cache entry of the connected device. The entry is
+//!                kept until the port enters operate again, the device may
+//!                have been replaced in between. The key needs the
+//!                SerialNumber, it is read once per operate entry and cached
+//!                as well.
 //!
 //!  \type         local
 //!
 //!  \param[in]	   void
 //!
-//!  \return       void
+//!  \return       0 if the entry is open
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readFirmwareRev() {
+uint8_t IOLGenericDevice::openCache() {
+	IOL::DirectParameterPage1 page;
+	char serialNumber[IDENT_TEXT_SIZE];
+	uint8_t length = IDENT_TEXT_SIZE - 1;
+	uint64_t operateTime = port->readStateTime(PORT_OPERATE);
+
+	if ((pCache == nullptr) || (pCache->isAvailable() == 0) || (operateTime == 0)) {
+		cacheEntry = CACHE_NO_ENTRY;
+		return ERROR;
+	}
+	if ((cacheEntry != CACHE_NO_ENTRY) && (operateTime == cacheOperateTime)) {
+		return SUCCESS;
+	}
+
+	cacheEntry = CACHE_NO_ENTRY;
+	if (port->readDirectParameterPage1(&page) == ERROR) {
+		return ERROR;
+	}
+	// A device without SerialNumber is only keyed by its IDs
+	if (port->readISDU(IOL::INDEX::SERIAL_NUMBER, 0, reinterpret_cast<uint8_t *>(serialNumber), &length) == ERROR) {
+		length = 0;
+	}
+	serialNumber[length] = '\0';
+
+	cacheEntry = pCache->open(page.vendorID, page.deviceID, serialNumber);
+	cacheOperateTime = operateTime;
+	if (length != 0) {
+		pCache->storeParameter(cacheEntry, IOL::INDEX::SERIAL_NUMBER, 0,
+		                       reinterpret_cast<uint8_t *>(serialNumber), length);
+	}
+	return SUCCESS;
+}
 
+//!*****************************************************************************
+//!  function :    readCachedISDU
+//!*****************************************************************************
+//!  \brief        Read a static parameter, from the cache if the device is
+//!                known, otherwise over ISDU. Values read from the device
+//!                are cached until a write or a parameter change event.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   index                index of the parameter
+//!  \param[in]	   subindex             subindex, 0 for the whole parameter
+//!  \param[out]   *pData               buffer for the value
+//!  \param[in,out] *pSize              size of the buffer, size of the value
+//!
+//!  \return       0 if success
+//!
+//!*****************************************************************************
+uint8_t IOLGenericDevice::readCachedISDU(uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t *pSize) {
+	if (openCache() == ERROR) {
+		return port->readISDU(index, subindex, pData, pSize);
+	}
+	eventHandler();
+	if (pCache->readParameter(cacheEntry, index, subindex, pData, pSize) == SUCCESS) {
+		return SUCCESS;
+	}
+	if (port->readISDU(index, subindex, pData, pSize) == ERROR) {
+		return ERROR;
+	}
+	pCache->storeParameter(cacheEntry, index, subindex, pData, *pSize);
+	return SUCCESS;
 }
 
 //!*****************************************************************************
@@ -482,147 +731,201 @@ void IOLGenericDevice::writeMasterCycleTime() {
 //!*****************************************************************************
 //!  function :    readMasterCycleTime
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the MasterCycleTime of the device (cycle time
+//!                encoding) from the direct parameter page 1, cached by
+//!                the port
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pCycleTime          masterCycleTime
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readMasterCycleTime() {
-
+uint8_t IOLGenericDevice::readMasterCycleTime(uint8_t *pCycleTime) {
+	IOL::DirectParameterPage1 page;
+	if (port->readDirectParameterPage1(&page) == ERROR) {
+		return ERROR;
+	}
+	*pCycleTime = page.masterCycleTime;
+	return SUCCESS;
 }
 
 //!*****************************************************************************
-//!  function :    readMinCycleTime() {
+//!  function :    readMinCycleTime
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the MinCycleTime of the device (cycle time
+//!                encoding) from the direct parameter page 1, cached by
+//!                the port
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pCycleTime          minCycleTime
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readMinCycleTime() {
-	uint8_t pData[2];
-	char buf[64];
-	uint8_t time = port->readDirectParameterPage(0x2, pData);	
-	sprintf(buf, "Min Cycle Time Data: %d, %d, Retval: %d", pData[0], pData[1], time);
-	//HardwareBase::Serial_Write(buf);
+uint8_t IOLGenericDevice::readMinCycleTime(uint8_t *pCycleTime) {
+	IOL::DirectParameterPage1 page;
+	if (port->readDirectParameterPage1(&page) == ERROR) {
+		return ERROR;
+	}
+	*pCycleTime = page.minCycleTime;
+	return SUCCESS;
 }
 
 //!*****************************************************************************
 //!  function :    readMSeqCapability
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the M-sequence capability of the device from the direct
+//!                parameter page 1, cached by the port
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pCapability         mSeqCapability
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readMSeqCapability() {
-
+uint8_t IOLGenericDevice::readMSeqCapability(uint8_t *pCapability) {
+	IOL::DirectParameterPage1 page;
+	if (port->readDirectParameterPage1(&page) == ERROR) {
+		return ERROR;
+	}
+	*pCapability = page.mSeqCapability;
+	return SUCCESS;
 }
 
 //!*****************************************************************************
 //!  function :    readRevID
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the IO-Link revision ID of the device from the direct
+//!                parameter page 1, cached by the port
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pRevID              revisionID
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readRevID() {
-
+uint8_t IOLGenericDevice::readRevID(uint8_t *pRevID) {
+	IOL::DirectParameterPage1 page;
+	if (port->readDirectParameterPage1(&page) == ERROR) {
+		return ERROR;
+	}
+	*pRevID = page.revisionID;
+	return SUCCESS;
 }
 
 //!*****************************************************************************
 //!  function :    readProcessDataIn
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the process data input length of the device (length
+//!                encoding) from the direct parameter page 1, cached by
+//!                the port
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pLength             processDataIn
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readProcessDataIn() {
-
+uint8_t IOLGenericDevice::readProcessDataIn(uint8_t *pLength) {
+	IOL::DirectParameterPage1 page;
+	if (port->readDirectParameterPage1(&page) == ERROR) {
+		return ERROR;
+	}
+	*pLength = page.processDataIn;
+	return SUCCESS;
 }
 
 //!*****************************************************************************
 //!  function :    readProcessDataOut
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the process data output length of the device (length
+//!                encoding) from the direct parameter page 1, cached by
+//!                the port
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pLength             processDataOut
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readProcessDataOut() {
-
+uint8_t IOLGenericDevice::readProcessDataOut(uint8_t *pLength) {
+	IOL::DirectParameterPage1 page;
+	if (port->readDirectParameterPage1(&page) == ERROR) {
+		return ERROR;
+	}
+	*pLength = page.processDataOut;
+	return SUCCESS;
 }
 
 //!*****************************************************************************
 //!  function :    readVendorID
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the VendorID of the device from the direct
+//!                parameter page 1, cached by the port
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pVendorID           vendorID
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readVendorID() {
-
+uint8_t IOLGenericDevice::readVendorID(uint16_t *pVendorID) {
+	IOL::DirectParameterPage1 page;
+	if (port->readDirectParameterPage1(&page) == ERROR) {
+		return ERROR;
+	}
+	*pVendorID = page.vendorID;
+	return SUCCESS;
 }
 
 //!*****************************************************************************
 //!  function :    readDeviceID
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the DeviceID of the device from the direct
+//!                parameter page 1, cached by the port
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pDeviceID           deviceID
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readDeviceID() {
-
+uint8_t IOLGenericDevice::readDeviceID(uint32_t *pDeviceID) {
+	IOL::DirectParameterPage1 page;
+	if (port->readDirectParameterPage1(&page) == ERROR) {
+		return ERROR;
+	}
+	*pDeviceID = page.deviceID;
+	return SUCCESS;
 }
 
 //!*****************************************************************************
 //!  function :    readFunctionID
 //!*****************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Read the FunctionID of the device from the direct
+//!                parameter page 1, cached by the port
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[out]   *pFunctionID         functionID
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*****************************************************************************
-void IOLGenericDevice::readFunctionID() {
-
+uint8_t IOLGenericDevice::readFunctionID(uint16_t *pFunctionID) {
+	IOL::DirectParameterPage1 page;
+	if (port->readDirectParameterPage1(&page) == ERROR) {
+		return ERROR;
+	}
+	*pFunctionID = page.functionID;
+	return SUCCESS;
 }
@@ -31,11 +31,25 @@
 
 //!**** Header-Files ************************************************************
 #include "IOLMasterPort.h"
+#include "IOLDeviceCache.h"
+#include "IOLDataStorage.h"
 
 #include <cstdint>
 //!**** Macros ******************************************************************
+constexpr uint8_t IDENT_TEXT_SIZE = 65u;    // identification strings, 64 characters and NUL
 
 //!**** Data types **************************************************************
+// Identification strings of the device, see readIdentification
+struct IOLIdentification {
+	char vendorName[IDENT_TEXT_SIZE];
+	char vendorText[IDENT_TEXT_SIZE];
+	char productName[IDENT_TEXT_SIZE];
+	char productID[IDENT_TEXT_SIZE];
+	char productText[IDENT_TEXT_SIZE];
+	char serialNumber[IDENT_TEXT_SIZE];
+	char hardwareRev[IDENT_TEXT_SIZE];
+	char firmwareRev[IDENT_TEXT_SIZE];
+};
 
 //!**** Function prototypes *****************************************************
 
@@ -46,6 +60,10 @@
 class IOLGenericDevice {
 public: 
 	IOLGenericDevice(IOLMasterPort * port);
+
+	void setCache(IOLDeviceCache * cache);
+
+	void setDataStorage(IOLDataStorage * dataStorage);
     
 	void begin();
 
@@ -71,9 +89,11 @@ public:
 
 	void readDI();
 
-	void writeSpecISDU();
+	uint8_t writeSpecISDU(uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t size);
+
+	uint8_t readSpecISDU(uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t *pSize);
 
-	void readSpecISDU();
+	uint8_t readCachedISDU(uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t *pSize);
 
 	void readDeviceAccessLocks();
 
@@ -83,48 +103,58 @@ public:
 
 	void readPDOutputDescriptor();
 
-	void readVendorName();
+	uint8_t readVendorName(char *pText, uint8_t size);
 
-	void readVendorText();
+	uint8_t readVendorText(char *pText, uint8_t size);
 
-	void readProductName();
+	uint8_t readProductName(char *pText, uint8_t size);
 
-	void readProductID();
+	uint8_t readProductID(char *pText, uint8_t size);
 
-	void readProductText();
+	uint8_t readProductText(char *pText, uint8_t size);
 
-	void readSerialNumber();
+	uint8_t readSerialNumber(char *pText, uint8_t size);
 
-	void readHardwareRev();
+	uint8_t readHardwareRev(char *pText, uint8_t size);
 
-	void readFirmwareRev();
+	uint8_t readFirmwareRev(char *pText, uint8_t size);
+
+	uint8_t readIdentification(IOLIdentification *pIdent);
 
 	void writeMasterCycleTime();
 
-	void readMasterCycleTime();
+	uint8_t readMasterCycleTime(uint8_t *pCycleTime);
 
-	void readMinCycleTime();
+	uint8_t readMinCycleTime(uint8_t *pCycleTime);
 
-	void readMSeqCapability();
+	uint8_t readMSeqCapability(uint8_t *pCapability);
 
-	void readRevID();
+	uint8_t readRevID(uint8_t *pRevID);
 
-	void readProcessDataIn();
+	uint8_t readProcessDataIn(uint8_t *pLength);
 
-	void readProcessDataOut();
+	uint8_t readProcessDataOut(uint8_t *pLength);
 
-	void readVendorID();
+	uint8_t readVendorID(uint16_t *pVendorID);
 
-	void readDeviceID();
+	uint8_t readDeviceID(uint32_t *pDeviceID);
     
-	void readFunctionID();
+	uint8_t readFunctionID(uint16_t *pFunctionID);
 protected: 
+	uint8_t readText(uint16_t index, char *pText, uint8_t size);
+
+	uint8_t openCache();
+
     uint16_t minCyclteTime;
     uint16_t deviceType;
     uint16_t diModeSupoort;
     uint16_t portType;
 	IOLMasterPort * port;
     uint16_t comSpeed;
+	IOLDeviceCache * pCache;
+	uint8_t cacheEntry;             // entry of the device, CACHE_NO_ENTRY if not opened
+	uint64_t cacheOperateTime;      // operate entry the entry was opened for
+	IOLDataStorage * pDataStorage;
 };
 
 #endif //_IOLGENERICDEVICE_H
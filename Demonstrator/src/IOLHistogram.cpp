@@ -0,0 +1,283 @@
+//!*****************************************************************************
+//!  \file      IOLHistogram.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Histogram of durations in microseconds with fixed memory,
+//!             recorded online by one producer and queried at any time.
+//!             The buckets are linear below 2^HIST_SUB_BITS and log-linear
+//!             above (HDR style): every power of two is split into
+//!             2^HIST_SUB_BITS buckets, a bucket is never wider than 1/16
+//!             of its value.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-31
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLHistogram.h"
+
+//!***** Macros *****************************************************************
+static_assert(HIST_RANGE_BITS < 32u, "HIST_RANGE_BITS must leave the sum of a value and a bucket width in 32 bit");
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLHistogram
+//!*****************************************************************************
+//!  \brief        Constructor, the histogram starts empty
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLHistogram::IOLHistogram()
+:count_(0),
+min_(UINT32_MAX),
+max_(0),
+sum_(0),
+overflows_(0)
+{
+    for (uint16_t i = 0; i < HIST_BUCKET_COUNT; i++) {
+        buckets_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+//!*****************************************************************************
+//!  function :    record
+//!*****************************************************************************
+//!  \brief        Count a value, only called by the producer. Never waits
+//!                and never allocates.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   value_us             duration in microseconds
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLHistogram::record(uint32_t value_us) {
+    if ((value_us >> HIST_RANGE_BITS) != 0) {
+        overflows_.fetch_add(1, std::memory_order_relaxed);
+    }
+    buckets_[bucketOf(value_us)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value_us, std::memory_order_relaxed);
+    // Single producer, a plain compare is enough
+    if (value_us < min_.load(std::memory_order_relaxed)) {
+        min_.store(value_us, std::memory_order_relaxed);
+    }
+    if (value_us > max_.load(std::memory_order_relaxed)) {
+        max_.store(value_us, std::memory_order_relaxed);
+    }
+    count_.fetch_add(1, std::memory_order_release);
+}
+
+//!*****************************************************************************
+//!  function :    readCount
+//!*****************************************************************************
+//!  \brief        Returns the number of recorded values
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       number of values
+//!
+//!*****************************************************************************
+uint32_t IOLHistogram::readCount() {
+    return count_.load(std::memory_order_acquire);
+}
+
+//!*****************************************************************************
+//!  function :    readMin
+//!*****************************************************************************
+//!  \brief        Returns the smallest recorded value
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       value in microseconds, 0 if empty
+//!
+//!*****************************************************************************
+uint32_t IOLHistogram::readMin() {
+    return (readCount() == 0) ? 0 : min_.load(std::memory_order_relaxed);
+}
+
+//!*****************************************************************************
+//!  function :    readMax
+//!*****************************************************************************
+//!  \brief        Returns the largest recorded value
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       value in microseconds, 0 if empty
+//!
+//!*****************************************************************************
+uint32_t IOLHistogram::readMax() {
+    return max_.load(std::memory_order_relaxed);
+}
+
+//!*****************************************************************************
+//!  function :    readMean
+//!*****************************************************************************
+//!  \brief        Returns the mean of the recorded values
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       value in microseconds, 0 if empty
+//!
+//!*****************************************************************************
+uint32_t IOLHistogram::readMean() {
+    uint32_t count = readCount();
+
+    if (count == 0) {
+        return 0;
+    }
+    return uint32_t(sum_.load(std::memory_order_relaxed) / count);
+}
+
+//!*****************************************************************************
+//!  function :    readPercentile
+//!*****************************************************************************
+//!  \brief        Returns the value not exceeded by the given part of the
+//!                recorded values, rounded up to the end of its bucket. The
+//!                producer may record meanwhile, the result is then off by
+//!                the values recorded during the walk at most.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   ppm                  part in parts per million, e.g.
+//!                                     990000 for the 99th percentile
+//!
+//!  \return       value in microseconds, 0 if empty
+//!
+//!*****************************************************************************
+uint32_t IOLHistogram::readPercentile(uint32_t ppm) {
+    uint32_t count = readCount();
+    uint32_t max = readMax();
+    uint64_t target;
+    uint64_t seen = 0;
+
+    if (count == 0) {
+        return 0;
+    }
+    if (ppm > HIST_PPM) {
+        ppm = HIST_PPM;
+    }
+    target = (uint64_t(count) * ppm + HIST_PPM - 1u) / HIST_PPM;
+    if (target == 0) {
+        target = 1;
+    }
+    for (uint16_t i = 0; i < HIST_BUCKET_COUNT; i++) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            uint32_t bound = upperBoundOf(i);
+            return (bound < max) ? bound : max;
+        }
+    }
+    return max;
+}
+
+//!*****************************************************************************
+//!  function :    readOverflowCount
+//!*****************************************************************************
+//!  \brief        Returns the values beyond 2^HIST_RANGE_BITS microseconds,
+//!                they are counted in the last bucket
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       number of values
+//!
+//!*****************************************************************************
+uint32_t IOLHistogram::readOverflowCount() {
+    return overflows_.load(std::memory_order_relaxed);
+}
+
+//!*****************************************************************************
+//!  function :    bucketOf
+//!*****************************************************************************
+//!  \brief        Index of the bucket of a value. Below HIST_SUB_COUNT every
+//!                value has its own bucket, above the HIST_SUB_BITS bits
+//!                following the most significant one select the bucket
+//!                within the power of two.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   value_us             duration in microseconds
+//!
+//!  \return       bucket index
+//!
+//!*****************************************************************************
+uint16_t IOLHistogram::bucketOf(uint32_t value_us) {
+    uint8_t msb = HIST_SUB_BITS;
+    uint8_t shift;
+
+    if (value_us < HIST_SUB_COUNT) {
+        return uint16_t(value_us);
+    }
+    if ((value_us >> HIST_RANGE_BITS) != 0) {
+        return uint16_t(HIST_BUCKET_COUNT - 1u);
+    }
+    while ((value_us >> (msb + 1u)) != 0) {
+        msb++;
+    }
+    shift = uint8_t(msb - HIST_SUB_BITS);
+    return uint16_t(HIST_SUB_COUNT + shift * HIST_SUB_COUNT + ((value_us >> shift) - HIST_SUB_COUNT));
+}
+
+//!*****************************************************************************
+//!  function :    upperBoundOf
+//!*****************************************************************************
+//!  \brief        Largest value counted in a bucket
+//!
+//!  \type         local
+//!
+//!  \param[in]	   bucket               bucket index
+//!
+//!  \return       value in microseconds
+//!
+//!*****************************************************************************
+uint32_t IOLHistogram::upperBoundOf(uint16_t bucket) {
+    uint8_t shift;
+    uint32_t sub;
+
+    if (bucket < HIST_SUB_COUNT) {
+        return bucket;
+    }
+    shift = uint8_t((bucket - HIST_SUB_COUNT) / HIST_SUB_COUNT);
+    sub = uint32_t((bucket - HIST_SUB_COUNT) % HIST_SUB_COUNT);
+    return ((HIST_SUB_COUNT + sub) << shift) + (1ul << shift) - 1u;
+}
@@ -0,0 +1,88 @@
+//!*****************************************************************************
+//!  \file      IOLHistogram.h
+//!*****************************************************************************
+//!
+//!  \brief		Histogram of durations in microseconds with fixed memory,
+//!             recorded online by one producer and queried at any time.
+//!             The buckets are linear below 2^HIST_SUB_BITS and log-linear
+//!             above (HDR style): every power of two is split into
+//!             2^HIST_SUB_BITS buckets, a bucket is never wider than 1/16
+//!             of its value.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-31
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLHISTOGRAM_H_INCLUDED
+#define IOLHISTOGRAM_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include <atomic>
+#include <cstdint>
+//!***** Macros *****************************************************************
+constexpr uint8_t HIST_SUB_BITS         = 4u;       // buckets per power of two: 2^HIST_SUB_BITS
+constexpr uint8_t HIST_RANGE_BITS       = 24u;      // values up to 2^24 us (16.7s), larger ones go to the last bucket
+constexpr uint16_t HIST_SUB_COUNT       = 1u << HIST_SUB_BITS;
+constexpr uint16_t HIST_BUCKET_COUNT    = (HIST_RANGE_BITS - HIST_SUB_BITS + 1u) * HIST_SUB_COUNT;
+constexpr uint32_t HIST_PPM             = 1000000u; // readPercentile of the largest value
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+class IOLHistogram {
+public:
+    IOLHistogram();
+
+    void record(uint32_t value_us);
+
+    uint32_t readCount();
+
+    uint32_t readMin();
+
+    uint32_t readMax();
+
+    uint32_t readMean();
+
+    uint32_t readPercentile(uint32_t ppm);
+
+    uint32_t readOverflowCount();
+
+private:
+    std::atomic<uint32_t> buckets_[HIST_BUCKET_COUNT];
+    std::atomic<uint32_t> count_;
+    std::atomic<uint32_t> min_;
+    std::atomic<uint32_t> max_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint32_t> overflows_;   // values beyond the range, counted in the last bucket
+
+    static uint16_t bucketOf(uint32_t value_us);
+    static uint32_t upperBoundOf(uint16_t bucket);
+
+    // Not copyable, the consumers refer to the histogram
+    IOLHistogram(IOLHistogram const &);
+    IOLHistogram & operator=(IOLHistogram const &);
+};
+
+#endif //IOLHISTOGRAM_H_INCLUDED
@@ -0,0 +1,440 @@
+//!*****************************************************************************
+//!  \file      IOLIsdu.cpp
+//!*****************************************************************************
+//!
+//!  \brief		ISDU engine of the master. Frames the index service data
+//!             units (I-Service, length, index, data and CHKPDU), splits
+//!             them into the on-request data octets of the M-sequences and
+//!             reassembles the response. The engine is advanced one
+//!             M-sequence at a time, the transport is up to the port.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-16
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLIsdu.h"
+
+//!***** Macros *****************************************************************
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLIsdu
+//!*****************************************************************************
+//!  \brief        Constructor, the engine starts idle with an empty queue
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLIsdu::IOLIsdu()
+:queueHead_(0),
+queueCount_(0),
+pActive_(nullptr),
+state_(ISDU_IDLE),
+header_(),
+sizeHeader_(0),
+sizeIsdu_(0),
+position_(0),
+flowCount_(0),
+checksum_(0),
+service_(0),
+odSize_(0),
+isOverrun_(0),
+deadline_ns_(0)
+{
+    for (uint8_t i = 0; i < ISDU_QUEUE_SIZE; i++) {
+        queue_[i] = nullptr;
+    }
+}
+
+//!*****************************************************************************
+//!  function :    reset
+//!*****************************************************************************
+//!  \brief        Drop the running and all queued requests, they end with
+//!                ERROR. Used when the communication to the device is lost.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLIsdu::reset() {
+    if (pActive_ != nullptr) {
+        pActive_->status = ERROR;
+        pActive_ = nullptr;
+    }
+    while (queueCount_ != 0) {
+        queue_[queueHead_]->status = ERROR;
+        queueHead_ = uint8_t((queueHead_ + 1) % ISDU_QUEUE_SIZE);
+        queueCount_--;
+    }
+    state_ = ISDU_IDLE;
+}
+
+//!*****************************************************************************
+//!  function :    queue
+//!*****************************************************************************
+//!  \brief        Queue a request. Queued requests are transferred back to
+//!                back, the next one starts in the M-sequence after the last
+//!                response octet.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pRequest            request, must live until it is done
+//!
+//!  \return       0 if queued, 1 if the queue is full or the request invalid
+//!
+//!*****************************************************************************
+uint8_t IOLIsdu::queue(Request *pRequest) {
+    if ((queueCount_ >= ISDU_QUEUE_SIZE) || (pRequest == nullptr)
+            || ((pRequest->isWrite != 0) && (pRequest->size > IOL::ISDU::MAX_DATA_SIZE))) {
+        return ERROR;
+    }
+    pRequest->status = PENDING;
+    pRequest->errorCode = 0;
+    queue_[(queueHead_ + queueCount_) % ISDU_QUEUE_SIZE] = pRequest;
+    queueCount_++;
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    isBusy
+//!*****************************************************************************
+//!  \brief        Returns if the engine needs the on-request channel
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       1 if a transfer runs or a request is queued
+//!
+//!*****************************************************************************
+uint8_t IOLIsdu::isBusy() {
+    return ((state_ != ISDU_IDLE) || (queueCount_ != 0)) ? 1 : 0;
+}
+
+//!*****************************************************************************
+//!  function :    nextMessage
+//!*****************************************************************************
+//!  \brief        Master command and OD octets of the next M-sequence. The
+//!                engine only advances with handleAnswer, so a message
+//!                without answer is simply built and sent again.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   time_ns              current time (see get_time_ns)
+//!  \param[in]	   odSize               OD octets of the M-sequence
+//!  \param[out]   *pOd                 OD octets for the write direction
+//!
+//!  \return       master command, bit 7 set for the read direction
+//!
+//!*****************************************************************************
+uint8_t IOLIsdu::nextMessage(uint64_t time_ns, uint8_t odSize, uint8_t *pOd) {
+    odSize_ = odSize;
+
+    if ((state_ == ISDU_IDLE) && (queueCount_ != 0)) {
+        startRequest(time_ns);
+    }
+    if (((state_ == ISDU_REQUEST) || (state_ == ISDU_WAIT) || (state_ == ISDU_RESPONSE)) && (time_ns > deadline_ns_)) {
+        finish(ERROR);
+        state_ = ISDU_ABORT;
+    }
+
+    switch (state_) {
+    case ISDU_REQUEST:
+        for (uint8_t i = 0; i < odSize; i++) {
+            pOd[i] = requestOctet(uint8_t(position_ + i));
+        }
+        return uint8_t(IOL::MC::ISDU_WRITE | ((position_ == 0) ? IOL::ISDU::FLOW_START : (flowCount_ & IOL::ISDU::FLOW_COUNT)));
+    case ISDU_WAIT:
+        return uint8_t(IOL::MC::ISDU_READ | IOL::ISDU::FLOW_START);
+    case ISDU_RESPONSE:
+        return uint8_t(IOL::MC::ISDU_READ | (flowCount_ & IOL::ISDU::FLOW_COUNT));
+    case ISDU_ABORT:
+        return uint8_t(IOL::MC::ISDU_READ | IOL::ISDU::FLOW_ABORT);
+    default:
+        return uint8_t(IOL::MC::ISDU_READ | IOL::ISDU::FLOW_IDLE_1);
+    }
+}
+
+//!*****************************************************************************
+//!  function :    handleAnswer
+//!*****************************************************************************
+//!  \brief        The device answered the message of nextMessage. In the
+//!                read direction the answer starts with the OD octets.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pOd                 OD octets of the answer, not used in
+//!                                     the write direction
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLIsdu::handleAnswer(uint8_t const *pOd) {
+    switch (state_) {
+    case ISDU_REQUEST:
+        position_ = uint8_t(position_ + odSize_);
+        flowCount_++;
+        if (position_ >= sizeIsdu_) {
+            state_ = ISDU_WAIT;
+        }
+        break;
+
+    case ISDU_WAIT:
+        if (pOd[0] == IOL::ISDU::BUSY) {
+            break;
+        }
+        if (pOd[0] == IOL::ISDU::NO_SERVICE) {
+            // The device dropped the request
+            finish(ERROR);
+            break;
+        }
+        position_ = 0;
+        sizeIsdu_ = 0;
+        checksum_ = 0;
+        flowCount_ = 1;
+        state_ = ISDU_RESPONSE;
+        for (uint8_t i = 0; (i < odSize_) && (state_ == ISDU_RESPONSE); i++) {
+            receiveOctet(pOd[i]);
+        }
+        break;
+
+    case ISDU_RESPONSE:
+        flowCount_++;
+        for (uint8_t i = 0; (i < odSize_) && (state_ == ISDU_RESPONSE); i++) {
+            receiveOctet(pOd[i]);
+        }
+        break;
+
+    default:
+        // IDLE or ABORT sent, the next request may start
+        state_ = ISDU_IDLE;
+        break;
+    }
+}
+
+//!*****************************************************************************
+//!  function :    startRequest
+//!*****************************************************************************
+//!  \brief        Take the next request from the queue and frame it. The
+//!                I-Service is chosen by the size of the index and subindex,
+//!                a length above 15 octets goes into ExtLength.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   time_ns              current time (see get_time_ns)
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLIsdu::startRequest(uint64_t time_ns) {
+    uint8_t service;
+    uint8_t sizeIndex;
+    uint8_t sizeData;
+
+    pActive_ = queue_[queueHead_];
+    queueHead_ = uint8_t((queueHead_ + 1) % ISDU_QUEUE_SIZE);
+    queueCount_--;
+
+    if (pActive_->index > 0xFFu) {
+        service = (pActive_->isWrite != 0) ? IOL::ISDU::WRITE_16_SUB : IOL::ISDU::READ_16_SUB;
+        sizeIndex = 3;
+    }
+    else if (pActive_->subindex != 0) {
+        service = (pActive_->isWrite != 0) ? IOL::ISDU::WRITE_8_SUB : IOL::ISDU::READ_8_SUB;
+        sizeIndex = 2;
+    }
+    else {
+        service = (pActive_->isWrite != 0) ? IOL::ISDU::WRITE_8 : IOL::ISDU::READ_8;
+        sizeIndex = 1;
+    }
+    sizeData = (pActive_->isWrite != 0) ? pActive_->size : 0;
+
+    // I-Service and length, the CHKPDU is the last octet
+    sizeIsdu_ = uint8_t(1 + sizeIndex + sizeData + 1);
+    sizeHeader_ = 0;
+    if (sizeIsdu_ > IOL::ISDU::LENGTH) {
+        sizeIsdu_++;
+        header_[sizeHeader_++] = uint8_t((service << 4) | IOL::ISDU::LENGTH_EXT);
+        header_[sizeHeader_++] = sizeIsdu_;
+    }
+    else {
+        header_[sizeHeader_++] = uint8_t((service << 4) | sizeIsdu_);
+    }
+    if (sizeIndex == 3) {
+        header_[sizeHeader_++] = uint8_t(pActive_->index >> 8);
+    }
+    header_[sizeHeader_++] = uint8_t(pActive_->index);
+    if (sizeIndex != 1) {
+        header_[sizeHeader_++] = pActive_->subindex;
+    }
+
+    // CHKPDU: XOR of all octets is zero
+    checksum_ = 0;
+    for (uint8_t i = 0; i < sizeHeader_; i++) {
+        checksum_ ^= header_[i];
+    }
+    for (uint8_t i = 0; i < sizeData; i++) {
+        checksum_ ^= pActive_->pData[i];
+    }
+
+    position_ = 0;
+    flowCount_ = 1;
+    isOverrun_ = 0;
+    deadline_ns_ = time_ns + ISDU_TIMEOUT_NS;
+    state_ = ISDU_REQUEST;
+}
+
+//!*****************************************************************************
+//!  function :    requestOctet
+//!*****************************************************************************
+//!  \brief        Octet of the running request, zero after its end
+//!
+//!  \type         local
+//!
+//!  \param[in]	   position             octet number within the ISDU
+//!
+//!  \return       octet
+//!
+//!*****************************************************************************
+uint8_t IOLIsdu::requestOctet(uint8_t position) {
+    if (position < sizeHeader_) {
+        return header_[position];
+    }
+    if (position < sizeIsdu_ - 1) {
+        return pActive_->pData[position - sizeHeader_];
+    }
+    if (position == sizeIsdu_ - 1) {
+        return checksum_;
+    }
+    return 0;
+}
+
+//!*****************************************************************************
+//!  function :    receiveOctet
+//!*****************************************************************************
+//!  \brief        Store one octet of the response. The length is known after
+//!                the first (or with ExtLength the second) octet, the
+//!                request is done with the CHKPDU.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   octet                received octet
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLIsdu::receiveOctet(uint8_t octet) {
+    checksum_ ^= octet;
+
+    if (position_ == 0) {
+        service_ = uint8_t(octet >> 4);
+        sizeIsdu_ = uint8_t(octet & IOL::ISDU::LENGTH);
+        sizeHeader_ = 1;
+        if (sizeIsdu_ == IOL::ISDU::LENGTH_EXT) {
+            sizeHeader_ = 2;
+            sizeIsdu_ = 3;      // at least I-Service, ExtLength and CHKPDU
+        }
+        else if (sizeIsdu_ < 2) {
+            finish(ERROR);
+            return;
+        }
+    }
+    else if ((position_ == 1) && (sizeHeader_ == 2)) {
+        if (octet < 3) {
+            finish(ERROR);
+            return;
+        }
+        sizeIsdu_ = octet;
+    }
+    else if (position_ < sizeIsdu_ - 1) {
+        // Data octet: read value or ErrorCode and AdditionalCode
+        uint8_t dataPosition = uint8_t(position_ - sizeHeader_);
+        if ((service_ == IOL::ISDU::READ_NEG) || (service_ == IOL::ISDU::WRITE_NEG)) {
+            if (dataPosition < 2) {
+                pActive_->errorCode = uint16_t(pActive_->errorCode | (octet << ((dataPosition == 0) ? 8 : 0)));
+            }
+        }
+        else if (service_ == IOL::ISDU::READ_POS) {
+            if ((pActive_->isWrite == 0) && (dataPosition < pActive_->size)) {
+                pActive_->pData[dataPosition] = octet;
+            }
+            else {
+                isOverrun_ = 1;
+            }
+        }
+    }
+    position_++;
+
+    if (position_ < sizeIsdu_) {
+        return;
+    }
+
+    // Complete, check CHKPDU and the I-Service
+    if (checksum_ != 0) {
+        finish(ERROR);
+    }
+    else if (pActive_->isWrite != 0) {
+        finish((service_ == IOL::ISDU::WRITE_POS) ? SUCCESS : ERROR);
+    }
+    else if ((service_ == IOL::ISDU::READ_POS) && (isOverrun_ == 0)) {
+        pActive_->size = uint8_t(sizeIsdu_ - sizeHeader_ - 1);
+        finish(SUCCESS);
+    }
+    else {
+        finish(ERROR);
+    }
+}
+
+//!*****************************************************************************
+//!  function :    finish
+//!*****************************************************************************
+//!  \brief        End the running request. The next queued request starts
+//!                right away, after the last one the engine sends IDLE.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   status               SUCCESS or ERROR
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLIsdu::finish(uint8_t status) {
+    if (pActive_ != nullptr) {
+        pActive_->status = status;
+        pActive_ = nullptr;
+    }
+    state_ = (queueCount_ != 0) ? ISDU_IDLE : ISDU_END;
+}
@@ -0,0 +1,108 @@
+//!*****************************************************************************
+//!  \file      IOLIsdu.h
+//!*****************************************************************************
+//!
+//!  \brief		ISDU engine of the master. Frames the index service data
+//!             units (I-Service, length, index, data and CHKPDU), splits
+//!             them into the on-request data octets of the M-sequences and
+//!             reassembles the response. The engine is advanced one
+//!             M-sequence at a time, the transport is up to the port.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-16
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLISDU_H_INCLUDED
+#define IOLISDU_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include "IOLink.h"
+
+#include <cstdint>
+//!***** Macros *****************************************************************
+constexpr uint8_t ISDU_QUEUE_SIZE   = 16u;              // requests queued at once
+constexpr uint64_t ISDU_TIMEOUT_NS  = 5000000000ull;    // worst case until the response
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+class IOLIsdu {
+public:
+    // One read or write of an index, owned by the caller until it is done
+    struct Request {
+        uint16_t index;
+        uint8_t subindex;
+        uint8_t isWrite;
+        uint8_t *pData;         // value to write, or buffer for the read value
+        uint8_t size;           // size of the value or the buffer, read size when done
+        uint8_t status;         // PENDING while queued, then SUCCESS or ERROR
+        uint16_t errorCode;     // ErrorCode and AdditionalCode of a negative response
+    };
+
+    IOLIsdu();
+
+    void reset();
+
+    uint8_t queue(Request *pRequest);
+
+    uint8_t isBusy();
+
+    uint8_t nextMessage(uint64_t time_ns, uint8_t odSize, uint8_t *pOd);
+
+    void handleAnswer(uint8_t const *pOd);
+
+private:
+    enum State {
+        ISDU_IDLE,              // no transfer, the next queued request starts
+        ISDU_REQUEST,           // sending the request octets
+        ISDU_WAIT,              // polling with START until the device is not busy
+        ISDU_RESPONSE,          // receiving the response octets
+        ISDU_END,               // sending IDLE after the last request
+        ISDU_ABORT              // sending ABORT after a timeout
+    };
+
+    Request *queue_[ISDU_QUEUE_SIZE];
+    uint8_t queueHead_;
+    uint8_t queueCount_;
+    Request *pActive_;
+    State state_;
+    uint8_t header_[4];         // I-Service, length, index and subindex of the request
+    uint8_t sizeHeader_;
+    uint8_t sizeIsdu_;          // octets of the request or response including CHKPDU
+    uint8_t position_;          // next octet of the request or response
+    uint8_t flowCount_;         // COUNT of the next segment
+    uint8_t checksum_;          // CHKPDU of the request, XOR of the received octets
+    uint8_t service_;           // I-Service of the response
+    uint8_t odSize_;            // OD octets of the last message
+    uint8_t isOverrun_;         // read value did not fit into the buffer
+    uint64_t deadline_ns_;
+
+    void startRequest(uint64_t time_ns);
+    uint8_t requestOctet(uint8_t position);
+    void receiveOctet(uint8_t octet);
+    void finish(uint8_t status);
+};
+
+#endif //IOLISDU_H_INCLUDED
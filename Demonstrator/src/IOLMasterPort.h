@@ -33,11 +33,26 @@
 
 //!***** Header-Files ***********************************************************
 #include "Max14819.h"
+#include "IOLIsdu.h"
+#include "IOLPDRing.h"
+#include "IOLPDTiming.h"
 
 #include <cstdint>
 //!***** Macros *****************************************************************
 
 //!***** Data types *************************************************************
+// States of the port state machine, see portHandler
+enum PortState {
+    PORT_INACTIVE,      // not started or stopped with end
+    PORT_POWER_OFF,     // L+ switched off to restart the device
+    PORT_BOOTUP,        // L+ switched on, device is booting
+    PORT_WAKEUP,        // wakeup request and communication establishing
+    PORT_STARTUP,       // identification with the direct parameter page
+    PORT_PREOPERATE,    // device switched to preoperate
+    PORT_OPERATE,       // cyclic process data exchange
+    PORT_FALLBACK       // communication lost, port gets restarted
+};
+constexpr uint8_t PORT_STATE_COUNT = PORT_FALLBACK + 1;
 
 //!***** Function prototypes ****************************************************
 
@@ -63,8 +78,18 @@ public:
 
     virtual uint8_t end() = 0;
 
+    virtual uint8_t start() = 0;
+
+    virtual uint8_t resume() = 0;
+
     virtual void portHandler() = 0;
 
+    virtual PortState readPortState() = 0;
+
+    virtual uint64_t readStateTime(PortState state) = 0;
+
+    virtual uint8_t readPDIn(uint8_t *pData, uint8_t sizeData) = 0;
+
     virtual void readStatus() = 0;
 
     virtual void sendMCmd() = 0;
@@ -75,16 +100,34 @@ public:
 
     virtual void writePage() = 0;
 
-    virtual void readISDU() = 0;
+    virtual uint8_t readISDU(uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t *pSize) = 0;
+
+    virtual uint8_t writeISDU(uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t size) = 0;
+
+    virtual uint8_t queueISDU(IOLIsdu::Request *pRequest) = 0;
 
-    virtual void writeISDU() = 0;
+    virtual uint8_t transferISDU(IOLIsdu::Request *pRequests, uint8_t count) = 0;
+
+    virtual uint8_t readEvent(IOL::Event *pEvent) = 0;
 
 	virtual uint8_t readDirectParameterPage(uint8_t address, uint8_t *pData) = 0;
 
+	virtual uint8_t readDirectParameterPage1(IOL::DirectParameterPage1 *pPage) = 0;
+
     virtual uint8_t readPD(uint8_t *pData, uint8_t sizeData) = 0;
 
+    virtual void setPDRing(IOLPDRing *pRing) = 0;
+
+    virtual void setPDTiming(IOLPDTiming *pTiming) = 0;
+
+    virtual void readPDTime(uint64_t *pSend_ns, uint64_t *pRx_ns) = 0;
+
     virtual uint8_t writePD(uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType) = 0;
 
+    virtual uint8_t enableCyclicPD(uint8_t sizeData, uint8_t cycleTime) = 0;
+
+    virtual uint8_t disableCyclicPD() = 0;
+
     virtual void readDI() = 0;
 
     virtual void readCQ() = 0;
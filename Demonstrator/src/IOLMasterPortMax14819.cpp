@@ -40,8 +40,38 @@
 #endif	
 
 //!***** Macros ******************************************************************
+constexpr uint32_t DIRECT_PARAMETER_TIMEOUT_US = 2000u;    // Worst case time for a TYPE_0 answer
+constexpr uint32_t PD_TIMEOUT_US               = 10000u;   // Worst case time for a TYPE_2_X answer
+constexpr uint32_t MIN_CYCLE_TIME_US           = 400u;     // Shortest cycle time of an IO-Link port
+constexpr uint32_t UART_FRAME_BITS             = 11u;      // Start, 8 data, parity and stop bit of an octet
+constexpr uint32_t RESPONSE_DELAY_BITS         = 10u;      // Longest response time of the device in bit times
+constexpr uint32_t PORT_POLL_US                = 100u;     // Poll interval of begin while the state machine runs
+constexpr uint8_t MAX_COM_ERRORS               = 3u;       // Consecutive errors before the port falls back
+constexpr uint8_t RESUME_PROBE_TRIES           = 2u;       // PD exchanges to verify a resumed device
+constexpr uint8_t OD_MESSAGE_ISDU              = 1u;       // odMessage_: the OD carries ISDU octets
+constexpr uint8_t OD_MESSAGE_EVENT             = 2u;       // odMessage_: the OD reads the event memory
+
+// Reads of the direct parameter page 1, the frames are built at compile time.
+// MasterCommand and SystemCommand are write only, 0x0E is reserved.
+constexpr IOL::MSequence PAGE1_FRAMES[] = {
+    IOL::pageRead(IOL::PAGE::MAS_CYCLE_TIME), IOL::pageRead(IOL::PAGE::MIN_CYCLE_TIME),
+    IOL::pageRead(IOL::PAGE::M_SEQ_CAP), IOL::pageRead(IOL::PAGE::REVISION_ID),
+    IOL::pageRead(IOL::PAGE::PD_IN), IOL::pageRead(IOL::PAGE::PD_OUT),
+    IOL::pageRead(IOL::PAGE::VENDOR_ID1), IOL::pageRead(IOL::PAGE::VENDOR_ID2),
+    IOL::pageRead(IOL::PAGE::DEVICE_ID1), IOL::pageRead(IOL::PAGE::DEVICE_ID2), IOL::pageRead(IOL::PAGE::DEVICE_ID3),
+    IOL::pageRead(IOL::PAGE::FUNCTION_ID1), IOL::pageRead(IOL::PAGE::FUNCTION_ID2)
+};
+constexpr uint8_t PAGE1_FRAME_COUNT = uint8_t(sizeof(PAGE1_FRAMES) / sizeof(PAGE1_FRAMES[0]));
 
 //!***** Data types **************************************************************
+// Port state kept in non-volatile storage for resume, see saveState
+struct WarmState {
+    uint8_t version;                    // WARM_STATE_VERSION, 0 if invalid
+    uint8_t revID;                      // RevID of the max14819
+    uint8_t comSpeedReg;                // ComRt bits of CQCtrlA/B
+    uint8_t directParameterPage[16];    // identification of the device
+};
+constexpr uint8_t WARM_STATE_VERSION = 1u;
 
 //!***** Function prototypes *****************************************************
 
@@ -69,8 +99,49 @@ diModeSupport_(0),
 portMode_(0),
 portStatus_(0),
 actualCycleTime_(0),
-comSpeed_(0)
+comSpeed_(0),
+minCycleTime_(0),
+cyclicSizeData_(0),
+trigger_(max14819::TRIGGER_NONE),
+state_(PORT_INACTIVE),
+step_(0),
+errorCount_(0),
+requestPending_(0),
+requestSize_(0),
+requestKind_(REQUEST_NONE),
+burstRemaining_(0),
+requestTimeout_us_(0),
+deadline_ns_(0),
+nextCycle_ns_(0),
+stateTime_ns_(),
+page1_(),
+isPage1Valid_(0),
+pdInSize_(0),
+odSize_(0),
+mSeqType_(IOL::M_TYPE_0),
+pdOutSize_(0),
+pdOut_(),
+pdWriteFrame_(IOL::pdRead(0)),
+pdWrite_(),
+pdWritePending_(0),
+isdu_(),
+events_(),
+cyclicFrame_(IOL::pdRead(0)),
+odMessage_(0),
+odIsRead_(0),
+odAnswerSize_(0),
+pdInCount_(0),
+pdReadFrame_(IOL::pdRead(0)),
+pdInLength_(0),
+pdInValid_(0),
+pPDRing_(nullptr),
+pPDTiming_(nullptr),
+pdInSend_ns_(0),
+pdInRx_ns_(0)
 {
+    for (uint8_t i = 0; i < sizeof(directParameterPage_); i++) {
+        directParameterPage_[i] = 0;
+    }
 
 }
 
@@ -94,8 +165,49 @@ IOLMasterPortMax14819::IOLMasterPortMax14819(max14819::Max14819* pDriver, max148
  portMode_(0),
  portStatus_(0),
  actualCycleTime_(0),
- comSpeed_(0)
+ comSpeed_(0),
+ minCycleTime_(0),
+ cyclicSizeData_(0),
+ trigger_(max14819::TRIGGER_NONE),
+ state_(PORT_INACTIVE),
+ step_(0),
+ errorCount_(0),
+ requestPending_(0),
+ requestSize_(0),
+ requestKind_(REQUEST_NONE),
+ burstRemaining_(0),
+ requestTimeout_us_(0),
+ deadline_ns_(0),
+ nextCycle_ns_(0),
+ stateTime_ns_(),
+ page1_(),
+ isPage1Valid_(0),
+ pdInSize_(0),
+ odSize_(0),
+ mSeqType_(IOL::M_TYPE_0),
+ pdOutSize_(0),
+ pdOut_(),
+ pdWriteFrame_(IOL::pdRead(0)),
+ pdWrite_(),
+ pdWritePending_(0),
+ isdu_(),
+ events_(),
+ cyclicFrame_(IOL::pdRead(0)),
+ odMessage_(0),
+ odIsRead_(0),
+ odAnswerSize_(0),
+ pdInCount_(0),
+ pdReadFrame_(IOL::pdRead(0)),
+ pdInLength_(0),
+ pdInValid_(0),
+ pPDRing_(nullptr),
+ pPDTiming_(nullptr),
+ pdInSend_ns_(0),
+ pdInRx_ns_(0)
 {
+    for (uint8_t i = 0; i < sizeof(directParameterPage_); i++) {
+        directParameterPage_[i] = 0;
+    }
 
 }
 //!*******************************************************************************
@@ -116,6 +228,8 @@ IOLMasterPortMax14819::~IOLMasterPortMax14819() {
 //!  function :    begin
 //!*******************************************************************************
 //!  \brief        Initialize port and connect to io-link device if attached.
+//!                Runs the state machine of portHandler until the device is
+//!                in operate or the startup failed.
 //!
 //!  \type         local
 //!
@@ -125,53 +239,206 @@ IOLMasterPortMax14819::~IOLMasterPortMax14819() {
 //!
 //!*******************************************************************************
 uint8_t IOLMasterPortMax14819::begin() {
-	char buf[256];
-    uint8_t retValue = SUCCESS;
+    max14819::ChipLock lock(pDriver_);
+    if (start() == ERROR) {
+        return ERROR;
+    }
+    while ((state_ != PORT_OPERATE) && (state_ != PORT_FALLBACK) && (state_ != PORT_INACTIVE)) {
+        portHandler();
+        pDriver_->sleepUntil(pDriver_->get_time_ns() + PORT_POLL_US * max14819::NS_PER_US);
+    }
+    return (state_ == PORT_OPERATE) ? SUCCESS : ERROR;
+}
 
-    // Initialize drivers
-    if( pDriver_->begin(port_) == ERROR){
-        retValue = ERROR;
-        // TODO: Serial.println("Error initialize driver01 PortA");
-    }
-    pDriver_->Serial_Write("WakeUp");
-    // Generate wakeup
-    retValue = uint8_t(retValue | pDriver_->wakeUpRequest(port_, &comSpeed_ ));
-   if(retValue == ERROR){
-       // TODO: Serial.println("Error wakeup driver01 PortA");
-   }
-   else{
-       sprintf(buf, "Communication established with %d bauds\n", comSpeed_);// TODO:
-       pDriver_->Serial_Write(buf);
-       // TODO: Serial.print("Communication established with ");
-       // TODO: Serial.print(comSpeed_);
-       // TODO: Serial.print(" Baud/s \n");
-   }
-    pDriver_->Serial_Write("Device");
-   uint8_t pData[3];
-   uint16_t VendorID;
-   uint32_t DeviceID;
-   readDirectParameterPage(0x02, pData);
-
-   // VendorID
-   readDirectParameterPage(0x07, pData); //MSB
-   readDirectParameterPage(0x08, pData+1); //LSB
-   VendorID = uint16_t((pData[0] << 8) + pData[1]);
-   // DeviceID
-   readDirectParameterPage(0x09, pData); //MSB
-   readDirectParameterPage(0x0A, pData+1);
-   readDirectParameterPage(0x0B, pData+2); //LSB
-   DeviceID = (pData[0] << 16) + (pData[1] << 8) + pData[2];
-   sprintf(buf, "Vendor ID: %d, Device ID: %d\n", VendorID, DeviceID);
-   pDriver_->Serial_Write(buf);
-
-    // Switch to operational
-
-   uint8_t value[1] = {IOL::MC::DEV_OPERATE};
-    if(pDriver_->writeData(IOL::MC::WRITE, 1, value , 1, IOL::M_TYPE_0, port_) == ERROR){
-        sprintf(buf, "Error operate driver01 PortA");// TODO: 
-		pDriver_->Serial_Write(buf);
+//!*******************************************************************************
+//!  function :    start
+//!*******************************************************************************
+//!  \brief        Switch off L+ and start the state machine of portHandler.
+//!                Returns immediately, the device gets powered, woken up and
+//!                switched to operate by the following portHandler calls.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::start() {
+    max14819::ChipLock lock(pDriver_);
+    // The port reset also stops the cycle timer and the trigger
+    clearMessages();
+
+    // The device is power cycled, a saved state is useless from now on
+    saveState(0);
+
+    if (pDriver_->initPort(port_) == ERROR) {
+        enterState(PORT_INACTIVE);
+        return ERROR;
     }
-    return retValue;
+    deadline_ns_ = pDriver_->get_time_ns() + max14819::INIT_POWER_OFF_DELAY * max14819::NS_PER_MS;
+    enterState(PORT_POWER_OFF);
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    resume
+//!*******************************************************************************
+//!  \brief        Warm restart: take over a device which a previous run of the
+//!                master left in operate, instead of power cycling it. The
+//!                saved port state must match the chip (RevID, ComRt bits)
+//!                and the device must answer a process data request. A
+//!                replaced device has been powered off and waits for a wakeup,
+//!                so it fails the probe.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       0 if the port is in operate, 1 if it needs start()
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::resume() {
+    max14819::ChipLock lock(pDriver_);
+    WarmState warm;
+    char name[16];
+    uint8_t answer[IOL::ANSWER_MAX_SIZE];
+    uint8_t retValue = ERROR;
+
+    clearMessages();
+    enterState(PORT_INACTIVE);
+
+    sprintf(name, "port%d", (pDriver_->readDriver() == max14819::DRIVER01) ? port_ : port_ + 2);
+    if ((pDriver_->getHardware()->NV_Read(name, reinterpret_cast<uint8_t *>(&warm), sizeof(warm)) != 0)
+            || (warm.version != WARM_STATE_VERSION)) {
+        return ERROR;
+    }
+    if (pDriver_->resumePort(port_, warm.revID, warm.comSpeedReg) == ERROR) {
+        return ERROR;
+    }
+
+    for (uint8_t i = 0; i < sizeof(directParameterPage_); i++) {
+        directParameterPage_[i] = warm.directParameterPage[i];
+    }
+    decodePage1();
+    switch (warm.comSpeedReg) {
+    case max14819::ComRt0:
+        comSpeed_ = 4800;
+        break;
+    case max14819::ComRt1:
+        comSpeed_ = 38400;
+        break;
+    default:
+        comSpeed_ = 230400;
+        break;
+    }
+
+    // Probe the device with a process data exchange, a device without
+    // process data answers the minimum cycle time page
+    for (uint8_t i = 0; (i < RESUME_PROBE_TRIES) && (retValue == ERROR); i++) {
+        if (pdInSize_ != 0) {
+            if ((sendRequest(pdReadFrame_, nullptr, PD_TIMEOUT_US, REQUEST_DIRECT) == SUCCESS)
+                    && (awaitAnswer(answer) == SUCCESS)) {
+                retValue = storePDIn(answer, pdInSize_);
+            }
+        }
+        else if ((readDirectParameterPage(IOL::PAGE::MIN_CYCLE_TIME, answer) == SUCCESS) && (answer[0] == minCycleTime_)) {
+            retValue = SUCCESS;
+        }
+    }
+    if (retValue == ERROR) {
+        return ERROR;
+    }
+
+    isPage1Valid_ = 1;
+    nextCycle_ns_ = pDriver_->get_time_ns();
+    enterState(PORT_OPERATE);
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    clearMessages
+//!*******************************************************************************
+//!  \brief        Forget every message of the port, queued or waiting for its
+//!                answer, and the data of the last device. Used when the port
+//!                is restarted or taken over.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::clearMessages() {
+    cyclicSizeData_ = 0;
+    trigger_ = max14819::TRIGGER_NONE;
+    requestPending_ = 0;
+    requestKind_ = REQUEST_NONE;
+    burstRemaining_ = 0;
+    errorCount_ = 0;
+    pdInLength_ = 0;
+    isPage1Valid_ = 0;
+    isdu_.reset();
+    events_.reset();
+    odMessage_ = 0;
+    pdWritePending_ = 0;
+    pdWriteFrame_ = IOL::pdRead(0);
+    step_ = 0;
+}
+
+//!*******************************************************************************
+//!  function :    saveState
+//!*******************************************************************************
+//!  \brief        Save the port state for resume, or invalidate it when the
+//!                device leaves operate. The block is only written if it
+//!                changes, a restart of an invalid port costs a read.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   valid                1 to save, 0 to invalidate
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::saveState(uint8_t valid) {
+    WarmState warm;
+    WarmState stored;
+    char name[16];
+    uint8_t isStored;
+
+    sprintf(name, "port%d", (pDriver_->readDriver() == max14819::DRIVER01) ? port_ : port_ + 2);
+    isStored = (pDriver_->getHardware()->NV_Read(name, reinterpret_cast<uint8_t *>(&stored), sizeof(stored)) == 0) ? 1 : 0;
+
+    if (valid == 0) {
+        if ((isStored == 0) || (stored.version != WARM_STATE_VERSION)) {
+            return SUCCESS;
+        }
+        warm = stored;
+        warm.version = 0;
+    }
+    else {
+        warm.version = WARM_STATE_VERSION;
+        warm.revID = pDriver_->readRegister(max14819::RevID);
+        warm.comSpeedReg = (port_ == max14819::PORTA) ? pDriver_->comSpeedRegA : pDriver_->comSpeedRegB;
+        for (uint8_t i = 0; i < sizeof(directParameterPage_); i++) {
+            warm.directParameterPage[i] = directParameterPage_[i];
+        }
+        if (isStored != 0) {
+            uint8_t const *pNew = reinterpret_cast<uint8_t const *>(&warm);
+            uint8_t const *pOld = reinterpret_cast<uint8_t const *>(&stored);
+            uint8_t isEqual = 1;
+            for (uint8_t i = 0; i < sizeof(warm); i++) {
+                if (pNew[i] != pOld[i]) {
+                    isEqual = 0;
+                }
+            }
+            if (isEqual != 0) {
+                return SUCCESS;
+            }
+        }
+    }
+    return (pDriver_->getHardware()->NV_Write(name, reinterpret_cast<uint8_t const *>(&warm), sizeof(warm)) == 0) ? SUCCESS : ERROR;
 }
 
 //!*******************************************************************************
@@ -187,13 +454,26 @@ uint8_t IOLMasterPortMax14819::begin() {
 //!
 //!*******************************************************************************
 uint8_t IOLMasterPortMax14819::end() {
+    max14819::ChipLock lock(pDriver_);
     uint8_t retValue = SUCCESS;
 
+    // Stop the cycle timer before the last message is sent
+    if (cyclicSizeData_ != 0) {
+        retValue = uint8_t(retValue | disableCyclicPD());
+    }
+
     // Send device fallback command
 	retValue = uint8_t(retValue | pDriver_->writeData(IOL::MC::DEV_FALLBACK, 0, nullptr , 1, IOL::M_TYPE_0, port_));
 
     // Reset port
 	retValue = uint8_t(retValue | pDriver_->reset(port_));
+    saveState(0);
+    requestPending_ = 0;
+    pdInLength_ = 0;
+    isdu_.reset();
+    events_.reset();
+    odMessage_ = 0;
+    enterState(PORT_INACTIVE);
 
     return retValue;
 }
@@ -201,7 +481,15 @@ uint8_t IOLMasterPortMax14819::end() {
 //!*******************************************************************************
 //!  function :    portHandler
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Advance the state machine of the port without blocking.
+//!                Every call does what the hardware has ready: the power off,
+//!                bootup and wakeup times are deadlines, the answers of the
+//!                device are polled with the RxDataRdy interrupt. Call it
+//!                periodically for all ports from one thread.
+//!
+//!                INACTIVE -> POWER_OFF -> BOOTUP -> WAKEUP -> STARTUP
+//!                -> PREOPERATE -> OPERATE, on communication errors FALLBACK
+//!                restarts the port with POWER_OFF.
 //!
 //!  \type         local
 //!
@@ -211,198 +499,1536 @@ uint8_t IOLMasterPortMax14819::end() {
 //!
 //!*******************************************************************************
 void IOLMasterPortMax14819::portHandler() {
+    max14819::ChipLock lock(pDriver_);
+    char buf[64];
+    uint8_t answer[IOL::ANSWER_MAX_SIZE];
+    uint8_t value[1];
+    uint8_t result;
+    uint64_t now = pDriver_->get_time_ns();
+
+    // A caller waits for the answer of its message, see awaitAnswer
+    if ((requestPending_ != 0) && (requestKind_ == REQUEST_DIRECT)) {
+        return;
+    }
+
+    switch (state_) {
+    case PORT_INACTIVE:
+        break;
+
+    case PORT_POWER_OFF:
+        if (now < deadline_ns_) {
+            break;
+        }
+        if (pDriver_->powerOnPort(port_) == ERROR) {
+            enterState(PORT_FALLBACK);
+            break;
+        }
+        deadline_ns_ = now + max14819::INIT_BOOTUP_DELAY * max14819::NS_PER_MS;
+        enterState(PORT_BOOTUP);
+        break;
+
+    case PORT_BOOTUP:
+        if (now < deadline_ns_) {
+            break;
+        }
+        if (pDriver_->startWakeUp(port_) == ERROR) {
+            enterState(PORT_FALLBACK);
+            break;
+        }
+        deadline_ns_ = now + max14819::INIT_WURQ_TIMEOUT * max14819::NS_PER_MS;
+        step_ = 0;
+        enterState(PORT_WAKEUP);
+        break;
+
+    case PORT_WAKEUP:
+        if (step_ == 0) {
+            // Establish communication sequence over, let the port settle.
+            // EstCom clears as soon as the device answered, a sequence
+            // running longer than INIT_WURQ_TIMEOUT is given up.
+            result = pDriver_->pollWakeUp(port_);
+            if ((result == PENDING) && (now < deadline_ns_)) {
+                break;
+            }
+            if (result != SUCCESS) {
+                enterState(PORT_FALLBACK);
+                break;
+            }
+            deadline_ns_ = now + max14819::INIT_WURQ_SETTLE * max14819::NS_PER_MS;
+            step_ = 1;
+            break;
+        }
+        if (now < deadline_ns_) {
+            break;
+        }
+        if (pDriver_->finishWakeUp(port_, &comSpeed_) == ERROR) {
+            enterState(PORT_FALLBACK);
+            break;
+        }
+        sprintf(buf, "Communication established with %d bauds\n", comSpeed_);
+        pDriver_->Serial_Write(buf);
+        step_ = 0;
+        enterState(PORT_STARTUP);
+        break;
 
+    case PORT_STARTUP:
+        // Read the direct parameter page 1 in one burst, step_ is the index
+        // of the awaited answer in PAGE1_FRAMES
+        if (requestPending_ != 0) {
+            result = pollAnswer(answer);
+            if (result == PENDING) {
+                break;
+            }
+            if (result == ERROR) {
+                comError();
+                break;
+            }
+            directParameterPage_[PAGE1_FRAMES[step_].mc & IOL::MC::PAGE_ADDRESS] = answer[0];
+            step_++;
+        }
+        if (step_ < PAGE1_FRAME_COUNT) {
+            // Queue the remaining pages, each answer sends the next request
+            if (requestPending_ == 0) {
+                sendBurst(&PAGE1_FRAMES[step_], uint8_t(PAGE1_FRAME_COUNT - step_), DIRECT_PARAMETER_TIMEOUT_US, REQUEST_PAGE);
+            }
+            break;
+        }
+
+        decodePage1();
+        isPage1Valid_ = 1;
+        sprintf(buf, "Vendor ID: %d, Device ID: %d\n", int(page1_.vendorID), int(page1_.deviceID));
+        pDriver_->Serial_Write(buf);
+        step_ = 0;
+        enterState(PORT_PREOPERATE);
+        break;
+
+    case PORT_PREOPERATE:
+        // Step 0 sends DEV_PREOPERATE, step 1 DEV_OPERATE
+        if (requestPending_ != 0) {
+            result = pollAnswer(answer);
+            if (result == PENDING) {
+                break;
+            }
+            if (result == ERROR) {
+                comError();
+                break;
+            }
+            step_++;
+        }
+        if (step_ < 2) {
+            value[0] = (step_ == 0) ? IOL::MC::DEV_PREOPERATE : IOL::MC::DEV_OPERATE;
+            sendRequest(IOL::MC::WRITE, 1, value, 1, IOL::M_TYPE_0, DIRECT_PARAMETER_TIMEOUT_US, REQUEST_PAGE);
+            break;
+        }
+        errorCount_ = 0;
+        nextCycle_ns_ = now;
+        enterState(PORT_OPERATE);
+        saveState(1);
+        break;
+
+    case PORT_OPERATE:
+        if (cyclicSizeData_ != 0) {
+            // The cycle timer sends the requests, collect the newest answer.
+            // ISDU and event messages are written one per cycle without
+            // TxKeepMsg, so each answer belongs to the last message.
+            if (pDriver_->pollRxData(port_) == SUCCESS) {
+                result = SUCCESS;
+                if (odMessage_ != 0) {
+                    if ((pDriver_->readData(answer, odAnswerSize_, port_) == ERROR)
+                            || (handleOdAnswer(answer) == ERROR)) {
+                        result = ERROR;
+                        comError();
+                    }
+                }
+                else if ((pDriver_->readCyclicData(answer, cyclicSizeData_, port_) == ERROR)
+                        || (storePDIn(answer, cyclicSizeData_) == ERROR)) {
+                    comError();
+                }
+                deadline_ns_ = now + (IOL::cycleTimeToUs(uint8_t(actualCycleTime_)) + PD_TIMEOUT_US) * max14819::NS_PER_US;
+
+                // Message of the next cycle
+                if (isOdBusy() != 0) {
+                    sendOdMessage(now, uint8_t((odMessage_ == 0) || (result == ERROR)));
+                }
+                else if (odMessage_ != 0) {
+                    odMessage_ = 0;
+                    pDriver_->writeCyclicFrame(cyclicFrame_, nullptr, 1, 0, port_);
+                }
+            }
+            else if (now > deadline_ns_) {
+                comError();
+                deadline_ns_ = now + (IOL::cycleTimeToUs(uint8_t(actualCycleTime_)) + PD_TIMEOUT_US) * max14819::NS_PER_US;
+                if (odMessage_ != 0) {
+                    sendOdMessage(now, 1);
+                }
+            }
+            break;
+        }
+        if (requestPending_ != 0) {
+            result = pollAnswer(answer);
+            if (result == PENDING) {
+                break;
+            }
+            if (result == ERROR) {
+                // An OD message is sent again, drop a late answer first
+                odMessage_ = 0;
+                comError();
+                break;
+            }
+            if (requestKind_ == REQUEST_OD) {
+                if (handleOdAnswer(answer) == ERROR) {
+                    odMessage_ = 0;
+                    comError();
+                    break;
+                }
+            }
+            else if (requestKind_ == REQUEST_PD_WRITE) {
+                // The answer of a process data write has no OD, it is only checked
+                if (IOL::isChecksumValid(answer, requestSize_) == 0) {
+                    comError();
+                    break;
+                }
+                checkEventFlag(answer[requestSize_ - 1]);
+                errorCount_ = 0;
+            }
+            else if (storePDIn(answer, pdInSize_) == ERROR) {
+                comError();
+                break;
+            }
+        }
+        if (pdWritePending_ != 0) {
+            // Process data output of writePD, an OD message continues after it
+            pdWritePending_ = 0;
+            odMessage_ = 0;
+            sendRequest(pdWriteFrame_, pdWrite_, PD_TIMEOUT_US, REQUEST_PD_WRITE);
+            break;
+        }
+        if (now >= nextCycle_ns_) {
+            // ISDU and event messages carry the process data as well
+            nextCycle_ns_ = now + uint64_t(readCycleTime_us()) * max14819::NS_PER_US;
+            if (isOdBusy() != 0) {
+                sendOdMessage(now, uint8_t(odMessage_ == 0));
+            }
+            else if (pdInSize_ != 0) {
+                odMessage_ = 0;
+                sendRequest(pdReadFrame_, nullptr, PD_TIMEOUT_US, REQUEST_PD_READ);
+            }
+        }
+        break;
+
+    case PORT_FALLBACK:
+        // Switch off L+ and start over
+        pDriver_->Serial_Write("Communication lost, restart port");
+        start();
+        break;
+
+    default:
+        enterState(PORT_INACTIVE);
+        break;
+    }
 }
 
 //!*******************************************************************************
-//!  function :    readStatus
+//!  function :    readPortState
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Returns the state of the port state machine.
 //!
 //!  \type         local
 //!
 //!  \param[in]	   void
 //!
-//!  \return       void
+//!  \return       state of the port
 //!
 //!*******************************************************************************
-void IOLMasterPortMax14819::readStatus() {
-
+PortState IOLMasterPortMax14819::readPortState() {
+    max14819::ChipLock lock(pDriver_);
+    return state_;
 }
 
 //!*******************************************************************************
-//!  function :    sendMCmd
+//!  function :    readStateTime
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Returns when the port state machine entered a state the last
+//!                time. The difference of two states gives the phase timing
+//!                of the bring-up.
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[in]    state                state of the port
 //!
-//!  \return       void
+//!  \return       timestamp in nanoseconds (see get_time_ns), 0 if never
 //!
 //!*******************************************************************************
-void IOLMasterPortMax14819::sendMCmd() {
-
+uint64_t IOLMasterPortMax14819::readStateTime(PortState state) {
+    max14819::ChipLock lock(pDriver_);
+    if (uint8_t(state) >= PORT_STATE_COUNT) {
+        return 0;
+    }
+    return stateTime_ns_[state];
 }
 
 //!*******************************************************************************
-//!  function :    readComSpeed
+//!  function :    enterState
 //!*******************************************************************************
-//!  \brief        Returns the communication speed of the port.
+//!  \brief        Switch the state machine to a new state and take the time.
 //!
 //!  \type         local
 //!
-//!  \param[in]    void
+//!  \param[in]    state                new state of the port
 //!
-//!  \return       communication speed
+//!  \return       void
 //!
 //!*******************************************************************************
-uint32_t IOLMasterPortMax14819::readComSpeed() {
-    return comSpeed_;
+void IOLMasterPortMax14819::enterState(PortState state) {
+    state_ = state;
+    if (uint8_t(state) < PORT_STATE_COUNT) {
+        stateTime_ns_[state] = pDriver_->get_time_ns();
+    }
 }
 
 //!*******************************************************************************
-//!  function :    readPage
+//!  function :    readPDIn
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Returns the newest process data answer (OD, PD and CKS)
+//!                collected by portHandler in operate. Does not communicate.
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[in]    *pData               pointer to data
+//!  \param[in]    sizeData             size of data
 //!
-//!  \return       void
+//!  \return       0 if success and processdata valid
 //!
 //!*******************************************************************************
-void IOLMasterPortMax14819::readPage() {
-
+uint8_t IOLMasterPortMax14819::readPDIn(uint8_t *pData, uint8_t sizeData) {
+    max14819::ChipLock lock(pDriver_);
+    if ((state_ != PORT_OPERATE) || (pdInLength_ == 0) || (sizeData != pdInLength_)) {
+        return ERROR;
+    }
+    for (uint8_t i = 0; i < sizeData; i++) {
+        pData[i] = pdIn_[i];
+    }
+    return (pdInValid_ != 0) ? SUCCESS : ERROR;
 }
 
 //!*******************************************************************************
-//!  function :    writePage
+//!  function :    sendRequest
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Send a message without waiting for the answer, see
+//!                pollAnswer.
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[in]    mc                   master command
+//!  \param[in]    sizeData             size in Byte of data
+//!  \param[in]    *pData               pointer to data
+//!  \param[in]    sizeAnswer           size in byte of answer
+//!  \param[in]    mSeqType             M-seqence type
+//!  \param[in]    timeout_us           worst case time for the answer
+//!  \param[in]    kind                 what the answer is for
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*******************************************************************************
-void IOLMasterPortMax14819::writePage() {
-
+uint8_t IOLMasterPortMax14819::sendRequest(uint8_t mc, uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType, uint32_t timeout_us, RequestKind kind) {
+    return sendRequest(IOL::makeMSequence(mc, mSeqType, sizeData, sizeAnswer), pData, timeout_us, kind);
 }
 
 //!*******************************************************************************
-//!  function :    readISDU
+//!  function :    sendRequest
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Send a precomputed M-sequence without waiting for the
+//!                answer, see pollAnswer.
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[in]    frame                M-sequence, see IOL::makeMSequence
+//!  \param[in]    *pData               payload of frame.sizeData bytes
+//!  \param[in]    timeout_us           worst case time for the answer
+//!  \param[in]    kind                 what the answer is for
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*******************************************************************************
-void IOLMasterPortMax14819::readISDU() {
-
+uint8_t IOLMasterPortMax14819::sendRequest(IOL::MSequence const &frame, uint8_t const *pData, uint32_t timeout_us, RequestKind kind) {
+    if (pDriver_->writeFrame(frame, pData, port_) == ERROR) {
+        comError();
+        return ERROR;
+    }
+    requestPending_ = 1;
+    requestSize_ = frame.sizeAnswer;
+    requestKind_ = kind;
+    deadline_ns_ = pDriver_->get_time_ns() + timeout_us * max14819::NS_PER_US;
+    return SUCCESS;
 }
 
 //!*******************************************************************************
-//!  function :    writeISDU
+//!  function :    sendBurst
 //!*******************************************************************************
-//!  \brief        Not implemented yet
+//!  \brief        Queue several requests without payload in the transmit FIFO
+//!                and send the first one. pollAnswer returns the answers in
+//!                order and sends the next request with each read, so no bus
+//!                transfer or wait is spent between the requests.
 //!
 //!  \type         local
 //!
-//!  \param[in]	   void
+//!  \param[in]    *pFrames             M-sequences, see IOL::makeMSequence
+//!  \param[in]    count                number of M-sequences
+//!  \param[in]    timeout_us           worst case time for each answer
+//!  \param[in]    kind                 what the answers are for
 //!
-//!  \return       void
+//!  \return       0 if success
 //!
 //!*******************************************************************************
-void IOLMasterPortMax14819::writeISDU() {
-
+uint8_t IOLMasterPortMax14819::sendBurst(IOL::MSequence const *pFrames, uint8_t count, uint32_t timeout_us, RequestKind kind) {
+    if (pDriver_->writeFrames(pFrames, count, port_) == ERROR) {
+        pDriver_->resetFifo(port_);
+        comError();
+        return ERROR;
+    }
+    requestPending_ = 1;
+    requestSize_ = pFrames[0].sizeAnswer;
+    requestKind_ = kind;
+    burstRemaining_ = uint8_t(count - 1);
+    requestTimeout_us_ = timeout_us;
+    deadline_ns_ = pDriver_->get_time_ns() + timeout_us * max14819::NS_PER_US;
+    return SUCCESS;
 }
 
-uint8_t IOLMasterPortMax14819::readDirectParameterPage(uint8_t address, uint8_t *pData) {
-	uint8_t MC;
-
-	if (address > 31) {
-		pDriver_->Serial_Write("readDirectParameterPage: address to big\n");
-		return 0;
-	}
+//!*******************************************************************************
+//!  function :    pollAnswer
+//!*******************************************************************************
+//!  \brief        Check without blocking for the answer of the message sent
+//!                with sendRequest and read it.
+//!
+//!  \type         local
+//!
+//!  \param[out]   *pData               buffer for the answer
+//!
+//!  \return       0 if success, PENDING if not received yet, 1 on timeout
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::pollAnswer(uint8_t *pData) {
+    uint8_t retValue;
 
-	MC = uint8_t((1 << 7) + (0b01 << 5) + address);
+    if (pDriver_->pollRxData(port_) == PENDING) {
+        if (pDriver_->get_time_ns() < deadline_ns_) {
+            return PENDING;
+        }
+        retValue = ERROR;
+    }
+    else if (burstRemaining_ != 0) {
+        // Read the answer and send the next request of the burst at once
+        retValue = pDriver_->readData(pData, requestSize_, port_, 1);
+        if (retValue == SUCCESS) {
+            burstRemaining_--;
+            deadline_ns_ = pDriver_->get_time_ns() + requestTimeout_us_ * max14819::NS_PER_US;
+            return SUCCESS;
+        }
+    }
+    else {
+        requestPending_ = 0;
+        return pDriver_->readData(pData, requestSize_, port_);
+    }
 
-	uint8_t retValue = SUCCESS;
+    // Drop the rest of a burst, the caller sends the missing requests again
+    if (burstRemaining_ != 0) {
+        burstRemaining_ = 0;
+        pDriver_->resetFifo(port_);
+    }
+    requestPending_ = 0;
+    return retValue;
+}
 
-	// Send processdata request to device
-	retValue = uint8_t(retValue | pDriver_->writeData(MC, 0, nullptr, 1, IOL::M_TYPE_0, port_));
+//!*******************************************************************************
+//!  function :    awaitAnswer
+//!*******************************************************************************
+//!  \brief        Wait for the answer of a message sent with kind
+//!                REQUEST_DIRECT and read it. The chip is released while
+//!                waiting, portHandler leaves the message to the caller.
+//!                On a timeout the FIFOs are reset, so a late answer is
+//!                dropped.
+//!
+//!  \type         local
+//!
+//!  \param[out]   *pData               buffer for the answer
+//!
+//!  \return       0 if success, 1 on timeout or error
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::awaitAnswer(uint8_t *pData) {
+    uint8_t result = pollAnswer(pData);
 
-	pDriver_->wait_for(2);
+    while (result == PENDING) {
+        pDriver_->awaitRxData(port_, deadline_ns_);
+        result = pollAnswer(pData);
+    }
+    if (result == ERROR) {
+        pDriver_->resetFifo(port_);
+    }
+    return result;
+}
 
-	// Receive answer
-	retValue = uint8_t(retValue | pDriver_->readData(pData, 1, port_));
+//!*******************************************************************************
+//!  function :    storePDIn
+//!*******************************************************************************
+//!  \brief        Store a process data answer for readPDIn. An answer with
+//!                a wrong CKS is dropped, the event flag of the CKS starts
+//!                the event reader.
+//!
+//!  \type         local
+//!
+//!  \param[in]    *pData               answer (OD, PD and CKS)
+//!  \param[in]    sizeData             size of the answer
+//!
+//!  \return       0 if the checksum is valid
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::storePDIn(uint8_t *pData, uint8_t sizeData) {
+    if (IOL::isChecksumValid(pData, sizeData) == 0) {
+        return ERROR;
+    }
+    for (uint8_t i = 0; i < sizeData; i++) {
+        pdIn_[i] = pData[i];
+    }
+    pdInLength_ = sizeData;
+    pdInValid_ = ((pData[sizeData - 1] & IOL::PD_VALID_BIT) == 0) ? 1 : 0;
+    checkEventFlag(pData[sizeData - 1]);
+    errorCount_ = 0;
+    pdInCount_++;
+    publishPDIn(pData, sizeData);
+    return SUCCESS;
+}
 
-	return retValue;
+//!*******************************************************************************
+//!  function :    publishPDIn
+//!*******************************************************************************
+//!  \brief        Stamp a process data answer with a valid checksum, record
+//!                its exchange and publish it to the ring of the port. The
+//!                request started with CQSend or the trigger of the port,
+//!                the cycle timer sends unseen, its start is estimated from
+//!                the line time of the M-sequence and is not recorded as
+//!                latency. An answer read without
+//!                RxDataRdy after its request is stamped now.
+//!
+//!  \type         local
+//!
+//!  \param[in]    *pData               answer (OD, PD and CKS)
+//!  \param[in]    sizeData             size of the answer
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::publishPDIn(uint8_t const *pData, uint8_t sizeData) {
+    uint64_t now = pDriver_->get_time_ns();
+    uint64_t rx_ns = pDriver_->readRxTime(port_);
+    uint64_t send_ns;
+    uint8_t isSendMeasured = 1;
 
+    if (sizeData == 0) {
+        return;
+    }
+    if (rx_ns == 0) {
+        rx_ns = now;
+    }
+    if (trigger_ != max14819::TRIGGER_NONE) {
+        send_ns = pDriver_->readTriggerTime(trigger_);
+    }
+    else if (cyclicSizeData_ != 0) {
+        // The cycle timer sends on its own, estimate the start from the answer
+        uint64_t transfer_ns = uint64_t(readTransferTime_us()) * max14819::NS_PER_US;
+        send_ns = (rx_ns > transfer_ns) ? (rx_ns - transfer_ns) : 0;
+        isSendMeasured = 0;
+    }
+    else {
+        send_ns = pDriver_->readSendTime(port_);
+    }
+    if (rx_ns < send_ns) {
+        rx_ns = now;
+    }
+    pdInSend_ns_ = send_ns;
+    pdInRx_ns_ = rx_ns;
+    if (pPDTiming_ != nullptr) {
+        pPDTiming_->record(send_ns, rx_ns, readCycleTime_us(), isSendMeasured);
+    }
+    if (pPDRing_ != nullptr) {
+        pPDRing_->publish(rx_ns, send_ns, uint8_t(((pData[sizeData - 1] & IOL::PD_VALID_BIT) == 0) ? 1 : 0), pData, sizeData);
+    }
 }
 
 //!*******************************************************************************
-//!  function :    readPD
+//!  function :    decodePage1
 //!*******************************************************************************
-//!  \brief        Sends a process data request to the device and receive the
-//!                answer from the slave.
+//!  \brief        Decode the direct parameter page 1 and derive the process
+//!                data request of the device.
 //!
 //!  \type         local
 //!
-//!  \param[in]    *pData               pointer to data
-//!  \param[in]    sizeData             size of data
+//!  \param[in]	   void
 //!
-//!  \return       0 if success and processdata valid
+//!  \return       void
 //!
 //!*******************************************************************************
-uint8_t IOLMasterPortMax14819::readPD(uint8_t *pData, uint8_t sizeData) {
-    uint8_t retValue = SUCCESS;
-
-    // Send processdata request to device
-    retValue = uint8_t(retValue | pDriver_->writeData(IOL::MC::PD_READ, 0, nullptr , sizeData, IOL::M_TYPE_2_X, port_));
+void IOLMasterPortMax14819::decodePage1() {
+    page1_ = IOL::decodePage1(directParameterPage_);
+    minCycleTime_ = page1_.minCycleTime;
+    odSize_ = IOL::odSizeOperate(page1_.mSeqCapability);
+    mSeqType_ = IOL::mSeqTypeOperate(page1_.mSeqCapability, page1_.processDataIn, page1_.processDataOut);
+    pdOutSize_ = IOL::pdLengthToBytes(page1_.processDataOut);
+    pdInSize_ = IOL::pdLengthToBytes(page1_.processDataIn);
+    if (pdInSize_ != 0) {
+        pdInSize_ = uint8_t(pdInSize_ + odSize_ + 1); // OD and CKS
+    }
+    pdReadFrame_ = IOL::pdRead(pdInSize_);
+}
 
-	pDriver_->wait_for(10);
+//!*******************************************************************************
+//!  function :    comError
+//!*******************************************************************************
+//!  \brief        Count a communication error, after MAX_COM_ERRORS in a row
+//!                the port falls back and gets restarted.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::comError() {
+    errorCount_++;
+    if (errorCount_ >= MAX_COM_ERRORS) {
+        pdInLength_ = 0;
+        enterState(PORT_FALLBACK);
+    }
+}
 
-    // Receive answer
-    retValue = uint8_t(retValue | pDriver_->readData(pData,  4,  port_));
-    if((pData[3]&IOL::PD_VALID_BIT) != 0){
-		retValue = ERROR;
-	}
-    return retValue;
+//!*******************************************************************************
+//!  function :    readStatus
+//!*******************************************************************************
+//!  \brief        Read the chip and channel status, set faults are published
+//!                to the event ring of the port
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::readStatus() {
+    max14819::ChipLock lock(pDriver_);
+    pDriver_->readStatus(port_);
 }
 
 //!*******************************************************************************
-//!  function :    writePD
+//!  function :    sendMCmd
 //!*******************************************************************************
-//!  \brief        Sends process data to the device. Informations like lenght and
-//!                m-sequence type must be set by user.
+//!  \brief        Not implemented yet
 //!
 //!  \type         local
 //!
-//!  \param[in]    sizeData             size in Byte of data
-//!  \param[in]    *pData               pointer to data
-//!  \param[in]    sizeAnswer           size in byte of answer
-//!  \param[in]    mSeqType             M-seqence type
+//!  \param[in]	   void
 //!
-//!  \return       0 if success
+//!  \return       void
 //!
 //!*******************************************************************************
-uint8_t IOLMasterPortMax14819::writePD(uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType) {
-    uint8_t retValue = SUCCESS;
+void IOLMasterPortMax14819::sendMCmd() {
 
-    // Send processdata to device
-    retValue = uint8_t(retValue | pDriver_->writeData(IOL::MC::WRITE, sizeData, pData, sizeAnswer, mSeqType, port_));
+}
 
-    return retValue;
+//!*******************************************************************************
+//!  function :    readComSpeed
+//!*******************************************************************************
+//!  \brief        Returns the communication speed of the port.
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       communication speed
+//!
+//!*******************************************************************************
+uint32_t IOLMasterPortMax14819::readComSpeed() {
+    return comSpeed_;
+}
+
+//!*******************************************************************************
+//!  function :    setCycleTime
+//!*******************************************************************************
+//!  \brief        Set the master cycle time of operate without cycle timer,
+//!                a slow device does not need to be polled at its
+//!                MIN_CYCLE_TIME. enableCyclicPD sets its own cycle time.
+//!
+//!  \type         local
+//!
+//!  \param[in]    cycleTime            cycle time in IO-Link encoding, 0 to
+//!                                     use MIN_CYCLE_TIME of the device
+//!
+//!  \return       0 if success, 1 while the cycle timer sends
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::setCycleTime(uint8_t cycleTime) {
+    max14819::ChipLock lock(pDriver_);
+    if (cyclicSizeData_ != 0) {
+        return ERROR;
+    }
+    // The cycle time must not be shorter than the device allows
+    if (IOL::cycleTimeToUs(cycleTime) < IOL::cycleTimeToUs(minCycleTime_)) {
+        cycleTime = minCycleTime_;
+    }
+    actualCycleTime_ = cycleTime;
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    readCycleTime_us
+//!*******************************************************************************
+//!  \brief        Returns the cycle time the port runs in operate
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       cycle time in microseconds
+//!
+//!*******************************************************************************
+uint32_t IOLMasterPortMax14819::readCycleTime_us() {
+    max14819::ChipLock lock(pDriver_);
+    uint32_t cycleTime_us = IOL::cycleTimeToUs(uint8_t(actualCycleTime_));
+
+    if (cyclicSizeData_ != 0) {
+        return cycleTime_us;
+    }
+    if (cycleTime_us < IOL::cycleTimeToUs(minCycleTime_)) {
+        cycleTime_us = IOL::cycleTimeToUs(minCycleTime_);
+    }
+    return (cycleTime_us > MIN_CYCLE_TIME_US) ? cycleTime_us : MIN_CYCLE_TIME_US;
+}
+
+//!*******************************************************************************
+//!  function :    readMSequenceSize
+//!*******************************************************************************
+//!  \brief        Returns the octets of one process data M-sequence of
+//!                operate, master message and answer
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       number of octets on the line
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::readMSequenceSize() {
+    max14819::ChipLock lock(pDriver_);
+    IOL::MSequence const &frame = (cyclicSizeData_ != 0) ? cyclicFrame_ : pdReadFrame_;
+
+    // MC and CKT precede the payload of the master message
+    return uint8_t(2u + frame.sizeData + frame.sizeAnswer);
+}
+
+//!*******************************************************************************
+//!  function :    readTransferTime_us
+//!*******************************************************************************
+//!  \brief        Returns the time one process data M-sequence of operate
+//!                takes on the line: master message, response delay and
+//!                answer at the COM speed of the device.
+//!
+//!  \type         local
+//!
+//!  \param[in]    void
+//!
+//!  \return       time in microseconds, 0 before the COM speed is known
+//!
+//!*******************************************************************************
+uint32_t IOLMasterPortMax14819::readTransferTime_us() {
+    max14819::ChipLock lock(pDriver_);
+
+    if (comSpeed_ == 0) {
+        return 0;
+    }
+    uint32_t bits = uint32_t(readMSequenceSize()) * UART_FRAME_BITS + RESPONSE_DELAY_BITS;
+    return uint32_t((uint64_t(bits) * 1000000u + comSpeed_ - 1u) / comSpeed_);
+}
+
+//!*******************************************************************************
+//!  function :    readPage
+//!*******************************************************************************
+//!  \brief        Not implemented yet
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::readPage() {
+
+}
+
+//!*******************************************************************************
+//!  function :    writePage
+//!*******************************************************************************
+//!  \brief        Not implemented yet
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::writePage() {
+
+}
+
+//!*******************************************************************************
+//!  function :    readISDU
+//!*******************************************************************************
+//!  \brief        Read an index of the device over the ISDU channel. Blocks
+//!                until the response is received, see transferISDU.
+//!
+//!  \type         local
+//!
+//!  \param[in]    index                index of the parameter
+//!  \param[in]    subindex             subindex, 0 for the whole parameter
+//!  \param[out]   *pData               buffer for the value
+//!  \param[in,out] *pSize              size of the buffer, size of the value
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::readISDU(uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t *pSize) {
+    max14819::ChipLock lock(pDriver_);
+    IOLIsdu::Request request = {index, subindex, 0, pData, *pSize, ERROR, 0};
+
+    if (transferISDU(&request, 1) == ERROR) {
+        return ERROR;
+    }
+    *pSize = request.size;
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    writeISDU
+//!*******************************************************************************
+//!  \brief        Write an index of the device over the ISDU channel. Blocks
+//!                until the response is received, see transferISDU.
+//!
+//!  \type         local
+//!
+//!  \param[in]    index                index of the parameter
+//!  \param[in]    subindex             subindex, 0 for the whole parameter
+//!  \param[in]    *pData               value
+//!  \param[in]    size                 size of the value
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::writeISDU(uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t size) {
+    max14819::ChipLock lock(pDriver_);
+    IOLIsdu::Request request = {index, subindex, 1, pData, size, ERROR, 0};
+
+    return transferISDU(&request, 1);
+}
+
+//!*******************************************************************************
+//!  function :    queueISDU
+//!*******************************************************************************
+//!  \brief        Queue an ISDU request without blocking. portHandler sends
+//!                the ISDU octets in the OD of the operate M-sequences, in
+//!                cyclic mode too, the process data is exchanged in the same
+//!                cycles. The request is done when its status is not PENDING.
+//!
+//!  \type         local
+//!
+//!  \param[in,out] *pRequest           request, must live until it is done
+//!
+//!  \return       0 if queued
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::queueISDU(IOLIsdu::Request *pRequest) {
+    max14819::ChipLock lock(pDriver_);
+    if ((state_ != PORT_OPERATE) || ((page1_.mSeqCapability & IOL::M_SEQ_CAP_ISDU) == 0)) {
+        return ERROR;
+    }
+    return isdu_.queue(pRequest);
+}
+
+//!*******************************************************************************
+//!  function :    transferISDU
+//!*******************************************************************************
+//!  \brief        Transfer several ISDU requests back to back and wait until
+//!                they are done. The requests are queued with queueISDU and
+//!                transferred by portHandler, the next request starts right
+//!                after the last response octet.
+//!
+//!  \type         local
+//!
+//!  \param[in,out] *pRequests          requests, status and size are updated
+//!  \param[in]    count                number of requests
+//!
+//!  \return       0 if all requests succeeded
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::transferISDU(IOLIsdu::Request *pRequests, uint8_t count) {
+    max14819::ChipLock lock(pDriver_);
+    uint8_t retValue = SUCCESS;
+    uint8_t isPending = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (queueISDU(&pRequests[i]) == ERROR) {
+            pRequests[i].status = ERROR;
+        }
+        else {
+            isPending = 1;
+        }
+    }
+
+    while ((isPending != 0) && (state_ == PORT_OPERATE)) {
+        portHandler();
+        isPending = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            if (pRequests[i].status == PENDING) {
+                isPending = 1;
+            }
+        }
+        if (isPending != 0) {
+            waitForEvent();
+        }
+    }
+    if (isPending != 0) {
+        // Communication lost
+        isdu_.reset();
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (pRequests[i].status != SUCCESS) {
+            retValue = ERROR;
+        }
+    }
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    readEvent
+//!*******************************************************************************
+//!  \brief        Take the oldest event of the device. Events are read when
+//!                an answer has the event flag set, while the event memory
+//!                is being read portHandler is run until it is confirmed.
+//!                An event flagged by the device but not seen in an answer
+//!                yet comes with a later call.
+//!
+//!  \type         local
+//!
+//!  \param[out]   *pEvent              event
+//!
+//!  \return       0 if an event was taken, 1 if there is none
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::readEvent(IOL::Event *pEvent) {
+    max14819::ChipLock lock(pDriver_);
+    while ((events_.isBusy() != 0) && (state_ == PORT_OPERATE)) {
+        portHandler();
+        if (events_.isBusy() != 0) {
+            waitForEvent();
+        }
+    }
+    return events_.read(pEvent);
+}
+
+//!*******************************************************************************
+//!  function :    sendOdMessage
+//!*******************************************************************************
+//!  \brief        Send the next M-sequence of the event reader or the ISDU
+//!                engine with the process data output. Events go first, they
+//!                take a few messages and the ISDU engine simply continues
+//!                after them. In cyclic mode the message is written for the
+//!                next cycle of the timer.
+//!
+//!  \type         local
+//!
+//!  \param[in]    now                  current time (see get_time_ns)
+//!  \param[in]    reset                1 to drop queued messages and answers
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::sendOdMessage(uint64_t now, uint8_t reset) {
+    uint8_t payload[IOL::PD_MAX_SIZE + IOL::OD_MAX_SIZE];
+    uint8_t mc;
+
+    if (events_.isBusy() != 0) {
+        mc = events_.nextMessage(odSize_, &payload[pdOutSize_]);
+        odMessage_ = OD_MESSAGE_EVENT;
+    }
+    else {
+        mc = isdu_.nextMessage(now, odSize_, &payload[pdOutSize_]);
+        odMessage_ = OD_MESSAGE_ISDU;
+    }
+    for (uint8_t i = 0; i < pdOutSize_; i++) {
+        payload[i] = pdOut_[i];
+    }
+    odIsRead_ = ((mc & IOL::MC::READ) != 0) ? 1 : 0;
+    odAnswerSize_ = uint8_t(((odIsRead_ != 0) ? odSize_ : 0) + IOL::pdLengthToBytes(page1_.processDataIn) + 1);
+    IOL::MSequence frame = IOL::makeMSequence(mc, mSeqType_, uint8_t(pdOutSize_ + ((odIsRead_ != 0) ? 0 : odSize_)), odAnswerSize_);
+
+    if (cyclicSizeData_ != 0) {
+        return pDriver_->writeCyclicFrame(frame, payload, 0, reset, port_);
+    }
+    if (reset != 0) {
+        pDriver_->resetFifo(port_);
+    }
+    return sendRequest(frame, payload, PD_TIMEOUT_US, REQUEST_OD);
+}
+
+//!*******************************************************************************
+//!  function :    handleOdAnswer
+//!*******************************************************************************
+//!  \brief        Check the answer of an OD message, store its process data
+//!                and pass the OD to the engine which sent the message. In
+//!                the write direction the answer has no OD, the process data
+//!                is stored with zero OD octets like a process data answer.
+//!
+//!  \type         local
+//!
+//!  \param[in]    *pData               answer of odAnswerSize_ bytes
+//!
+//!  \return       0 if the checksum is valid
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::handleOdAnswer(uint8_t *pData) {
+    uint8_t answer[IOL::ANSWER_MAX_SIZE];
+
+    if (IOL::isChecksumValid(pData, odAnswerSize_) == 0) {
+        return ERROR;
+    }
+    if (pdInSize_ == 0) {
+        checkEventFlag(pData[odAnswerSize_ - 1]);
+        errorCount_ = 0;
+    }
+    else if (odIsRead_ != 0) {
+        storePDIn(pData, pdInSize_);
+    }
+    else {
+        // Zero octets do not change the checksum
+        for (uint8_t i = 0; i < odSize_; i++) {
+            answer[i] = 0;
+        }
+        for (uint8_t i = 0; i < odAnswerSize_; i++) {
+            answer[odSize_ + i] = pData[i];
+        }
+        storePDIn(answer, pdInSize_);
+    }
+    if (odMessage_ == OD_MESSAGE_EVENT) {
+        IOL::Event event;
+        if (events_.handleAnswer(pData, &event) == SUCCESS) {
+            pDriver_->publishEvent(port_, EVENT_SOURCE_DEVICE, event.qualifier, event.code);
+        }
+    }
+    else {
+        isdu_.handleAnswer(pData);
+    }
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    isOdBusy
+//!*******************************************************************************
+//!  \brief        Returns if the ISDU engine or the event reader needs the
+//!                OD of the next M-sequence
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       1 if an OD message has to be sent
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::isOdBusy() {
+    return ((isdu_.isBusy() != 0) || (events_.isBusy() != 0)) ? 1 : 0;
+}
+
+//!*******************************************************************************
+//!  function :    isTransmitFree
+//!*******************************************************************************
+//!  \brief        Returns if a caller may send a message of its own: no
+//!                message waits for its answer, the cycle timer does not
+//!                keep its message and the wakeup does not use the port
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       1 if the transmit FIFO is free
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::isTransmitFree() {
+    if ((requestPending_ != 0) || (cyclicSizeData_ != 0)) {
+        return 0;
+    }
+    return ((state_ == PORT_POWER_OFF) || (state_ == PORT_BOOTUP) || (state_ == PORT_WAKEUP)) ? 0 : 1;
+}
+
+//!*******************************************************************************
+//!  function :    checkEventFlag
+//!*******************************************************************************
+//!  \brief        Start reading the event memory when the CKS of an answer
+//!                has the event flag set
+//!
+//!  \type         local
+//!
+//!  \param[in]    cks                  last octet of a valid answer
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::checkEventFlag(uint8_t cks) {
+    if ((cks & IOL::EVENT_BIT) != 0) {
+        events_.trigger();
+    }
+}
+
+//!*******************************************************************************
+//!  function :    waitForEvent
+//!*******************************************************************************
+//!  \brief        Sleep until portHandler has something to do in operate: the
+//!                answer of the pending message or the next cycle. The chip
+//!                is released meanwhile, a service thread may run
+//!                portHandler of this or the other port.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::waitForEvent() {
+    if ((requestPending_ != 0) && (requestKind_ == REQUEST_DIRECT)) {
+        // The answer belongs to another caller, wait until it is done
+        pDriver_->sleepUntil(deadline_ns_);
+    }
+    else if ((requestPending_ != 0) || (cyclicSizeData_ != 0)) {
+        pDriver_->awaitRxData(port_, deadline_ns_);
+    }
+    else {
+        pDriver_->sleepUntil(nextCycle_ns_);
+    }
+}
+
+//!*******************************************************************************
+//!  function :    readWakeupTime
+//!*******************************************************************************
+//!  \brief        Latest time portHandler has to run again, for a thread
+//!                serving the port (see IOLMasterService). Answers of the
+//!                device assert the interrupt pin before.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       time in nanoseconds (see get_time_ns), UINT64_MAX if the
+//!                port has nothing to do
+//!
+//!*******************************************************************************
+uint64_t IOLMasterPortMax14819::readWakeupTime() {
+    max14819::ChipLock lock(pDriver_);
+    if (state_ == PORT_INACTIVE) {
+        return UINT64_MAX;
+    }
+    if ((state_ == PORT_OPERATE) && (requestPending_ == 0) && (cyclicSizeData_ == 0)) {
+        return nextCycle_ns_;
+    }
+    return deadline_ns_;
+}
+
+//!*******************************************************************************
+//!  function :    readDirectParameterPage
+//!*******************************************************************************
+//!  \brief        Read one octet of the direct parameter page 1. The transmit
+//!                FIFO must be free: not while a message of portHandler waits
+//!                for its answer or the cycle timer keeps its message.
+//!
+//!  \type         local
+//!
+//!  \param[in]    address              address in the page
+//!  \param[out]   *pData               value of the octet
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::readDirectParameterPage(uint8_t address, uint8_t *pData) {
+    max14819::ChipLock lock(pDriver_);
+	if (address > IOL::MC::PAGE_ADDRESS) {
+		pDriver_->Serial_Write("readDirectParameterPage: address to big\n");
+		return ERROR;
+	}
+
+    // The transmit FIFO must be free
+    if ((isTransmitFree() == 0) || (pdWritePending_ != 0)) {
+        return ERROR;
+    }
+
+	// Send page request to device, 2 ms is the worst case for the answer
+	if (sendRequest(IOL::pageRead(address), nullptr, DIRECT_PARAMETER_TIMEOUT_US, REQUEST_DIRECT) == ERROR) {
+		return ERROR;
+	}
+	return awaitAnswer(pData);
+}
+
+//!*******************************************************************************
+//!  function :    readDirectParameterPage1
+//!*******************************************************************************
+//!  \brief        Returns the decoded direct parameter page 1. The page is
+//!                cached from the startup (or resume), otherwise the readable
+//!                octets are read in one burst: the requests are queued in
+//!                the transmit FIFO and each answer sends the next one.
+//!
+//!  \type         local
+//!
+//!  \param[out]   *pPage               decoded page
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::readDirectParameterPage1(IOL::DirectParameterPage1 *pPage) {
+    max14819::ChipLock lock(pDriver_);
+    uint8_t page[PAGE1_FRAME_COUNT];
+
+    if (isPage1Valid_ != 0) {
+        *pPage = page1_;
+        return SUCCESS;
+    }
+
+    // The transmit FIFO must be free
+    if ((isTransmitFree() == 0) || (pdWritePending_ != 0)) {
+        return ERROR;
+    }
+
+    // Each answer sends the next request, see pollAnswer
+    if (sendBurst(PAGE1_FRAMES, PAGE1_FRAME_COUNT, DIRECT_PARAMETER_TIMEOUT_US, REQUEST_DIRECT) == ERROR) {
+        return ERROR;
+    }
+    for (uint8_t i = 0; i < PAGE1_FRAME_COUNT; i++) {
+        if (awaitAnswer(&page[i]) == ERROR) {
+            return ERROR;
+        }
+    }
+
+    for (uint8_t i = 0; i < PAGE1_FRAME_COUNT; i++) {
+        directParameterPage_[PAGE1_FRAMES[i].mc & IOL::MC::PAGE_ADDRESS] = page[i];
+    }
+    decodePage1();
+    isPage1Valid_ = 1;
+    *pPage = page1_;
+    return SUCCESS;
+}
+
+//!*******************************************************************************
+//!  function :    readPD
+//!*******************************************************************************
+//!  \brief        Sends a process data request to the device and receive the
+//!                answer from the slave. In cyclic mode (see enableCyclicPD)
+//!                the newest answer sent by the cycle timer is returned.
+//!                The request and its answer go through portHandler, so a
+//!                service thread serving the port meanwhile takes part
+//!                instead of colliding. While ISDU or event messages carry
+//!                the process data or another message waits for its answer,
+//!                the next answer is returned.
+//!
+//!  \type         local
+//!
+//!  \param[in]    *pData               pointer to data
+//!  \param[in]    sizeData             size of data
+//!
+//!  \return       0 if success and processdata valid
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::readPD(uint8_t *pData, uint8_t sizeData) {
+    max14819::ChipLock lock(pDriver_);
+    uint32_t count = pdInCount_;
+    uint64_t now = pDriver_->get_time_ns();
+    uint64_t deadline;
+
+    if ((state_ != PORT_OPERATE) || (sizeData == 0)) {
+        return ERROR;
+    }
+    if (cyclicSizeData_ != 0) {
+        // The chip sends the request, only collect the answer
+        if (sizeData != cyclicSizeData_) {
+            return ERROR;
+        }
+        deadline = now + (IOL::cycleTimeToUs(uint8_t(actualCycleTime_)) + PD_TIMEOUT_US) * max14819::NS_PER_US;
+    }
+    else {
+        if (sizeData != pdInSize_) {
+            return ERROR;
+        }
+        // Request the process data now instead of with the next cycle
+        if ((isOdBusy() == 0) && (requestPending_ == 0) && (pdWritePending_ == 0)) {
+            odMessage_ = 0;
+            nextCycle_ns_ = now + uint64_t(readCycleTime_us()) * max14819::NS_PER_US;
+            if (sendRequest(pdReadFrame_, nullptr, PD_TIMEOUT_US, REQUEST_PD_READ) == ERROR) {
+                return ERROR;
+            }
+        }
+        deadline = now + (readCycleTime_us() + PD_TIMEOUT_US) * max14819::NS_PER_US;
+    }
+
+    while ((pdInCount_ == count) && (state_ == PORT_OPERATE) && (pDriver_->get_time_ns() < deadline)) {
+        portHandler();
+        if (pdInCount_ == count) {
+            waitForEvent();
+        }
+    }
+    if (pdInCount_ == count) {
+        return ERROR;
+    }
+    return readPDIn(pData, sizeData);
+}
+
+//!*******************************************************************************
+//!  function :    setPDRing
+//!*******************************************************************************
+//!  \brief        Publish every process data answer of the port to a ring.
+//!                The consumers read the ring at their own pace, the cycle
+//!                never waits for them.
+//!
+//!  \type         local
+//!
+//!  \param[in]    *pRing               ring, nullptr to stop publishing
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::setPDRing(IOLPDRing *pRing) {
+    pPDRing_ = pRing;
+}
+
+//!*******************************************************************************
+//!  function :    setPDTiming
+//!*******************************************************************************
+//!  \brief        Record the latency and the jitter of every process data
+//!                exchange of the port. The histograms are queried at
+//!                runtime, recording never waits for the readers.
+//!
+//!  \type         local
+//!
+//!  \param[in]    *pTiming             histograms, nullptr to stop recording
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::setPDTiming(IOLPDTiming *pTiming) {
+    pPDTiming_ = pTiming;
+}
+
+//!*******************************************************************************
+//!  function :    readPDTime
+//!*******************************************************************************
+//!  \brief        Timestamps of the last process data answer returned by
+//!                readPD or readPDIn, to tell when it was sampled and how
+//!                old it is (see get_time_ns).
+//!
+//!  \type         local
+//!
+//!  \param[out]   *pSend_ns            request started at, may be nullptr
+//!  \param[out]   *pRx_ns              answer completed at, may be nullptr
+//!
+//!  \return       void
+//!
+//!*******************************************************************************
+void IOLMasterPortMax14819::readPDTime(uint64_t *pSend_ns, uint64_t *pRx_ns) {
+    max14819::ChipLock lock(pDriver_);
+
+    if (pSend_ns != nullptr) {
+        *pSend_ns = pdInSend_ns_;
+    }
+    if (pRx_ns != nullptr) {
+        *pRx_ns = pdInRx_ns_;
+    }
+}
+
+//!*******************************************************************************
+//!  function :    writePD
+//!*******************************************************************************
+//!  \brief        Sends process data to the device. Informations like lenght and
+//!                m-sequence type must be set by user. The message is queued
+//!                for portHandler, which sends it as soon as the answer of
+//!                the pending message is in, a newer output replaces one not
+//!                sent yet. One portHandler step is run here, so a port
+//!                served by nobody else sends it with this or the next call.
+//!
+//!  \type         local
+//!
+//!  \param[in]    sizeData             size in Byte of data
+//!  \param[in]    *pData               pointer to data
+//!  \param[in]    sizeAnswer           size in byte of answer
+//!  \param[in]    mSeqType             M-seqence type
+//!
+//!  \return       0 if sent or queued
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::writePD(uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType) {
+    max14819::ChipLock lock(pDriver_);
+
+    // The transmit FIFO holds the cyclic message, before operate it
+    // belongs to the startup of portHandler
+    if ((cyclicSizeData_ != 0) || (state_ != PORT_OPERATE)) {
+        return ERROR;
+    }
+    if ((sizeData > sizeof(pdWrite_)) || (sizeAnswer == 0) || (sizeAnswer > IOL::ANSWER_MAX_SIZE)) {
+        return ERROR;
+    }
+
+    // Keep the process data output for the ISDU messages
+    if (sizeData >= pdOutSize_) {
+        for (uint8_t i = 0; i < pdOutSize_; i++) {
+            pdOut_[i] = pData[i];
+        }
+    }
+
+    for (uint8_t i = 0; i < sizeData; i++) {
+        pdWrite_[i] = pData[i];
+    }
+    pdWriteFrame_ = IOL::makeMSequence(IOL::MC::WRITE, mSeqType, sizeData, sizeAnswer);
+    pdWritePending_ = 1;
+
+    portHandler();
+    return (state_ == PORT_OPERATE) ? SUCCESS : ERROR;
+}
+
+//!*******************************************************************************
+//!  function :    enableCyclicPD
+//!*******************************************************************************
+//!  \brief        Let the max14819 cycle timer send the process data request.
+//!                The chip repeats the master frame on its own, readPD then
+//!                only drains the receive FIFO. writePD is not possible until
+//!                disableCyclicPD is called.
+//!
+//!  \type         local
+//!
+//!  \param[in]    sizeData             size of the answer (OD, PD and CKS)
+//!  \param[in]    cycleTime            cycle time in IO-Link encoding, 0 to
+//!                                     use MIN_CYCLE_TIME of the device
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::enableCyclicPD(uint8_t sizeData, uint8_t cycleTime) {
+    max14819::ChipLock lock(pDriver_);
+    uint8_t retValue = SUCCESS;
+
+    // The answer of a caller's message must not be taken for process data
+    if ((sizeData == 0) || ((requestPending_ != 0) && (requestKind_ == REQUEST_DIRECT))) {
+        return ERROR;
+    }
+    if (cycleTime == 0) {
+        cycleTime = minCycleTime_;
+    }
+
+    // The cycle time must not be shorter than the device allows
+    if (IOL::cycleTimeToUs(cycleTime) < IOL::cycleTimeToUs(minCycleTime_)) {
+        cycleTime = minCycleTime_;
+    }
+
+    retValue = uint8_t(retValue | pDriver_->writeCycleTimer(cycleTime, port_));
+    actualCycleTime_ = pDriver_->readRegister((port_ == max14819::PORTA) ? max14819::CyclTmrA : max14819::CyclTmrB);
+    retValue = uint8_t(retValue | pDriver_->enableCyclicSend(IOL::MC::PD_READ, 0, nullptr, sizeData, IOL::M_TYPE_2_X, 0, port_));
+    if (retValue == SUCCESS) {
+        cyclicSizeData_ = sizeData;
+        trigger_ = max14819::TRIGGER_NONE;
+        cyclicFrame_ = IOL::makeMSequence(IOL::MC::PD_READ, IOL::M_TYPE_2_X, 0, sizeData);
+        requestPending_ = 0;
+        odMessage_ = 0;
+        deadline_ns_ = pDriver_->get_time_ns() + (IOL::cycleTimeToUs(uint8_t(actualCycleTime_)) + PD_TIMEOUT_US) * max14819::NS_PER_US;
+    }
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    disableCyclicPD
+//!*******************************************************************************
+//!  \brief        Stop the cycle timer, process data is requested by readPD
+//!                again.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::disableCyclicPD() {
+    max14819::ChipLock lock(pDriver_);
+    cyclicSizeData_ = 0;
+    trigger_ = max14819::TRIGGER_NONE;
+    odMessage_ = 0;
+    return pDriver_->disableCyclicSend(minCycleTime_, port_);
+}
+
+//!*******************************************************************************
+//!  function :    enableTriggeredPD
+//!*******************************************************************************
+//!  \brief        Like enableCyclicPD, but a trigger of the chip starts the
+//!                process data request instead of the cycle timer. All ports
+//!                on the same trigger sample at the same instant, the
+//!                trigger is written once per cycle (see IOLSyncGroup).
+//!                writePD is not possible until disableCyclicPD is called.
+//!
+//!  \type         local
+//!
+//!  \param[in]    sizeData             size of the answer (OD, PD and CKS)
+//!  \param[in]    trigger              0 to max14819::TRIGGER_COUNT - 1
+//!  \param[in]    cycleTime            cycle time of the trigger in IO-Link
+//!                                     encoding, bounds the wait for an
+//!                                     answer, 0 for MIN_CYCLE_TIME
+//!
+//!  \return       0 if success
+//!
+//!*******************************************************************************
+uint8_t IOLMasterPortMax14819::enableTriggeredPD(uint8_t sizeData, uint8_t trigger, uint8_t cycleTime) {
+    max14819::ChipLock lock(pDriver_);
+    uint8_t retValue = SUCCESS;
+
+    // The answer of a caller's message must not be taken for process data
+    if ((sizeData == 0) || ((requestPending_ != 0) && (requestKind_ == REQUEST_DIRECT))) {
+        return ERROR;
+    }
+
+    // The cycle time must not be shorter than the device allows
+    if (IOL::cycleTimeToUs(cycleTime) < IOL::cycleTimeToUs(minCycleTime_)) {
+        cycleTime = minCycleTime_;
+    }
+
+    retValue = uint8_t(retValue | pDriver_->enableTriggeredSend(IOL::MC::PD_READ, 0, nullptr, sizeData, IOL::M_TYPE_2_X, trigger, port_));
+    if (retValue == SUCCESS) {
+        actualCycleTime_ = cycleTime;
+        cyclicSizeData_ = sizeData;
+        trigger_ = trigger;
+        cyclicFrame_ = IOL::makeMSequence(IOL::MC::PD_READ, IOL::M_TYPE_2_X, 0, sizeData);
+        requestPending_ = 0;
+        odMessage_ = 0;
+        deadline_ns_ = pDriver_->get_time_ns() + (IOL::cycleTimeToUs(uint8_t(actualCycleTime_)) + PD_TIMEOUT_US) * max14819::NS_PER_US;
+    }
+    return retValue;
+}
+
+//!*******************************************************************************
+//!  function :    readDriver
+//!*******************************************************************************
+//!  \brief        Returns the chip of the port
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       driver of the MAX14819
+//!
+//!*******************************************************************************
+max14819::Max14819 *IOLMasterPortMax14819::readDriver() {
+    return pDriver_;
 }
 
 //!*******************************************************************************
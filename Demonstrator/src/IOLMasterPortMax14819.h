@@ -33,11 +33,24 @@
 //!***** Header-Files ***********************************************************
 #include "IOLMasterPort.h"
 #include "Max14819.h"
+#include "IOLink.h"
+#include "IOLIsdu.h"
+#include "IOLEvent.h"
 
 #include <stdint.h>
 //!***** Macros *****************************************************************
 
 //!***** Data types *************************************************************
+// Kind of the message waiting for its answer, tells portHandler what to do
+// with the answer
+enum RequestKind {
+    REQUEST_NONE,
+    REQUEST_PAGE,                   // direct parameter page access of the startup
+    REQUEST_PD_READ,                // process data request, the answer is stored as input
+    REQUEST_PD_WRITE,               // process data output of writePD, the answer is only checked
+    REQUEST_OD,                     // ISDU or event message, see odMessage_
+    REQUEST_DIRECT                  // page read or probe of a caller, see awaitAnswer
+};
 
 //!***** Function prototypes ****************************************************
 
@@ -55,6 +68,67 @@ private:
     uint16_t portStatus_;
     uint16_t actualCycleTime_;
     uint32_t comSpeed_;
+    uint8_t minCycleTime_;
+    uint8_t cyclicSizeData_;
+    uint8_t trigger_;               // trigger starting the cyclic message, TRIGGER_NONE for the cycle timer
+
+    // State machine of portHandler
+    PortState state_;
+    uint8_t step_;                  // substep of the state
+    uint8_t errorCount_;            // consecutive communication errors
+    uint8_t requestPending_;        // a message waits for its answer
+    uint8_t requestSize_;           // size of the awaited answer
+    RequestKind requestKind_;       // message waiting for its answer
+    uint8_t burstRemaining_;        // requests still queued by sendBurst
+    uint32_t requestTimeout_us_;    // worst case time for each answer of a burst
+    uint64_t deadline_ns_;          // end of the current step
+    uint64_t nextCycle_ns_;         // next process data request in operate
+    uint64_t stateTime_ns_[PORT_STATE_COUNT]; // last entry of each state
+    uint8_t directParameterPage_[IOL::PAGE1_SIZE];
+    IOL::DirectParameterPage1 page1_;   // decoded directParameterPage_
+    uint8_t isPage1Valid_;
+    uint8_t pdInSize_;              // size of the answer (OD, PD and CKS)
+    uint8_t odSize_;                // OD octets of the M-sequence in operate
+    uint8_t mSeqType_;              // M-sequence type in operate
+    uint8_t pdOutSize_;
+    uint8_t pdOut_[IOL::PD_MAX_SIZE];   // last process data output, sent with the ISDU messages
+    IOL::MSequence pdWriteFrame_;   // process data write queued by writePD
+    uint8_t pdWrite_[IOL::PD_MAX_SIZE + IOL::OD_MAX_SIZE];
+    uint8_t pdWritePending_;        // portHandler sends pdWriteFrame_ next
+    IOLIsdu isdu_;
+    IOLEvent events_;               // reads the event memory when the device flags events
+    IOL::MSequence cyclicFrame_;    // process data request of the cycle timer
+    uint8_t odMessage_;             // the awaited answer belongs to an ISDU or event message
+    uint8_t odIsRead_;              // the OD message is in the read direction
+    uint8_t odAnswerSize_;          // size of the answer to the OD message
+    uint32_t pdInCount_;            // process data answers stored so far
+    IOL::MSequence pdReadFrame_;    // process data request of pdInSize_
+    uint8_t pdIn_[IOL::ANSWER_MAX_SIZE];
+    uint8_t pdInLength_;            // size of the stored answer, 0 if none
+    uint8_t pdInValid_;
+    IOLPDRing *pPDRing_;            // every process data answer is published here
+    IOLPDTiming *pPDTiming_;        // every process data exchange is recorded here
+    uint64_t pdInSend_ns_;          // request of the last process data answer started at
+    uint64_t pdInRx_ns_;            // last process data answer completed at
+
+    uint8_t sendRequest(uint8_t mc, uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType, uint32_t timeout_us, RequestKind kind);
+    uint8_t sendRequest(IOL::MSequence const &frame, uint8_t const *pData, uint32_t timeout_us, RequestKind kind);
+    uint8_t sendBurst(IOL::MSequence const *pFrames, uint8_t count, uint32_t timeout_us, RequestKind kind);
+    uint8_t pollAnswer(uint8_t *pData);
+    uint8_t awaitAnswer(uint8_t *pData);
+    uint8_t storePDIn(uint8_t *pData, uint8_t sizeData);
+    void publishPDIn(uint8_t const *pData, uint8_t sizeData);
+    uint8_t isOdBusy();
+    uint8_t isTransmitFree();
+    uint8_t sendOdMessage(uint64_t now, uint8_t reset);
+    uint8_t handleOdAnswer(uint8_t *pData);
+    void checkEventFlag(uint8_t cks);
+    void waitForEvent();
+    void decodePage1();
+    void comError();
+    void enterState(PortState state);
+    void clearMessages();
+    uint8_t saveState(uint8_t valid);
 public: 
     IOLMasterPortMax14819();
 
@@ -66,28 +140,70 @@ public:
 
     uint8_t end();
 
+    uint8_t start();
+
+    uint8_t resume();
+
 	void portHandler();
 
+	uint64_t readWakeupTime();
+
+	PortState readPortState();
+
+	uint64_t readStateTime(PortState state);
+
+	uint8_t readPDIn(uint8_t *pData, uint8_t sizeData);
+
 	void readStatus();
 
 	void sendMCmd();
 
 	uint32_t readComSpeed();
 
+	uint8_t setCycleTime(uint8_t cycleTime);
+
+	uint32_t readCycleTime_us();
+
+	uint8_t readMSequenceSize();
+
+	uint32_t readTransferTime_us();
+
 	void readPage();
 
 	void writePage();
 
-	void readISDU();
+	uint8_t readISDU(uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t *pSize);
 
-	void writeISDU();
+	uint8_t writeISDU(uint16_t index, uint8_t subindex, uint8_t *pData, uint8_t size);
+
+	uint8_t queueISDU(IOLIsdu::Request *pRequest);
+
+	uint8_t transferISDU(IOLIsdu::Request *pRequests, uint8_t count);
+
+	uint8_t readEvent(IOL::Event *pEvent);
 
 	uint8_t readDirectParameterPage(uint8_t address, uint8_t *pData);
 
+	uint8_t readDirectParameterPage1(IOL::DirectParameterPage1 *pPage);
+
 	uint8_t readPD(uint8_t *pData, uint8_t sizeData);
 
+	void setPDRing(IOLPDRing *pRing);
+
+	void setPDTiming(IOLPDTiming *pTiming);
+
+	void readPDTime(uint64_t *pSend_ns, uint64_t *pRx_ns);
+
 	uint8_t writePD(uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType);
 
+	uint8_t enableCyclicPD(uint8_t sizeData, uint8_t cycleTime);
+
+	uint8_t enableTriggeredPD(uint8_t sizeData, uint8_t trigger, uint8_t cycleTime);
+
+	max14819::Max14819 *readDriver();
+
+	uint8_t disableCyclicPD();
+
 	void readDI();
 
 	void readCQ();
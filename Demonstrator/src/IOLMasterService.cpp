@@ -0,0 +1,274 @@
+//!*****************************************************************************
+//!  \file      IOLMasterService.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Service of the ports of one MAX14819. A thread per chip runs
+//!             the port state machines and sleeps on the interrupt pin of
+//!             its chip. The chip is held only while the ports are handled,
+//!             so the wait of one chip overlaps the bus traffic of the
+//!             other. Without threads poll is called from the main loop.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-30
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLMasterService.h"
+#include "IOLink.h"
+
+//!***** Macros *****************************************************************
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLMasterService
+//!*****************************************************************************
+//!  \brief        Constructor, no ports yet
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pDriver             chip of the ports
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLMasterService::IOLMasterService(max14819::Max14819 *pDriver)
+:pDriver_(pDriver),
+ports_(),
+portCount_(0),
+pScheduler_(nullptr)
+#ifndef ARDUINO
+,thread_(),
+isRunning_(false)
+#endif
+{
+}
+
+//!*****************************************************************************
+//!  function :    ~IOLMasterService
+//!*****************************************************************************
+//!  \brief        Destructor, stops the thread
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLMasterService::~IOLMasterService() {
+#ifndef ARDUINO
+    stop();
+#endif
+}
+
+//!*****************************************************************************
+//!  function :    addPort
+//!*****************************************************************************
+//!  \brief        Serve a port of the chip. Only called before start, the
+//!                thread reads the list without locking.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pPort               port on the chip of the service
+//!
+//!  \return       0 if added, 1 if the list is full
+//!
+//!*****************************************************************************
+uint8_t IOLMasterService::addPort(IOLMasterPortMax14819 *pPort) {
+    if ((pPort == nullptr) || (portCount_ >= SERVICE_MAX_PORTS)) {
+        return ERROR;
+    }
+    ports_[portCount_++] = pPort;
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    setScheduler
+//!*****************************************************************************
+//!  \brief        Let a scheduler order the jobs of the ports, shared with
+//!                the services of the other chips. Only called before start.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pScheduler          scheduler, nullptr to serve the
+//!                                     ports in order of their wakeup time
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLMasterService::setScheduler(IOLBusScheduler *pScheduler) {
+    pScheduler_ = pScheduler;
+}
+
+//!*****************************************************************************
+//!  function :    poll
+//!*****************************************************************************
+//!  \brief        Handle all ports once. The interrupt flags are collected
+//!                first, this releases the pin also for the flags of a port
+//!                not served here. An interrupt makes the jobs of all ports
+//!                due, the ports are handled in the order of the scheduler,
+//!                each one as a job of its own on the bus.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       latest time of the next poll (see get_time_ns)
+//!
+//!*****************************************************************************
+uint64_t IOLMasterService::poll() {
+    uint64_t wakeup = UINT64_MAX;
+    uint64_t releases[SERVICE_MAX_PORTS];
+    uint8_t order[SERVICE_MAX_PORTS];
+
+    {
+        max14819::ChipLock lock(pDriver_);
+        uint64_t now = pDriver_->get_time_ns();
+        uint8_t isInterrupt = 0;
+
+        if (pDriver_->waitForInterrupt(0) == SUCCESS) {
+            pDriver_->readInterrupt();
+            isInterrupt = 1;
+        }
+        for (uint8_t i = 0; i < portCount_; i++) {
+            releases[i] = ports_[i]->readWakeupTime();
+            if ((isInterrupt != 0) && (releases[i] > now)) {
+                releases[i] = now;
+            }
+        }
+    }
+
+    // Insertion sort, a chip has two ports
+    for (uint8_t i = 0; i < portCount_; i++) {
+        uint8_t j = i;
+        while ((j > 0) && (isBefore(i, order[j - 1], releases) != 0)) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    for (uint8_t i = 0; i < portCount_; i++) {
+        IOLMasterPortMax14819 *pPort = ports_[order[i]];
+        IOLBusScheduler::Job job(pScheduler_, pPort, releases[order[i]]);
+        pPort->portHandler();
+        uint64_t portWakeup = pPort->readWakeupTime();
+        if (portWakeup < wakeup) {
+            wakeup = portWakeup;
+        }
+    }
+    return wakeup;
+}
+
+//!*****************************************************************************
+//!  function :    isBefore
+//!*****************************************************************************
+//!  \brief        Order of the jobs of two ports, by the scheduler if there
+//!                is one, by their release otherwise
+//!
+//!  \type         local
+//!
+//!  \param[in]	   a                    index of the first port
+//!  \param[in]	   b                    index of the second port
+//!  \param[in]	   *pReleases           release of the job of each port
+//!
+//!  \return       1 if the job of the first port runs first
+//!
+//!*****************************************************************************
+uint8_t IOLMasterService::isBefore(uint8_t a, uint8_t b, uint64_t const *pReleases) {
+    if (pScheduler_ != nullptr) {
+        return pScheduler_->isBefore(ports_[a], pReleases[a], ports_[b], pReleases[b]);
+    }
+    return uint8_t(pReleases[a] < pReleases[b]);
+}
+
+#ifndef ARDUINO
+//!*****************************************************************************
+//!  function :    start
+//!*****************************************************************************
+//!  \brief        Start the thread serving the ports. From now on other
+//!                threads use the ports only through their rings or take
+//!                the chip with each call.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       0 if started, 1 if already running
+//!
+//!*****************************************************************************
+uint8_t IOLMasterService::start() {
+    if (isRunning_.load() || thread_.joinable()) {
+        return ERROR;
+    }
+    isRunning_.store(true);
+    thread_ = std::thread(&IOLMasterService::run, this);
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    stop
+//!*****************************************************************************
+//!  \brief        Stop the thread after its current pass
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLMasterService::stop() {
+    isRunning_.store(false);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+//!*****************************************************************************
+//!  function :    run
+//!*****************************************************************************
+//!  \brief        Thread function. Sleeps on the interrupt pin without
+//!                holding the chip, the next pass starts on an interrupt
+//!                or when a port has to send.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLMasterService::run() {
+    while (isRunning_.load()) {
+        uint64_t wakeup = poll();
+        uint64_t limit = pDriver_->get_time_ns() + uint64_t(SERVICE_MAX_WAIT_US) * max14819::NS_PER_US;
+        pDriver_->waitForInterrupt((wakeup < limit) ? wakeup : limit);
+    }
+}
+#endif
@@ -0,0 +1,94 @@
+//!*****************************************************************************
+//!  \file      IOLMasterService.h
+//!*****************************************************************************
+//!
+//!  \brief		Service of the ports of one MAX14819. A thread per chip runs
+//!             the port state machines and sleeps on the interrupt pin of
+//!             its chip. The chip is held only while the ports are handled,
+//!             so the wait of one chip overlaps the bus traffic of the
+//!             other. Without threads poll is called from the main loop.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-30
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLMASTERSERVICE_H_INCLUDED
+#define IOLMASTERSERVICE_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include "IOLBusScheduler.h"
+#include "IOLMasterPortMax14819.h"
+#include "Max14819.h"
+
+#include <cstdint>
+#ifndef ARDUINO
+#include <atomic>
+#include <thread>
+#endif
+//!***** Macros *****************************************************************
+constexpr uint8_t SERVICE_MAX_PORTS    = 2u;        // ports of one chip
+constexpr uint32_t SERVICE_MAX_WAIT_US = 10000u;    // longest sleep without interrupt, bounds the reaction to stop
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+class IOLMasterService {
+public:
+    explicit IOLMasterService(max14819::Max14819 *pDriver);
+
+    ~IOLMasterService();
+
+    uint8_t addPort(IOLMasterPortMax14819 *pPort);
+
+    void setScheduler(IOLBusScheduler *pScheduler);
+
+    uint64_t poll();
+
+#ifndef ARDUINO
+    uint8_t start();
+
+    void stop();
+#endif
+
+private:
+    max14819::Max14819 *pDriver_;
+    IOLMasterPortMax14819 *ports_[SERVICE_MAX_PORTS];
+    uint8_t portCount_;
+    IOLBusScheduler *pScheduler_;   // orders the jobs of the ports on the bus, may be nullptr
+
+    uint8_t isBefore(uint8_t a, uint8_t b, uint64_t const *pReleases);
+#ifndef ARDUINO
+    std::thread thread_;
+    std::atomic<bool> isRunning_;
+
+    void run();
+#endif
+
+    // Not copyable, the thread refers to the object
+    IOLMasterService(IOLMasterService const &);
+    IOLMasterService & operator=(IOLMasterService const &);
+};
+
+#endif //IOLMASTERSERVICE_H_INCLUDED
@@ -0,0 +1,221 @@
+#ifndef ARDUINO
+
+//!*****************************************************************************
+//!  \file      IOLPDLog.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Binary log of process data samples in a memory mapped ring
+//!             file. The file is preallocated with a header and a fixed
+//!             number of fixed size records, appending a sample is a copy
+//!             into the mapping and an update of the header index, the
+//!             kernel writes the pages back. The oldest records are
+//!             overwritten. tools/PDLogConvert prints the file as CSV or
+//!             Matlab matrix.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-31
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLPDLog.h"
+
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+//!***** Macros *****************************************************************
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+static char const PD_LOG_MAGIC[8] = {'I', 'O', 'L', 'P', 'D', 'L', 'O', 'G'};
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLPDLog
+//!*****************************************************************************
+//!  \brief        Constructor, no file open
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLPDLog::IOLPDLog()
+:pHeader_(nullptr),
+pRecords_(nullptr),
+recordCount_(0),
+head_(0),
+length_(0)
+{
+}
+
+//!*****************************************************************************
+//!  function :    ~IOLPDLog
+//!*****************************************************************************
+//!  \brief        Destructor, closes the file
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLPDLog::~IOLPDLog() {
+    close();
+}
+
+//!*****************************************************************************
+//!  function :    open
+//!*****************************************************************************
+//!  \brief        Create the file with its full length and map it shared.
+//!                An existing file is overwritten, all pages are allocated
+//!                here and not in the cycle.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *path                file name
+//!  \param[in]	   recordCount          records of the ring
+//!  \param[in]	   time_ns              now (see get_time_ns)
+//!
+//!  \return       0 if success
+//!
+//!*****************************************************************************
+uint8_t IOLPDLog::open(char const *path, uint32_t recordCount, uint64_t time_ns) {
+    size_t length = sizeof(PDLogHeader) + size_t(recordCount) * sizeof(PDLogRecord);
+
+    close();
+    if (recordCount == 0) {
+        return ERROR;
+    }
+    int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return ERROR;
+    }
+    // Reserve the blocks, a full disk fails now and not with SIGBUS later
+    if ((ftruncate(fd, off_t(length)) != 0) || (posix_fallocate(fd, 0, off_t(length)) != 0)) {
+        ::close(fd);
+        return ERROR;
+    }
+    void *block = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (block == MAP_FAILED) {
+        return ERROR;
+    }
+
+    pHeader_ = static_cast<PDLogHeader *>(block);
+    pRecords_ = reinterpret_cast<PDLogRecord *>(static_cast<uint8_t *>(block) + sizeof(PDLogHeader));
+    recordCount_ = recordCount;
+    head_ = 0;
+    length_ = length;
+    memset(pHeader_, 0, sizeof(PDLogHeader));
+    memcpy(pHeader_->magic, PD_LOG_MAGIC, sizeof(PD_LOG_MAGIC));
+    pHeader_->version = PD_LOG_VERSION;
+    pHeader_->recordSize = sizeof(PDLogRecord);
+    pHeader_->recordCount = recordCount;
+    pHeader_->created_ns = time_ns;
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    close
+//!*****************************************************************************
+//!  \brief        Write the mapping back and unmap it
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLPDLog::close() {
+    if (pHeader_ == nullptr) {
+        return;
+    }
+    msync(pHeader_, length_, MS_SYNC);
+    munmap(pHeader_, length_);
+    pHeader_ = nullptr;
+    pRecords_ = nullptr;
+    recordCount_ = 0;
+    length_ = 0;
+}
+
+//!*****************************************************************************
+//!  function :    append
+//!*****************************************************************************
+//!  \brief        Copy a sample over the oldest record, only called by one
+//!                writer. The header index is updated after the record, a
+//!                reader of the running log sees complete records up to it.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   port                 port number of the sample
+//!  \param[in]	   sample               sample of the ring of the port
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLPDLog::append(uint8_t port, PDSample const &sample) {
+    if (pHeader_ == nullptr) {
+        return;
+    }
+    PDLogRecord &record = pRecords_[head_ % recordCount_];
+    uint8_t size = (sample.size < PD_LOG_DATA_SIZE) ? sample.size : PD_LOG_DATA_SIZE;
+
+    record.time_ns = sample.time_ns;
+    record.send_ns = sample.send_ns;
+    record.sequence = sample.sequence;
+    record.port = port;
+    record.status = (sample.isValid != 0) ? PD_LOG_STATUS_VALID : 0;
+    record.size = size;
+    record.reserved = 0;
+    memcpy(record.data, sample.data, size);
+    head_++;
+    std::atomic_thread_fence(std::memory_order_release);
+    pHeader_->head = head_;
+}
+
+//!*****************************************************************************
+//!  function :    readAppendCount
+//!*****************************************************************************
+//!  \brief        Returns the records appended since the file was opened
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       number of records
+//!
+//!*****************************************************************************
+uint64_t IOLPDLog::readAppendCount() {
+    return head_;
+}
+
+#endif
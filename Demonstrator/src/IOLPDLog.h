@@ -0,0 +1,111 @@
+//!*****************************************************************************
+//!  \file      IOLPDLog.h
+//!*****************************************************************************
+//!
+//!  \brief		Binary log of process data samples in a memory mapped ring
+//!             file. The file is preallocated with a header and a fixed
+//!             number of fixed size records, appending a sample is a copy
+//!             into the mapping and an update of the header index, the
+//!             kernel writes the pages back. The oldest records are
+//!             overwritten. tools/PDLogConvert prints the file as CSV or
+//!             Matlab matrix.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-31
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLPDLOG_H_INCLUDED
+#define IOLPDLOG_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include "IOLPDRing.h"
+
+#include <cstddef>
+#include <cstdint>
+//!***** Macros *****************************************************************
+constexpr uint32_t PD_LOG_VERSION       = 1u;
+constexpr uint8_t PD_LOG_DATA_SIZE      = 72u;      // octets of a record, IOL::ANSWER_MAX_SIZE rounded up
+constexpr uint32_t PD_LOG_RECORDS       = 65536u;   // default records of a file, 6 MiB
+constexpr uint8_t PD_LOG_STATUS_VALID   = 0x01u;    // PD valid bit of the CKS
+
+static_assert(PD_LOG_DATA_SIZE >= IOL::ANSWER_MAX_SIZE, "PD_LOG_DATA_SIZE must hold an answer");
+
+//!***** Data types *************************************************************
+// Start of the file, little endian as written by the master
+struct PDLogHeader {
+    char magic[8];              // "IOLPDLOG"
+    uint32_t version;           // PD_LOG_VERSION
+    uint32_t recordSize;        // sizeof(PDLogRecord)
+    uint32_t recordCount;       // records of the ring
+    uint32_t reserved;
+    uint64_t head;              // records appended so far, the next one goes to head % recordCount
+    uint64_t created_ns;        // opened at (see get_time_ns)
+    uint8_t padding[24];
+};
+
+// One process data sample, see PDSample
+struct PDLogRecord {
+    uint64_t time_ns;           // answer completed at
+    uint64_t send_ns;           // request started at
+    uint32_t sequence;          // sequence of the sample in the ring of its port
+    uint8_t port;               // port number 0 to 3
+    uint8_t status;             // PD_LOG_STATUS_x
+    uint8_t size;               // octets in data
+    uint8_t reserved;
+    uint8_t data[PD_LOG_DATA_SIZE];     // OD, PD and CKS
+};
+
+static_assert(sizeof(PDLogHeader) == 64u, "PDLogHeader is part of the file format");
+static_assert(sizeof(PDLogRecord) == 96u, "PDLogRecord is part of the file format");
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+#ifndef ARDUINO
+class IOLPDLog {
+public:
+    IOLPDLog();
+    ~IOLPDLog();
+
+    uint8_t open(char const *path, uint32_t recordCount, uint64_t time_ns);
+
+    void close();
+
+    void append(uint8_t port, PDSample const &sample);
+
+    uint64_t readAppendCount();
+
+private:
+    PDLogHeader *pHeader_;      // start of the mapping, nullptr if closed
+    PDLogRecord *pRecords_;
+    uint32_t recordCount_;
+    uint64_t head_;             // records appended, only the writer changes it
+    size_t length_;             // of the mapping
+
+    // Not copyable, owns the mapping
+    IOLPDLog(IOLPDLog const &);
+    IOLPDLog & operator=(IOLPDLog const &);
+};
+#endif
+
+#endif //IOLPDLOG_H_INCLUDED
@@ -0,0 +1,228 @@
+//!*****************************************************************************
+//!  \file      IOLPDRing.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Ring of process data input samples of a port. The cycle
+//!             context publishes every answer with its time and validity,
+//!             any number of consumers read at their own pace with a
+//!             cursor of their own. A consumer that falls behind by more
+//!             than the ring loses the oldest samples and counts them.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-27
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLPDRing.h"
+
+//!***** Macros *****************************************************************
+static_assert((PD_RING_SIZE & (PD_RING_SIZE - 1u)) == 0, "PD_RING_SIZE must be a power of two");
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLPDRing
+//!*****************************************************************************
+//!  \brief        Constructor, no sample published yet
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLPDRing::IOLPDRing()
+:head_(0)
+{
+    for (uint16_t i = 0; i < PD_RING_SIZE; i++) {
+        slots_[i].stamp.store(0, std::memory_order_relaxed);
+        slots_[i].sample = PDSample();
+    }
+}
+
+//!*****************************************************************************
+//!  function :    publish
+//!*****************************************************************************
+//!  \brief        Store a sample over the oldest one, only called by the
+//!                cycle context of the port. Never waits for the consumers,
+//!                the odd stamp tells them the slot is being written.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   time_ns              completion of the answer
+//!  \param[in]	   send_ns              start of the request
+//!  \param[in]	   isValid              PD valid bit of the CKS
+//!  \param[in]	   *pData               answer (OD, PD and CKS)
+//!  \param[in]	   size                 size of the answer
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLPDRing::publish(uint64_t time_ns, uint64_t send_ns, uint8_t isValid, uint8_t const *pData, uint8_t size) {
+    uint32_t sequence = head_.load(std::memory_order_relaxed);
+    Slot &slot = slots_[sequence & (PD_RING_SIZE - 1u)];
+
+    if (size > IOL::ANSWER_MAX_SIZE) {
+        size = IOL::ANSWER_MAX_SIZE;
+    }
+    slot.stamp.store(2u * sequence + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.sample.time_ns = time_ns;
+    slot.sample.send_ns = send_ns;
+    slot.sample.sequence = sequence;
+    slot.sample.isValid = isValid;
+    slot.sample.size = size;
+    for (uint8_t i = 0; i < size; i++) {
+        slot.sample.data[i] = pData[i];
+    }
+    slot.stamp.store(2u * sequence + 2u, std::memory_order_release);
+    head_.store(sequence + 1u, std::memory_order_release);
+}
+
+//!*****************************************************************************
+//!  function :    attach
+//!*****************************************************************************
+//!  \brief        Start a consumer at the next published sample
+//!
+//!  \type         local
+//!
+//!  \param[out]   *pCursor             read position of the consumer
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLPDRing::attach(PDCursor *pCursor) {
+    pCursor->next = head_.load(std::memory_order_acquire);
+    pCursor->overruns = 0;
+}
+
+//!*****************************************************************************
+//!  function :    read
+//!*****************************************************************************
+//!  \brief        Take the next sample of a consumer. Samples overwritten
+//!                before the consumer got to them are skipped and counted
+//!                in the overruns of the cursor.
+//!
+//!  \type         local
+//!
+//!  \param[in,out] *pCursor            read position of the consumer
+//!  \param[out]   *pSample             sample
+//!
+//!  \return       0 if a sample was taken, 2 if there is no new sample
+//!
+//!*****************************************************************************
+uint8_t IOLPDRing::read(PDCursor *pCursor, PDSample *pSample) {
+    for (;;) {
+        uint32_t head = head_.load(std::memory_order_acquire);
+        if (pCursor->next == head) {
+            return PENDING;
+        }
+        if (uint32_t(head - pCursor->next) > PD_RING_SIZE) {
+            pCursor->overruns += uint32_t(head - pCursor->next - PD_RING_SIZE);
+            pCursor->next = uint32_t(head - PD_RING_SIZE);
+        }
+        if (copySlot(pCursor->next, pSample) == SUCCESS) {
+            pCursor->next++;
+            return SUCCESS;
+        }
+        // Overwritten while reading, the sample is lost
+        pCursor->overruns++;
+        pCursor->next++;
+    }
+}
+
+//!*****************************************************************************
+//!  function :    readLatest
+//!*****************************************************************************
+//!  \brief        Take the newest sample, for consumers that only need the
+//!                current value
+//!
+//!  \type         local
+//!
+//!  \param[out]   *pSample             sample
+//!
+//!  \return       0 if a sample was taken, 2 if none was published yet
+//!
+//!*****************************************************************************
+uint8_t IOLPDRing::readLatest(PDSample *pSample) {
+    for (;;) {
+        uint32_t head = head_.load(std::memory_order_acquire);
+        if (head == 0) {
+            return PENDING;
+        }
+        if (copySlot(head - 1u, pSample) == SUCCESS) {
+            return SUCCESS;
+        }
+    }
+}
+
+//!*****************************************************************************
+//!  function :    readPublishCount
+//!*****************************************************************************
+//!  \brief        Returns the samples published so far
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       number of samples
+//!
+//!*****************************************************************************
+uint32_t IOLPDRing::readPublishCount() {
+    return head_.load(std::memory_order_relaxed);
+}
+
+//!*****************************************************************************
+//!  function :    copySlot
+//!*****************************************************************************
+//!  \brief        Copy a sample if it is still in its slot. The stamp is
+//!                compared before and after the copy, a change means the
+//!                producer overwrote the slot meanwhile.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   sequence             sequence of the sample
+//!  \param[out]   *pSample             sample
+//!
+//!  \return       0 if copied, 1 if the slot holds another sample
+//!
+//!*****************************************************************************
+uint8_t IOLPDRing::copySlot(uint32_t sequence, PDSample *pSample) {
+    Slot const &slot = slots_[sequence & (PD_RING_SIZE - 1u)];
+    uint32_t stamp = slot.stamp.load(std::memory_order_acquire);
+
+    if (stamp != 2u * sequence + 2u) {
+        return ERROR;
+    }
+    *pSample = slot.sample;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.stamp.load(std::memory_order_relaxed) != stamp) {
+        return ERROR;
+    }
+    return SUCCESS;
+}
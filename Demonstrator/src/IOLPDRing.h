@@ -0,0 +1,96 @@
+//!*****************************************************************************
+//!  \file      IOLPDRing.h
+//!*****************************************************************************
+//!
+//!  \brief		Ring of process data input samples of a port. The cycle
+//!             context publishes every answer with its time and validity,
+//!             any number of consumers read at their own pace with a
+//!             cursor of their own. A consumer that falls behind by more
+//!             than the ring loses the oldest samples and counts them.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-27
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLPDRING_H_INCLUDED
+#define IOLPDRING_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include "IOLink.h"
+
+#include <atomic>
+#include <cstdint>
+//!***** Macros *****************************************************************
+constexpr uint16_t PD_RING_SIZE = 32u;          // samples per port, power of two
+
+//!***** Data types *************************************************************
+// Process data answer as readPD returns it
+struct PDSample {
+    uint64_t time_ns;           // answer completed at, RxDataRdy (see get_time_ns)
+    uint64_t send_ns;           // request started at, CQSend or trigger, estimated for the cycle timer
+    uint32_t sequence;          // number of the sample since the ring was created
+    uint8_t isValid;            // PD valid bit of the CKS
+    uint8_t size;               // octets in data
+    uint8_t data[IOL::ANSWER_MAX_SIZE];   // OD, PD and CKS
+};
+
+// Read position of one consumer
+struct PDCursor {
+    uint32_t next;              // sequence of the next sample to read
+    uint32_t overruns;          // samples overwritten before they were read
+};
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+class IOLPDRing {
+public:
+    IOLPDRing();
+
+    void publish(uint64_t time_ns, uint64_t send_ns, uint8_t isValid, uint8_t const *pData, uint8_t size);
+
+    void attach(PDCursor *pCursor);
+
+    uint8_t read(PDCursor *pCursor, PDSample *pSample);
+
+    uint8_t readLatest(PDSample *pSample);
+
+    uint32_t readPublishCount();
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> stamp;    // 2 * sequence + 2 when written, odd while writing
+        PDSample sample;
+    };
+
+    Slot slots_[PD_RING_SIZE];
+    std::atomic<uint32_t> head_;        // sequence of the next sample to publish
+
+    uint8_t copySlot(uint32_t sequence, PDSample *pSample);
+
+    // Not copyable, the consumers refer to the ring
+    IOLPDRing(IOLPDRing const &);
+    IOLPDRing & operator=(IOLPDRing const &);
+};
+
+#endif //IOLPDRING_H_INCLUDED
@@ -0,0 +1,148 @@
+//!*****************************************************************************
+//!  \file      IOLPDTiming.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Timing of the process data exchanges of a port. Every
+//!             answer is recorded with the start of its request (CQSend or
+//!             trigger) and its completion (RxDataRdy), both taken from the
+//!             monotonic clock of the HAL. The latency and the jitter of the
+//!             request period against the cycle time are kept in fixed
+//!             size histograms, queried at runtime.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-31
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLPDTiming.h"
+#include "Max14819.h"
+
+//!***** Macros *****************************************************************
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLPDTiming
+//!*****************************************************************************
+//!  \brief        Constructor, nothing recorded yet
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLPDTiming::IOLPDTiming()
+:prevSend_ns_(0),
+lastRx_ns_(0)
+{
+}
+
+//!*****************************************************************************
+//!  function :    record
+//!*****************************************************************************
+//!  \brief        Record one exchange, only called by the cycle context of
+//!                the port. The first request has no period, a request
+//!                started at the same time as the previous one (answer read
+//!                twice) adds no jitter. A start estimated from the answer
+//!                (cycle timer) gives no latency, only the period.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   send_ns              start of the request
+//!  \param[in]	   rx_ns                completion of the answer
+//!  \param[in]	   cycle_us             target cycle time
+//!  \param[in]	   isSendMeasured       0 if send_ns is an estimate
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLPDTiming::record(uint64_t send_ns, uint64_t rx_ns, uint32_t cycle_us, uint8_t isSendMeasured) {
+    if ((isSendMeasured != 0) && (rx_ns >= send_ns)) {
+        latency_.record(uint32_t((rx_ns - send_ns) / max14819::NS_PER_US));
+    }
+    if ((prevSend_ns_ != 0) && (send_ns > prevSend_ns_)) {
+        uint64_t period_ns = send_ns - prevSend_ns_;
+        uint64_t cycle_ns = uint64_t(cycle_us) * max14819::NS_PER_US;
+        uint64_t deviation_ns = (period_ns > cycle_ns) ? (period_ns - cycle_ns) : (cycle_ns - period_ns);
+        jitter_.record(uint32_t(deviation_ns / max14819::NS_PER_US));
+    }
+    prevSend_ns_ = send_ns;
+    lastRx_ns_.store(rx_ns, std::memory_order_relaxed);
+}
+
+//!*****************************************************************************
+//!  function :    readLatency
+//!*****************************************************************************
+//!  \brief        Histogram of the time from the start of a request to the
+//!                completion of its answer
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       histogram in microseconds
+//!
+//!*****************************************************************************
+IOLHistogram & IOLPDTiming::readLatency() {
+    return latency_;
+}
+
+//!*****************************************************************************
+//!  function :    readJitter
+//!*****************************************************************************
+//!  \brief        Histogram of the deviation of the period between two
+//!                requests from the cycle time
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       histogram in microseconds
+//!
+//!*****************************************************************************
+IOLHistogram & IOLPDTiming::readJitter() {
+    return jitter_;
+}
+
+//!*****************************************************************************
+//!  function :    readLastRxTime
+//!*****************************************************************************
+//!  \brief        Returns the completion of the last recorded answer, the
+//!                age of the process data is now minus this time
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       time in nanoseconds (see get_time_ns), 0 if none
+//!
+//!*****************************************************************************
+uint64_t IOLPDTiming::readLastRxTime() {
+    return lastRx_ns_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,74 @@
+//!*****************************************************************************
+//!  \file      IOLPDTiming.h
+//!*****************************************************************************
+//!
+//!  \brief		Timing of the process data exchanges of a port. Every
+//!             answer is recorded with the start of its request (CQSend or
+//!             trigger) and its completion (RxDataRdy), both taken from the
+//!             monotonic clock of the HAL. The latency and the jitter of the
+//!             request period against the cycle time are kept in fixed
+//!             size histograms, queried at runtime.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-31
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLPDTIMING_H_INCLUDED
+#define IOLPDTIMING_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include "IOLHistogram.h"
+
+#include <atomic>
+#include <cstdint>
+//!***** Macros *****************************************************************
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+class IOLPDTiming {
+public:
+    IOLPDTiming();
+
+    void record(uint64_t send_ns, uint64_t rx_ns, uint32_t cycle_us, uint8_t isSendMeasured);
+
+    IOLHistogram & readLatency();
+
+    IOLHistogram & readJitter();
+
+    uint64_t readLastRxTime();
+
+private:
+    IOLHistogram latency_;              // completion of the answer minus start of the request
+    IOLHistogram jitter_;               // deviation of the request period from the cycle time
+    uint64_t prevSend_ns_;              // start of the previous request, producer only
+    std::atomic<uint64_t> lastRx_ns_;   // completion of the last answer
+
+    // Not copyable, the consumers refer to the histograms
+    IOLPDTiming(IOLPDTiming const &);
+    IOLPDTiming & operator=(IOLPDTiming const &);
+};
+
+#endif //IOLPDTIMING_H_INCLUDED
@@ -0,0 +1,210 @@
+//!*****************************************************************************
+//!  \file      IOLSyncGroup.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Ports sampled at the same instant. Every member gets its
+//!             process data request started by the same trigger of its
+//!             MAX14819 (Trigger and TrigAssgnA/B), one register write per
+//!             chip starts the requests of all members of the chip. The
+//!             time between the writes of the chips is the skew of a cycle.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-31
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!***** Header-Files ***********************************************************
+#include "IOLSyncGroup.h"
+#include "IOLink.h"
+
+//!***** Macros *****************************************************************
+
+//!***** Data types *************************************************************
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+//!*****************************************************************************
+//!  function :    IOLSyncGroup
+//!*****************************************************************************
+//!  \brief        Constructor, no ports yet. The first cycle starts with the
+//!                first call of fire.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   trigger              0 to max14819::TRIGGER_COUNT - 1
+//!  \param[in]	   cycleTime            cycle time in IO-Link encoding
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+IOLSyncGroup::IOLSyncGroup(uint8_t trigger, uint8_t cycleTime)
+:trigger_(trigger),
+cycleTime_(cycleTime),
+ports_(),
+portCount_(0),
+chips_(),
+chipCount_(0),
+pScheduler_(nullptr),
+nextTime_ns_(0),
+stats_()
+{
+}
+
+//!*****************************************************************************
+//!  function :    addPort
+//!*****************************************************************************
+//!  \brief        Let the trigger of the group start the process data
+//!                requests of a port in operate (see enableTriggeredPD)
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pPort               port in operate
+//!  \param[in]	   sizeData             size of the answer (OD, PD and CKS)
+//!
+//!  \return       0 if added, 1 if the group is full or the port failed
+//!
+//!*****************************************************************************
+uint8_t IOLSyncGroup::addPort(IOLMasterPortMax14819 *pPort, uint8_t sizeData) {
+    if ((pPort == nullptr) || (portCount_ >= SYNC_MAX_PORTS)) {
+        return ERROR;
+    }
+    max14819::Max14819 *pDriver = pPort->readDriver();
+    uint8_t chip = 0;
+    while ((chip < chipCount_) && (chips_[chip] != pDriver)) {
+        chip++;
+    }
+    if ((chip == chipCount_) && (chipCount_ >= SYNC_MAX_CHIPS)) {
+        return ERROR;
+    }
+    if (pPort->enableTriggeredPD(sizeData, trigger_, cycleTime_) == ERROR) {
+        return ERROR;
+    }
+    if (chip == chipCount_) {
+        chips_[chipCount_++] = pDriver;
+    }
+    ports_[portCount_++] = pPort;
+    return SUCCESS;
+}
+
+//!*****************************************************************************
+//!  function :    setScheduler
+//!*****************************************************************************
+//!  \brief        Write the triggers as one job of the first port, no other
+//!                scheduled job gets between the writes of the chips
+//!
+//!  \type         local
+//!
+//!  \param[in]	   *pScheduler          scheduler, nullptr to write unscheduled
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLSyncGroup::setScheduler(IOLBusScheduler *pScheduler) {
+    pScheduler_ = pScheduler;
+}
+
+//!*****************************************************************************
+//!  function :    fire
+//!*****************************************************************************
+//!  \brief        Start a cycle: write the trigger to every chip of the
+//!                group, the chips are written back to back. The next cycle
+//!                is planned one cycle time later, a late cycle is not
+//!                caught up.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       0 if all writes succeeded
+//!
+//!*****************************************************************************
+uint8_t IOLSyncGroup::fire() {
+    uint8_t retValue = SUCCESS;
+    uint64_t first_ns = 0;
+    uint64_t last_ns = 0;
+
+    if (portCount_ == 0) {
+        return ERROR;
+    }
+    {
+        uint64_t release_ns = (nextTime_ns_ != 0) ? nextTime_ns_ : chips_[0]->get_time_ns();
+        IOLBusScheduler::Job job(pScheduler_, ports_[0], release_ns);
+        for (uint8_t i = 0; i < chipCount_; i++) {
+            max14819::ChipLock lock(chips_[i]);
+            retValue = uint8_t(retValue | chips_[i]->fireTrigger(trigger_, &last_ns));
+            if (i == 0) {
+                first_ns = last_ns;
+            }
+        }
+    }
+
+    uint32_t skew_ns = ((last_ns - first_ns) > UINT32_MAX) ? UINT32_MAX : uint32_t(last_ns - first_ns);
+    stats_.cycles++;
+    stats_.writes += chipCount_;
+    stats_.lastTime_ns = first_ns;
+    stats_.lastSkew_ns = skew_ns;
+    if (skew_ns > stats_.maxSkew_ns) {
+        stats_.maxSkew_ns = skew_ns;
+    }
+
+    uint64_t cycle_ns = uint64_t(IOL::cycleTimeToUs(cycleTime_)) * max14819::NS_PER_US;
+    nextTime_ns_ += cycle_ns;
+    if (nextTime_ns_ <= last_ns) {
+        nextTime_ns_ = first_ns + cycle_ns;
+    }
+    return retValue;
+}
+
+//!*****************************************************************************
+//!  function :    readNextTime
+//!*****************************************************************************
+//!  \brief        Returns the planned start of the next cycle
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       time in nanoseconds (see get_time_ns), 0 before the first
+//!
+//!*****************************************************************************
+uint64_t IOLSyncGroup::readNextTime() {
+    return nextTime_ns_;
+}
+
+//!*****************************************************************************
+//!  function :    readStats
+//!*****************************************************************************
+//!  \brief        Copy the counters of the group, only called by the thread
+//!                calling fire
+//!
+//!  \type         local
+//!
+//!  \param[out]   *pStats              counters
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void IOLSyncGroup::readStats(SyncStats *pStats) {
+    *pStats = stats_;
+}
@@ -0,0 +1,87 @@
+//!*****************************************************************************
+//!  \file      IOLSyncGroup.h
+//!*****************************************************************************
+//!
+//!  \brief		Ports sampled at the same instant. Every member gets its
+//!             process data request started by the same trigger of its
+//!             MAX14819 (Trigger and TrigAssgnA/B), one register write per
+//!             chip starts the requests of all members of the chip. The
+//!             time between the writes of the chips is the skew of a cycle.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-31
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef IOLSYNCGROUP_H_INCLUDED
+#define IOLSYNCGROUP_H_INCLUDED
+
+//!***** Header-Files ***********************************************************
+#include "IOLBusScheduler.h"
+#include "IOLMasterPortMax14819.h"
+#include "Max14819.h"
+
+#include <cstdint>
+//!***** Macros *****************************************************************
+constexpr uint8_t SYNC_MAX_PORTS = 4u;      // ports of both chips
+constexpr uint8_t SYNC_MAX_CHIPS = 2u;
+
+//!***** Data types *************************************************************
+// Cycles of a group, the time of each sample is in its PDSample
+struct SyncStats {
+    uint32_t cycles;            // cycles started with fire
+    uint32_t writes;            // Trigger writes on the bus, one per chip and cycle
+    uint64_t lastTime_ns;       // first write of the last cycle (see get_time_ns)
+    uint32_t lastSkew_ns;       // first to last write of the last cycle
+    uint32_t maxSkew_ns;
+};
+
+//!***** Function prototypes ****************************************************
+
+//!***** Data *******************************************************************
+
+//!***** Implementation *********************************************************
+
+class IOLSyncGroup {
+public:
+    IOLSyncGroup(uint8_t trigger, uint8_t cycleTime);
+
+    uint8_t addPort(IOLMasterPortMax14819 *pPort, uint8_t sizeData);
+
+    void setScheduler(IOLBusScheduler *pScheduler);
+
+    uint8_t fire();
+
+    uint64_t readNextTime();
+
+    void readStats(SyncStats *pStats);
+
+private:
+    uint8_t trigger_;
+    uint8_t cycleTime_;             // IO-Link encoding
+    IOLMasterPortMax14819 *ports_[SYNC_MAX_PORTS];
+    uint8_t portCount_;
+    max14819::Max14819 *chips_[SYNC_MAX_CHIPS];
+    uint8_t chipCount_;
+    IOLBusScheduler *pScheduler_;   // keeps other jobs off the bus between the writes, may be nullptr
+    uint64_t nextTime_ns_;          // planned start of the next cycle
+    SyncStats stats_;
+};
+
+#endif //IOLSYNCGROUP_H_INCLUDED
@@ -32,6 +32,11 @@
 //!***** Header-Files ***********************************************************
 #include <cstdint>
 
+// Error define
+constexpr uint8_t ERROR             = 1u;
+constexpr uint8_t SUCCESS           = 0u;
+constexpr uint8_t PENDING           = 2u;    // non-blocking step not finished yet
+
 namespace IOL{
     // IO-Link M-Sequence Types
     constexpr uint8_t M_TYPE_0          = 0u;
@@ -39,9 +44,21 @@ namespace IOL{
     constexpr uint8_t M_TYPE_2_X        = 2u;
 
     constexpr uint8_t PD_VALID_BIT      = 0x40u;
+    constexpr uint8_t EVENT_BIT         = 0x80u;     // CKS of the device, events are pending
+    constexpr uint8_t PD_MAX_SIZE       = 32u;       // maximal process data length in byte
+    constexpr uint8_t PAGE1_SIZE        = 16u;       // octets of the direct parameter page 1
+    constexpr uint8_t OD_MAX_SIZE       = 32u;       // maximal on-request data octets of an M-sequence
+    constexpr uint8_t ANSWER_MAX_SIZE   = PD_MAX_SIZE + OD_MAX_SIZE + 1u;   // OD, PD and CKS
     namespace MC{
         constexpr uint8_t PD_READ       = 0x80u;
         constexpr uint8_t WRITE         = 0x20u;
+        constexpr uint8_t PAGE_READ     = 0xA0u;     // read direct parameter page, or with address
+        constexpr uint8_t PAGE_ADDRESS  = 0x1Fu;     // address bits of PAGE_READ
+        constexpr uint8_t READ          = 0x80u;     // bit 7, read access
+        constexpr uint8_t ISDU_WRITE    = 0x60u;     // ISDU channel, or with flow control
+        constexpr uint8_t ISDU_READ     = 0xE0u;     // ISDU channel, or with flow control
+        constexpr uint8_t DIAG_WRITE    = 0x40u;     // diagnosis channel, or with the event memory address
+        constexpr uint8_t DIAG_READ     = 0xC0u;     // diagnosis channel, or with the event memory address
 
         constexpr uint8_t DEV_FALLBACK  = 0x5Au;
         constexpr uint8_t MAS_IDENT     = 0x95u;
@@ -68,6 +85,299 @@ namespace IOL{
         constexpr uint8_t FUNCTION_ID2  = 0x0Du;
         constexpr uint8_t SYSTEM_CMD    = 0x0Fu;
     }
+    namespace ISDU{
+        // Flow control in the address bits of the MC
+        constexpr uint8_t FLOW_COUNT    = 0x0Fu;     // segment counter
+        constexpr uint8_t FLOW_START    = 0x10u;
+        constexpr uint8_t FLOW_IDLE_1   = 0x11u;
+        constexpr uint8_t FLOW_IDLE_2   = 0x12u;
+        constexpr uint8_t FLOW_ABORT    = 0x1Fu;
+
+        // I-Service in bit 7:4 of the first octet, the length in bit 3:0
+        constexpr uint8_t NO_SERVICE    = 0x00u;     // whole first octet, device idle
+        constexpr uint8_t BUSY          = 0x01u;     // whole first octet, response not ready
+        constexpr uint8_t READ_8        = 0x1u;      // 8 bit index
+        constexpr uint8_t READ_8_SUB    = 0x2u;      // 8 bit index and subindex
+        constexpr uint8_t READ_16_SUB   = 0x3u;      // 16 bit index and subindex
+        constexpr uint8_t WRITE_NEG     = 0x4u;
+        constexpr uint8_t WRITE_POS     = 0x5u;
+        constexpr uint8_t WRITE_8       = 0x9u;
+        constexpr uint8_t WRITE_8_SUB   = 0xAu;
+        constexpr uint8_t WRITE_16_SUB  = 0xBu;
+        constexpr uint8_t READ_NEG      = 0xCu;
+        constexpr uint8_t READ_POS      = 0xDu;
+        constexpr uint8_t LENGTH        = 0x0Fu;
+        constexpr uint8_t LENGTH_EXT    = 0x01u;     // length in the second octet
+
+        constexpr uint8_t MAX_SIZE      = 238u;      // octets of an ISDU including CHKPDU
+        constexpr uint8_t MAX_DATA_SIZE = 232u;      // data octets of a write request
+
+        // ErrorCode and AdditionalCode of a negative response
+        constexpr uint16_t ERROR_APP            = 0x8000u;
+        constexpr uint16_t ERROR_IDX_NOTAVAIL   = 0x8011u;
+        constexpr uint16_t ERROR_SUBIDX_NOTAVAIL= 0x8012u;
+        constexpr uint16_t ERROR_ACCESS_DENIED  = 0x8023u;
+        constexpr uint16_t ERROR_VAL_LENOVRRUN  = 0x8033u;
+        constexpr uint16_t ERROR_VAL_LENUNDRUN  = 0x8034u;
+    }
+    // Event memory of the device, read over the diagnosis channel: the
+    // StatusCode and six slots of EventQualifier, EventCode MSB and LSB
+    namespace EVENT{
+        constexpr uint8_t STATUS_CODE   = 0x00u;     // address of the StatusCode, written to confirm
+        constexpr uint8_t STATUS_DETAILS= 0x80u;     // StatusCode type 2, the slots hold the events
+        constexpr uint8_t STATUS_SLOTS  = 0x3Fu;     // one bit per slot in use
+        constexpr uint8_t SLOT_COUNT    = 6u;
+        constexpr uint8_t SLOT_SIZE     = 3u;        // octets of a slot, the first at address 1
+        constexpr uint8_t MEMORY_SIZE   = 1u + SLOT_COUNT * SLOT_SIZE;
+
+        // EventQualifier: bit 7:6 mode, bit 5:4 type, bit 3 source, bit 2:0 instance
+        constexpr uint8_t MODE_SINGLE_SHOT  = 0x40u;
+        constexpr uint8_t TYPE_NOTIFICATION = 0x10u;
+        constexpr uint8_t INSTANCE_APP      = 0x04u;
+
+        constexpr uint16_t DS_UPLOAD_REQ    = 0xFF91u;   // parameters changed on the device
+    }
+    // Subindices and values of the Data Storage index, see IO-Link
+    // Specification 10.4.5
+    namespace DS{
+        constexpr uint8_t SUB_COMMAND       = 1u;        // DS_Command, write only
+        constexpr uint8_t SUB_STATE         = 2u;        // State_Property
+        constexpr uint8_t SUB_SIZE          = 3u;        // Data_Storage_Size, 32 bit
+        constexpr uint8_t SUB_CHECKSUM      = 4u;        // Parameter_Checksum, 32 bit
+        constexpr uint8_t SUB_INDEX_LIST    = 5u;        // Index_List, terminated by index 0
+
+        constexpr uint8_t CMD_UPLOAD_START  = 0x01u;
+        constexpr uint8_t CMD_UPLOAD_END    = 0x02u;
+        constexpr uint8_t CMD_DOWNLOAD_START= 0x03u;
+        constexpr uint8_t CMD_DOWNLOAD_END  = 0x04u;
+        constexpr uint8_t CMD_BREAK         = 0x05u;
+
+        // State_Property: bit 7 DS_UPLOAD_FLAG, bit 2:1 state of the device
+        constexpr uint8_t STATE_UPLOAD_FLAG = 0x80u;
+        constexpr uint8_t STATE_MASK        = 0x06u;
+        constexpr uint8_t STATE_INACTIVE    = 0x00u;
+        constexpr uint8_t STATE_DOWNLOAD    = 0x02u;
+        constexpr uint8_t STATE_UPLOAD      = 0x04u;
+        constexpr uint8_t STATE_LOCKED      = 0x06u;
+
+        constexpr uint8_t ENTRY_SIZE        = 3u;        // index and subindex of an Index_List entry
+    }
+
+    // Indices of the ISDU parameters
+    namespace INDEX{
+        constexpr uint16_t SYSTEM_COMMAND       = 0x0002u;
+        constexpr uint16_t DATA_STORAGE         = 0x0003u;
+        constexpr uint16_t DEVICE_ACCESS_LOCKS  = 0x000Cu;
+        constexpr uint16_t PROFILE_CHARACTERISTIC= 0x000Du;
+        constexpr uint16_t PD_INPUT_DESCRIPTOR  = 0x000Eu;
+        constexpr uint16_t PD_OUTPUT_DESCRIPTOR = 0x000Fu;
+        constexpr uint16_t VENDOR_NAME          = 0x0010u;
+        constexpr uint16_t VENDOR_TEXT          = 0x0011u;
+        constexpr uint16_t PRODUCT_NAME         = 0x0012u;
+        constexpr uint16_t PRODUCT_ID           = 0x0013u;
+        constexpr uint16_t PRODUCT_TEXT         = 0x0014u;
+        constexpr uint16_t SERIAL_NUMBER        = 0x0015u;
+        constexpr uint16_t HARDWARE_REVISION    = 0x0016u;
+        constexpr uint16_t FIRMWARE_REVISION    = 0x0017u;
+        constexpr uint16_t APPLICATION_TAG      = 0x0018u;
+    }
+
+    // M-sequence capability of the direct parameter page 1:
+    // bit 0 ISDU supported, bit 3:1 OPERATE code, bit 5:4 PREOPERATE code
+    constexpr uint8_t M_SEQ_CAP_ISDU    = 0x01u;
+    constexpr uint8_t M_SEQ_CAP_OPERATE = 0x0Eu;
+
+    // Cycle time encoding of MAS_CYCLE_TIME and MIN_CYCLE_TIME:
+    // bit 7:6 time base, bit 5:0 multiplier
+    constexpr uint8_t CYCLE_TIME_BASE   = 0xC0u;
+    constexpr uint8_t CYCLE_TIME_MULT   = 0x3Fu;
+
+    // Process data length encoding of PD_IN and PD_OUT:
+    // bit 7 SIO, bit 6 BYTE, bit 4:0 LENGTH
+    constexpr uint8_t PD_LENGTH_BYTE    = 0x40u;
+    constexpr uint8_t PD_LENGTH         = 0x1Fu;
+
+    //!*************************************************************************
+    //!  \brief    Convert an encoded process data length to bytes
+    //!             (LENGTH + 1 bytes if BYTE is set, otherwise LENGTH bits).
+    //!*************************************************************************
+    constexpr uint8_t pdLengthToBytes(uint8_t pdLength) {
+        return ((pdLength & PD_LENGTH_BYTE) != 0) ? uint8_t((pdLength & PD_LENGTH) + 1u)
+             : uint8_t(((pdLength & PD_LENGTH) + 7u) / 8u);
+    }
+
+    //!*************************************************************************
+    //!  \brief    Convert an encoded cycle time to microseconds
+    //!             (0.1ms base, 6.4ms + 0.4ms base, 32ms + 1.6ms base).
+    //!*************************************************************************
+    constexpr uint32_t cycleTimeToUs(uint8_t cycleTime) {
+        return ((cycleTime & CYCLE_TIME_BASE) == 0x00u) ? uint32_t(cycleTime & CYCLE_TIME_MULT) * 100u
+             : ((cycleTime & CYCLE_TIME_BASE) == 0x40u) ? 6400u + uint32_t(cycleTime & CYCLE_TIME_MULT) * 400u
+             : 32000u + uint32_t(cycleTime & CYCLE_TIME_MULT) * 1600u;
+    }
+
+    //!*************************************************************************
+    //!  \brief    On-request data octets of the OPERATE M-sequence, see
+    //!             IO-Link Specification A.2.6 (TYPE_0/TYPE_2_1..6: 1,
+    //!             TYPE_1_2: 2, TYPE_x_V: 1, 2, 8 or 32 by the code).
+    //!*************************************************************************
+    constexpr uint8_t odSizeOperate(uint8_t mSeqCap) {
+        return (((mSeqCap & M_SEQ_CAP_OPERATE) >> 1) == 1u) ? 2u
+             : (((mSeqCap & M_SEQ_CAP_OPERATE) >> 1) == 5u) ? 2u
+             : (((mSeqCap & M_SEQ_CAP_OPERATE) >> 1) == 6u) ? 8u
+             : (((mSeqCap & M_SEQ_CAP_OPERATE) >> 1) == 7u) ? 32u
+             : 1u;
+    }
+
+    //!*************************************************************************
+    //!  \brief    M-sequence type in OPERATE: TYPE_2_x with process data,
+    //!             otherwise TYPE_0 or TYPE_1_x by the OD size.
+    //!*************************************************************************
+    constexpr uint8_t mSeqTypeOperate(uint8_t mSeqCap, uint8_t pdIn, uint8_t pdOut) {
+        return ((pdLengthToBytes(pdIn) != 0) || (pdLengthToBytes(pdOut) != 0)) ? M_TYPE_2_X
+             : (odSizeOperate(mSeqCap) == 1u) ? M_TYPE_0 : M_TYPE_1_X;
+    }
+
+    //!*************************************************************************
+    //!  \brief    Decoded direct parameter page 1, see decodePage1.
+    //!*************************************************************************
+    struct DirectParameterPage1 {
+        uint8_t masterCycleTime;    // cycle time encoding, see cycleTimeToUs
+        uint8_t minCycleTime;       // cycle time encoding, see cycleTimeToUs
+        uint8_t mSeqCapability;
+        uint8_t revisionID;
+        uint8_t processDataIn;      // length encoding, see pdLengthToBytes
+        uint8_t processDataOut;     // length encoding, see pdLengthToBytes
+        uint16_t vendorID;
+        uint32_t deviceID;
+        uint16_t functionID;
+    };
+
+    inline DirectParameterPage1 decodePage1(uint8_t const *pPage) {
+        DirectParameterPage1 page;
+        page.masterCycleTime = pPage[PAGE::MAS_CYCLE_TIME];
+        page.minCycleTime = pPage[PAGE::MIN_CYCLE_TIME];
+        page.mSeqCapability = pPage[PAGE::M_SEQ_CAP];
+        page.revisionID = pPage[PAGE::REVISION_ID];
+        page.processDataIn = pPage[PAGE::PD_IN];
+        page.processDataOut = pPage[PAGE::PD_OUT];
+        page.vendorID = uint16_t((pPage[PAGE::VENDOR_ID1] << 8) | pPage[PAGE::VENDOR_ID2]);
+        page.deviceID = (uint32_t(pPage[PAGE::DEVICE_ID1]) << 16) | (uint32_t(pPage[PAGE::DEVICE_ID2]) << 8) | pPage[PAGE::DEVICE_ID3];
+        page.functionID = uint16_t((pPage[PAGE::FUNCTION_ID1] << 8) | pPage[PAGE::FUNCTION_ID2]);
+        return page;
+    }
+
+    //!*************************************************************************
+    //!  \brief    Event read from the event memory of the device.
+    //!*************************************************************************
+    struct Event {
+        uint8_t qualifier;          // EventQualifier, see EVENT
+        uint16_t code;              // EventCode
+    };
+
+    // Checksum of CKT and CKS, see IO-Link Specification A.1.6: the seed and
+    // all octets are XORed, the result is compressed to 6 bits
+    constexpr uint8_t CHECKSUM_SEED     = 0x52u;
+    constexpr uint8_t CHECKSUM_TYPE     = 0xC0u;     // CKT bit 7:6 M-sequence type, CKS bit 7:6 event and PD invalid
+    constexpr uint8_t CHECKSUM_MASK     = 0x3Fu;
+
+    //!*************************************************************************
+    //!  \brief    Compressed checksum of every XOR result, generated with
+    //!             compressChecksum (checked by the static_assert below).
+    //!*************************************************************************
+    constexpr uint8_t CHECKSUM_TABLE[256] = {
+        0x00u, 0x11u, 0x21u, 0x30u, 0x12u, 0x03u, 0x33u, 0x22u, 0x22u, 0x33u, 0x03u, 0x12u, 0x30u, 0x21u, 0x11u, 0x00u,
+        0x14u, 0x05u, 0x35u, 0x24u, 0x06u, 0x17u, 0x27u, 0x36u, 0x36u, 0x27u, 0x17u, 0x06u, 0x24u, 0x35u, 0x05u, 0x14u,
+        0x24u, 0x35u, 0x05u, 0x14u, 0x36u, 0x27u, 0x17u, 0x06u, 0x06u, 0x17u, 0x27u, 0x36u, 0x14u, 0x05u, 0x35u, 0x24u,
+        0x30u, 0x21u, 0x11u, 0x00u, 0x22u, 0x33u, 0x03u, 0x12u, 0x12u, 0x03u, 0x33u, 0x22u, 0x00u, 0x11u, 0x21u, 0x30u,
+        0x18u, 0x09u, 0x39u, 0x28u, 0x0Au, 0x1Bu, 0x2Bu, 0x3Au, 0x3Au, 0x2Bu, 0x1Bu, 0x0Au, 0x28u, 0x39u, 0x09u, 0x18u,
+        0x0Cu, 0x1Du, 0x2Du, 0x3Cu, 0x1Eu, 0x0Fu, 0x3Fu, 0x2Eu, 0x2Eu, 0x3Fu, 0x0Fu, 0x1Eu, 0x3Cu, 0x2Du, 0x1Du, 0x0Cu,
+        0x3Cu, 0x2Du, 0x1Du, 0x0Cu, 0x2Eu, 0x3Fu, 0x0Fu, 0x1Eu, 0x1Eu, 0x0Fu, 0x3Fu, 0x2Eu, 0x0Cu, 0x1Du, 0x2Du, 0x3Cu,
+        0x28u, 0x39u, 0x09u, 0x18u, 0x3Au, 0x2Bu, 0x1Bu, 0x0Au, 0x0Au, 0x1Bu, 0x2Bu, 0x3Au, 0x18u, 0x09u, 0x39u, 0x28u,
+        0x28u, 0x39u, 0x09u, 0x18u, 0x3Au, 0x2Bu, 0x1Bu, 0x0Au, 0x0Au, 0x1Bu, 0x2Bu, 0x3Au, 0x18u, 0x09u, 0x39u, 0x28u,
+        0x3Cu, 0x2Du, 0x1Du, 0x0Cu, 0x2Eu, 0x3Fu, 0x0Fu, 0x1Eu, 0x1Eu, 0x0Fu, 0x3Fu, 0x2Eu, 0x0Cu, 0x1Du, 0x2Du, 0x3Cu,
+        0x0Cu, 0x1Du, 0x2Du, 0x3Cu, 0x1Eu, 0x0Fu, 0x3Fu, 0x2Eu, 0x2Eu, 0x3Fu, 0x0Fu, 0x1Eu, 0x3Cu, 0x2Du, 0x1Du, 0x0Cu,
+        0x18u, 0x09u, 0x39u, 0x28u, 0x0Au, 0x1Bu, 0x2Bu, 0x3Au, 0x3Au, 0x2Bu, 0x1Bu, 0x0Au, 0x28u, 0x39u, 0x09u, 0x18u,
+        0x30u, 0x21u, 0x11u, 0x00u, 0x22u, 0x33u, 0x03u, 0x12u, 0x12u, 0x03u, 0x33u, 0x22u, 0x00u, 0x11u, 0x21u, 0x30u,
+        0x24u, 0x35u, 0x05u, 0x14u, 0x36u, 0x27u, 0x17u, 0x06u, 0x06u, 0x17u, 0x27u, 0x36u, 0x14u, 0x05u, 0x35u, 0x24u,
+        0x14u, 0x05u, 0x35u, 0x24u, 0x06u, 0x17u, 0x27u, 0x36u, 0x36u, 0x27u, 0x17u, 0x06u, 0x24u, 0x35u, 0x05u, 0x14u,
+        0x00u, 0x11u, 0x21u, 0x30u, 0x12u, 0x03u, 0x33u, 0x22u, 0x22u, 0x33u, 0x03u, 0x12u, 0x30u, 0x21u, 0x11u, 0x00u
+    };
+
+    //!*************************************************************************
+    //!  \brief    Compress the XOR of the seed and all octets to the 6 bit
+    //!             checksum (bit by bit, reference for CHECKSUM_TABLE).
+    //!*************************************************************************
+    constexpr uint8_t compressChecksum(uint8_t x) {
+        return uint8_t(((((x >> 7) ^ (x >> 5) ^ (x >> 3) ^ (x >> 1)) & 0x01u) << 5)
+                     | ((((x >> 6) ^ (x >> 4) ^ (x >> 2) ^ (x >> 0)) & 0x01u) << 4)
+                     | ((((x >> 7) ^ (x >> 6)) & 0x01u) << 3)
+                     | ((((x >> 5) ^ (x >> 4)) & 0x01u) << 2)
+                     | ((((x >> 3) ^ (x >> 2)) & 0x01u) << 1)
+                     | ((((x >> 1) ^ (x >> 0)) & 0x01u) << 0));
+    }
+
+    constexpr bool isChecksumTableValid(uint16_t i) {
+        return (i > 0xFFu) || ((CHECKSUM_TABLE[i] == compressChecksum(uint8_t(i))) && isChecksumTableValid(uint16_t(i + 1u)));
+    }
+    static_assert(isChecksumTableValid(0), "CHECKSUM_TABLE does not match compressChecksum");
+
+    //!*************************************************************************
+    //!  \brief    Constant part of a master message (M-sequence). The FIFO
+    //!             header and the CKT of a message without payload are
+    //!             computed at compile time, only the payload is folded into
+    //!             the checksum per cycle (see frameCKT).
+    //!*************************************************************************
+    struct MSequence {
+        uint8_t sizeAnswer;     // size in byte of the answer
+        uint8_t sizeData;       // size in byte of the payload (PD and OD)
+        uint8_t mc;             // master command
+        uint8_t ckt;            // CKT without payload
+        uint8_t seed;           // checksum XOR over seed, MC and M-sequence type
+    };
+
+    constexpr MSequence makeMSequence(uint8_t mc, uint8_t mSeqType, uint8_t sizeData, uint8_t sizeAnswer) {
+        return MSequence{ sizeAnswer, sizeData, mc,
+            uint8_t(uint8_t(mSeqType << 6) | CHECKSUM_TABLE[uint8_t(CHECKSUM_SEED ^ mc ^ uint8_t(mSeqType << 6))]),
+            uint8_t(CHECKSUM_SEED ^ mc ^ uint8_t(mSeqType << 6)) };
+    }
+
+    // Read one byte of the direct parameter page 1, the answer has no CKS
+    constexpr MSequence pageRead(uint8_t address) {
+        return makeMSequence(uint8_t(MC::PAGE_READ | (address & MC::PAGE_ADDRESS)), M_TYPE_0, 0, 1);
+    }
+
+    // Request the process data input, the answer holds OD, PD and CKS
+    constexpr MSequence pdRead(uint8_t sizeAnswer) {
+        return makeMSequence(MC::PD_READ, M_TYPE_2_X, 0, sizeAnswer);
+    }
+
+    //!*************************************************************************
+    //!  \brief    CKT of a message with its payload.
+    //!*************************************************************************
+    inline uint8_t frameCKT(MSequence const &frame, uint8_t const *pData) {
+        uint8_t checksum = frame.seed;
+        for (uint8_t i = 0; i < frame.sizeData; i++) {
+            checksum ^= pData[i];
+        }
+        return uint8_t((frame.ckt & CHECKSUM_TYPE) | CHECKSUM_TABLE[checksum]);
+    }
+
+    //!*************************************************************************
+    //!  \brief    Check the CKS in the last byte of a device answer.
+    //!             Returns 1 if the checksum matches.
+    //!*************************************************************************
+    inline uint8_t isChecksumValid(uint8_t const *pData, uint8_t sizeData) {
+        if (sizeData == 0) {
+            return 0;
+        }
+        uint8_t cks = pData[sizeData - 1];
+        uint8_t checksum = uint8_t(CHECKSUM_SEED ^ (cks & CHECKSUM_TYPE));
+        for (uint8_t i = 0; i < sizeData - 1; i++) {
+            checksum ^= pData[i];
+        }
+        return (CHECKSUM_TABLE[checksum] == (cks & CHECKSUM_MASK)) ? 1 : 0;
+    }
 
 }
 
@@ -52,9 +52,16 @@ constexpr uint8_t write = 0b01111111;
 //!**** Data types **************************************************************
 
 //!**** Function prototypes *****************************************************
-uint8_t calculateCKT(uint8_t mc, uint8_t *data, uint8_t dataSize, uint8_t type);
+static inline void countUp(std::atomic<uint32_t> *counter, uint32_t value);
 
 //!**** Data ********************************************************************
+// Register names for printStatistics
+static char const * const REGISTER_NAMES[max14819::MAX_REG + 1] = {
+    "TxRxDataA", "TxRxDataB", "Interrupt", "InterruptEn", "RxFIFOLvlA", "RxFIFOLvlB", "CQCtrlA", "CQCtrlB",
+    "CQErrA", "CQErrB", "MsgCtrlA", "MsgCtrlB", "ChanStatA", "ChanStatB", "LEDCtrl", "Trigger",
+    "CQCfgA", "CQCfgB", "CyclTmrA", "CyclTmrB", "DeviceDlyA", "DeviceDlyB", "TrigAssgnA", "TrigAssgnB",
+    "LCnfgA", "LCnfgB", "IOStCfgA", "IOStCfgB", "DrvrCurrLim", "Clock", "Status", "RevID"
+};
 
 //!**** Implementation **********************************************************
 using namespace max14819;
@@ -80,6 +87,32 @@ Max14819::Max14819(){
 	comSpeedRegA = 0;
 	comSpeedRegB = 0;
 	Hardware = nullptr;
+	shadowValid_ = 0;
+	pendingInterrupt_ = 0;
+	for (uint8_t i = 0; i <= MAX_REG; i++) {
+		shadowReg_[i] = 0;
+	}
+	clearRegisterStats();
+	for (uint16_t i = 0; i < TRACE_SIZE; i++) {
+		trace_[i].seq.store(0, std::memory_order_relaxed);
+		trace_[i].command = 0;
+		trace_[i].data = 0;
+		trace_[i].time_ns = 0;
+	}
+	traceHead_.store(0, std::memory_order_relaxed);
+	isTraceEn_.store(0, std::memory_order_relaxed);
+	for (uint8_t i = 0; i < TRIGGER_COUNT; i++) {
+		triggerTime_ns_[i] = 0;
+	}
+	for (uint8_t i = 0; i < 2; i++) {
+		sendTime_ns_[i] = 0;
+		rxTime_ns_[i] = 0;
+		rxCount_[i] = 0;
+	}
+#ifndef ARDUINO
+	lockDepth_ = 0;
+	isPinWatched_ = 0;
+#endif
 }
 
 //!******************************************************************************
@@ -103,6 +136,32 @@ Max14819::Max14819(DriverSelect driver, HardwareBase * hardware){
 	comSpeedRegA = 0;
 	comSpeedRegB = 0;
 	Hardware = hardware;
+	shadowValid_ = 0;
+	pendingInterrupt_ = 0;
+	for (uint8_t i = 0; i <= MAX_REG; i++) {
+		shadowReg_[i] = 0;
+	}
+	clearRegisterStats();
+	for (uint16_t i = 0; i < TRACE_SIZE; i++) {
+		trace_[i].seq.store(0, std::memory_order_relaxed);
+		trace_[i].command = 0;
+		trace_[i].data = 0;
+		trace_[i].time_ns = 0;
+	}
+	traceHead_.store(0, std::memory_order_relaxed);
+	isTraceEn_.store(0, std::memory_order_relaxed);
+	for (uint8_t i = 0; i < TRIGGER_COUNT; i++) {
+		triggerTime_ns_[i] = 0;
+	}
+	for (uint8_t i = 0; i < 2; i++) {
+		sendTime_ns_[i] = 0;
+		rxTime_ns_[i] = 0;
+		rxCount_[i] = 0;
+	}
+#ifndef ARDUINO
+	lockDepth_ = 0;
+	isPinWatched_ = 0;
+#endif
 
 }
 //!******************************************************************************
@@ -127,7 +186,8 @@ Max14819::~Max14819() {
 //!					set the default configuration of the max14819. Enables the
 //!					L+ mosfet to power the device. Remember that driver01 must
 //! 				be initilized to use driver23 because the daisychaining of
-//!					the clock.
+//!					the clock. Blocks for the power off and bootup time, see
+//!                 initPort and powerOnPort for the non-blocking steps.
 //!  \type         	local
 //!
 //!  \param[in]     port                PORTA or PORTB
@@ -137,7 +197,63 @@ Max14819::~Max14819() {
 //!******************************************************************************
 uint8_t Max14819::begin(PortSelect port) {
     uint8_t retValue = SUCCESS;
-    uint8_t shadowReg = 0;
+
+    // Reset the port, this switches off L+
+    retValue = uint8_t(retValue | initPort(port));
+    uint64_t powerOffDeadline = Hardware->get_time_ns() + INIT_POWER_OFF_DELAY * NS_PER_MS;
+
+    // Wait 1 s for turning on the powersupply for sensor
+	Hardware->wait_until_ns(powerOffDeadline);
+
+    retValue = uint8_t(retValue | powerOnPort(port));
+    uint64_t bootupDeadline = Hardware->get_time_ns() + INIT_BOOTUP_DELAY * NS_PER_MS;
+
+    // Wait 0.2s for bootup of the device
+	Hardware->wait_until_ns(bootupDeadline);
+
+    // Return Error state
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	initPort
+//!******************************************************************************
+//!* \brief        	Initialize IOs and clock of the max14819 and reset the port,
+//!                 which switches off L+. The device needs INIT_POWER_OFF_DELAY
+//!                 before powerOnPort is called.
+//!  \type         	local
+//!
+//!  \param[in]     port                PORTA or PORTB
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::initPort(PortSelect port) {
+    uint8_t retValue = SUCCESS;
+
+    // Initialize IOs and clock
+    retValue = uint8_t(retValue | initIO(port));
+
+    // Reset max14819 register, this switches off L+
+    retValue = uint8_t(retValue | reset(port));
+
+    // Return Error state
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	initIO
+//!******************************************************************************
+//!* \brief        	Initialize the IOs of the port and, with the first port of
+//!                 the chip, the clock of the max14819. Does not touch the
+//!                 port registers.
+//!  \type         	local
+//!
+//!  \param[in]     port                PORTA or PORTB
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::initIO(PortSelect port) {
+    uint8_t retValue = SUCCESS;
 
     switch (driver_) {
     case DRIVER01:
@@ -266,46 +382,147 @@ uint8_t Max14819::begin(PortSelect port) {
         break;
     } // switch(driver)
 
-    // Reset max14819 register
-    retValue = uint8_t(retValue | reset(port));
+    // Return Error state
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	resumePort
+//!******************************************************************************
+//!* \brief        	Take over a port which a previous run of the master left in
+//!                 communication, without power cycling the device. The chip
+//!                 must still have the same revision and communication speed.
+//!                 Stops the cycle timer and clears the FIFOs of the port.
+//!  \type         	local
+//!
+//!  \param[in]     port                PORTA or PORTB
+//!  \param[in]     revID               expected content of RevID
+//!  \param[in]     comSpeedReg         expected ComRt bits of CQCtrlA/B
+//!
+//!  \return        0 if the port is resumed, 1 if it needs a cold start
+//!
+//!******************************************************************************
+uint8_t Max14819::resumePort(PortSelect port, uint8_t revID, uint8_t comSpeedReg) {
+    uint8_t retValue = SUCCESS;
+    uint8_t chipRevID = 0;
+    uint8_t cqCtrl = 0;
 
-    // Wait 1 s for turning on the powersupply for sensor
-	Hardware->wait_for(INIT_POWER_OFF_DELAY);
+    if (((port != PORTA) && (port != PORTB)) || (comSpeedReg == 0)) {
+        return ERROR;
+    }
+    uint8_t cqCtrlRegister = (port == PORTA) ? CQCtrlA : CQCtrlB;
+
+    retValue = uint8_t(retValue | initIO(port));
+
+    // Probe the chip in one bus transfer
+    shadowValid_ &= ~(1ul << RevID);
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
+    retValue = uint8_t(retValue | queueReadRegister(transaction, RevID, &chipRevID));
+    retValue = uint8_t(retValue | queueReadRegister(transaction, cqCtrlRegister, &cqCtrl));
+    transaction.flush();
+    if ((retValue == ERROR) || (chipRevID != revID) || ((cqCtrl & (ComRt0 | ComRt1)) != comSpeedReg)) {
+        return ERROR;
+    }
+
+    // The registers were written by the previous run, take them over
+    retValue = uint8_t(retValue | resyncShadow());
+
+    // Stop the cycle timer, drop kept messages and clear both FIFOs
+    retValue = uint8_t(retValue | queueWriteRegister(transaction, (port == PORTA) ? MsgCtrlA : MsgCtrlB, 0));
+    retValue = uint8_t(retValue | queueWriteRegister(transaction, cqCtrlRegister, uint8_t(TxFifoRst | RxFifoRst | comSpeedReg)));
+    transaction.flush();
+
+    if (port == PORTA) {
+        comSpeedRegA = comSpeedReg;
+    } else {
+        comSpeedRegB = comSpeedReg;
+    }
+    pendingInterrupt_ &= uint8_t(~((port == PORTA) ? (RxDataRdyA | RxErrorA | TxErrorA) : (RxDataRdyB | RxErrorB | TxErrorB)));
+
+    // Return Error state
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	readDriver
+//!******************************************************************************
+//!  \brief        	Returns which max14819 of the shield this driver controls.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     void
+//!
+//!  \return        DRIVER01 or DRIVER23
+//!
+//!******************************************************************************
+DriverSelect Max14819::readDriver(void) {
+    return driver_;
+}
+//!******************************************************************************
+//!  function :    	getHardware
+//!******************************************************************************
+//!  \brief        	Returns the hardware abstraction used by this driver.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     void
+//!
+//!  \return        hardware abstraction
+//!
+//!******************************************************************************
+HardwareBase* Max14819::getHardware(void) {
+    return Hardware;
+}
+//!******************************************************************************
+//!  function :    	powerOnPort
+//!******************************************************************************
+//!* \brief        	Set the default configuration of the port and enable L+.
+//!                 The device needs INIT_BOOTUP_DELAY before wakeUpRequest or
+//!                 startWakeUp is called.
+//!  \type         	local
+//!
+//!  \param[in]     port                PORTA or PORTB
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::powerOnPort(PortSelect port) {
+    uint8_t retValue = SUCCESS;
+
+    // Read the shared registers of both ports in one bus transfer
+    uint8_t shadowInterruptEn = 0;
+    uint8_t shadowLedCtrl = 0;
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
+    retValue = uint8_t(retValue | queueReadRegister(transaction, InterruptEn, &shadowInterruptEn));
+    retValue = uint8_t(retValue | queueReadRegister(transaction, LEDCtrl, &shadowLedCtrl));
+    transaction.flush();
 
     // Initialize global registers
-    retValue = uint8_t(retValue | writeRegister(DrvrCurrLim, CL1 | CL0 | CLBL1 | CLBL0 | ArEn)); //CQ 500 mA currentlimit, 5 ms min error duration before interrupt
+    retValue = uint8_t(retValue | queueWriteRegister(transaction, DrvrCurrLim, CL1 | CL0 | CLBL1 | CLBL0 | ArEn)); //CQ 500 mA currentlimit, 5 ms min error duration before interrupt
 
     // Initialize the port sepcific registers
     switch (port) {
     case PORTA:
         // Set all Interrupts
-        shadowReg = readRegister(InterruptEn);
-        retValue = uint8_t(retValue | writeRegister(InterruptEn, StatusIntEn | WURQIntEn | TxErrIntEnA | RxErrIntEnA | RxDaRdyIntEnA | shadowReg));
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, InterruptEn, StatusIntEn | WURQIntEn | TxErrIntEnA | RxErrIntEnA | RxDaRdyIntEnA | shadowInterruptEn));
         // Enable LedRxRdy and RyError LED
-        shadowReg = readRegister(LEDCtrl);
-        retValue = uint8_t(retValue | writeRegister(LEDCtrl, RxRdyEnA | RxErrEnA | shadowReg));
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, LEDCtrl, RxRdyEnA | RxErrEnA | shadowLedCtrl));
         // Initialize the Channel A register
-        retValue = uint8_t(retValue | writeRegister(LCnfgA, LRT0 | LBL0 | LBL1 | LClimDis | LEn)); // Enable current retry 0.4s,  disable currentlimiting, enable Current
-        retValue = uint8_t(retValue | writeRegister(CQCfgA, SinkSel0 | PushPul)); // Int Current Sink, 5 mA, PushPull, Channel Enable
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, LCnfgA, LRT0 | LBL0 | LBL1 | LClimDis | LEn)); // Enable current retry 0.4s,  disable currentlimiting, enable Current
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, CQCfgA, SinkSel0 | PushPul)); // Int Current Sink, 5 mA, PushPull, Channel Enable
         break;
     case PORTB:
         // Set all Interrupts
-        shadowReg = readRegister(InterruptEn);
-        retValue = uint8_t(retValue | writeRegister(InterruptEn, StatusIntEn | WURQIntEn | TxErrIntEnB | RxErrIntEnB | RxDaRdyIntEnB | shadowReg));
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, InterruptEn, StatusIntEn | WURQIntEn | TxErrIntEnB | RxErrIntEnB | RxDaRdyIntEnB | shadowInterruptEn));
         // Enable LedRxRdy and RyError LED
-        shadowReg = readRegister(LEDCtrl);
-        retValue = uint8_t(retValue | writeRegister(LEDCtrl, RxRdyEnB | RxErrEnB | shadowReg));
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, LEDCtrl, RxRdyEnB | RxErrEnB | shadowLedCtrl));
         // Initialize the Channel A register
-        retValue = uint8_t(retValue | writeRegister(LCnfgB, LRT0 | LBL0 | LBL1 | LClimDis | LEn)); // Enable current retry 0.4s,  disable currentlimiting, enable Current
-        retValue = uint8_t(retValue | writeRegister(CQCfgB, SinkSel0 | PushPul)); // Int Current Sink, 5 mA, PushPull, Channel Enable
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, LCnfgB, LRT0 | LBL0 | LBL1 | LClimDis | LEn)); // Enable current retry 0.4s,  disable currentlimiting, enable Current
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, CQCfgB, SinkSel0 | PushPul)); // Int Current Sink, 5 mA, PushPull, Channel Enable
         break;
     default:
         retValue = ERROR;
         break;
     } // switch(port)
-
-    // Wait 0.2s for bootup of the device
-	Hardware->wait_for(INIT_BOOTUP_DELAY);
+    transaction.flush();
 
     // Return Error state
     return retValue;
@@ -423,23 +640,49 @@ uint8_t Max14819::reset(PortSelect port) {
 //!******************************************************************************
 //!  function :    	readStatus
 //!******************************************************************************
-//! \brief        	Init peripheries and starts the tasks.
+//! \brief        	Read the Status register of the chip and the ChanStat
+//!                 register of the port in one bus transfer. Set fault bits
+//!                 are published to the event ring of the port, the COR bits
+//!                 are cleared by the read.
 //!
 //!  \type         	local
 //!
-//!  \param[in]     port
+//!  \param[in]     port                PORTA or PORTB
 //!
-//!  \return        0 if success
+//!  \return        Status register, 0 if the read failed
 //!
 //!******************************************************************************
 uint8_t Max14819::readStatus(PortSelect port) {
-    return 0;
+    uint8_t status = 0;
+    uint8_t chanStat = 0;
+    uint8_t retValue = SUCCESS;
+
+    if ((port != PORTA) && (port != PORTB)) {
+        return 0;
+    }
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
+    retValue = uint8_t(retValue | queueReadRegister(transaction, Status, &status));
+    retValue = uint8_t(retValue | queueReadRegister(transaction, (port == PORTA) ? ChanStatA : ChanStatB, &chanStat));
+    transaction.flush();
+    if (retValue == ERROR) {
+        return 0;
+    }
+
+    if (status != 0) {
+        publishEvent(port, EVENT_SOURCE_STATUS, status, 0);
+    }
+    if ((chanStat & (LCLimCOR | CQFaultCOR | LCLim | UVL | CQFault)) != 0) {
+        publishEvent(port, EVENT_SOURCE_CHANNEL, chanStat, 0);
+    }
+    return status;
 }
 
 //!******************************************************************************
 //!  function :    	wakeUpRequest
 //!******************************************************************************
-//! \brief        	Generates wakeup impuls and handles communication speed
+//! \brief        	Generates wakeup impuls and handles communication speed.
+//!                 Blocks until the sequence is over, see startWakeUp,
+//!                 pollWakeUp and finishWakeUp for the non-blocking steps.
 //!
 //!  \type         	local
 //!
@@ -449,83 +692,138 @@ uint8_t Max14819::readStatus(PortSelect port) {
 //!
 //!******************************************************************************
 uint8_t Max14819::wakeUpRequest(PortSelect port, uint32_t * comSpeed_ret) {
-    uint32_t comSpeed;
-    uint8_t retValue = 0;
     uint8_t comReqRunning = 0;
-    uint8_t timeOutCounter = 0;
-    uint16_t length = 0;
+    uint64_t timeOutDeadline = 0;
+    uint64_t pollDeadline = 0;
+
+    if (startWakeUp(port) == ERROR) {
+        return ERROR;
+    }
+    timeOutDeadline = Hardware->get_time_ns() + INIT_WURQ_TIMEOUT * NS_PER_MS;
+    pollDeadline = Hardware->get_time_ns();
+
+    // Wait till establish communication sequence is over or timeout is reached,
+    // EstCom clears as soon as the device answered
+    do {
+        comReqRunning = pollWakeUp(port);
+        pollDeadline += INIT_WURQ_POLL_US * NS_PER_US;
+        Hardware->wait_until_ns(pollDeadline);
+    } while ((comReqRunning == PENDING) && (pollDeadline < timeOutDeadline));
+
+	Hardware->wait_until_ns(Hardware->get_time_ns() + INIT_WURQ_SETTLE * NS_PER_MS);
+
+    return finishWakeUp(port, comSpeed_ret);
+}
+//!******************************************************************************
+//!  function :    	startWakeUp
+//!******************************************************************************
+//! \brief        	Enable the framer and start the wakeup and establish
+//!                 communication sequence of the max14819 (EstCom).
+//!
+//!  \type         	local
+//!
+//!  \param[in]     port            PORTA or PORTB
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::startWakeUp(PortSelect port) {
+    uint8_t retValue = SUCCESS;
 
-    // wake up and communication establishing for selected port
+    // Start wakeup and communcation for selected port in one bus transfer
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
     switch(port){
     case PORTA:
-        // Start wakeup and communcation
-        retValue = uint8_t(retValue | writeRegister(IOStCfgA, 0)); // Disable tx needed for wake up
-        retValue = uint8_t(retValue | writeRegister(ChanStatA, FramerEn)); // Enable ChanA Framer
-        retValue = uint8_t(retValue | writeRegister(MsgCtrlA, 0)); // Dont use InsChks when transmit OD Data, max14819 doesnt calculate it right
-        retValue = uint8_t(retValue | writeRegister(CQCtrlA, EstCom));     // Start communication
-
-        // Wait till establish communication sequence is over or timeout is reached
-        do {
-            comReqRunning = readRegister(CQCtrlA);
-            comReqRunning &= EstCom;
-            timeOutCounter++;
-            Hardware->wait_for(1);
-        } while (comReqRunning || (timeOutCounter < INIT_WURQ_TIMEOUT));
-
-		Hardware->wait_for(10);
-        // Clear buffer
-        length = readRegister(RxFIFOLvlA);
-        for (uint8_t i = 0; i < length; i++) {
-            readRegister(TxRxDataA);
-        }
-
-        // read communication speed
-        comSpeedRegA = readRegister(CQCtrlA) & (ComRt0 | ComRt1);
-        comSpeed = comSpeedRegA;
-        if (comSpeed == 0) {
-            return ERROR;
-        }
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, IOStCfgA, 0)); // Disable tx needed for wake up
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, ChanStatA, FramerEn)); // Enable ChanA Framer
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, MsgCtrlA, 0)); // Dont use InsChks when transmit OD Data, max14819 doesnt calculate it right
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, CQCtrlA, EstCom));     // Start communication
         break;
     case PORTB:
-        // Start wakeup and communcation
-        retValue = uint8_t(retValue | writeRegister(IOStCfgB, 0)); // Disable tx needed for wake up
-        retValue = uint8_t(retValue | writeRegister(ChanStatB, FramerEn)); // Enable Chanb Framer
-        retValue = uint8_t(retValue | writeRegister(MsgCtrlB, 0)); // Dont use InsChks when transmit OD Data, max14819 doesnt calculate it right
-        retValue = uint8_t(retValue | writeRegister(CQCtrlB, EstCom));     // Start communication
-
-        // Wait till establish communication sequence is over or timeout is reached
-        do {
-            comReqRunning = readRegister(CQCtrlB);
-            comReqRunning &= EstCom;
-            timeOutCounter++;
-			Hardware->wait_for(1);
-        } while (comReqRunning || (timeOutCounter < INIT_WURQ_TIMEOUT));
-
-		Hardware->wait_for(10);
-        // Clear buffer
-       length = readRegister(RxFIFOLvlB);
-        for (uint8_t i = 0; i < length; i++) {
-            readRegister(TxRxDataB);
-        }
-
-        // read communication speed
-        comSpeedRegB = readRegister(CQCtrlB) & (ComRt0 | ComRt1);
-        comSpeed = comSpeedRegB;
-        if (comSpeed == 0) {
-            return ERROR;
-        }
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, IOStCfgB, 0)); // Disable tx needed for wake up
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, ChanStatB, FramerEn)); // Enable Chanb Framer
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, MsgCtrlB, 0)); // Dont use InsChks when transmit OD Data, max14819 doesnt calculate it right
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, CQCtrlB, EstCom));     // Start communication
         break;
     default:
         retValue = ERROR;
         break;
     } // switch(port)
+    transaction.flush();
+
+    // Return Error state
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	pollWakeUp
+//!******************************************************************************
+//! \brief        	Check if the establish communication sequence is still
+//!                 running. The sequence takes up to INIT_WURQ_TIMEOUT.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     port            PORTA or PORTB
+//!
+//!  \return        PENDING while running, 0 if over, 1 if Error
+//!
+//!******************************************************************************
+uint8_t Max14819::pollWakeUp(PortSelect port) {
+    if ((port != PORTA) && (port != PORTB)) {
+        return ERROR;
+    }
+    if ((readRegister((port == PORTA) ? CQCtrlA : CQCtrlB) & EstCom) != 0) {
+        return PENDING;
+    }
+    return SUCCESS;
+}
+//!******************************************************************************
+//!  function :    	finishWakeUp
+//!******************************************************************************
+//! \brief        	Clear the receive FIFO after the establish communication
+//!                 sequence and read the communication speed. Call it
+//!                 INIT_WURQ_SETTLE after pollWakeUp reported the end.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     port            PORTA or PORTB
+//!  \param[out]    comSpeed_ret    communication speed in Baud/s
+//!
+//!  \return        0 if success, 1 if no communication established
+//!
+//!******************************************************************************
+uint8_t Max14819::finishWakeUp(PortSelect port, uint32_t * comSpeed_ret) {
+    uint32_t comSpeed;
+    uint8_t length = 0;
+    uint8_t dummy = 0;
+
+    if ((port != PORTA) && (port != PORTB)) {
+        return ERROR;
+    }
+    uint8_t bufferRegister = (port == PORTA) ? TxRxDataA : TxRxDataB;
+
+    // Clear buffer
+    length = readRegister((port == PORTA) ? RxFIFOLvlA : RxFIFOLvlB);
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
+    for (uint8_t i = 0; (i < length) && (i < RX_FIFO_SIZE); i++) {
+        queueReadRegister(transaction, bufferRegister, &dummy);
+    }
+    transaction.flush();
+
+    // read communication speed
+    if (port == PORTA) {
+        comSpeedRegA = readRegister(CQCtrlA) & (ComRt0 | ComRt1);
+        comSpeed = comSpeedRegA;
+    } else {
+        comSpeedRegB = readRegister(CQCtrlB) & (ComRt0 | ComRt1);
+        comSpeed = comSpeedRegB;
+    }
 
     // Set correct communication speed in kBaud/s
     switch (comSpeed) {
     case 0:
         // No communication established
         *comSpeed_ret = 0;
-        break;
+        return ERROR;
     case ComRt0:
         // Communication established at 4.8 kBaud/s
         *comSpeed_ret = 4800;
@@ -544,11 +842,28 @@ uint8_t Max14819::wakeUpRequest(PortSelect port, uint32_t * comSpeed_ret) {
     }
     return SUCCESS;
 }
-
+//!******************************************************************************
+//!  function :    	pollRxData
+//!******************************************************************************
+//!  \brief        	Check without blocking if the answer of the last message
+//!                 of the port is received (RxDataRdy interrupt).
+//!
+//!  \type         	local
+//!
+//!  \param[in]     port                PORTA or PORTB
+//!
+//!  \return       	0 if data is ready, PENDING if not
+//!
+//!******************************************************************************
+uint8_t Max14819::pollRxData(PortSelect port) {
+    // A deadline in the past only samples the interrupt pin
+    return (waitForRxData(port, 0) == SUCCESS) ? SUCCESS : PENDING;
+}
 //!******************************************************************************
 //!  function :    	readRegister
 //!******************************************************************************
-//! \brief         	read register from max14819
+//! \brief         	read register from max14819. Registers in SHADOW_REGS are
+//!                 served from the register shadow once they are known.
 //!
 //!  \type       	local
 //!
@@ -558,41 +873,76 @@ uint8_t Max14819::wakeUpRequest(PortSelect port, uint32_t * comSpeed_ret) {
 //!
 //!******************************************************************************
 uint8_t Max14819::readRegister(uint8_t reg) {
-    uint8_t channel = 0;
-    uint8_t buf[2];
+    if ((reg <= MAX_REG) && ((shadowValid_ & (1ul << reg)) != 0)) {
+        countUp(&regStats_[reg].shadowHits, 1);
+        return shadowReg_[reg];
+    }
+    return readRegisterUncached(reg);
+}
+//!******************************************************************************
+//!  function :    	readRegisterUncached
+//!******************************************************************************
+//! \brief         	read register from max14819 bypassing the register shadow.
+//!                 Used for status bits in otherwise shadowed registers
+//!                 (e.g. DiLevel, CQLevel in IOStCfgA/B).
+//!
+//!  \type       	local
+//!
+//!  \param[in]     reg             registeraddress to read
+//!
+//!  \return        registervalue
+//!
+//!******************************************************************************
+uint8_t Max14819::readRegisterUncached(uint8_t reg) {
+    uint8_t value = 0;
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
 
-    // Check if register address is in the correct range
-    if (reg > MAX_REG) {
-        Hardware->Serial_Write("Registeraddress out of range");
+    // Send the device the register you want to read:
+    if (reg <= MAX_REG) {
+        shadowValid_ &= ~(1ul << reg);
+    }
+    if (queueReadRegister(transaction, reg, &value) == ERROR) {
         return ERROR;
     }
+    transaction.flush();
 
-    switch(driver_){
-    case DRIVER01:
-        // Mask read register with the read cmd and set spi address of the max14819
-        reg = reg | (read << 7) | (port01Address << 5);
-        // Set channel to 0
-        channel = 0;
-        break;
-    case DRIVER23:
-        // Mask read register with the read cmd and set spiad dress of the max14819
-        reg = reg | (read << 7) | (port23Address << 5);
-        // Set channel to 1
-        channel = 1;
-        break;
-    default:
-        break;
-    } // switch(driver)
+    // Refresh the shadow of the register
+    if ((SHADOW_REGS & (1ul << reg)) != 0) {
+        shadowReg_[reg] = value;
+        shadowValid_ |= (1ul << reg);
+    }
 
-    // Predefine buffer
-    buf[0] = reg;
-    buf[1] = 0x00;
+    // Return Registervalue
+    return value;
+}
+//!******************************************************************************
+//!  function :    	resyncShadow
+//!******************************************************************************
+//! \brief         	Read all registers in SHADOW_REGS from the chip in one bus
+//!                 transfer. Needed if the registers may have been changed
+//!                 outside of this driver (e.g. power loss of the max14819).
+//!
+//!  \type       	local
+//!
+//!  \param[in]     void
+//!
+//!  \return        0 if successful
+//!
+//!******************************************************************************
+uint8_t Max14819::resyncShadow(void) {
+    uint8_t retValue = SUCCESS;
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
 
-    // Send the device the register you want to read:
-    Hardware->SPI_Write(channel, buf, 2);
+    shadowValid_ = 0;
+    for (uint8_t reg = 0; reg <= MAX_REG; reg++) {
+        if ((SHADOW_REGS & (1ul << reg)) != 0) {
+            retValue = uint8_t(retValue | queueReadRegister(transaction, reg, &shadowReg_[reg]));
+        }
+    }
+    transaction.flush();
+    shadowValid_ = (retValue == SUCCESS) ? SHADOW_REGS : 0;
 
-    // Return Registervalue
-    return buf[1];
+    return retValue;
 }
 //!******************************************************************************
 //!  function :    	writeRegister
@@ -609,42 +959,206 @@ uint8_t Max14819::readRegister(uint8_t reg) {
 //!******************************************************************************
 uint8_t Max14819::writeRegister(uint8_t reg, uint8_t data) {
     uint8_t retValue = SUCCESS;
-    uint8_t buf[2];
-    uint8_t channel = 0;
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
 
-    // Check if register address is in the correct range
-    if (reg > MAX_REG) {
-        Hardware->Serial_Write("Registeraddress out of range");
-        return ERROR;
-    }
-    // Set write bit in register command
-    reg &= write;
+    // Send SPI telegram
+    retValue = queueWriteRegister(transaction, reg, data);
+    transaction.flush();
 
-    switch (driver_) {
-    case DRIVER01:
-        // Set SPI address of the max14819
+    // Return Error state
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	spiChannel
+//!******************************************************************************
+//!  \brief        	SPI channel (chipselect) of this max14819
+//!
+//!  \type        	local
+//!
+//!  \param[in]     void
+//!
+//!  \return        0 for DRIVER01, 1 for DRIVER23
+//!
+//!******************************************************************************
+uint8_t Max14819::spiChannel(void) {
+    return (driver_ == DRIVER23) ? 1 : 0;
+}
+//!******************************************************************************
+//!  function :    	updateShadow
+//!******************************************************************************
+//!  \brief        	Keep the register shadow in sync with a register write.
+//!                 A channel reset invalidates the registers of the channel.
+//!
+//!  \type        	local
+//!
+//!  \param[in]     reg             register address
+//!  \param[in]     data            byte written
+//!
+//!  \return        void
+//!
+//!******************************************************************************
+void Max14819::updateShadow(uint8_t reg, uint8_t data) {
+    if ((reg == ChanStatA) && ((data & Rst) != 0)) {
+        shadowValid_ &= ~SHADOW_REGS_A;
+    }
+    if ((reg == ChanStatB) && ((data & Rst) != 0)) {
+        shadowValid_ &= ~SHADOW_REGS_B;
+    }
+    if ((SHADOW_REGS & (1ul << reg)) != 0) {
+        shadowReg_[reg] = data;
+        shadowValid_ |= (1ul << reg);
+    }
+}
+//!******************************************************************************
+//!  function :    	queueReadRegister
+//!******************************************************************************
+//! \brief         	Queue a register read in a SPI transaction. The value is
+//!                 stored in *pData when the transaction is flushed. Known
+//!                 shadowed registers are answered immediately without a frame.
+//!
+//!  \type       	local
+//!
+//!  \param[in]     transaction     transaction on the channel of this driver
+//!  \param[in]     reg             registeraddress to read
+//!  \param[out]    *pData          destination of the registervalue
+//!
+//!  \return        0 if successful
+//!
+//!******************************************************************************
+uint8_t Max14819::queueReadRegister(HardwareBase::SPITransaction &transaction, uint8_t reg, uint8_t *pData) {
+    // Check if register address is in the correct range
+    if (reg > MAX_REG) {
+        countUp(&rangeErrors_, 1);
+        Hardware->Serial_Write("Registeraddress out of range");
+        return ERROR;
+    }
+
+    if ((shadowValid_ & (1ul << reg)) != 0) {
+        countUp(&regStats_[reg].shadowHits, 1);
+        *pData = shadowReg_[reg];
+        return SUCCESS;
+    }
+    countUp(&regStats_[reg].reads, 1);
+    countUp(&regStats_[reg].bytes, HardwareBase::SPI_FRAME_SIZE);
+
+    switch(driver_){
+    case DRIVER01:
+        // Mask read register with the read cmd and set spi address of the max14819
+        reg = reg | (read << 7) | (port01Address << 5);
+        break;
+    case DRIVER23:
+        // Mask read register with the read cmd and set spiad dress of the max14819
+        reg = reg | (read << 7) | (port23Address << 5);
+        break;
+    default:
+        return ERROR;
+    } // switch(driver)
+
+    traceFrame(reg, 0);
+    transaction.read(reg, pData);
+    return SUCCESS;
+}
+//!******************************************************************************
+//!  function :    	queueWriteRegister
+//!******************************************************************************
+//!  \brief        	Queue a register write in a SPI transaction
+//!
+//!  \type        	local
+//!
+//!  \param[in]     transaction     transaction on the channel of this driver
+//!  \param[in]     reg             register address
+//!  \param[in]     data            byte to write
+//!
+//!  \return        0 if successful
+//!
+//!******************************************************************************
+uint8_t Max14819::queueWriteRegister(HardwareBase::SPITransaction &transaction, uint8_t reg, uint8_t data) {
+    // Check if register address is in the correct range
+    if (reg > MAX_REG) {
+        countUp(&rangeErrors_, 1);
+        Hardware->Serial_Write("Registeraddress out of range");
+        return ERROR;
+    }
+    // Write through to the register shadow
+    updateShadow(reg, data);
+    countUp(&regStats_[reg].writes, 1);
+    countUp(&regStats_[reg].bytes, HardwareBase::SPI_FRAME_SIZE);
+
+    // Set write bit in register command
+    reg &= write;
+
+    switch (driver_) {
+    case DRIVER01:
+        // Set SPI address of the max14819
         reg |= (port01Address << 5);
-        // Set channel to 0
-        channel = 0;
         break;
     case DRIVER23:
         // Set SPI address of the max14819
         reg |= (port23Address << 5);
-        // Set channel to 1
-        channel = 1;
         break;
     default:
-        retValue = ERROR;
-        break;
+        return ERROR;
     }
 
-    // Send SPI telegram
-    buf[0] = reg;
-    buf[1] = data;
-    Hardware->SPI_Write(channel, buf, 2);
+    traceFrame(reg, data);
+    transaction.write(reg, data);
+    return SUCCESS;
+}
+//!******************************************************************************
+//!  function :    	queueTxMessage
+//!******************************************************************************
+//!  \brief        	Queue a message for the transmit FIFO of a port. The
+//!                 message is not sent before CQSend or the cycle timer is set.
+//!                 The header comes from the precomputed frame, only the
+//!                 payload is folded into the CKT.
+//!
+//!  \type        	local
+//!
+//!  \param[in]     transaction         transaction on the channel of this driver
+//!  \param[in]     frame               M-sequence, see IOL::makeMSequence
+//!  \param[in]     *pData              payload of frame.sizeData bytes
+//!  \param[in]     port                port to send data
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::queueTxMessage(HardwareBase::SPITransaction &transaction, IOL::MSequence const &frame, uint8_t const *pData, PortSelect port) {
+    uint8_t retValue = SUCCESS;
+
+    // Test if message is not too long
+    if ((frame.sizeData + 2) > MAX_MSG_LENGTH) { //include 1 byte master command and 1 byte for checksum
+        return ERROR;
+    }
+
+    uint8_t bufferRegister;
+    // Use corresponding transmit FIFO address
+    switch(port){
+    case PORTA:
+        bufferRegister = TxRxDataA;
+        break;
+    case PORTB:
+        bufferRegister = TxRxDataB;
+        break;
+    default:
+        return ERROR;
+    } // switch(port)
+
+    // Write message to max14819 FIFO
+    retValue = uint8_t(retValue | queueWriteRegister(transaction, bufferRegister, frame.sizeAnswer)); // number of bytes for answer
+    retValue = uint8_t(retValue | queueWriteRegister(transaction, bufferRegister, uint8_t(frame.sizeData + 2))); // number of bytes to send including master command and checksum
+    retValue = uint8_t(retValue | queueWriteRegister(transaction, bufferRegister, frame.mc)); // begin of message, master command
+    if (frame.sizeData == 0) {
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, bufferRegister, frame.ckt)); // second byte of message, checksum (CKT)
+    }
+    else {
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, bufferRegister, IOL::frameCKT(frame, pData)));
+        for (uint8_t i = 0; i < frame.sizeData; i++) {
+            retValue = uint8_t(retValue | queueWriteRegister(transaction, bufferRegister, pData[i])); // send data to buffer
+        }
+    }
 
     // Return Error state
-    return retValue;;
+    return retValue;
 }
 
 //!******************************************************************************
@@ -665,299 +1179,1009 @@ uint8_t Max14819::writeRegister(uint8_t reg, uint8_t data) {
 //!
 //!******************************************************************************
 uint8_t Max14819::writeData(uint8_t mc, uint8_t data, uint8_t sizeAnswer, uint8_t mSeqType, PortSelect port) {
+    return writeData(mc, 1, &data, sizeAnswer, mSeqType, port);
+}
+//!******************************************************************************
+//!  function :    	writeData
+//!******************************************************************************
+//!  \brief       	send data to device
+//!
+//!  \type        	local
+//!
+//!  \param[in]     uint8_t mc			master command
+//!  \param[in]     sizeData	        size in Byte of data
+//!  \param[in]     *pData		        pointer to data
+//!  \param[in]     sizeAnswer	        size in byte of answer
+//!  \param[in]     mSeqType	        M-seqence type
+//!  \param[in]     port		        port to send data
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::writeData(uint8_t mc, uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType, PortSelect port) {
+    return writeFrame(IOL::makeMSequence(mc, mSeqType, sizeData, sizeAnswer), pData, port);
+}
+//!******************************************************************************
+//!  function :    	writeFrame
+//!******************************************************************************
+//!  \brief       	Send a precomputed M-sequence to the device (see
+//!                 IOL::makeMSequence), only the payload is added per call.
+//!
+//!  \type        	local
+//!
+//!  \param[in]     frame               M-sequence
+//!  \param[in]     *pData              payload of frame.sizeData bytes
+//!  \param[in]     port                port to send data
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::writeFrame(IOL::MSequence const &frame, uint8_t const *pData, PortSelect port) {
     uint8_t retValue = SUCCESS;
-
-    uint8_t bufferRegister;
-    // Use corresponding transmit FIFO address
-    switch(port){
-      case PORTA:
-          bufferRegister = TxRxDataA;
-          break;
-      case PORTB:
-          bufferRegister = TxRxDataB;
-          break;
-      default:
-          bufferRegister = 0;
-          retValue = ERROR;
-          break;
-      } // switch(port)
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
 
     // Write message to max14819 FIFO
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, sizeAnswer)); // number of bytes for answer
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, 3)); // 3 bytes to send including master command and checksum
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, mc)); // begin of message, master command
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, calculateCKT(mc, &data, 1, mSeqType))); // second byte of message, checksum (CKT)
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, data)); // send data to buffer, increment address of data after every byte
+    if (queueTxMessage(transaction, frame, pData, port) == ERROR) {
+        return ERROR;
+    }
+
+    // Forget a data ready of a previous message, the answer to this one is awaited
+    pendingInterrupt_ &= uint8_t(~((port == PORTA) ? RxDataRdyA : RxDataRdyB));
 
     // Enable transmit message
     switch(port){
     case PORTA:
-        retValue = uint8_t(retValue | writeRegister(CQCtrlA, CQSend | comSpeedRegA));
-        break;
+       retValue = uint8_t(retValue | queueWriteRegister(transaction, CQCtrlA, CQSend | comSpeedRegA));
+       break;
     case PORTB:
-        retValue = uint8_t(retValue | writeRegister(CQCtrlB, CQSend | comSpeedRegB));
-        break;
+       retValue = uint8_t(retValue | queueWriteRegister(transaction, CQCtrlB, CQSend | comSpeedRegB));
+       break;
     default:
-        retValue = ERROR;
-        break;
-    } // switch(port)
+       retValue = ERROR;
+    break;
+   } // switch(port)
+
+    // Send message and CQSend in one bus transfer
+    transaction.flush();
+    if (retValue == SUCCESS) {
+        sendTime_ns_[port] = get_time_ns();
+    }
 
     // Return Error state
     return retValue;
 }
 //!******************************************************************************
-//!  function :    	writeData
+//!  function :    	writeFrames
 //!******************************************************************************
-//!  \brief       	send data to device
+//!  \brief       	Queue several M-sequences without payload in the transmit
+//!                 FIFO and send the first one. Each following message is
+//!                 sent by readData with sendNext set, so a burst of requests
+//!                 costs one bus transfer per answer. On an error the FIFOs
+//!                 must be cleared with resetFifo.
 //!
 //!  \type        	local
 //!
-//!  \param[in]     uint8_t mc			master command
-//!  \param[in]     sizeData	        size in Byte of data
-//!  \param[in]     *pData		        pointer to data
-//!  \param[in]     sizeAnswer	        size in byte of answer
-//!  \param[in]     mSeqType	        M-seqence type
-//!  \param[in]     port		        port to send data
+//!  \param[in]     *pFrames            M-sequences, sizeData must be 0
+//!  \param[in]     count               number of M-sequences
+//!  \param[in]     port                port to send data
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::writeFrames(IOL::MSequence const *pFrames, uint8_t count, PortSelect port) {
+    uint8_t retValue = SUCCESS;
+    uint16_t sizeFifo = 0;
+
+    if (((port != PORTA) && (port != PORTB)) || (count == 0)) {
+        return ERROR;
+    }
+    // All messages must fit into the transmit FIFO (header, MC and CKT)
+    for (uint8_t i = 0; i < count; i++) {
+        if (pFrames[i].sizeData != 0) {
+            return ERROR;
+        }
+        sizeFifo = uint16_t(sizeFifo + 4);
+    }
+    if (sizeFifo > MAX_MSG_LENGTH) {
+        return ERROR;
+    }
+
+    // Forget a data ready of a previous message, the answer to the first one is awaited
+    pendingInterrupt_ &= uint8_t(~((port == PORTA) ? RxDataRdyA : RxDataRdyB));
+
+    // The first message goes out with CQSend while the others are queued,
+    // all in one bus transfer
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
+    retValue = uint8_t(retValue | queueTxMessage(transaction, pFrames[0], nullptr, port));
+    if (port == PORTA) {
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, CQCtrlA, CQSend | comSpeedRegA));
+    }
+    else {
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, CQCtrlB, CQSend | comSpeedRegB));
+    }
+    for (uint8_t i = 1; i < count; i++) {
+        retValue = uint8_t(retValue | queueTxMessage(transaction, pFrames[i], nullptr, port));
+    }
+    transaction.flush();
+    sendTime_ns_[port] = get_time_ns();
+
+    // Return Error state
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	resetFifo
+//!******************************************************************************
+//!  \brief       	Drop the queued messages and the received answers of a
+//!                 port, e.g. after a failed burst of writeFrames.
+//!
+//!  \type        	local
+//!
+//!  \param[in]     port                PORTA or PORTB
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::resetFifo(PortSelect port) {
+    pendingInterrupt_ &= uint8_t(~((port == PORTA) ? RxDataRdyA : RxDataRdyB));
+    switch(port){
+    case PORTA:
+        return writeRegister(CQCtrlA, uint8_t(TxFifoRst | RxFifoRst | comSpeedRegA));
+    case PORTB:
+        return writeRegister(CQCtrlB, uint8_t(TxFifoRst | RxFifoRst | comSpeedRegB));
+    default:
+        return ERROR;
+    } // switch(port)
+}
+//!******************************************************************************
+//!  function :    	readData
+//!******************************************************************************
+//!  \brief        	readMessage from device
+//!
+//!  \type         	local
+//!
+//!  \param[in]     *pData              pointer to data
+//!  \param[in]     sizeData            size of data
+//!  \param[in]     port                driver PORTA or PORTB
+//!
+//!  \return       	0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::readData(uint8_t *pData, uint8_t sizeData, PortSelect port) {
+    return readData(pData, sizeData, port, 0);
+}
+//!******************************************************************************
+//!  function :    	readData
+//!******************************************************************************
+//!  \brief        	readMessage from device and optionally send the next
+//!                 message queued with writeFrames in the same bus transfer
+//!
+//!  \type         	local
+//!
+//!  \param[in]     *pData              pointer to data
+//!  \param[in]     sizeData            size of data
+//!  \param[in]     port                driver PORTA or PORTB
+//!  \param[in]     sendNext            1 to set CQSend after the read
+//!
+//!  \return       	0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::readData(uint8_t *pData, uint8_t sizeData, PortSelect port, uint8_t sendNext) {
+    uint8_t bufferRegister;
+    uint8_t cqCtrlRegister;
+    uint8_t cqSend;
+    uint8_t retValue = SUCCESS;
+    uint8_t length = 0;
+    // Use corresponding transmit FIFO address
+    switch(port){
+    case PORTA:
+        bufferRegister = TxRxDataA;
+        cqCtrlRegister = CQCtrlA;
+        cqSend = uint8_t(CQSend | comSpeedRegA);
+        break;
+    case PORTB:
+        bufferRegister = TxRxDataB;
+        cqCtrlRegister = CQCtrlB;
+        cqSend = uint8_t(CQSend | comSpeedRegB);
+            break;
+    default:
+        return ERROR;
+    } // switch(port)
+
+    // Read messagelength and data from FIFO in one bus transfer
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
+    retValue = uint8_t(retValue | queueReadRegister(transaction, bufferRegister, &length));
+    for (uint8_t i = 0; i < sizeData; i++) {
+        retValue = uint8_t(retValue | queueReadRegister(transaction, bufferRegister, pData + i));
+    }
+    if (sendNext != 0) {
+        pendingInterrupt_ &= uint8_t(~((port == PORTA) ? RxDataRdyA : RxDataRdyB));
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, cqCtrlRegister, cqSend));
+    }
+    transaction.flush();
+    if (sendNext != 0) {
+        sendTime_ns_[port] = get_time_ns();
+    }
+
+    // Controll if the aswer has the expected length (first byte in the FIFO is the messagelength)
+    if (sizeData != length) {
+        // TODO Error Handling if Buffer is corrupted
+        retValue = ERROR;
+    }
+
+    // Return Error state
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	readInterrupt
+//!******************************************************************************
+//!  \brief        	Read the Interrupt register, which releases the IRQ pin.
+//!                 The flags are collected until a waiter of the corresponding
+//!                 port consumes them, because one read clears the flags of
+//!                 both ports. Transmit and receive errors are published to
+//!                 the event ring of their port. A status change costs one
+//!                 more frame for the Status register, it goes to both rings.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     void
+//!
+//!  \return       	collected interrupt flags
+//!
+//!******************************************************************************
+uint8_t Max14819::readInterrupt(void) {
+    uint8_t flags = readRegister(Interrupt);
+    uint64_t now = get_time_ns();
+
+    if ((flags & RxDataRdyA) != 0) {
+        rxTime_ns_[PORTA] = now;
+    }
+    if ((flags & RxDataRdyB) != 0) {
+        rxTime_ns_[PORTB] = now;
+    }
+
+    if ((flags & (TxErrorA | RxErrorA)) != 0) {
+        publishEvent(PORTA, EVENT_SOURCE_INTERRUPT, uint8_t(flags & (TxErrorA | RxErrorA)), 0);
+    }
+    if ((flags & (TxErrorB | RxErrorB)) != 0) {
+        publishEvent(PORTB, EVENT_SOURCE_INTERRUPT, uint8_t(flags & (TxErrorB | RxErrorB)), 0);
+    }
+    if ((flags & StatusInt) != 0) {
+        uint8_t status = readRegister(Status);
+        publishEvent(PORTA, EVENT_SOURCE_STATUS, status, 0);
+        publishEvent(PORTB, EVENT_SOURCE_STATUS, status, 0);
+    }
+    pendingInterrupt_ |= flags;
+#ifndef ARDUINO
+    if (flags != 0) {
+        chipEvent_.notify_all();
+    }
+#endif
+    return pendingInterrupt_;
+}
+
+//!******************************************************************************
+//!  function :    	publishEvent
+//!******************************************************************************
+//!  \brief        	Push an event record to the ring of a port. Never waits,
+//!                 the record is dropped if the consumer fell behind.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     port                PORTA or PORTB
+//!  \param[in]     source              EVENT_SOURCE_x, see IOLEventRing.h
+//!  \param[in]     value               EventQualifier or register value
+//!  \param[in]     code                EventCode, 0 for the chip sources
+//!
+//!  \return       	void
+//!
+//!******************************************************************************
+void Max14819::publishEvent(PortSelect port, uint8_t source, uint8_t value, uint16_t code) {
+    EventRecord record;
+
+    if ((port != PORTA) && (port != PORTB)) {
+        return;
+    }
+    record.time_ns = Hardware->get_time_ns();
+    record.source = source;
+    record.value = value;
+    record.code = code;
+    eventRings_[port].push(record);
+}
+
+//!******************************************************************************
+//!  function :    	readEventRing
+//!******************************************************************************
+//!  \brief        	Event ring of a port, for the consumer
+//!
+//!  \type         	local
+//!
+//!  \param[in]     port                PORTA or PORTB
+//!
+//!  \return       	ring, nullptr for an invalid port
+//!
+//!******************************************************************************
+IOLEventRing * Max14819::readEventRing(PortSelect port) {
+    if ((port != PORTA) && (port != PORTB)) {
+        return nullptr;
+    }
+    return &eventRings_[port];
+}
+//!******************************************************************************
+//!  function :    	waitForRxData
+//!******************************************************************************
+//!  \brief        	Wait until the answer of the last message of the port is
+//!                 received (RxDataRdy interrupt) or the timeout expires.
+//!                 Interrupts of the other port are kept for its waiter.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     port                PORTA or PORTB
+//!  \param[in]     deadline_ns         worst case time for the answer (see
+//!                                     get_time_ns)
+//!
+//!  \return       	0 if data is ready, 1 on timeout
+//!
+//!******************************************************************************
+uint8_t Max14819::waitForRxData(PortSelect port, uint64_t deadline_ns) {
+    uint8_t rxDataRdy = (port == PORTA) ? RxDataRdyA : RxDataRdyB;
+    HardwareBase::PinNames irqPin = (driver_ == DRIVER01) ? HardwareBase::port01IRQ : HardwareBase::port23IRQ;
+
+    while (1) {
+        if ((pendingInterrupt_ & rxDataRdy) != 0) {
+            pendingInterrupt_ &= uint8_t(~rxDataRdy);
+            rxCount_[port]++;
+            return SUCCESS;
+        }
+        if (Hardware->IO_WaitForInterrupt(irqPin, deadline_ns) == 0) {
+            return ERROR;
+        }
+        readInterrupt();
+    }
+}
+//!******************************************************************************
+//!  function :    	awaitRxData
+//!******************************************************************************
+//!  \brief        	Sleep until the answer of the last message of the port is
+//!                 received, but leave the data ready for the next
+//!                 pollRxData. Used to sleep until a state machine polling the
+//!                 port has something to do. The chip is released while
+//!                 sleeping, so the service thread keeps driving the other
+//!                 port. An answer taken by another thread meanwhile ends the
+//!                 sleep as well. Called with the chip held.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     port                PORTA or PORTB
+//!  \param[in]     deadline_ns         give up at this time (see get_time_ns)
+//!
+//!  \return       	0 if data ready, 1 on timeout
+//!
+//!******************************************************************************
+uint8_t Max14819::awaitRxData(PortSelect port, uint64_t deadline_ns) {
+    uint8_t rxDataRdy = (port == PORTA) ? RxDataRdyA : RxDataRdyB;
+    uint32_t count = rxCount_[port];
+
+    while (((pendingInterrupt_ & rxDataRdy) == 0) && (rxCount_[port] == count)) {
+        if (get_time_ns() >= deadline_ns) {
+            return ERROR;
+        }
+        if (watchPin(deadline_ns) == SUCCESS) {
+            readInterrupt();
+        }
+    }
+    return SUCCESS;
+}
+//!******************************************************************************
+//!  function :    	waitForInterrupt
+//!******************************************************************************
+//!  \brief        	Wait until the interrupt pin of the chip is asserted or
+//!                 the deadline is reached. Only samples the pin, the flags
+//!                 are left to readInterrupt. Takes the chip for the
+//!                 bookkeeping only, the caller does not have to hold it
+//!                 while it sleeps. Returns early if another thread read
+//!                 the flags.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     deadline_ns         give up at this time (see get_time_ns)
+//!
+//!  \return       	0 if the pin is asserted, 1 otherwise
+//!
+//!******************************************************************************
+uint8_t Max14819::waitForInterrupt(uint64_t deadline_ns) {
+    ChipLock lock(this);
+    return watchPin(deadline_ns);
+}
+//!******************************************************************************
+//!  function :    	sleepUntil
+//!******************************************************************************
+//!  \brief        	Sleep until the deadline without the chip, for a thread
+//!                 holding it with nothing to do before. Returns with the
+//!                 chip held again.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     deadline_ns         wake up time (see get_time_ns)
+//!
+//!  \return       	void
+//!
+//!******************************************************************************
+void Max14819::sleepUntil(uint64_t deadline_ns) {
+#ifndef ARDUINO
+    uint32_t depth = releaseChip();
+    wait_until_ns(deadline_ns);
+    retakeChip(depth);
+#else
+    wait_until_ns(deadline_ns);
+#endif
+}
+//!******************************************************************************
+//!  function :    	watchPin
+//!******************************************************************************
+//!  \brief        	Release the chip and wait for its interrupt pin. One
+//!                 thread watches the pin, the others sleep on the chip event
+//!                 until it reads the flags or stops watching. Two waits on
+//!                 the pin would race for the same edge otherwise.
+//!                 Called with the chip held, returns with the chip held.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     deadline_ns         give up at this time (see get_time_ns)
+//!
+//!  \return       	0 if the pin is asserted, 1 on timeout or if woken by
+//!                 another thread
+//!
+//!******************************************************************************
+uint8_t Max14819::watchPin(uint64_t deadline_ns) {
+    HardwareBase::PinNames irqPin = (driver_ == DRIVER01) ? HardwareBase::port01IRQ : HardwareBase::port23IRQ;
+    uint8_t retValue;
+
+    if (Hardware->IO_WaitForInterrupt(irqPin, 0) != 0) {
+        return SUCCESS;
+    }
+    if (get_time_ns() >= deadline_ns) {
+        return ERROR;
+    }
+#ifndef ARDUINO
+    if (isPinWatched_ != 0) {
+        waitChipEvent(deadline_ns);
+        return ERROR;
+    }
+    isPinWatched_ = 1;
+    uint32_t depth = releaseChip();
+    retValue = (Hardware->IO_WaitForInterrupt(irqPin, deadline_ns) != 0) ? SUCCESS : ERROR;
+    retakeChip(depth);
+    isPinWatched_ = 0;
+    chipEvent_.notify_all();
+#else
+    retValue = (Hardware->IO_WaitForInterrupt(irqPin, deadline_ns) != 0) ? SUCCESS : ERROR;
+#endif
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	lock
+//!******************************************************************************
+//!  \brief        	Take the chip for the calling thread, see ChipLock. The
+//!                 ports of a chip share its FIFOs and interrupt flags, only
+//!                 one thread may drive them at a time.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     void
+//!
+//!  \return       	void
+//!
+//!******************************************************************************
+void Max14819::lock(void) {
+#ifndef ARDUINO
+    chipMutex_.lock();
+    lockDepth_++;
+#endif
+}
+//!******************************************************************************
+//!  function :    	unlock
+//!******************************************************************************
+//!  \brief        	Release the chip taken with lock
+//!
+//!  \type         	local
+//!
+//!  \param[in]     void
+//!
+//!  \return       	void
+//!
+//!******************************************************************************
+void Max14819::unlock(void) {
+#ifndef ARDUINO
+    lockDepth_--;
+    chipMutex_.unlock();
+#endif
+}
+#ifndef ARDUINO
+//!******************************************************************************
+//!  function :    	releaseChip
+//!******************************************************************************
+//!  \brief        	Release all recursion levels of the chip held by the
+//!                 calling thread, see retakeChip
+//!
+//!  \type         	local
+//!
+//!  \param[in]     void
+//!
+//!  \return       	recursion levels released
+//!
+//!******************************************************************************
+uint32_t Max14819::releaseChip(void) {
+    uint32_t depth = lockDepth_;
+
+    lockDepth_ = 0;
+    for (uint32_t i = 0; i < depth; i++) {
+        chipMutex_.unlock();
+    }
+    return depth;
+}
+//!******************************************************************************
+//!  function :    	retakeChip
+//!******************************************************************************
+//!  \brief        	Take the chip again with the recursion levels released
+//!                 by releaseChip
+//!
+//!  \type         	local
+//!
+//!  \param[in]     depth               recursion levels, see releaseChip
+//!
+//!  \return       	void
+//!
+//!******************************************************************************
+void Max14819::retakeChip(uint32_t depth) {
+    for (uint32_t i = 0; i < depth; i++) {
+        chipMutex_.lock();
+    }
+    lockDepth_ = depth;
+}
+//!******************************************************************************
+//!  function :    	waitChipEvent
+//!******************************************************************************
+//!  \brief        	Sleep without the chip until another thread reads the
+//!                 interrupt flags or stops watching the pin, at most until
+//!                 the deadline or CHIP_EVENT_MAX_WAIT. Called with the chip
+//!                 held, returns with the chip held. Only used while another
+//!                 thread watches the pin, i.e. in real time.
+//!
+//!  \type         	local
+//!
+//!  \param[in]     deadline_ns         give up at this time (see get_time_ns)
+//!
+//!  \return       	void
+//!
+//!******************************************************************************
+void Max14819::waitChipEvent(uint64_t deadline_ns) {
+    uint64_t now = get_time_ns();
+    uint32_t depth = lockDepth_;
+
+    if (deadline_ns <= now) {
+        return;
+    }
+    uint64_t timeout_ns = deadline_ns - now;
+    if (timeout_ns > CHIP_EVENT_MAX_WAIT) {
+        timeout_ns = CHIP_EVENT_MAX_WAIT;
+    }
+
+    // The condition variable releases the last recursion level
+    lockDepth_ = 0;
+    for (uint32_t i = 1; i < depth; i++) {
+        chipMutex_.unlock();
+    }
+    std::unique_lock<std::recursive_mutex> lock(chipMutex_, std::adopt_lock);
+    chipEvent_.wait_for(lock, std::chrono::nanoseconds(timeout_ns));
+    lock.release();
+    for (uint32_t i = 1; i < depth; i++) {
+        chipMutex_.lock();
+    }
+    lockDepth_ = depth;
+}
+#endif
+//!******************************************************************************
+//!  function :    	enableCyclicSend
+//!******************************************************************************
+//!  \brief         Set master command, which will be send periodically.
+//!                 Set cycleTime to 0 to use the minCycleTime from the device
+//!                 (see writeCycleTimer). The message stays in the transmit
+//!                 FIFO (TxKeepMsg), the answers are collected with
+//!                 readCyclicData.
+//!
+//!  \type          local
+//!
+//!  \param[in]     mc                  master command, only one message possible
+//!  \param[in]     sizeData            size in byte of data
+//!  \param[in]     *pData              pointer to data
+//!  \param[in]     sizeAnswer          size in byte of answer
+//!  \param[in]     mSeqType            M-seqence type
+//!  \param[in]     minCycleTime        in a multiple of 0.1ms, min 0.4ms, max 132.8ms
+//!  \param[in]     port                port to send data
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::enableCyclicSend(uint8_t mc, uint8_t sizeData, uint8_t *pData,uint8_t sizeAnswer, uint8_t mSeqType, uint16_t cycleTime,PortSelect port) {
+    uint8_t retValue = SUCCESS;
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
+
+    if ((port != PORTA) && (port != PORTB)) {
+        return ERROR;
+    }
+    uint8_t cyclTmrRegister = (port == PORTA) ? CyclTmrA : CyclTmrB;
+
+    // Set cycleTime (use minCycleTime stored allready CyclTmrA/B when 0
+    uint8_t cycleBase = 0;
+    uint8_t cycleMult = 0;
+    if (cycleTime == 0) {
+    } else if ((cycleTime >= 4) && (cycleTime <= 63)) {
+        // Calculate CyclTmr register values, base 0.1ms, no offset
+        cycleBase = 1;
+        cycleMult = uint8_t(cycleTime / cycleBase);
+        // Write cycle base and cycle multiplicator in cycle register
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, cyclTmrRegister, cycleMult));
+    } else if (cycleTime <= 316) {
+        // Calculate CyclTmr register values, base 0.4ms, offset 6.4ms
+        cycleBase = 4;
+        cycleMult = uint8_t((cycleTime - 64) / cycleBase);
+        // Write cycle base and cycle multiplicator in cycle register
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, cyclTmrRegister, TCyclBs0 | cycleMult));
+    } else if (cycleTime <= 1328) {
+        // Calculate CyclTmr register values, base 1.6ms, offset 32ms
+        cycleBase = 16;
+        cycleMult = uint8_t((cycleTime - 320) / cycleBase);
+        // Write cycle base and cycle multiplicator in cycle register
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, cyclTmrRegister, TCyclBs1 | cycleMult));
+    } else {
+        return ERROR;
+    }
+
+    // The cycle timer and no trigger starts the message
+    uint8_t trigAssgnRegister = (port == PORTA) ? TrigAssgnA : TrigAssgnB;
+    if (readRegister(trigAssgnRegister) != 0) {
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, trigAssgnRegister, 0));
+    }
+
+    // Keep the message in the transmit FIFO, so the chip resends it every cycle
+    uint8_t msgCtrlRegister = (port == PORTA) ? MsgCtrlA : MsgCtrlB;
+    retValue = uint8_t(retValue | queueWriteRegister(transaction, msgCtrlRegister, uint8_t(readRegister(msgCtrlRegister) | TxKeepMsg)));
+
+    // Write message to max14819 FIFO
+    if (queueTxMessage(transaction, IOL::makeMSequence(mc, mSeqType, sizeData, sizeAnswer), pData, port) == ERROR) {
+        return ERROR;
+    }
+
+    // Forget a data ready of a previous message, the answers are awaited from now on
+    pendingInterrupt_ &= uint8_t(~((port == PORTA) ? RxDataRdyA : RxDataRdyB));
+
+    // enable cyclic send
+    if (port == PORTA)
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, CQCtrlA, CycleTmrEn | comSpeedRegA));
+    if (port == PORTB)
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, CQCtrlB, CycleTmrEn | comSpeedRegB));
+
+    // Send timer, message and enable in one bus transfer
+    transaction.flush();
+
+    // Return Error state
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	writeCyclicFrame
+//!******************************************************************************
+//!  \brief         Replace the message of the running cycle timer. With keep
+//!                 the message is sent every cycle (TxKeepMsg), otherwise it
+//!                 is sent once at the next cycle and the timer sends nothing
+//!                 until the next message is written. Reset drops the kept
+//!                 message and the received answers first. The timer keeps
+//!                 its phase. A port started by a trigger keeps its trigger
+//!                 and the timer stays off.
+//!
+//!  \type          local
+//!
+//!  \param[in]     frame               M-sequence, see IOL::makeMSequence
+//!  \param[in]     *pData              payload of frame.sizeData bytes
+//!  \param[in]     keep                1 to repeat the message every cycle
+//!  \param[in]     reset               1 to reset both FIFOs before
+//!  \param[in]     port                PORTA or PORTB
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::writeCyclicFrame(IOL::MSequence const &frame, uint8_t const *pData, uint8_t keep, uint8_t reset, PortSelect port) {
+    uint8_t retValue = SUCCESS;
+
+    if ((port != PORTA) && (port != PORTB)) {
+        return ERROR;
+    }
+    uint8_t cqCtrlRegister = (port == PORTA) ? CQCtrlA : CQCtrlB;
+    uint8_t msgCtrlRegister = (port == PORTA) ? MsgCtrlA : MsgCtrlB;
+    uint8_t msgCtrl = readRegister(msgCtrlRegister);
+    uint8_t newMsgCtrl = (keep != 0) ? uint8_t(msgCtrl | TxKeepMsg) : uint8_t(msgCtrl & ~TxKeepMsg);
+    uint8_t cycleTmrEn = ((readRegister((port == PORTA) ? TrigAssgnA : TrigAssgnB) & TrigEn) == 0) ? CycleTmrEn : 0;
+
+    // Reset, message control and message in one bus transfer
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
+    if (reset != 0) {
+        pendingInterrupt_ &= uint8_t(~((port == PORTA) ? RxDataRdyA : RxDataRdyB));
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, cqCtrlRegister,
+                uint8_t(TxFifoRst | RxFifoRst | cycleTmrEn | ((port == PORTA) ? comSpeedRegA : comSpeedRegB))));
+    }
+    if (newMsgCtrl != msgCtrl) {
+        retValue = uint8_t(retValue | queueWriteRegister(transaction, msgCtrlRegister, newMsgCtrl));
+    }
+    if (queueTxMessage(transaction, frame, pData, port) == ERROR) {
+        return ERROR;
+    }
+    transaction.flush();
+
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	disableCyclicSend
+//!******************************************************************************
+//! \brief          Disable cyclic or triggered send and set the cyclic send
+//!                 timer to the minimum cycle time of the device
+//!
+//!  \type          local
+//!
+//!  \param[in]     cycleTime           MIN_CYCLE_TIME of the device, IO-Link encoding
+//!  \param[in]     port                PORTA or PORTB
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::disableCyclicSend(uint8_t cycleTime, PortSelect port) {
+    uint8_t retValue = SUCCESS;
+
+    // Disable cyclic send and drop the kept message
+    if (port == PORTA) {
+        retValue = uint8_t(retValue | writeRegister(CQCtrlA, comSpeedRegA));
+        retValue = uint8_t(retValue | writeRegister(MsgCtrlA, uint8_t(readRegister(MsgCtrlA) & ~TxKeepMsg)));
+        retValue = uint8_t(retValue | writeRegister(CQCtrlA, TxFifoRst | comSpeedRegA));
+    }
+    if (port == PORTB) {
+        retValue = uint8_t(retValue | writeRegister(CQCtrlB, comSpeedRegB));
+        retValue = uint8_t(retValue | writeRegister(MsgCtrlB, uint8_t(readRegister(MsgCtrlB) & ~TxKeepMsg)));
+        retValue = uint8_t(retValue | writeRegister(CQCtrlB, TxFifoRst | comSpeedRegB));
+    }
+    uint8_t trigAssgnRegister = (port == PORTA) ? TrigAssgnA : TrigAssgnB;
+    if (readRegister(trigAssgnRegister) != 0) {
+        retValue = uint8_t(retValue | writeRegister(trigAssgnRegister, 0));
+    }
+
+    // Reset the cycle timer to the minimum cycle time of the device
+    retValue = uint8_t(retValue | writeCycleTimer(cycleTime, port));
+
+    // Return Error state
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	enableTriggeredSend
+//!******************************************************************************
+//! \brief          Let a trigger start the message instead of the cycle
+//!                 timer. The message stays in the transmit FIFO
+//!                 (TxKeepMsg) and is sent each time the trigger is written
+//!                 (see fireTrigger), all ports of the chip assigned to the
+//!                 same trigger start together. The answers are collected
+//!                 with readCyclicData.
+//!
+//!  \type          local
+//!
+//!  \param[in]     mc                  master command
+//!  \param[in]     sizeData            size of the payload
+//!  \param[in]     *pData              payload
+//!  \param[in]     sizeAnswer          size of the answer
+//!  \param[in]     mSeqType            M-sequence type
+//!  \param[in]     trigger             0 to TRIGGER_COUNT - 1
+//!  \param[in]     port                PORTA or PORTB
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::enableTriggeredSend(uint8_t mc, uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType, uint8_t trigger, PortSelect port) {
+    uint8_t retValue = SUCCESS;
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
+
+    if (((port != PORTA) && (port != PORTB)) || (trigger >= TRIGGER_COUNT)) {
+        return ERROR;
+    }
+
+    // Stop the cycle timer, assign the trigger (one Trig bit per trigger)
+    retValue = uint8_t(retValue | queueWriteRegister(transaction, (port == PORTA) ? CQCtrlA : CQCtrlB,
+            (port == PORTA) ? comSpeedRegA : comSpeedRegB));
+    retValue = uint8_t(retValue | queueWriteRegister(transaction, (port == PORTA) ? TrigAssgnA : TrigAssgnB,
+            uint8_t((Trig0 << trigger) | TrigEn)));
+
+    // Keep the message in the transmit FIFO, so every trigger resends it
+    uint8_t msgCtrlRegister = (port == PORTA) ? MsgCtrlA : MsgCtrlB;
+    retValue = uint8_t(retValue | queueWriteRegister(transaction, msgCtrlRegister, uint8_t(readRegister(msgCtrlRegister) | TxKeepMsg)));
+    if (queueTxMessage(transaction, IOL::makeMSequence(mc, mSeqType, sizeData, sizeAnswer), pData, port) == ERROR) {
+        return ERROR;
+    }
+
+    // Forget a data ready of a previous message, the answers are awaited from now on
+    pendingInterrupt_ &= uint8_t(~((port == PORTA) ? RxDataRdyA : RxDataRdyB));
+
+    // Assignment and message in one bus transfer
+    transaction.flush();
+
+    return retValue;
+}
+//!******************************************************************************
+//!  function :    	fireTrigger
+//!******************************************************************************
+//! \brief          Start the messages of all ports assigned to a trigger
+//!                 with a single register write
+//!
+//!  \type          local
+//!
+//!  \param[in]     trigger             0 to TRIGGER_COUNT - 1
+//!  \param[out]    *pTime_ns           end of the write, may be nullptr
 //!
 //!  \return        0 if success
 //!
 //!******************************************************************************
-uint8_t Max14819::writeData(uint8_t mc, uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType, PortSelect port) {
-    uint8_t retValue = SUCCESS;
-
-    // Test if message is not too long
-    if ((sizeData + 2) > MAX_MSG_LENGTH) { //include 1 byte masterc ommand and 1 byte for checksum
+uint8_t Max14819::fireTrigger(uint8_t trigger, uint64_t *pTime_ns) {
+    if (trigger >= TRIGGER_COUNT) {
         return ERROR;
     }
-
-    uint8_t bufferRegister;
-    // Use corresponding transmit FIFO address
-    switch(port){
-    case PORTA:
-        bufferRegister = TxRxDataA;
-        break;
-    case PORTB:
-        bufferRegister = TxRxDataB;
-        break;
-    default:
-        bufferRegister = 0;
-        retValue = ERROR;
-        break;
-    } // switch(port)
-
-    // Write message to max14819 FIFO
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, sizeAnswer)); // number of bytes for answer
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, uint8_t(sizeData + 2))); // number of bytes to send including master command and checksum
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, mc)); // begin of message, master command
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, calculateCKT(mc, pData, sizeData, mSeqType))); // second byte of message, checksum (CKT)
-    for (uint8_t i = 0; i < sizeData; i++) {
-        retValue = uint8_t(retValue | writeRegister(bufferRegister, *pData)); // send data to buffer, increment address of data after every byte
-        pData++;
+    uint8_t retValue = writeRegister(Trigger, uint8_t(TrigInit0 << trigger));
+    triggerTime_ns_[trigger] = get_time_ns();
+    if (pTime_ns != nullptr) {
+        *pTime_ns = triggerTime_ns_[trigger];
     }
-    // Enable transmit message
-    switch(port){
-    case PORTA:
-       retValue = uint8_t(retValue | writeRegister(CQCtrlA, CQSend | comSpeedRegA));
-       break;
-    case PORTB:
-       retValue = uint8_t(retValue | writeRegister(CQCtrlB, CQSend | comSpeedRegB));
-       break;
-    default:
-       retValue = ERROR;
-    break;
-   } // switch(port)
-    // Return Error state
     return retValue;
-
 }
 //!******************************************************************************
-//!  function :    	readData
+//!  function :    	readTriggerTime
 //!******************************************************************************
-//!  \brief        	readMessage from device
+//! \brief          Returns the time of the last write of a trigger, the
+//!                 start of the messages of its ports
 //!
-//!  \type         	local
+//!  \type          local
 //!
-//!  \param[in]     *pData              pointer to data
-//!  \param[in]     sizeData            size of data
-//!  \param[in]     port                driver PORTA or PORTB
+//!  \param[in]     trigger             0 to TRIGGER_COUNT - 1
 //!
-//!  \return       	0 if success
+//!  \return        time in nanoseconds (see get_time_ns), 0 if never written
 //!
 //!******************************************************************************
-uint8_t Max14819::readData(uint8_t *pData, uint8_t sizeData, PortSelect port) {
-    uint8_t bufferRegister;
-    uint8_t retValue = SUCCESS;
-    // Use corresponding transmit FIFO address
-    switch(port){
-    case PORTA:
-        bufferRegister = TxRxDataA;
-        break;
-    case PORTB:
-        bufferRegister = TxRxDataB;
-            break;
-    default:
-        retValue = ERROR;
-        bufferRegister = 0;
-        break;
-    } // switch(port)
-
-    // Controll if the aswer has the expected length (first byte in the FIFO is the messagelength)
-    if (sizeData != readRegister(bufferRegister)) {
-        // TODO Error Handling if Buffer is corrupted
-        retValue = ERROR;
+uint64_t Max14819::readTriggerTime(uint8_t trigger) {
+    return (trigger < TRIGGER_COUNT) ? triggerTime_ns_[trigger] : 0;
+}
+//!******************************************************************************
+//!  function :    	readSendTime
+//!******************************************************************************
+//! \brief          Returns the time of the last CQSend of a port, the start
+//!                 of its last message sent without trigger or cycle timer
+//!
+//!  \type          local
+//!
+//!  \param[in]     port                PORTA or PORTB
+//!
+//!  \return        time in nanoseconds (see get_time_ns), 0 if never sent
+//!
+//!******************************************************************************
+uint64_t Max14819::readSendTime(PortSelect port) {
+    return ((port == PORTA) || (port == PORTB)) ? sendTime_ns_[port] : 0;
+}
+//!******************************************************************************
+//!  function :    	readRxTime
+//!******************************************************************************
+//! \brief          Returns the time the last RxDataRdy of a port was read
+//!                 from the Interrupt register, the completion of its last
+//!                 answer as seen by the master
+//!
+//!  \type          local
+//!
+//!  \param[in]     port                PORTA or PORTB
+//!
+//!  \return        time in nanoseconds (see get_time_ns), 0 if never received
+//!
+//!******************************************************************************
+uint64_t Max14819::readRxTime(PortSelect port) {
+    return ((port == PORTA) || (port == PORTB)) ? rxTime_ns_[port] : 0;
+}
+//!******************************************************************************
+//!  function :    	writeCycleTimer
+//!******************************************************************************
+//! \brief          Write the cycle timer of a port. The register uses the same
+//!                 encoding as the IO-Link MIN_CYCLE_TIME and MAS_CYCLE_TIME
+//!                 pages (time base in bit 7:6, multiplier in bit 5:0), so the
+//!                 value read from the device can be used directly. Values
+//!                 below 0.4ms are raised to 0.4ms.
+//!
+//!  \type          local
+//!
+//!  \param[in]     cycleTime           cycle time in IO-Link encoding
+//!  \param[in]     port                PORTA or PORTB
+//!
+//!  \return        0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::writeCycleTimer(uint8_t cycleTime, PortSelect port) {
+    if ((port != PORTA) && (port != PORTB)) {
+        return ERROR;
     }
-
-    // Read data from FIFO
-    for (uint8_t i = 0; i < sizeData; i++) {
-        *pData++ = readRegister(bufferRegister);
+    if (((cycleTime & (TCyclBs1 | TCyclBs0)) == 0) && (cycleTime < MIN_CYCL_TMR)) {
+        cycleTime = MIN_CYCL_TMR;
     }
-    // Return Error state
-    return retValue;
+    return writeRegister((port == PORTA) ? CyclTmrA : CyclTmrB, cycleTime);
 }
 //!******************************************************************************
-//!  function :    	enableCyclicSend
+//!  function :    	readCyclicData
 //!******************************************************************************
-//!  \brief         Set master command, which will be send periodically.
-//!                 Set cycleTime to 0 to use the minCycleTime from the device.
+//! \brief          Drain the receive FIFO of a port in cyclic send mode and
+//!                 return the newest answer. The FIFO level is read first,
+//!                 then all answers in one bus transfer, older answers which
+//!                 piled up are overwritten. A FIFO which does not hold whole
+//!                 answers (overrun) is reset.
 //!
 //!  \type          local
 //!
-//!  \param[in]     mc                  master command, only one message possible
-//!  \param[in]     sizeData            size in byte of data
 //!  \param[in]     *pData              pointer to data
-//!  \param[in]     sizeAnswer          size in byte of answer
-//!  \param[in]     mSeqType            M-seqence type
-//!  \param[in]     minCycleTime        in a multiple of 0.1ms, min 0.4ms, max 132.8ms
-//!  \param[in]     port                port to send data
+//!  \param[in]     sizeData            size of one answer
+//!  \param[in]     port                PORTA or PORTB
 //!
 //!  \return        0 if success
 //!
 //!******************************************************************************
-uint8_t Max14819::enableCyclicSend(uint8_t mc, uint8_t sizeData, uint8_t *pData,uint8_t sizeAnswer, uint8_t mSeqType, uint16_t cycleTime,PortSelect port) {
+uint8_t Max14819::readCyclicData(uint8_t *pData, uint8_t sizeData, PortSelect port) {
     uint8_t retValue = SUCCESS;
+    uint8_t level = 0;
+    uint8_t length = 0;
+    uint8_t answerSize = uint8_t(sizeData + 1); // including the length byte
 
-    // Set cycleTime (use minCycleTime stored allready CyclTmrA/B when 0
-    uint8_t cycleBase = 0;
-    uint8_t cycleMult = 0;
-    if (cycleTime == 0) {
-    } else if ((cycleTime >= 4) && (cycleTime <= 63)) {
-        // Calculate CyclTmr register values, base 0.1ms, no offset
-        cycleBase = 1;
-        cycleMult = uint8_t(cycleTime / cycleBase);
-        // Write cycle base and cycle multiplicator in cycle register
-        if (port == PORTA)
-            retValue = uint8_t(retValue | writeRegister(CyclTmrA, cycleMult));
-        if (port == PORTB)
-            retValue = uint8_t(retValue | writeRegister(CyclTmrB, cycleMult));
-    } else if (cycleTime <= 316) {
-        // Calculate CyclTmr register values, base 0.4ms, offset 6.4ms
-        cycleBase = 4;
-        cycleMult = uint8_t((cycleTime - 64) / cycleBase);
-        // Write cycle base and cycle multiplicator in cycle register
-        if (port == PORTA)
-            retValue = uint8_t(retValue | writeRegister(CyclTmrA, TCyclBs0 | cycleMult));
-        if (port == PORTB)
-            retValue = uint8_t(retValue | writeRegister(CyclTmrB, TCyclBs0 | cycleMult));
-    } else if (cycleTime <= 1328) {
-        // Calculate CyclTmr register values, base 1.6ms, offset 32ms
-        cycleBase = 16;
-        cycleMult = uint8_t((cycleTime - 320) / cycleBase);
-        // Write cycle base and cycle multiplicator in cycle register
-        if (port == PORTA)
-            retValue = uint8_t(retValue | writeRegister(CyclTmrA, TCyclBs1 | cycleMult));
-        if (port == PORTB)
-            retValue = uint8_t(retValue | writeRegister(CyclTmrB, TCyclBs1 | cycleMult));
-    } else {
+    if ((port != PORTA) && (port != PORTB)) {
         return ERROR;
     }
+    uint8_t bufferRegister = (port == PORTA) ? TxRxDataA : TxRxDataB;
 
-    // Test if message is not too long
-    if ((sizeData + 2) > MAX_MSG_LENGTH) { //include 1 byte master command and 1 byte for checksum
-        return ERROR;
+    // Read the FIFO level first, an empty or torn FIFO is not read
+    level = readRegister((port == PORTA) ? RxFIFOLvlA : RxFIFOLvlB);
+    if ((level == 0) || (level > RX_FIFO_SIZE) || ((level % answerSize) != 0)) {
+        return resyncCyclicFifo(port);
     }
 
-    uint8_t bufferRegister;
-    // Use corresponding transmit FIFO address
-    if (port == PORTA)
-        bufferRegister = TxRxDataA;
-    if (port == PORTB)
-        bufferRegister = TxRxDataB;
-
-    // Write message to max14819 FIFO
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, sizeAnswer)); // number of bytes for answer
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, uint8_t(sizeData + 2))); // number of bytes to send including master command and checksum
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, mc)); // begin of message, master command
-    retValue = uint8_t(retValue | writeRegister(bufferRegister, calculateCKT(mc, pData, sizeData, mSeqType))); // second byte of message, checksum (CKT)
-    for (uint8_t i = 0; i < sizeData; i++) {
-        retValue = uint8_t(retValue | writeRegister(bufferRegister, *pData)); // send data to buffer, increment address of data after every byte
-        pData++;
+    // Read all answers in one bus transfer, the newest one is kept
+    HardwareBase::SPITransaction transaction(Hardware, spiChannel());
+    for (; level >= answerSize; level = uint8_t(level - answerSize)) {
+        retValue = uint8_t(retValue | queueReadRegister(transaction, bufferRegister, &length));
+        for (uint8_t i = 0; i < sizeData; i++) {
+            retValue = uint8_t(retValue | queueReadRegister(transaction, bufferRegister, pData + i));
+        }
     }
+    transaction.flush();
 
-    // enable cyclic send
-    if (port == PORTA)
-        retValue = uint8_t(retValue | writeRegister(CQCtrlA, CycleTmrEn | comSpeedRegA));
-    if (port == PORTB)
-        retValue = uint8_t(retValue | writeRegister(CQCtrlB, CycleTmrEn | comSpeedRegB));
+    if (length != sizeData) {
+        return resyncCyclicFifo(port);
+    }
 
     // Return Error state
     return retValue;
 }
 //!******************************************************************************
-//!  function :    	disableCyclicSend
+//!  function :    	resyncCyclicFifo
 //!******************************************************************************
-//! \brief          Disable cyclic send and set the cyclic send timer to
-//!                 minCycleTime
+//! \brief          Reset the receive FIFO of a port in cyclic or triggered
+//!                 send mode, so the next answer starts in sync. The cycle
+//!                 timer is only kept running if no trigger is assigned, as
+//!                 in writeCyclicFrame.
 //!
 //!  \type          local
 //!
 //!  \param[in]     port                PORTA or PORTB
 //!
-//!  \return        0 if success
+//!  \return        1, the answer is lost
 //!
 //!******************************************************************************
-uint8_t Max14819::disableCyclicSend(PortSelect port) {
-    uint8_t retValue = SUCCESS;
-
-    // Disable cyclic send
-    if (port == PORTA)
-        retValue = uint8_t(retValue | writeRegister(CQCtrlA, comSpeedRegA));
-    if (port == PORTB)
-        retValue = uint8_t(retValue | writeRegister(CQCtrlB, comSpeedRegB));
+uint8_t Max14819::resyncCyclicFifo(PortSelect port) {
+    uint8_t cycleTmrEn = ((readRegister((port == PORTA) ? TrigAssgnA : TrigAssgnB) & TrigEn) == 0) ? CycleTmrEn : 0;
 
-    // Reset CyclTmr register to minCycleTime
-    uint16_t cycleTime = 100; // TODO use minCycleTime stored in port Object
-    uint8_t cycleBase = 0;
-    uint8_t cycleMult = 0;
-    if ((cycleTime >= 4) && (cycleTime <= 63)) {
-        // Calculate CyclTmr register values, base 0.1ms, no offset
-        cycleBase = 1;
-        cycleMult = uint8_t(cycleTime / cycleBase);
-        // Write cycle base and cycle multiplicator in cycle register
-        if (port == PORTA)
-            retValue = uint8_t(retValue | writeRegister(CyclTmrA, cycleMult));
-        if (port == PORTB)
-            retValue = uint8_t(retValue | writeRegister(CyclTmrB, cycleMult));
-    } else if (cycleTime <= 316) {
-        // Calculate CyclTmr register values, base 0.4ms, offset 6.4ms
-        cycleBase = 4;
-        cycleMult = uint8_t((cycleTime - 64) / cycleBase);
-        // Write cycle base and cycle multiplicator in cycle register
-        if (port == PORTA)
-            retValue = uint8_t(retValue | writeRegister(CyclTmrA, TCyclBs0 | cycleMult));
-        if (port == PORTB)
-            retValue = uint8_t(retValue | writeRegister(CyclTmrB, TCyclBs0 | cycleMult));
-    } else if (cycleTime <= 1328) {
-        // Calculate CyclTmr register values, base 1.6ms, offset 32ms
-        cycleBase = 16;
-        cycleMult = uint8_t((cycleTime - 320) / cycleBase);
-        // Write cycle base and cycle multiplicator in cycle register
-        if (port == PORTA)
-            retValue = uint8_t(retValue | writeRegister(CyclTmrA, TCyclBs1 | cycleMult));
-        if (port == PORTB)
-            retValue = uint8_t(retValue | writeRegister(CyclTmrB, TCyclBs1 | cycleMult));
-    }
-    // Return Error state
-    return retValue;
+    writeRegister((port == PORTA) ? CQCtrlA : CQCtrlB,
+            uint8_t(RxFifoRst | cycleTmrEn | ((port == PORTA) ? comSpeedRegA : comSpeedRegB)));
+    return ERROR;
 }
 //!******************************************************************************
 //!  function :    	enableLedControl
@@ -1289,11 +2513,11 @@ uint8_t Max14819::readCQ(PortSelect port) {
     switch(port){
     case PORTA:
         // Return current mode (last 2 bits) from IOStCfgA register
-        state = ((readRegister(IOStCfgA)) & CQLevel) >> 6;
+        state = ((readRegisterUncached(IOStCfgA)) & CQLevel) >> 6;
         break;
     case PORTB:
         // Return current mode (last 2 bits) from IOStCfgB register
-        state = ((readRegister(IOStCfgB)) & CQLevel) >> 6;
+        state = ((readRegisterUncached(IOStCfgB)) & CQLevel) >> 6;
         break;
     default:
         state = ERROR;
@@ -1365,11 +2589,11 @@ uint8_t Max14819::readDI(PortSelect port) {
     switch(port){
     case PORTA:
         // Return current mode (last 2 bits) from IOStCfgA register
-        state = ((readRegister(IOStCfgA)) & DiLevel) >> 7;
+        state = ((readRegisterUncached(IOStCfgA)) & DiLevel) >> 7;
         break;
     case PORTB:
         // Return current mode (last 2 bits) from IOStCfgB register
-        state = ((readRegister(IOStCfgB)) & DiLevel) >> 7;
+        state = ((readRegisterUncached(IOStCfgB)) & DiLevel) >> 7;
         break;
     default:
         state = ERROR;
@@ -1377,6 +2601,183 @@ uint8_t Max14819::readDI(PortSelect port) {
     }
     return state;
 }
+//!******************************************************************************
+//!  function :    	readRegisterStats
+//!******************************************************************************
+//! \brief        	Copy the SPI traffic counters of a register. Can be called
+//!                 from another thread while the driver is running.
+//!
+//!  \type          local
+//!
+//!  \param[in]	  	reg         register address
+//!  \param[out]    *pStats     counters of the register
+//!
+//!  \return       	0 if success
+//!
+//!******************************************************************************
+uint8_t Max14819::readRegisterStats(uint8_t reg, RegisterStats *pStats) {
+    if (reg > MAX_REG) {
+        return ERROR;
+    }
+    pStats->reads = regStats_[reg].reads.load(std::memory_order_relaxed);
+    pStats->writes = regStats_[reg].writes.load(std::memory_order_relaxed);
+    pStats->shadowHits = regStats_[reg].shadowHits.load(std::memory_order_relaxed);
+    pStats->bytes = regStats_[reg].bytes.load(std::memory_order_relaxed);
+    return SUCCESS;
+}
+//!******************************************************************************
+//!  function :    	clearRegisterStats
+//!******************************************************************************
+//! \brief        	Reset the SPI traffic counters of all registers
+//!
+//!  \type          local
+//!
+//!  \param[in]	  	void
+//!
+//!  \return       	void
+//!
+//!******************************************************************************
+void Max14819::clearRegisterStats(void) {
+    for (uint8_t i = 0; i <= MAX_REG; i++) {
+        regStats_[i].reads.store(0, std::memory_order_relaxed);
+        regStats_[i].writes.store(0, std::memory_order_relaxed);
+        regStats_[i].shadowHits.store(0, std::memory_order_relaxed);
+        regStats_[i].bytes.store(0, std::memory_order_relaxed);
+    }
+    rangeErrors_.store(0, std::memory_order_relaxed);
+}
+//!******************************************************************************
+//!  function :    	enableTrace
+//!******************************************************************************
+//! \brief        	Start or stop recording the SPI frames in the trace ring.
+//!                 A traced frame costs one get_time_ns call.
+//!
+//!  \type          local
+//!
+//!  \param[in]	  	enable      1 to record, 0 to stop
+//!
+//!  \return       	void
+//!
+//!******************************************************************************
+void Max14819::enableTrace(uint8_t enable) {
+    isTraceEn_.store(enable, std::memory_order_relaxed);
+}
+//!******************************************************************************
+//!  function :    	readTrace
+//!******************************************************************************
+//! \brief        	Copy the newest frames of the trace ring, the oldest first.
+//!                 Can be called from another thread while the driver is
+//!                 running, frames overwritten during the copy are dropped.
+//!
+//!  \type          local
+//!
+//!  \param[out]    *pEntries   buffer for the frames
+//!  \param[in]	  	maxEntries  size of the buffer
+//!
+//!  \return       	number of frames copied
+//!
+//!******************************************************************************
+uint16_t Max14819::readTrace(TraceEntry *pEntries, uint16_t maxEntries) {
+    uint32_t head = traceHead_.load(std::memory_order_acquire);
+    uint32_t count = (head < TRACE_SIZE) ? head : TRACE_SIZE;
+    if (count > maxEntries) {
+        count = maxEntries;
+    }
+    uint16_t copied = 0;
+
+    for (uint32_t index = head - count; index != head; index++) {
+        TraceSlot *pEntry = &trace_[index & (TRACE_SIZE - 1)];
+        uint32_t seq = pEntry->seq.load(std::memory_order_acquire);
+        pEntries[copied].command = pEntry->command;
+        pEntries[copied].data = pEntry->data;
+        pEntries[copied].time_ns = pEntry->time_ns;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Keep the frame only if the writer did not touch it during the copy
+        if ((seq == index + 1) && (pEntry->seq.load(std::memory_order_relaxed) == seq)) {
+            pEntries[copied].seq = seq;
+            copied++;
+        }
+    }
+    return copied;
+}
+//!******************************************************************************
+//!  function :    	printStatistics
+//!******************************************************************************
+//! \brief        	Print the SPI traffic of every accessed register and, if
+//!                 enabled, the trace ring with the time relative to the
+//!                 newest frame
+//!
+//!  \type          local
+//!
+//!  \param[in]	  	void
+//!
+//!  \return       	void
+//!
+//!******************************************************************************
+void Max14819::printStatistics(void) {
+    char buf[96];
+    RegisterStats stats;
+
+    sprintf(buf, "MAX14819 DRIVER%s register traffic (reads/writes/shadow hits/bytes):",
+            (driver_ == DRIVER01) ? "01" : "23");
+    Hardware->Serial_Write(buf);
+    for (uint8_t reg = 0; reg <= MAX_REG; reg++) {
+        readRegisterStats(reg, &stats);
+        if ((stats.reads | stats.writes | stats.shadowHits) == 0) {
+            continue;
+        }
+        sprintf(buf, "  %-12s %10lu %10lu %10lu %10lu", REGISTER_NAMES[reg], (unsigned long)stats.reads,
+                (unsigned long)stats.writes, (unsigned long)stats.shadowHits, (unsigned long)stats.bytes);
+        Hardware->Serial_Write(buf);
+    }
+    if (rangeErrors_.load(std::memory_order_relaxed) != 0) {
+        sprintf(buf, "  address out of range: %lu", (unsigned long)rangeErrors_.load(std::memory_order_relaxed));
+        Hardware->Serial_Write(buf);
+    }
+
+    if (isTraceEn_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    TraceEntry entries[TRACE_SIZE];
+    uint16_t count = readTrace(entries, TRACE_SIZE);
+    Hardware->Serial_Write("  trace (us before the newest frame, command, data):");
+    for (uint16_t i = 0; i < count; i++) {
+        uint8_t reg = uint8_t(entries[i].command & MAX_REG);
+        sprintf(buf, "  %8lu %s %-12s 0x%02X", (unsigned long)((entries[count - 1].time_ns - entries[i].time_ns) / NS_PER_US),
+                ((entries[i].command & 0x80u) != 0) ? "R" : "W", REGISTER_NAMES[reg], entries[i].data);
+        Hardware->Serial_Write(buf);
+    }
+}
+//!******************************************************************************
+//!  function :    	traceFrame
+//!******************************************************************************
+//! \brief        	Record a frame in the trace ring if tracing is enabled.
+//!                 Only the driver writes the ring, the sequence number of an
+//!                 entry is cleared while it is written.
+//!
+//!  \type          local
+//!
+//!  \param[in]	  	command     register address, read bit and chip address
+//!  \param[in]	  	data        written byte, 0 for reads
+//!
+//!  \return       	void
+//!
+//!******************************************************************************
+void Max14819::traceFrame(uint8_t command, uint8_t data) {
+    if (isTraceEn_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    uint32_t index = traceHead_.load(std::memory_order_relaxed);
+    TraceSlot *pEntry = &trace_[index & (TRACE_SIZE - 1)];
+
+    pEntry->seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    pEntry->command = command;
+    pEntry->data = data;
+    pEntry->time_ns = Hardware->get_time_ns();
+    pEntry->seq.store(index + 1, std::memory_order_release);
+    traceHead_.store(index + 1, std::memory_order_release);
+}
 void max14819::Max14819::Serial_Write(char const * buf)
 {
 	Hardware->Serial_Write(buf);
@@ -1385,40 +2786,29 @@ void max14819::Max14819::wait_for(uint32_t delay_ms)
 {
 	Hardware->wait_for(delay_ms);
 }
+void max14819::Max14819::wait_until_ns(uint64_t deadline_ns)
+{
+	Hardware->wait_until_ns(deadline_ns);
+}
+uint64_t max14819::Max14819::get_time_ns(void)
+{
+	return Hardware->get_time_ns();
+}
 //!******************************************************************************
-//!  function :    	calculate_CKT
+//!  function :    	countUp
 //!******************************************************************************
-//!  \brief         calculate the checksum byte for master, for more informations
-//!                 see IO-Link Specifications, A1.6, S.195
+//!  \brief         Increment a statistics counter. Only the driver writes the
+//!                 counters, so a relaxed load and store is enough to let
+//!                 other threads read them without tearing.
 //!
 //!  \type          local
 //!
-//!  \param[in]	    uint8_t mc          mastercommand data
-//!  \param[in]     *data       pointer to transmit data
-//!  \param[in]     dataSize    number of bytes transmit data
-//!  \param[in]     type        m-seqeunce type depending on sensor
+//!  \param[in]     *counter    counter
+//!  \param[in]     value       increment
 //!
-//!  \return        uint8_t CKT         checksum
+//!  \return        void
 //!
 //!******************************************************************************
-uint8_t calculateCKT(uint8_t mc, uint8_t *data, uint8_t dataSize, uint8_t type) {
-    // Insert m-sequence type (bit6, 7)
-    uint8_t CKT = uint8_t(type << 6);
-
-    // XOR all Bytes (including MC, CKT, PD and OD)
-    uint8_t CKT_XOR = mc ^ 0x52; // Seed value 0x52
-    CKT_XOR ^= CKT;
-    for (uint8_t i = 0; i < dataSize; i++) {
-        CKT_XOR ^= data[i];
-    }
-
-    // calculate bits 5-0
-    CKT |= uint8_t((((CKT_XOR >> 7) ^ (CKT_XOR >> 5) ^ (CKT_XOR >> 3) ^ (CKT_XOR >> 1))  & 0x01) << 5);
-    CKT |= uint8_t((((CKT_XOR >> 6) ^ (CKT_XOR >> 4) ^ (CKT_XOR >> 2) ^ (CKT_XOR >> 0)) & 0x01) << 4);
-    CKT |= uint8_t((((CKT_XOR >> 7) ^ ((CKT_XOR >> 6))) & 0x01) << 3);
-    CKT |= uint8_t((((CKT_XOR >> 5) ^ ((CKT_XOR >> 4))) & 0x01) << 2);
-    CKT |= uint8_t((((CKT_XOR >> 3) ^ ((CKT_XOR >> 2))) & 0x01) << 1);
-    CKT |= uint8_t((((CKT_XOR >> 1) ^ ((CKT_XOR >> 0))) & 0x01) << 0);
-
-    return CKT;
+static inline void countUp(std::atomic<uint32_t> *counter, uint32_t value) {
+    counter->store(counter->load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
 }
@@ -33,11 +33,15 @@
 
 //!**** Header-Files **********************************************************
 #include "HardwareBase.h"
+#include "IOLink.h"
+#include "IOLEventRing.h"
+#include <atomic>
+#ifndef ARDUINO
+#include <condition_variable>
+#include <mutex>
+#endif
 //!**** Macros ****************************************************************
-// Error define
-constexpr uint8_t ERROR             = 1u;
-constexpr uint8_t SUCCESS           = 0u;
-
+// Error define, see IOLink.h
 
 namespace max14819 {
 	// MAX14819 driver enum
@@ -74,6 +78,11 @@ namespace max14819 {
 	constexpr uint32_t INIT_POWER_OFF_DELAY	= 1000u;	// Delay in ms for disable duration of sensor power when startup
 	constexpr uint32_t INIT_BOOTUP_DELAY    = 300u;	// Delay after switch-to-operational-command
 	constexpr uint32_t INIT_WURQ_TIMEOUT    = 80u;   // Timeout in ms for abort WURQ request (2x retry after 10ms, 3x tries a 20ms)
+	constexpr uint32_t INIT_WURQ_POLL_US    = 1000u; // Poll interval in us of EstCom while establishing communication
+	constexpr uint32_t INIT_WURQ_SETTLE     = 10u;   // Delay in ms after establishing communication before the FIFO gets cleared
+	constexpr uint64_t NS_PER_MS            = 1000000u;
+	constexpr uint64_t NS_PER_US            = 1000u;
+	constexpr uint64_t CHIP_EVENT_MAX_WAIT  = 1000u * NS_PER_MS;   // longest sleep on the chip event, the sleeper checks again after it
 
 	// IO-Link Master Shield Max14819 Address
 	constexpr uint8_t port01Address  = 0;
@@ -177,7 +186,7 @@ namespace max14819 {
 	constexpr uint8_t CQFilterEn    = 0x01u;
 
 	constexpr uint8_t CyclTmrA 	    = 0x12u;
-	constexpr uint8_t CyclTmrB      = 0x12u;
+	constexpr uint8_t CyclTmrB      = 0x13u;
 	constexpr uint8_t TCyclBs1      = 0x80u;
 	constexpr uint8_t TCyclBs0      = 0x40u;
 	constexpr uint8_t TCyclM5       = 0x20u;
@@ -266,10 +275,64 @@ namespace max14819 {
 
 	constexpr uint8_t MAX_REG       = RevID;
 
+	// Registers which are only changed by the driver and therefore served
+	// from the register shadow. FIFO, interrupt, status and control registers
+	// with self-clearing bits are always read from the chip.
+	constexpr uint32_t SHADOW_REGS  = (1ul << InterruptEn) | (1ul << MsgCtrlA) | (1ul << MsgCtrlB)
+	                                | (1ul << LEDCtrl) | (1ul << CQCfgA) | (1ul << CQCfgB)
+	                                | (1ul << CyclTmrA) | (1ul << CyclTmrB) | (1ul << TrigAssgnA) | (1ul << TrigAssgnB)
+	                                | (1ul << LCnfgA) | (1ul << LCnfgB) | (1ul << IOStCfgA) | (1ul << IOStCfgB)
+	                                | (1ul << DrvrCurrLim) | (1ul << Clock) | (1ul << RevID);
+	// Shadowed registers which get their default value with ChanStatA/B Rst
+	constexpr uint32_t SHADOW_REGS_A= (1ul << MsgCtrlA) | (1ul << CQCfgA) | (1ul << CyclTmrA) | (1ul << TrigAssgnA) | (1ul << LCnfgA) | (1ul << IOStCfgA);
+	constexpr uint32_t SHADOW_REGS_B= (1ul << MsgCtrlB) | (1ul << CQCfgB) | (1ul << CyclTmrB) | (1ul << TrigAssgnB) | (1ul << LCnfgB) | (1ul << IOStCfgB);
+
 	// maximal number of bytes to send (according to max14819 FIFO length)
 	constexpr uint8_t MAX_MSG_LENGTH= 64;
+	// size of the receive FIFO in bytes
+	constexpr uint8_t RX_FIFO_SIZE  = 64;
+	// Shortest cycle time of the cycle timer (multiple of 0.1ms, no base)
+	constexpr uint8_t MIN_CYCL_TMR  = 4;
+	// Triggers of the Trigger register, a port starts its message on one of them
+	constexpr uint8_t TRIGGER_COUNT = 4;
+	constexpr uint8_t TRIGGER_NONE  = 0xFF;
+	// Number of SPI frames kept in the trace ring, power of two
+	constexpr uint16_t TRACE_SIZE   = 128;
 
 //!**** Data types ************************************************************
+	// SPI traffic of one register, counted by the driver
+	struct RegisterStats {
+		uint32_t reads;         // read frames on the bus
+		uint32_t writes;        // write frames on the bus
+		uint32_t shadowHits;    // reads served from the register shadow
+		uint32_t bytes;         // bytes on the bus
+	};
+
+	// Counters of one register as the driver keeps them, read by other
+	// threads as RegisterStats
+	struct RegisterCounters {
+		std::atomic<uint32_t> reads;
+		std::atomic<uint32_t> writes;
+		std::atomic<uint32_t> shadowHits;
+		std::atomic<uint32_t> bytes;
+	};
+
+	// One SPI frame of the trace ring. Read frames have data 0, the value
+	// is not known before the transaction is flushed.
+	struct TraceEntry {
+		uint32_t seq;           // number of the frame + 1, 0 while written
+		uint8_t command;        // register address, read bit and chip address
+		uint8_t data;
+		uint64_t time_ns;       // queued at (see get_time_ns)
+	};
+
+	// Entry of the trace ring as the driver writes it, copied as TraceEntry
+	struct TraceSlot {
+		std::atomic<uint32_t> seq;  // number of the frame + 1, 0 while written
+		uint8_t command;
+		uint8_t data;
+		uint64_t time_ns;
+	};
 
 //!**** Function prototypes ***************************************************
 
@@ -284,6 +347,40 @@ namespace max14819 {
         uint8_t isLedCtrlPortAEn_;
         uint8_t isLedCtrlPortBEn_;
 		HardwareBase* Hardware;
+        uint8_t shadowReg_[MAX_REG + 1];
+        uint32_t shadowValid_;
+        uint8_t pendingInterrupt_;
+        RegisterCounters regStats_[MAX_REG + 1];
+        std::atomic<uint32_t> rangeErrors_;
+        TraceSlot trace_[TRACE_SIZE];
+        std::atomic<uint32_t> traceHead_;
+        std::atomic<uint8_t> isTraceEn_;
+        IOLEventRing eventRings_[2];
+        uint64_t triggerTime_ns_[TRIGGER_COUNT];   // last write of each trigger
+        uint64_t sendTime_ns_[2];       // last CQSend of each port
+        uint64_t rxTime_ns_[2];         // last RxDataRdy of each port read from the Interrupt register
+        uint32_t rxCount_[2];           // RxDataRdy of each port taken by waitForRxData
+#ifndef ARDUINO
+        std::recursive_mutex chipMutex_;   // held by the thread driving the chip, see ChipLock
+        uint32_t lockDepth_;            // recursion of chipMutex_ by its holder
+        std::condition_variable_any chipEvent_;    // interrupt flags read or the pin watcher is done
+        uint8_t isPinWatched_;          // a thread sleeps on the interrupt pin, see watchPin
+#endif
+
+        uint8_t spiChannel(void);
+        uint8_t initIO(PortSelect port);
+        void updateShadow(uint8_t reg, uint8_t data);
+        uint8_t queueReadRegister(HardwareBase::SPITransaction &transaction, uint8_t reg, uint8_t *pData);
+        uint8_t queueWriteRegister(HardwareBase::SPITransaction &transaction, uint8_t reg, uint8_t data);
+        uint8_t watchPin(uint64_t deadline_ns);
+#ifndef ARDUINO
+        uint32_t releaseChip(void);
+        void retakeChip(uint32_t depth);
+        void waitChipEvent(uint64_t deadline_ns);
+#endif
+        void traceFrame(uint8_t command, uint8_t data);
+        uint8_t queueTxMessage(HardwareBase::SPITransaction &transaction, IOL::MSequence const &frame, uint8_t const *pData, PortSelect port);
+        uint8_t resyncCyclicFifo(PortSelect port);
 
     public:
         uint8_t comSpeedRegA;
@@ -294,6 +391,16 @@ namespace max14819 {
         uint8_t begin (PortSelect port);
         uint8_t end(PortSelect port);
 
+        uint8_t initPort(PortSelect port);
+
+        uint8_t powerOnPort(PortSelect port);
+
+        uint8_t resumePort(PortSelect port, uint8_t revID, uint8_t comSpeedReg);
+
+        DriverSelect readDriver(void);
+
+        HardwareBase* getHardware(void);
+
         uint8_t reset(void);
         uint8_t reset(PortSelect port);
 
@@ -301,19 +408,73 @@ namespace max14819 {
 
         uint8_t wakeUpRequest(PortSelect port, uint32_t * comSpeed_ret);
 
+        uint8_t startWakeUp(PortSelect port);
+
+        uint8_t pollWakeUp(PortSelect port);
+
+        uint8_t finishWakeUp(PortSelect port, uint32_t * comSpeed_ret);
+
         uint8_t readRegister(uint8_t reg);
 
+        uint8_t readRegisterUncached(uint8_t reg);
+
+        uint8_t resyncShadow(void);
+
         uint8_t writeRegister(uint8_t reg, uint8_t data);
 
         uint8_t writeData(uint8_t mc, uint8_t data, uint8_t sizeAnswer, uint8_t mSeqType, PortSelect port);
 
         uint8_t writeData(uint8_t mc, uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType, PortSelect port);
 
+        uint8_t writeFrame(IOL::MSequence const &frame, uint8_t const *pData, PortSelect port);
+
         uint8_t readData(uint8_t *pData, uint8_t sizeData, PortSelect port);
 
+        uint8_t readData(uint8_t *pData, uint8_t sizeData, PortSelect port, uint8_t sendNext);
+
+        uint8_t writeFrames(IOL::MSequence const *pFrames, uint8_t count, PortSelect port);
+
+        uint8_t resetFifo(PortSelect port);
+
+        uint8_t readInterrupt(void);
+
+        void publishEvent(PortSelect port, uint8_t source, uint8_t value, uint16_t code);
+
+        IOLEventRing * readEventRing(PortSelect port);
+
+        uint8_t waitForRxData(PortSelect port, uint64_t deadline_ns);
+
+        uint8_t pollRxData(PortSelect port);
+
+        uint8_t awaitRxData(PortSelect port, uint64_t deadline_ns);
+
+        uint8_t waitForInterrupt(uint64_t deadline_ns);
+
+        void sleepUntil(uint64_t deadline_ns);
+
+        void lock(void);
+
+        void unlock(void);
+
         uint8_t enableCyclicSend(uint8_t mc, uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType, uint16_t cycleTime, PortSelect port);
 
-        uint8_t disableCyclicSend(PortSelect port);
+        uint8_t disableCyclicSend(uint8_t cycleTime, PortSelect port);
+
+        uint8_t enableTriggeredSend(uint8_t mc, uint8_t sizeData, uint8_t *pData, uint8_t sizeAnswer, uint8_t mSeqType, uint8_t trigger, PortSelect port);
+
+        uint8_t fireTrigger(uint8_t trigger, uint64_t *pTime_ns);
+
+        uint64_t readTriggerTime(uint8_t trigger);
+
+        uint64_t readSendTime(PortSelect port);
+
+        uint64_t readRxTime(PortSelect port);
+
+        uint8_t writeCyclicFrame(IOL::MSequence const &frame, uint8_t const *pData, uint8_t keep, uint8_t reset, PortSelect port);
+
+        uint8_t writeCycleTimer(uint8_t cycleTime, PortSelect port);
+
+        uint8_t readCyclicData(uint8_t *pData, uint8_t sizeData, PortSelect port);
 
         uint8_t enableLedControl(PortSelect port);
 
@@ -331,9 +492,37 @@ namespace max14819 {
 
         uint8_t readDI(PortSelect port);
 
+        uint8_t readRegisterStats(uint8_t reg, RegisterStats *pStats);
+
+        void clearRegisterStats(void);
+
+        void enableTrace(uint8_t enable);
+
+        uint16_t readTrace(TraceEntry *pEntries, uint16_t maxEntries);
+
+        void printStatistics(void);
+
 		void Serial_Write(char const * buf);
 		void wait_for(uint32_t delay_ms);
+		void wait_until_ns(uint64_t deadline_ns);
+		uint64_t get_time_ns(void);
     };// class max14819
+
+    //!**************************************************************************
+    //!  Holds the chip for the thread driving its ports, for the lifetime of
+    //!  the object. The lock is recursive, port functions calling each other
+    //!  take it again. A no-op without threads.
+    //!**************************************************************************
+    class ChipLock {
+    public:
+        explicit ChipLock(Max14819 *pDriver) : pDriver_(pDriver) { pDriver_->lock(); }
+        ~ChipLock() { pDriver_->unlock(); }
+    private:
+        Max14819 *pDriver_;
+
+        ChipLock(ChipLock const &);
+        ChipLock & operator=(ChipLock const &);
+    };
 } // namespace max14819
 
 #endif //MAX14819_H_INCLUDED
@@ -0,0 +1,1159 @@
+#ifndef ARDUINO
+//!*****************************************************************************
+//!  \file      SimDevice.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Virtual IO-Link devices for the HardwareSim backend. A device
+//!             answers the M-sequences the simulated MAX14819 sends to it.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-09
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!**** Header-Files ************************************************************
+#include "SimDevice.h"
+#include "IOLink.h"
+
+#include <cstdio>
+#include <cstring>
+
+//!**** Macros ******************************************************************
+constexpr uint64_t BOOT_TIME_NS = 100000000u;		// default bootup time of a device after L+ on
+constexpr uint8_t MIN_CYCLE_TIME = 0x17u;			// default MinCycleTime 2.3 ms
+constexpr uint8_t REVISION_ID = 0x11u;				// IO-Link V1.1
+constexpr uint8_t CKS_PD_INVALID = 0x40u;			// CKS bit 6, process data invalid
+constexpr uint8_t CKS_EVENT = 0x80u;				// CKS bit 7, events in the event memory
+constexpr uint8_t ISDU_BUSY_POLLS = 2u;				// ISDU reads answered with BUSY before the response
+constexpr uint8_t DIAG_CHANNEL = 2u;
+constexpr uint8_t ISDU_CHANNEL = 3u;
+constexpr uint16_t SWITCH_POINT_INDEX = 0x003Cu;	// parameters of the distance sensor
+constexpr uint16_t HYSTERESIS_INDEX = 0x003Du;
+constexpr uint32_t FNV_OFFSET = 2166136261u;		// Parameter_Checksum, FNV-1a over the Data Storage set
+constexpr uint32_t FNV_PRIME = 16777619u;
+
+//!**** Data types **************************************************************
+
+//!**** Function prototypes *****************************************************
+static uint8_t encodePDLength(uint8_t size);
+static uint8_t encodeMSeqCapability(uint8_t odSize);
+
+//!**** Data ********************************************************************
+static uint32_t serialNumber = 0;					// serial number of the next device
+
+//!**** Implementation **********************************************************
+
+SimDevice::SimDevice(uint16_t vendorID, uint32_t deviceID, uint8_t pdInSize, uint8_t pdOutSize, uint8_t odSize, uint32_t baudrate)
+:pdInSize_((pdInSize <= IOL::PD_MAX_SIZE) ? pdInSize : IOL::PD_MAX_SIZE),
+pdOutSize_((pdOutSize <= IOL::PD_MAX_SIZE) ? pdOutSize : IOL::PD_MAX_SIZE),
+odSize_(odSize),
+pdOutValid_(0),
+pdInvalid_(0),
+baudrate_(baudrate),
+bootTime_ns_(BOOT_TIME_NS),
+readyTime_ns_(0),
+isPowered_(0),
+mode_(SIO),
+parameters_(),
+isduState_(ISDU_IDLE),
+isduSize_(0),
+isduPosition_(0),
+isduFlow_(0),
+isduBusy_(0),
+dsState_(IOL::DS::STATE_INACTIVE),
+dsUploadFlag_(0)
+{
+	char serial[16];
+
+	for (uint8_t i = 0; i < sizeof(directParameterPage_); i++) {
+		directParameterPage_[i] = 0;
+	}
+	for (uint8_t i = 0; i < sizeof(pdIn_); i++) {
+		pdIn_[i] = 0;
+		pdOut_[i] = 0;
+	}
+	for (uint8_t i = 0; i < sizeof(eventMemory_); i++) {
+		eventMemory_[i] = 0;
+	}
+	directParameterPage_[IOL::PAGE::MIN_CYCLE_TIME] = MIN_CYCLE_TIME;
+	directParameterPage_[IOL::PAGE::M_SEQ_CAP] = encodeMSeqCapability(odSize_);
+	directParameterPage_[IOL::PAGE::REVISION_ID] = REVISION_ID;
+	directParameterPage_[IOL::PAGE::PD_IN] = encodePDLength(pdInSize_);
+	directParameterPage_[IOL::PAGE::PD_OUT] = encodePDLength(pdOutSize_);
+	directParameterPage_[IOL::PAGE::VENDOR_ID1] = uint8_t(vendorID >> 8);
+	directParameterPage_[IOL::PAGE::VENDOR_ID2] = uint8_t(vendorID);
+	directParameterPage_[IOL::PAGE::DEVICE_ID1] = uint8_t(deviceID >> 16);
+	directParameterPage_[IOL::PAGE::DEVICE_ID2] = uint8_t(deviceID >> 8);
+	directParameterPage_[IOL::PAGE::DEVICE_ID3] = uint8_t(deviceID);
+
+	// Identification, derived devices set their product
+	sprintf(serial, "SIM%06u", unsigned(++serialNumber));
+	setParameter(IOL::INDEX::VENDOR_NAME, "Balluff GmbH", 0);
+	setParameter(IOL::INDEX::VENDOR_TEXT, "www.balluff.com", 0);
+	setParameter(IOL::INDEX::PRODUCT_NAME, "Generic IO-Link device", 0);
+	setParameter(IOL::INDEX::PRODUCT_ID, "SIM-GENERIC", 0);
+	setParameter(IOL::INDEX::PRODUCT_TEXT, "Simulated IO-Link device", 0);
+	setParameter(IOL::INDEX::SERIAL_NUMBER, serial, 0);
+	setParameter(IOL::INDEX::HARDWARE_REVISION, "1.0", 0);
+	setParameter(IOL::INDEX::FIRMWARE_REVISION, "1.0.0", 0);
+	setParameter(IOL::INDEX::APPLICATION_TAG, "***", 1);
+}
+
+SimDevice::~SimDevice()
+{
+}
+
+//!*****************************************************************************
+//!function :      powerOn
+//!*****************************************************************************
+//!  \brief        L+ switched on, the device boots and stays in SIO mode
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint64_t   time of L+ on in nanoseconds
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SimDevice::powerOn(uint64_t time_ns)
+{
+	if (isPowered_ == 0) {
+		isPowered_ = 1;
+		readyTime_ns_ = time_ns + bootTime_ns_;
+		mode_ = SIO;
+	}
+}
+
+//!*****************************************************************************
+//!function :      powerOff
+//!*****************************************************************************
+//!  \brief        L+ switched off, the device loses its communication state
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SimDevice::powerOff()
+{
+	isPowered_ = 0;
+	pdOutValid_ = 0;
+	mode_ = SIO;
+	isduState_ = ISDU_IDLE;
+	eventMemory_[IOL::EVENT::STATUS_CODE] = 0;
+	dsState_ = IOL::DS::STATE_INACTIVE;
+}
+
+//!*****************************************************************************
+//!function :      isReady
+//!*****************************************************************************
+//!  \brief        Returns if the device is powered and booted
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint64_t   current time in nanoseconds
+//!
+//!  \return       1 if ready
+//!
+//!*****************************************************************************
+uint8_t SimDevice::isReady(uint64_t time_ns)
+{
+	return ((isPowered_ != 0) && (time_ns >= readyTime_ns_)) ? 1 : 0;
+}
+
+//!*****************************************************************************
+//!function :      wakeUp
+//!*****************************************************************************
+//!  \brief        Wakeup request of the master, the device switches to
+//!                communication mode if it is ready
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint64_t   time of the wakeup request in nanoseconds
+//!
+//!  \return       1 if the device communicates
+//!
+//!*****************************************************************************
+uint8_t SimDevice::wakeUp(uint64_t time_ns)
+{
+	if (isReady(time_ns) == 0) {
+		return 0;
+	}
+	mode_ = STARTUP;
+	return 1;
+}
+
+uint32_t SimDevice::readBaudrate()
+{
+	return baudrate_;
+}
+
+SimDevice::ComMode SimDevice::readComMode()
+{
+	return mode_;
+}
+
+//!*****************************************************************************
+//!function :      handleMessage
+//!*****************************************************************************
+//!  \brief        Answers a master message (MC, CKT, data). Messages with a
+//!                wrong CKT, a wrong length or an M-sequence type which does
+//!                not fit the mode of the device are not answered.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t const* master message
+//!				   uint8_t        size of the message
+//!  \param[out]   uint8_t*       answer (OD, PD and CKS), at least 36 bytes
+//!
+//!  \return       size of the answer, 0 if the device does not answer
+//!
+//!*****************************************************************************
+uint8_t SimDevice::handleMessage(uint8_t const * msg, uint8_t sizeMsg, uint8_t * answer)
+{
+	if ((isPowered_ == 0) || (mode_ == SIO) || (sizeMsg < 2)) {
+		return 0;
+	}
+
+	uint8_t mc = msg[0];
+	uint8_t ckt = msg[1];
+	uint8_t const * data = msg + 2;
+	uint8_t sizeData = uint8_t(sizeMsg - 2);
+
+	// Check CKT, the checksum bits count as zero
+	uint8_t checksum = uint8_t(0x52u ^ mc ^ (ckt & 0xC0u));
+	for (uint8_t i = 0; i < sizeData; i++) {
+		checksum ^= data[i];
+	}
+	if (compressChecksum(checksum) != (ckt & 0x3Fu)) {
+		return 0;
+	}
+
+	uint8_t mSeqType = uint8_t(ckt >> 6);
+	uint8_t isRead = ((mc & 0x80u) != 0) ? 1 : 0;
+	uint8_t channel = uint8_t((mc >> 5) & 0x03u);
+	uint8_t address = uint8_t(mc & 0x1Fu);
+	uint8_t size = 0;
+
+	switch (mSeqType) {
+	case IOL::M_TYPE_0:
+		// One OD octet, no process data
+		if (sizeData != ((isRead != 0) ? 0 : 1)) {
+			return 0;
+		}
+		if (channel == ISDU_CHANNEL) {
+			if (isRead != 0) {
+				isduRead(address, &answer[size++], 1);
+			}
+			else {
+				isduWrite(address, data, 1);
+			}
+		}
+		else if (isRead != 0) {
+			answer[size++] = readOnRequest(channel, address);
+		}
+		else {
+			writeOnRequest(channel, address, data[0]);
+		}
+		break;
+	case IOL::M_TYPE_2_X:
+		// Process data, OD octets only in the direction of the transfer
+		if ((mode_ != OPERATE) || (sizeData != pdOutSize_ + ((isRead != 0) ? 0 : odSize_))) {
+			return 0;
+		}
+		if (pdOutSize_ != 0) {
+			for (uint8_t i = 0; i < pdOutSize_; i++) {
+				pdOut_[i] = data[i];
+			}
+			processDataOutChanged();
+		}
+		if ((channel == ISDU_CHANNEL) && (odSize_ != 0)) {
+			if (isRead != 0) {
+				isduRead(address, &answer[size], odSize_);
+				size = uint8_t(size + odSize_);
+			}
+			else {
+				isduWrite(address, &data[pdOutSize_], odSize_);
+			}
+		}
+		else if (isRead != 0) {
+			for (uint8_t i = 0; i < odSize_; i++) {
+				answer[size++] = (i == 0) ? readOnRequest(channel, address) : 0;
+			}
+		}
+		else if (odSize_ != 0) {
+			writeOnRequest(channel, address, data[pdOutSize_]);
+		}
+		updateProcessData();
+		for (uint8_t i = 0; i < pdInSize_; i++) {
+			answer[size++] = pdIn_[i];
+		}
+		break;
+	default:
+		return 0;
+	}
+
+	// CKS: event flag, PD invalid and the checksum over the whole answer
+	uint8_t cks = (pdInvalid_ != 0) ? CKS_PD_INVALID : 0;
+	if (eventMemory_[IOL::EVENT::STATUS_CODE] != 0) {
+		cks = uint8_t(cks | CKS_EVENT);
+	}
+	checksum = uint8_t(0x52u ^ cks);
+	for (uint8_t i = 0; i < size; i++) {
+		checksum ^= answer[i];
+	}
+	answer[size++] = uint8_t(cks | compressChecksum(checksum));
+	return size;
+}
+
+//!*****************************************************************************
+//!function :      readOnRequest
+//!*****************************************************************************
+//!  \brief        Read access to an on-request data channel. The page channel
+//!                serves the direct parameter page 1, the diagnosis channel
+//!                the event memory. The ISDU channel is handled by isduRead.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    channel of the master command
+//!				   uint8_t    address of the master command
+//!
+//!  \return       OD octet
+//!
+//!*****************************************************************************
+uint8_t SimDevice::readOnRequest(uint8_t channel, uint8_t address)
+{
+	if ((channel == 1) && (address < sizeof(directParameterPage_))) {
+		return directParameterPage_[address];
+	}
+	if ((channel == DIAG_CHANNEL) && (address < sizeof(eventMemory_))) {
+		return eventMemory_[address];
+	}
+	return 0;
+}
+
+//!*****************************************************************************
+//!function :      writeOnRequest
+//!*****************************************************************************
+//!  \brief        Write access to an on-request data channel. Page address 0
+//!                is the MasterCommand, address 1 the MasterCycleTime. A
+//!                write of the StatusCode confirms the events.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    channel of the master command
+//!				   uint8_t    address of the master command
+//!				   uint8_t    OD octet
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SimDevice::writeOnRequest(uint8_t channel, uint8_t address, uint8_t value)
+{
+	if ((channel == DIAG_CHANNEL) && (address == IOL::EVENT::STATUS_CODE)) {
+		eventMemory_[IOL::EVENT::STATUS_CODE] = 0;
+		return;
+	}
+	if (channel != 1) {
+		return;
+	}
+	if (address == IOL::PAGE::MAS_COMMAND) {
+		masterCommand(value);
+	}
+	else if (address == IOL::PAGE::MAS_CYCLE_TIME) {
+		directParameterPage_[address] = value;
+	}
+}
+
+//!*****************************************************************************
+//!function :      masterCommand
+//!*****************************************************************************
+//!  \brief        Executes a MasterCommand
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    MasterCommand
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SimDevice::masterCommand(uint8_t command)
+{
+	switch (command) {
+	case IOL::MC::DEV_FALLBACK:
+		mode_ = SIO;
+		pdOutValid_ = 0;
+		break;
+	case IOL::MC::DEV_STARTUP:
+		mode_ = STARTUP;
+		break;
+	case IOL::MC::DEV_PREOPERATE:
+		mode_ = PREOPERATE;
+		break;
+	case IOL::MC::DEV_OPERATE:
+		mode_ = OPERATE;
+		break;
+	case IOL::MC::PDOUT_VALID:
+		pdOutValid_ = 1;
+		break;
+	default:
+		break;
+	}
+}
+
+//!*****************************************************************************
+//!function :      isduWrite
+//!*****************************************************************************
+//!  \brief        ISDU request segment of the master. START begins a new
+//!                request, a repeated COUNT overwrites the last segment. The
+//!                complete request is executed.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t        flow control of the master command
+//!				   uint8_t const* OD octets
+//!				   uint8_t        number of OD octets
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SimDevice::isduWrite(uint8_t flow, uint8_t const * od, uint8_t size)
+{
+	if (flow == IOL::ISDU::FLOW_START) {
+		isduState_ = ISDU_REQUEST;
+		isduSize_ = 0;
+		isduPosition_ = 0;
+	}
+	else if ((flow & IOL::ISDU::FLOW_START) != 0) {
+		// IDLE or ABORT
+		isduState_ = ISDU_IDLE;
+		return;
+	}
+	else if (isduState_ != ISDU_REQUEST) {
+		return;
+	}
+	else if (flow != isduFlow_) {
+		isduPosition_ = uint8_t(isduPosition_ + size);
+	}
+	isduFlow_ = flow;
+
+	for (uint8_t i = 0; (i < size) && (isduPosition_ + i < int(sizeof(isduRequest_))); i++) {
+		isduRequest_[isduPosition_ + i] = od[i];
+		if (isduPosition_ + i >= isduSize_) {
+			isduSize_ = uint8_t(isduPosition_ + i + 1);
+		}
+	}
+
+	// Length in the first octet, or in ExtLength
+	uint8_t length = uint8_t(isduRequest_[0] & IOL::ISDU::LENGTH);
+	if (length == IOL::ISDU::LENGTH_EXT) {
+		if (isduSize_ < 2) {
+			return;
+		}
+		length = isduRequest_[1];
+	}
+	if ((length >= 2) && (isduSize_ >= length)) {
+		isduSize_ = length;
+		isduExecute();
+	}
+}
+
+//!*****************************************************************************
+//!function :      isduRead
+//!*****************************************************************************
+//!  \brief        ISDU response segment for the master. The first polls with
+//!                START are answered with BUSY, a repeated COUNT sends the
+//!                last segment again. IDLE and ABORT end the transfer.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t        flow control of the master command
+//!  \param[out]   uint8_t*       OD octets
+//!  \param[in]	   uint8_t        number of OD octets
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SimDevice::isduRead(uint8_t flow, uint8_t * od, uint8_t size)
+{
+	for (uint8_t i = 0; i < size; i++) {
+		od[i] = 0;
+	}
+	if ((flow & IOL::ISDU::FLOW_START) != 0) {
+		if (flow != IOL::ISDU::FLOW_START) {
+			// IDLE or ABORT
+			isduState_ = ISDU_IDLE;
+			return;
+		}
+		if (isduState_ == ISDU_REQUEST) {
+			od[0] = IOL::ISDU::BUSY;
+			return;
+		}
+		if (isduState_ != ISDU_RESPONSE) {
+			od[0] = IOL::ISDU::NO_SERVICE;
+			return;
+		}
+		if (isduBusy_ != 0) {
+			isduBusy_--;
+			od[0] = IOL::ISDU::BUSY;
+			return;
+		}
+		isduPosition_ = 0;
+	}
+	else if (isduState_ != ISDU_RESPONSE) {
+		return;
+	}
+	else if (flow != isduFlow_) {
+		isduPosition_ = uint8_t(isduPosition_ + size);
+	}
+	isduFlow_ = flow;
+
+	for (uint8_t i = 0; (i < size) && (isduPosition_ + i < isduSize_); i++) {
+		od[i] = isduResponse_[isduPosition_ + i];
+	}
+}
+
+//!*****************************************************************************
+//!function :      isduExecute
+//!*****************************************************************************
+//!  \brief        Execute a complete ISDU request and prepare the response.
+//!                A request with a wrong CHKPDU or an unknown I-Service is
+//!                dropped, the master then reads NO_SERVICE.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SimDevice::isduExecute()
+{
+	uint8_t checksum = 0;
+	for (uint8_t i = 0; i < isduSize_; i++) {
+		checksum ^= isduRequest_[i];
+	}
+	isduState_ = ISDU_IDLE;
+	if (checksum != 0) {
+		return;
+	}
+
+	uint8_t service = uint8_t(isduRequest_[0] >> 4);
+	uint8_t position = ((isduRequest_[0] & IOL::ISDU::LENGTH) == IOL::ISDU::LENGTH_EXT) ? 2 : 1;
+	uint16_t index = 0;
+	uint8_t subindex = 0;
+
+	switch (service & 0x3u) {
+	case 1:
+		index = isduRequest_[position++];
+		break;
+	case 2:
+		index = isduRequest_[position++];
+		subindex = isduRequest_[position++];
+		break;
+	case 3:
+		index = uint16_t((isduRequest_[position] << 8) | isduRequest_[position + 1]);
+		position = uint8_t(position + 2);
+		subindex = isduRequest_[position++];
+		break;
+	default:
+		return;
+	}
+	if (position >= isduSize_) {
+		return;
+	}
+
+	uint8_t value[256];
+	uint8_t size = IOL::ISDU::MAX_DATA_SIZE;
+	uint16_t errorCode;
+	switch (service) {
+	case IOL::ISDU::READ_8:
+	case IOL::ISDU::READ_8_SUB:
+	case IOL::ISDU::READ_16_SUB:
+		errorCode = readParameter(index, subindex, value, &size);
+		service = (errorCode == 0) ? IOL::ISDU::READ_POS : IOL::ISDU::READ_NEG;
+		break;
+	case IOL::ISDU::WRITE_8:
+	case IOL::ISDU::WRITE_8_SUB:
+	case IOL::ISDU::WRITE_16_SUB:
+		errorCode = writeParameter(index, subindex, &isduRequest_[position], uint8_t(isduSize_ - 1 - position));
+		service = (errorCode == 0) ? IOL::ISDU::WRITE_POS : IOL::ISDU::WRITE_NEG;
+		size = 0;
+		break;
+	default:
+		return;
+	}
+	if (errorCode != 0) {
+		value[0] = uint8_t(errorCode >> 8);
+		value[1] = uint8_t(errorCode);
+		size = 2;
+	}
+	isduRespond(service, value, size);
+}
+
+//!*****************************************************************************
+//!function :      isduRespond
+//!*****************************************************************************
+//!  \brief        Frame an ISDU response with I-Service, length and CHKPDU
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t        I-Service of the response
+//!				   uint8_t const* data of the response
+//!				   uint8_t        size of the data
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SimDevice::isduRespond(uint8_t service, uint8_t const * data, uint8_t size)
+{
+	uint8_t length = uint8_t(size + 2);
+	uint8_t position = 0;
+
+	if (length > IOL::ISDU::LENGTH) {
+		length++;
+		isduResponse_[position++] = uint8_t((service << 4) | IOL::ISDU::LENGTH_EXT);
+		isduResponse_[position++] = length;
+	}
+	else {
+		isduResponse_[position++] = uint8_t((service << 4) | length);
+	}
+	for (uint8_t i = 0; i < size; i++) {
+		isduResponse_[position++] = data[i];
+	}
+	uint8_t checksum = 0;
+	for (uint8_t i = 0; i < position; i++) {
+		checksum ^= isduResponse_[i];
+	}
+	isduResponse_[position++] = checksum;
+
+	isduSize_ = position;
+	isduPosition_ = 0;
+	isduBusy_ = ISDU_BUSY_POLLS;
+	isduState_ = ISDU_RESPONSE;
+}
+
+//!*****************************************************************************
+//!function :      readParameter
+//!*****************************************************************************
+//!  \brief        Read a parameter of the ISDU channel. Only whole parameters
+//!                are supported, subindex 0.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint16_t   index
+//!				   uint8_t    subindex
+//!  \param[out]   uint8_t*   value
+//!  \param[in,out] uint8_t*  size of the buffer, size of the value
+//!
+//!  \return       0 if success, otherwise the ISDU error code
+//!
+//!*****************************************************************************
+uint16_t SimDevice::readParameter(uint16_t index, uint8_t subindex, uint8_t * data, uint8_t * size)
+{
+	if (index == IOL::INDEX::DATA_STORAGE) {
+		return readDataStorage(subindex, data, size);
+	}
+	std::map<uint16_t, Parameter>::const_iterator it = parameters_.find(index);
+	if (it == parameters_.end()) {
+		return IOL::ISDU::ERROR_IDX_NOTAVAIL;
+	}
+	if (subindex != 0) {
+		return IOL::ISDU::ERROR_SUBIDX_NOTAVAIL;
+	}
+	if (it->second.value.size() > *size) {
+		return IOL::ISDU::ERROR_APP;
+	}
+	*size = uint8_t(it->second.value.size());
+	for (uint8_t i = 0; i < *size; i++) {
+		data[i] = it->second.value[i];
+	}
+	return 0;
+}
+
+//!*****************************************************************************
+//!function :      writeParameter
+//!*****************************************************************************
+//!  \brief        Write a parameter of the ISDU channel, only parameters set
+//!                as writable with setParameter
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint16_t       index
+//!				   uint8_t        subindex
+//!				   uint8_t const* value
+//!				   uint8_t        size of the value
+//!
+//!  \return       0 if success, otherwise the ISDU error code
+//!
+//!*****************************************************************************
+uint16_t SimDevice::writeParameter(uint16_t index, uint8_t subindex, uint8_t const * data, uint8_t size)
+{
+	if (index == IOL::INDEX::DATA_STORAGE) {
+		return writeDataStorage(subindex, data, size);
+	}
+	std::map<uint16_t, Parameter>::iterator it = parameters_.find(index);
+	if (it == parameters_.end()) {
+		return IOL::ISDU::ERROR_IDX_NOTAVAIL;
+	}
+	if (subindex != 0) {
+		return IOL::ISDU::ERROR_SUBIDX_NOTAVAIL;
+	}
+	if (it->second.isWritable == 0) {
+		return IOL::ISDU::ERROR_ACCESS_DENIED;
+	}
+	it->second.value.assign(data, data + size);
+	return 0;
+}
+
+void SimDevice::setParameter(uint16_t index, char const * value, uint8_t isWritable)
+{
+	setParameter(index, reinterpret_cast<uint8_t const *>(value), uint8_t(strlen(value)), isWritable);
+}
+
+void SimDevice::setParameter(uint16_t index, uint8_t const * data, uint8_t size, uint8_t isWritable)
+{
+	Parameter & parameter = parameters_[index];
+	parameter.value.assign(data, data + size);
+	parameter.isWritable = isWritable;
+}
+
+//!*****************************************************************************
+//!function :      changeParameter
+//!*****************************************************************************
+//!  \brief        A parameter is changed on the device itself, e.g. by a
+//!                teach-in. The device reports it with a DS_UPLOAD_REQ event.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint16_t       index
+//!				   char const*    new value
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SimDevice::changeParameter(uint16_t index, char const * value)
+{
+	Parameter & parameter = parameters_[index];
+	parameter.value.assign(value, value + strlen(value));
+	dsUploadFlag_ = 1;
+	raiseEvent(uint8_t(IOL::EVENT::MODE_SINGLE_SHOT | IOL::EVENT::TYPE_NOTIFICATION | IOL::EVENT::INSTANCE_APP),
+			IOL::EVENT::DS_UPLOAD_REQ);
+}
+
+//!*****************************************************************************
+//!function :      readDataStorage
+//!*****************************************************************************
+//!  \brief        Read a subindex of the Data Storage index. The Index_List
+//!                holds the writable parameters.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    subindex
+//!  \param[out]   uint8_t*   value
+//!  \param[in,out] uint8_t*  size of the buffer, size of the value
+//!
+//!  \return       0 if success, otherwise the ISDU error code
+//!
+//!*****************************************************************************
+uint16_t SimDevice::readDataStorage(uint8_t subindex, uint8_t * data, uint8_t * size)
+{
+	uint8_t value[IOL::ISDU::MAX_DATA_SIZE];
+	uint8_t length = 0;
+	uint32_t number = 0;
+
+	switch (subindex) {
+	case IOL::DS::SUB_STATE:
+		value[length++] = uint8_t(dsState_ | ((dsUploadFlag_ != 0) ? IOL::DS::STATE_UPLOAD_FLAG : 0));
+		break;
+	case IOL::DS::SUB_SIZE:
+	case IOL::DS::SUB_CHECKSUM:
+		if (subindex == IOL::DS::SUB_CHECKSUM) {
+			number = dataStorageChecksum();
+		}
+		else {
+			for (std::map<uint16_t, Parameter>::const_iterator it = parameters_.begin(); it != parameters_.end(); ++it) {
+				number += (it->second.isWritable != 0) ? uint32_t(it->second.value.size()) : 0;
+			}
+		}
+		for (uint8_t i = 0; i < 4; i++) {
+			value[length++] = uint8_t(number >> (24 - 8 * i));
+		}
+		break;
+	case IOL::DS::SUB_INDEX_LIST:
+		for (std::map<uint16_t, Parameter>::const_iterator it = parameters_.begin(); it != parameters_.end(); ++it) {
+			if ((it->second.isWritable != 0) && (size_t(length + 2 * IOL::DS::ENTRY_SIZE) <= sizeof(value))) {
+				value[length++] = uint8_t(it->first >> 8);
+				value[length++] = uint8_t(it->first);
+				value[length++] = 0;
+			}
+		}
+		value[length++] = 0;
+		value[length++] = 0;
+		break;
+	default:
+		return IOL::ISDU::ERROR_SUBIDX_NOTAVAIL;
+	}
+	if (length > *size) {
+		return IOL::ISDU::ERROR_APP;
+	}
+	*size = length;
+	memcpy(data, value, length);
+	return 0;
+}
+
+//!*****************************************************************************
+//!function :      writeDataStorage
+//!*****************************************************************************
+//!  \brief        DS_Command of the master. The end of an upload clears the
+//!                DS_UPLOAD_FLAG.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t        subindex
+//!				   uint8_t const* value
+//!				   uint8_t        size of the value
+//!
+//!  \return       0 if success, otherwise the ISDU error code
+//!
+//!*****************************************************************************
+uint16_t SimDevice::writeDataStorage(uint8_t subindex, uint8_t const * data, uint8_t size)
+{
+	if (subindex != IOL::DS::SUB_COMMAND) {
+		return IOL::ISDU::ERROR_ACCESS_DENIED;
+	}
+	if (size != 1) {
+		return IOL::ISDU::ERROR_VAL_LENOVRRUN;
+	}
+	switch (data[0]) {
+	case IOL::DS::CMD_UPLOAD_START:
+		dsState_ = IOL::DS::STATE_UPLOAD;
+		break;
+	case IOL::DS::CMD_UPLOAD_END:
+		dsState_ = IOL::DS::STATE_INACTIVE;
+		dsUploadFlag_ = 0;
+		break;
+	case IOL::DS::CMD_DOWNLOAD_START:
+		dsState_ = IOL::DS::STATE_DOWNLOAD;
+		break;
+	case IOL::DS::CMD_DOWNLOAD_END:
+	case IOL::DS::CMD_BREAK:
+		dsState_ = IOL::DS::STATE_INACTIVE;
+		break;
+	default:
+		return IOL::ISDU::ERROR_APP;
+	}
+	return 0;
+}
+
+//!*****************************************************************************
+//!function :      dataStorageChecksum
+//!*****************************************************************************
+//!  \brief        Parameter_Checksum of the writable parameters. The
+//!                algorithm is up to the device, the master only compares.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void
+//!
+//!  \return       checksum
+//!
+//!*****************************************************************************
+uint32_t SimDevice::dataStorageChecksum()
+{
+	uint32_t checksum = FNV_OFFSET;
+
+	for (std::map<uint16_t, Parameter>::const_iterator it = parameters_.begin(); it != parameters_.end(); ++it) {
+		if (it->second.isWritable == 0) {
+			continue;
+		}
+		checksum = (checksum ^ uint8_t(it->first >> 8)) * FNV_PRIME;
+		checksum = (checksum ^ uint8_t(it->first)) * FNV_PRIME;
+		for (size_t i = 0; i < it->second.value.size(); i++) {
+			checksum = (checksum ^ it->second.value[i]) * FNV_PRIME;
+		}
+	}
+	return checksum;
+}
+
+//!*****************************************************************************
+//!function :      raiseEvent
+//!*****************************************************************************
+//!  \brief        Put an event into a free slot of the event memory, the
+//!                event flag is set until the master confirms. The event is
+//!                lost if all slots are used.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    EventQualifier
+//!				   uint16_t   EventCode
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SimDevice::raiseEvent(uint8_t qualifier, uint16_t code)
+{
+	uint8_t slots = uint8_t(eventMemory_[IOL::EVENT::STATUS_CODE] & IOL::EVENT::STATUS_SLOTS);
+
+	for (uint8_t i = 0; i < IOL::EVENT::SLOT_COUNT; i++) {
+		if ((slots & (1u << i)) != 0) {
+			continue;
+		}
+		uint8_t * slot = &eventMemory_[1 + i * IOL::EVENT::SLOT_SIZE];
+		slot[0] = qualifier;
+		slot[1] = uint8_t(code >> 8);
+		slot[2] = uint8_t(code);
+		eventMemory_[IOL::EVENT::STATUS_CODE] = uint8_t(IOL::EVENT::STATUS_DETAILS | slots | (1u << i));
+		return;
+	}
+}
+
+//!*****************************************************************************
+//!function :      readParameterValue
+//!*****************************************************************************
+//!  \brief        Copies a parameter, e.g. to check a write of the master
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint16_t   index
+//!  \param[out]   uint8_t*   value
+//!  \param[in]	   uint8_t    size of the buffer
+//!
+//!  \return       size of the value, 0 if the index does not exist
+//!
+//!*****************************************************************************
+uint8_t SimDevice::readParameterValue(uint16_t index, uint8_t * data, uint8_t size)
+{
+	std::map<uint16_t, Parameter>::const_iterator it = parameters_.find(index);
+	if (it == parameters_.end()) {
+		return 0;
+	}
+	uint8_t count = 0;
+	for (; (count < size) && (count < it->second.value.size()); count++) {
+		data[count] = it->second.value[count];
+	}
+	return count;
+}
+
+void SimDevice::updateProcessData()
+{
+}
+
+void SimDevice::processDataOutChanged()
+{
+}
+
+void SimDevice::setProcessDataIn(uint8_t const * data)
+{
+	for (uint8_t i = 0; i < pdInSize_; i++) {
+		pdIn_[i] = data[i];
+	}
+}
+
+void SimDevice::setPDInvalid(uint8_t invalid)
+{
+	pdInvalid_ = invalid;
+}
+
+//!*****************************************************************************
+//!function :      readProcessDataOut
+//!*****************************************************************************
+//!  \brief        Copies the last process data output of the master
+//!
+//!  \type         local
+//!
+//!  \param[out]   uint8_t*   buffer with the size of the process data output
+//!
+//!  \return       1 if the master marked the output valid
+//!
+//!*****************************************************************************
+uint8_t SimDevice::readProcessDataOut(uint8_t * data)
+{
+	for (uint8_t i = 0; i < pdOutSize_; i++) {
+		data[i] = pdOut_[i];
+	}
+	return pdOutValid_;
+}
+
+void SimDevice::setMinCycleTime(uint8_t cycleTime)
+{
+	directParameterPage_[IOL::PAGE::MIN_CYCLE_TIME] = cycleTime;
+}
+
+void SimDevice::setBootTime(uint32_t bootTime_ms)
+{
+	bootTime_ns_ = uint64_t(bootTime_ms) * 1000000u;
+}
+
+//!*****************************************************************************
+//!function :      compressChecksum
+//!*****************************************************************************
+//!  \brief        Compresses the XOR of all octets of a message to the six
+//!                bit checksum of CKT and CKS, see IO-Link Specification A.1.6
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    XOR of the seed 0x52 and all octets
+//!
+//!  \return       checksum in bit 5:0
+//!
+//!*****************************************************************************
+uint8_t SimDevice::compressChecksum(uint8_t checksum)
+{
+	uint8_t result = 0;
+	result |= uint8_t((((checksum >> 7) ^ (checksum >> 5) ^ (checksum >> 3) ^ (checksum >> 1)) & 0x01) << 5);
+	result |= uint8_t((((checksum >> 6) ^ (checksum >> 4) ^ (checksum >> 2) ^ (checksum >> 0)) & 0x01) << 4);
+	result |= uint8_t((((checksum >> 7) ^ (checksum >> 6)) & 0x01) << 3);
+	result |= uint8_t((((checksum >> 5) ^ (checksum >> 4)) & 0x01) << 2);
+	result |= uint8_t((((checksum >> 3) ^ (checksum >> 2)) & 0x01) << 1);
+	result |= uint8_t((((checksum >> 1) ^ (checksum >> 0)) & 0x01) << 0);
+	return result;
+}
+
+//!*****************************************************************************
+//!function :      encodePDLength
+//!*****************************************************************************
+//!  \brief        Encodes a process data length in bytes for PD_IN / PD_OUT
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    length in bytes
+//!
+//!  \return       encoded length
+//!
+//!*****************************************************************************
+static uint8_t encodePDLength(uint8_t size)
+{
+	if (size <= 2) {
+		return uint8_t(size * 8);
+	}
+	return uint8_t(IOL::PD_LENGTH_BYTE | (size - 1));
+}
+
+//!*****************************************************************************
+//!function :      encodeMSeqCapability
+//!*****************************************************************************
+//!  \brief        M-sequence capability with ISDU support and the OPERATE
+//!                code of the OD size, see IOL::odSizeOperate
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    OD octets in operate
+//!
+//!  \return       M_SEQ_CAP of the direct parameter page 1
+//!
+//!*****************************************************************************
+static uint8_t encodeMSeqCapability(uint8_t odSize)
+{
+	uint8_t code = (odSize == 2) ? 5u : (odSize == 8) ? 6u : (odSize == 32) ? 7u : 0u;
+	return uint8_t(IOL::M_SEQ_CAP_ISDU | (code << 1));
+}
+
+//!*****************************************************************************
+//!  SimDistanceSensor
+//!*****************************************************************************
+SimDistanceSensor::SimDistanceSensor()
+:SimDevice(0x0378u, 0x050118u, 2, 0, 1, 38400),
+distance_(3000),
+minDistance_(0),
+maxDistance_(0),
+step_(0),
+direction_(1)
+{
+	setDistance(distance_);
+	setParameter(IOL::INDEX::PRODUCT_NAME, "BUS M18M1-XA-02/015-S92G", 0);
+	setParameter(IOL::INDEX::PRODUCT_ID, "BUS0023", 0);
+	setParameter(IOL::INDEX::PRODUCT_TEXT, "Ultrasonic sensor", 0);
+
+	// Switching point and hysteresis in mm, the Data Storage set
+	uint8_t const switchPoint[] = { 0x03, 0xE8 };
+	uint8_t const hysteresis[] = { 0x00, 0x0A };
+	setParameter(SWITCH_POINT_INDEX, switchPoint, sizeof(switchPoint), 1);
+	setParameter(HYSTERESIS_INDEX, hysteresis, sizeof(hysteresis), 1);
+}
+
+void SimDistanceSensor::setDistance(uint16_t distance)
+{
+	distance_ = distance;
+	pdIn_[0] = uint8_t(distance_ >> 7);
+	pdIn_[1] = uint8_t(distance_ << 1);
+}
+
+//!*****************************************************************************
+//!function :      setSweep
+//!*****************************************************************************
+//!  \brief        The distance changes by step with every process data
+//!                request and turns around at the limits. A step of 0 keeps
+//!                the distance.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint16_t   lower limit
+//!				   uint16_t   upper limit
+//!				   uint16_t   change per request
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SimDistanceSensor::setSweep(uint16_t minDistance, uint16_t maxDistance, uint16_t step)
+{
+	minDistance_ = minDistance;
+	maxDistance_ = maxDistance;
+	step_ = step;
+}
+
+void SimDistanceSensor::updateProcessData()
+{
+	if (step_ != 0) {
+		if ((direction_ > 0) && (distance_ + step_ > maxDistance_)) {
+			direction_ = -1;
+		}
+		else if ((direction_ < 0) && (distance_ < minDistance_ + step_)) {
+			direction_ = 1;
+		}
+		distance_ = uint16_t((direction_ > 0) ? distance_ + step_ : distance_ - step_);
+	}
+	setDistance(distance_);
+}
+
+//!*****************************************************************************
+//!  SimSmartLight
+//!*****************************************************************************
+SimSmartLight::SimSmartLight()
+:SimDevice(0x0378u, 0x050B01u, 0, 8, 2, 38400),
+updateCount_(0)
+{
+	setParameter(IOL::INDEX::PRODUCT_NAME, "BNI IOL-802-102-Z037", 0);
+	setParameter(IOL::INDEX::PRODUCT_ID, "BNI0088", 0);
+	setParameter(IOL::INDEX::PRODUCT_TEXT, "Smart light", 0);
+}
+
+uint32_t SimSmartLight::readUpdateCount()
+{
+	return updateCount_;
+}
+
+void SimSmartLight::processDataOutChanged()
+{
+	updateCount_++;
+}
+#endif
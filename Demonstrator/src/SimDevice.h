@@ -0,0 +1,181 @@
+//!*****************************************************************************
+//!  \file      SimDevice.h
+//!*****************************************************************************
+//!
+//!  \brief		Virtual IO-Link devices for the HardwareSim backend. A device
+//!             answers the M-sequences the simulated MAX14819 sends to it.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-09
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+#ifndef _SIMDEVICE_H
+#define _SIMDEVICE_H
+
+//!**** Header-Files ************************************************************
+#include <cstdint>
+#include <map>
+#include <vector>
+//!**** Macros ******************************************************************
+
+//!**** Data types **************************************************************
+
+//!**** Function prototypes *****************************************************
+
+//!**** Data ********************************************************************
+
+//!**** Implementation **********************************************************
+
+//!*****************************************************************************
+//!  Generic IO-Link device. Answers wakeup, the direct parameter page 1, the
+//!  master commands and process data with M-sequence TYPE_0 and TYPE_2_X.
+//!  The process data input is set with setProcessDataIn, derived devices
+//!  generate it in updateProcessData. The ISDU channel serves the parameters
+//!  set with setParameter, derived devices may override readParameter and
+//!  writeParameter. The writable parameters form the Data Storage set of the
+//!  device, see index 3. The diagnosis channel serves the event memory
+//!  filled by raiseEvent.
+//!*****************************************************************************
+class SimDevice
+{
+public:
+	enum ComMode { SIO, STARTUP, PREOPERATE, OPERATE };
+
+	SimDevice(uint16_t vendorID, uint32_t deviceID, uint8_t pdInSize, uint8_t pdOutSize, uint8_t odSize, uint32_t baudrate);
+	virtual ~SimDevice();
+
+	void powerOn(uint64_t time_ns);
+	void powerOff();
+	uint8_t isReady(uint64_t time_ns);
+	uint8_t wakeUp(uint64_t time_ns);
+
+	uint32_t readBaudrate();
+	ComMode readComMode();
+	uint8_t handleMessage(uint8_t const * msg, uint8_t sizeMsg, uint8_t * answer);
+
+	void setProcessDataIn(uint8_t const * data);
+	void setPDInvalid(uint8_t invalid);
+	uint8_t readProcessDataOut(uint8_t * data);
+	void setMinCycleTime(uint8_t cycleTime);
+	void setBootTime(uint32_t bootTime_ms);
+	void setParameter(uint16_t index, char const * value, uint8_t isWritable);
+	void setParameter(uint16_t index, uint8_t const * data, uint8_t size, uint8_t isWritable);
+	uint8_t readParameterValue(uint16_t index, uint8_t * data, uint8_t size);
+	void changeParameter(uint16_t index, char const * value);
+	void raiseEvent(uint8_t qualifier, uint16_t code);
+
+	static uint8_t compressChecksum(uint8_t checksum);
+
+protected:
+	virtual void updateProcessData();
+	virtual void processDataOutChanged();
+	virtual uint8_t readOnRequest(uint8_t channel, uint8_t address);
+	virtual void writeOnRequest(uint8_t channel, uint8_t address, uint8_t value);
+	void masterCommand(uint8_t command);
+	virtual uint16_t readParameter(uint16_t index, uint8_t subindex, uint8_t * data, uint8_t * size);
+	virtual uint16_t writeParameter(uint16_t index, uint8_t subindex, uint8_t const * data, uint8_t size);
+
+	uint8_t directParameterPage_[16];
+	uint8_t pdIn_[32];
+	uint8_t pdOut_[32];
+	uint8_t pdInSize_;
+	uint8_t pdOutSize_;
+	uint8_t odSize_;
+	uint8_t pdOutValid_;
+	uint8_t pdInvalid_;
+
+private:
+	enum IsduState { ISDU_IDLE, ISDU_REQUEST, ISDU_RESPONSE };
+
+	struct Parameter {
+		std::vector<uint8_t> value;
+		uint8_t isWritable;
+	};
+
+	uint32_t baudrate_;
+	uint64_t bootTime_ns_;
+	uint64_t readyTime_ns_;
+	uint8_t isPowered_;
+	ComMode mode_;
+
+	std::map<uint16_t, Parameter> parameters_;
+	IsduState isduState_;
+	uint8_t isduRequest_[256];
+	uint8_t isduResponse_[256];
+	uint8_t isduSize_;				// octets of the request received, or of the response
+	uint8_t isduPosition_;			// first octet of the last segment
+	uint8_t isduFlow_;				// flow control of the last segment
+	uint8_t isduBusy_;				// polls answered with BUSY before the response
+	uint8_t eventMemory_[19];		// StatusCode and six event slots
+	uint8_t dsState_;				// Data Storage state, see IOL::DS::STATE_MASK
+	uint8_t dsUploadFlag_;			// parameters changed on the device, kept without L+
+
+	void isduWrite(uint8_t flow, uint8_t const * od, uint8_t size);
+	void isduRead(uint8_t flow, uint8_t * od, uint8_t size);
+	void isduExecute();
+	void isduRespond(uint8_t service, uint8_t const * data, uint8_t size);
+	uint16_t readDataStorage(uint8_t subindex, uint8_t * data, uint8_t * size);
+	uint16_t writeDataStorage(uint8_t subindex, uint8_t const * data, uint8_t size);
+	uint32_t dataStorageChecksum();
+};
+
+//!*****************************************************************************
+//!  Distance sensor similar to the Balluff BUS0023. Two bytes process data,
+//!  the distance in bit 15:1 and the switching output in bit 0. The distance
+//!  sweeps between two limits with every process data request.
+//!*****************************************************************************
+class SimDistanceSensor: public SimDevice
+{
+public:
+	SimDistanceSensor();
+
+	void setDistance(uint16_t distance);
+	void setSweep(uint16_t minDistance, uint16_t maxDistance, uint16_t step);
+
+protected:
+	virtual void updateProcessData();
+
+private:
+	uint16_t distance_;
+	uint16_t minDistance_;
+	uint16_t maxDistance_;
+	uint16_t step_;
+	int8_t direction_;
+};
+
+//!*****************************************************************************
+//!  Smartlight similar to the Balluff BNI0088, no process data input and
+//!  eight bytes process data output (segment colors, mode, level).
+//!*****************************************************************************
+class SimSmartLight: public SimDevice
+{
+public:
+	SimSmartLight();
+
+	uint32_t readUpdateCount();
+
+protected:
+	virtual void processDataOutChanged();
+
+private:
+	uint32_t updateCount_;
+};
+
+#endif //_SIMDEVICE_H
@@ -0,0 +1,261 @@
+#ifndef ARDUINO
+
+//!*****************************************************************************
+//!  \file      SpidevBus.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Linux spidev access without wiringPi. The device files are
+//!             opened and driven through SpidevIO, which a test replaces by
+//!             a fake (see SpidevFake). Batched register frames are
+//!             submitted as one chain of spi_ioc_transfer with cs_change
+//!             set between the frames.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-02
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!	
+//!*****************************************************************************
+
+//!**** Header-Files ************************************************************
+#include "SpidevBus.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <fcntl.h>   			// Needed for SPI port
+#include <sys/ioctl.h>			// Needed for SPI port
+#include <linux/spi/spidev.h>	// Needed for SPI port
+
+//!**** Macros ******************************************************************
+
+//!**** Data types **************************************************************
+
+//!**** Function prototypes *****************************************************
+
+//!**** Data ********************************************************************
+
+//!**** Implementation **********************************************************
+
+SpidevIO::~SpidevIO()
+{
+}
+
+int SpidevSystemIO::open(char const * path)
+{
+	return ::open(path, O_RDWR);
+}
+
+int SpidevSystemIO::close(int fd)
+{
+	return ::close(fd);
+}
+
+int SpidevSystemIO::ioctl(int fd, unsigned long request, void * arg)
+{
+	return ::ioctl(fd, request, arg);
+}
+
+//!*****************************************************************************
+//!function :      SpidevBus
+//!*****************************************************************************
+//!  \brief        Constructor, no device open
+//!
+//!  \type         local
+//!
+//!  \param[in]	   SpidevIO*  file access, nullptr for the kernel
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+SpidevBus::SpidevBus(SpidevIO * io)
+:systemIO_(),
+io_((io != nullptr) ? io : &systemIO_),
+speed_hz_(0),
+frameDelay_us_(0)
+{
+	for (uint8_t channel = 0; channel < SPI_CHANNELS; channel++) {
+		fd_[channel] = -1;
+	}
+}
+
+
+SpidevBus::~SpidevBus()
+{
+	for (uint8_t channel = 0; channel < SPI_CHANNELS; channel++) {
+		if (fd_[channel] >= 0) {
+			io_->close(fd_[channel]);
+		}
+	}
+}
+
+//!*****************************************************************************
+//!function :      open
+//!*****************************************************************************
+//!  \brief        Opens the spidev devices of both chipselects
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t       SPI bus number
+//!				   char const *  device path without bus and channel,
+//!				                 "/dev/spidev" opens /dev/spidev<bus>.<channel>
+//!
+//!  \return       0 if both devices are open
+//!
+//!*****************************************************************************
+uint8_t SpidevBus::open(uint8_t bus, char const * devicePrefix)
+{
+	char path[64];
+	uint8_t retValue = 0;
+
+	for (uint8_t channel = 0; channel < SPI_CHANNELS; channel++) {
+		snprintf(path, sizeof(path), "%s%d.%d", devicePrefix, bus, channel);
+		fd_[channel] = io_->open(path);
+		if (fd_[channel] < 0) {
+			printf("SpidevBus: cannot open %s\n", path);
+			retValue = 1;
+		}
+	}
+	return retValue;
+}
+
+//!*****************************************************************************
+//!function :      writeFrames
+//!*****************************************************************************
+//!  \brief        Writes several frames to the specified chipselect with one
+//!                SPI_IOC_MESSAGE ioctl. The chipselect is released and the
+//!                frame delay is inserted between the frames. The received
+//!                bytes overwrite the sent ones.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    channel number
+//!				   uint8_t*   pointer to the frames
+//!				   uint8_t    length of one frame in bytes
+//!				   uint8_t    number of frames
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SpidevBus::writeFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount)
+{
+	struct spi_ioc_transfer transfer[HardwareBase::SPI_MAX_FRAMES];
+
+	if ((channel >= SPI_CHANNELS) || (fd_[channel] < 0)) {
+		return;
+	}
+
+	while (frameCount > 0) {
+		uint8_t count = (frameCount > HardwareBase::SPI_MAX_FRAMES) ? HardwareBase::SPI_MAX_FRAMES : frameCount;
+
+		memset(transfer, 0, sizeof(transfer[0]) * count);
+		for (uint8_t i = 0; i < count; i++) {
+			transfer[i].tx_buf = (unsigned long)(data + i * frameLength);
+			transfer[i].rx_buf = (unsigned long)(data + i * frameLength);
+			transfer[i].len = frameLength;
+			transfer[i].speed_hz = speed_hz_;
+			transfer[i].bits_per_word = 8;
+			// Release chipselect between the frames, not after the last one
+			if (i + 1 < count) {
+				transfer[i].cs_change = 1;
+				transfer[i].delay_usecs = frameDelay_us_;
+			}
+		}
+		if (io_->ioctl(fd_[channel], SPI_IOC_MESSAGE(count), transfer) < 0) {
+			printf("SpidevBus: ioctl failed\n");
+		}
+
+		data += count * frameLength;
+		frameCount = uint8_t(frameCount - count);
+	}
+}
+
+//!*****************************************************************************
+//!function :      setSpeed
+//!*****************************************************************************
+//!  \brief        Sets the SPI clock of both chipselects
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint32_t   SPI clock in Hz
+//!
+//!  \return       0 if success
+//!
+//!*****************************************************************************
+uint8_t SpidevBus::setSpeed(uint32_t speed_hz)
+{
+	uint8_t retValue = 0;
+
+	for (uint8_t channel = 0; channel < SPI_CHANNELS; channel++) {
+		if ((fd_[channel] < 0) || (io_->ioctl(fd_[channel], SPI_IOC_WR_MAX_SPEED_HZ, &speed_hz) < 0)) {
+			retValue = 1;
+		}
+	}
+	speed_hz_ = speed_hz;
+	return retValue;
+}
+
+//!*****************************************************************************
+//!function :      setMode
+//!*****************************************************************************
+//!  \brief        Sets the SPI mode (clock polarity and phase) and 8 bit
+//!                words on both chipselects
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint8_t    SPI mode 0..3
+//!
+//!  \return       0 if success
+//!
+//!*****************************************************************************
+uint8_t SpidevBus::setMode(uint8_t mode)
+{
+	uint8_t retValue = 0;
+	uint8_t bits = 8;
+
+	if (mode > 3) {
+		return 1;
+	}
+	for (uint8_t channel = 0; channel < SPI_CHANNELS; channel++) {
+		if ((fd_[channel] < 0)
+			|| (io_->ioctl(fd_[channel], SPI_IOC_WR_MODE, &mode) < 0)
+			|| (io_->ioctl(fd_[channel], SPI_IOC_WR_BITS_PER_WORD, &bits) < 0)) {
+			retValue = 1;
+		}
+	}
+	return retValue;
+}
+
+//!*****************************************************************************
+//!function :      setFrameDelay
+//!*****************************************************************************
+//!  \brief        Sets the delay between two register frames of a batched
+//!                transfer
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint16_t   delay in microseconds
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SpidevBus::setFrameDelay(uint16_t delay_us)
+{
+	frameDelay_us_ = delay_us;
+}
+#endif
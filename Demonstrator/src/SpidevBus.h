@@ -0,0 +1,101 @@
+//!*****************************************************************************
+//!  \file      SpidevBus.h
+//!*****************************************************************************
+//!
+//!  \brief		Linux spidev access without wiringPi. The device files are
+//!             opened and driven through SpidevIO, which a test replaces by
+//!             a fake (see SpidevFake). Batched register frames are
+//!             submitted as one chain of spi_ioc_transfer with cs_change
+//!             set between the frames.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-02
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!	
+//!*****************************************************************************
+#ifndef _SPIDEVBUS_H
+#define _SPIDEVBUS_H
+
+//!**** Header-Files ************************************************************
+#include "HardwareBase.h"
+#include <cstdint>
+//!**** Macros ******************************************************************
+
+//!**** Data types **************************************************************
+
+//!**** Function prototypes *****************************************************
+
+//!**** Data ********************************************************************
+
+//!**** Implementation **********************************************************
+
+//!*****************************************************************************
+//!  File access of SpidevBus, the calls have the semantics of the libc
+//!  functions of the same name.
+//!*****************************************************************************
+class SpidevIO
+{
+public:
+	virtual ~SpidevIO();
+
+	virtual int open(char const * path) = 0;
+	virtual int close(int fd) = 0;
+	virtual int ioctl(int fd, unsigned long request, void * arg) = 0;
+};
+
+//!*****************************************************************************
+//!  SpidevIO of the kernel
+//!*****************************************************************************
+class SpidevSystemIO:
+	public SpidevIO
+{
+public:
+	virtual int open(char const * path);
+	virtual int close(int fd);
+	virtual int ioctl(int fd, unsigned long request, void * arg);
+};
+
+class SpidevBus
+{
+public:
+	static constexpr uint8_t SPI_CHANNELS = 2;
+
+	explicit SpidevBus(SpidevIO * io = nullptr);
+	~SpidevBus();
+
+	uint8_t open(uint8_t bus, char const * devicePrefix);
+	void writeFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount);
+
+	uint8_t setSpeed(uint32_t speed_hz);
+	uint8_t setMode(uint8_t mode);
+	void setFrameDelay(uint16_t delay_us);
+
+private:
+	SpidevSystemIO systemIO_;
+	SpidevIO * io_;
+	int fd_[SPI_CHANNELS];
+	uint32_t speed_hz_;
+	uint16_t frameDelay_us_;
+
+	// Not copyable, owns the file descriptors
+	SpidevBus(SpidevBus const &);
+	SpidevBus & operator=(SpidevBus const &);
+};
+
+#endif //_SPIDEVBUS_H
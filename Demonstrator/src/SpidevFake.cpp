@@ -0,0 +1,313 @@
+#ifndef ARDUINO
+
+//!*****************************************************************************
+//!  \file      SpidevFake.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Fake spidev for a plain Linux machine. SpidevFake serves the
+//!             SpidevIO calls of SpidevBus, checks every spi_ioc_transfer
+//!             chain the way the kernel driver and the MAX14819 need it
+//!             and passes the frames to another hardware, normally the
+//!             simulation. HardwareSpidevSim runs the simulation with its
+//!             SPI through SpidevBus and the fake (--sim spidev).
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-02
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!	
+//!*****************************************************************************
+
+//!**** Header-Files ************************************************************
+#include "SpidevFake.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <sys/ioctl.h>			// Needed for SPI port
+#include <linux/spi/spidev.h>	// Needed for SPI port
+
+//!**** Macros ******************************************************************
+
+//!**** Data types **************************************************************
+
+//!**** Function prototypes *****************************************************
+
+//!**** Data ********************************************************************
+
+//!**** Implementation **********************************************************
+
+//!*****************************************************************************
+//!function :      SpidevFake
+//!*****************************************************************************
+//!  \brief        Constructor
+//!
+//!  \type         local
+//!
+//!  \param[in]	   HardwareBase*  receives the frames of the checked messages
+//!				   uint8_t        expected length of every frame
+//!				   uint16_t       expected delay between the frames
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+SpidevFake::SpidevFake(HardwareBase * target, uint8_t frameLength, uint16_t frameDelay_us)
+:target_(target),
+frameLength_(frameLength),
+frameDelay_us_(frameDelay_us),
+speed_hz_(0),
+messages_(0),
+violations_(0)
+{
+}
+
+//!*****************************************************************************
+//!function :      open
+//!*****************************************************************************
+//!  \brief        Opens <prefix><bus>.<channel> for the channels 0 and 1
+//!
+//!  \type         local
+//!
+//!  \param[in]	   char const *  device path
+//!
+//!  \return       file descriptor, -1 for another channel
+//!
+//!*****************************************************************************
+int SpidevFake::open(char const * path)
+{
+	char const * dot = strrchr(path, '.');
+
+	if ((dot == nullptr) || (dot[1] < '0') || (dot[1] > '1') || (dot[2] != '\0')) {
+		errno = ENOENT;
+		return -1;
+	}
+	return FD_BASE + (dot[1] - '0');
+}
+
+int SpidevFake::close(int fd)
+{
+	(void)fd;
+	return 0;
+}
+
+//!*****************************************************************************
+//!function :      ioctl
+//!*****************************************************************************
+//!  \brief        Serves the spidev requests of SpidevBus. A message is
+//!                checked first, its frames go to the target one chipselect
+//!                cycle each. A message which breaks a rule is counted,
+//!                reported and rejected with EINVAL like the kernel would.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   int            file descriptor of open
+//!				   unsigned long  SPI_IOC_x request
+//!				   void*          argument of the request
+//!
+//!  \return       0 if success, -1 with errno otherwise
+//!
+//!*****************************************************************************
+int SpidevFake::ioctl(int fd, unsigned long request, void * arg)
+{
+	uint8_t channel = uint8_t(fd - FD_BASE);
+
+	if ((fd < FD_BASE) || (channel > 1)) {
+		errno = EBADF;
+		return -1;
+	}
+	if (request == SPI_IOC_WR_MODE) {
+		if (*static_cast<uint8_t *>(arg) > 3) {
+			errno = EINVAL;
+			return -1;
+		}
+		return 0;
+	}
+	if (request == SPI_IOC_WR_BITS_PER_WORD) {
+		if (*static_cast<uint8_t *>(arg) != 8) {
+			report(0, "bits per word is not 8");
+			errno = EINVAL;
+			return -1;
+		}
+		return 0;
+	}
+	if (request == SPI_IOC_WR_MAX_SPEED_HZ) {
+		speed_hz_ = *static_cast<uint32_t *>(arg);
+		return 0;
+	}
+	if ((_IOC_TYPE(request) != SPI_IOC_MAGIC) || (_IOC_NR(request) != 0) || (_IOC_DIR(request) != _IOC_WRITE)
+			|| ((_IOC_SIZE(request) % sizeof(struct spi_ioc_transfer)) != 0)) {
+		errno = ENOTTY;
+		return -1;
+	}
+
+	uint32_t count = _IOC_SIZE(request) / sizeof(struct spi_ioc_transfer);
+	struct spi_ioc_transfer const * transfer = static_cast<struct spi_ioc_transfer const *>(arg);
+	messages_++;
+	if (checkMessage(arg, count) != 0) {
+		errno = EINVAL;
+		return -1;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		target_->SPI_Write(channel, reinterpret_cast<uint8_t *>(transfer[i].tx_buf), uint8_t(transfer[i].len));
+	}
+	return 0;
+}
+
+//!*****************************************************************************
+//!function :      checkMessage
+//!*****************************************************************************
+//!  \brief        Checks a chain of transfers as SpidevBus must build it:
+//!                1 to SPI_MAX_FRAMES frames of the frame length, back to
+//!                back in one buffer received in place, 8 bit words at the
+//!                set speed, chipselect released with the frame delay after
+//!                every frame but the last.
+//!
+//!  \type         local
+//!
+//!  \param[in]	   void const*  spi_ioc_transfer array
+//!				   uint32_t     number of transfers
+//!
+//!  \return       0 if the message is valid
+//!
+//!*****************************************************************************
+uint8_t SpidevFake::checkMessage(void const * arg, uint32_t count)
+{
+	struct spi_ioc_transfer const * transfer = static_cast<struct spi_ioc_transfer const *>(arg);
+	uint32_t violations = violations_;
+
+	if ((count == 0) || (count > HardwareBase::SPI_MAX_FRAMES)) {
+		report(0, "frame count out of range");
+		return 1;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		bool isLast = (i + 1 == count);
+		if (transfer[i].len != frameLength_) {
+			report(i, "wrong frame length");
+		}
+		if ((transfer[i].tx_buf == 0) || (transfer[i].rx_buf != transfer[i].tx_buf)) {
+			report(i, "not received in place");
+		}
+		if ((i > 0) && (transfer[i].tx_buf != transfer[i - 1].tx_buf + transfer[i - 1].len)) {
+			report(i, "frames not back to back");
+		}
+		if ((transfer[i].bits_per_word != 8) || (transfer[i].speed_hz != speed_hz_)) {
+			report(i, "word size or speed differs from the device setting");
+		}
+		if (transfer[i].cs_change != (isLast ? 0 : 1)) {
+			report(i, isLast ? "chipselect kept after the last frame" : "chipselect not released between frames");
+		}
+		if (transfer[i].delay_usecs != (isLast ? 0 : frameDelay_us_)) {
+			report(i, "wrong frame delay");
+		}
+	}
+	return (violations_ != violations) ? 1 : 0;
+}
+
+//!*****************************************************************************
+//!function :      report
+//!*****************************************************************************
+//!  \brief        Counts a violation, the first ones are printed
+//!
+//!  \type         local
+//!
+//!  \param[in]	   uint32_t      frame of the message
+//!				   char const *  rule
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+void SpidevFake::report(uint32_t frame, char const * what)
+{
+	violations_++;
+	if (violations_ <= MAX_REPORTS) {
+		printf("SpidevFake: message %lu frame %lu: %s\n", (unsigned long)messages_, (unsigned long)frame, what);
+	}
+}
+
+uint32_t SpidevFake::readMessageCount()
+{
+	return messages_;
+}
+
+uint32_t SpidevFake::readViolationCount()
+{
+	return violations_;
+}
+
+//!*****************************************************************************
+//!function :      HardwareSpidevSim
+//!*****************************************************************************
+//!  \brief        Opens the fake devices and sets the SPI parameters as
+//!                HardwareSpidev does
+//!
+//!  \type         local
+//!
+//!  \param[in]	   HardwareBase*  hardware serving GPIO, time, NV and SPI
+//!				   uint32_t       SPI clock in Hz
+//!				   uint16_t       delay between the frames of a message
+//!
+//!  \return       void
+//!
+//!*****************************************************************************
+HardwareSpidevSim::HardwareSpidevSim(HardwareBase * hardware, uint32_t speed_hz, uint16_t frameDelay_us)
+:hardware_(hardware),
+fake_(hardware, SPI_FRAME_SIZE, frameDelay_us),
+bus_(&fake_)
+{
+	bus_.open(0, "/dev/spidev");
+	bus_.setMode(0);
+	bus_.setSpeed(speed_hz);
+	bus_.setFrameDelay(frameDelay_us);
+}
+
+void HardwareSpidevSim::begin() { hardware_->begin(); }
+
+void HardwareSpidevSim::IO_Write(PinNames pinnumber, uint8_t state) { hardware_->IO_Write(pinnumber, state); }
+
+void HardwareSpidevSim::IO_PinMode(PinNames pinnumber, PinMode mode) { hardware_->IO_PinMode(pinnumber, mode); }
+
+uint8_t HardwareSpidevSim::IO_Read(PinNames pinnumber) { return hardware_->IO_Read(pinnumber); }
+
+uint8_t HardwareSpidevSim::IO_WaitForInterrupt(PinNames pinnumber, uint64_t deadline_ns) { return hardware_->IO_WaitForInterrupt(pinnumber, deadline_ns); }
+
+void HardwareSpidevSim::Serial_Write(char const * buf) { hardware_->Serial_Write(buf); }
+
+void HardwareSpidevSim::Serial_Write(int number) { hardware_->Serial_Write(number); }
+
+void HardwareSpidevSim::SPI_Write(uint8_t channel, uint8_t * data, uint8_t length) { bus_.writeFrames(channel, data, length, 1); }
+
+void HardwareSpidevSim::SPI_WriteFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount) { bus_.writeFrames(channel, data, frameLength, frameCount); }
+
+void HardwareSpidevSim::wait_for(uint32_t delay_ms) { hardware_->wait_for(delay_ms); }
+
+void HardwareSpidevSim::wait_for_us(uint32_t delay_us) { hardware_->wait_for_us(delay_us); }
+
+void HardwareSpidevSim::wait_until_ns(uint64_t deadline_ns) { hardware_->wait_until_ns(deadline_ns); }
+
+uint64_t HardwareSpidevSim::get_time_ns() { return hardware_->get_time_ns(); }
+
+uint8_t HardwareSpidevSim::hasVirtualTime() { return hardware_->hasVirtualTime(); }
+
+uint8_t HardwareSpidevSim::NV_Read(char const * name, uint8_t * data, uint16_t length) { return hardware_->NV_Read(name, data, length); }
+
+uint8_t HardwareSpidevSim::NV_Write(char const * name, uint8_t const * data, uint16_t length) { return hardware_->NV_Write(name, data, length); }
+
+uint8_t * HardwareSpidevSim::NV_Map(char const * name, uint16_t length) { return hardware_->NV_Map(name, length); }
+
+SpidevFake & HardwareSpidevSim::readFake() { return fake_; }
+#endif
@@ -0,0 +1,120 @@
+//!*****************************************************************************
+//!  \file      SpidevFake.h
+//!*****************************************************************************
+//!
+//!  \brief		Fake spidev for a plain Linux machine. SpidevFake serves the
+//!             SpidevIO calls of SpidevBus, checks every spi_ioc_transfer
+//!             chain the way the kernel driver and the MAX14819 need it
+//!             and passes the frames to another hardware, normally the
+//!             simulation. HardwareSpidevSim runs the simulation with its
+//!             SPI through SpidevBus and the fake (--sim spidev).
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-02
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!	
+//!*****************************************************************************
+#ifndef _SPIDEVFAKE_H
+#define _SPIDEVFAKE_H
+
+//!**** Header-Files ************************************************************
+#include "HardwareBase.h"
+#include "SpidevBus.h"
+#include <cstdint>
+//!**** Macros ******************************************************************
+
+//!**** Data types **************************************************************
+
+//!**** Function prototypes *****************************************************
+
+//!**** Data ********************************************************************
+
+//!**** Implementation **********************************************************
+
+class SpidevFake:
+	public SpidevIO
+{
+public:
+	SpidevFake(HardwareBase * target, uint8_t frameLength, uint16_t frameDelay_us);
+
+	virtual int open(char const * path);
+	virtual int close(int fd);
+	virtual int ioctl(int fd, unsigned long request, void * arg);
+
+	uint32_t readMessageCount();
+	uint32_t readViolationCount();
+
+private:
+	static constexpr int FD_BASE = 100;				// fd of channel 0
+	static constexpr uint32_t MAX_REPORTS = 8;		// violations printed
+
+	HardwareBase * target_;
+	uint8_t frameLength_;
+	uint16_t frameDelay_us_;
+	uint32_t speed_hz_;
+	uint32_t messages_;
+	uint32_t violations_;
+
+	uint8_t checkMessage(void const * arg, uint32_t count);
+	void report(uint32_t frame, char const * what);
+};
+
+//!*****************************************************************************
+//!  Hardware which forwards to another hardware, the SPI goes through
+//!  SpidevBus and SpidevFake on the way. Exercises the spidev backend
+//!  without the Raspberry Pi.
+//!*****************************************************************************
+class HardwareSpidevSim:
+	public HardwareBase
+{
+public:
+	HardwareSpidevSim(HardwareBase * hardware, uint32_t speed_hz = 500000, uint16_t frameDelay_us = 0);
+
+	virtual void begin();
+
+	virtual void IO_Write(PinNames pinnumber, uint8_t state);
+	virtual void IO_PinMode(PinNames pinnumber, PinMode mode);
+	virtual uint8_t IO_Read(PinNames pinnumber);
+	virtual uint8_t IO_WaitForInterrupt(PinNames pinnumber, uint64_t deadline_ns);
+
+	virtual void Serial_Write(char const * buf);
+	virtual void Serial_Write(int number);
+
+	virtual void SPI_Write(uint8_t channel, uint8_t * data, uint8_t length);
+	virtual void SPI_WriteFrames(uint8_t channel, uint8_t * data, uint8_t frameLength, uint8_t frameCount);
+
+	virtual void wait_for(uint32_t delay_ms);
+	virtual void wait_for_us(uint32_t delay_us);
+	virtual void wait_until_ns(uint64_t deadline_ns);
+	virtual uint64_t get_time_ns();
+	virtual uint8_t hasVirtualTime();
+
+	virtual uint8_t NV_Read(char const * name, uint8_t * data, uint16_t length);
+	virtual uint8_t NV_Write(char const * name, uint8_t const * data, uint16_t length);
+	virtual uint8_t * NV_Map(char const * name, uint16_t length);
+
+	SpidevFake & readFake();
+
+private:
+	HardwareBase * hardware_;
+	SpidevFake fake_;
+	SpidevBus bus_;
+};
+
+#endif //_SPIDEVFAKE_H
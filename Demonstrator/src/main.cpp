@@ -31,21 +31,121 @@
 	//!**** Header-Files ***********************************************************
 	#include "Demonstrator_V1_0.h"
 
+	#include "HardwareSim.h"
+	#include "SimDevice.h"
+	#include "SpidevFake.h"
+	#ifndef HARDWARE_SIM_ONLY
 	#include "HardwareRaspberry.h"
+	#include "HardwareSpidev.h"
+	#endif
+
+	#include <csignal>
+	#include <cstdlib>
+	#include <cstring>
 
 	//!**** Macros *****************************************************************
 
 	//!**** Data types *************************************************************
 
 	//!**** Function prototypes ****************************************************
+	HardwareBase * createSimulation(bool virtualTime);
+	void onStatisticsSignal(int signal);
 
 	//!**** Data *******************************************************************
 
 	//!**** Implementation *********************************************************
 
-	int main(){
-		HardwareRaspberry hardware;
-		Demo_setup(&hardware);
+	//!*************************************************************************
+	//!  Simulated shield with the devices of the demonstrator: distance
+	//!  sensor on port 0, smartlight on port 1 and two buttons on port 2/3
+	//!*************************************************************************
+	HardwareBase * createSimulation(bool virtualTime) {
+		HardwareSim *sim = new HardwareSim(virtualTime);
+		SimDistanceSensor *sensor = new SimDistanceSensor();
+		sensor->setSweep(2600, 4900, 20);
+		sim->attachDevice(0, sensor);
+		sim->attachDevice(1, new SimSmartLight());
+		sim->attachDevice(2, new SimDevice(0x0378u, 0x0A0001u, 1, 0, 1, 38400));
+		sim->attachDevice(3, new SimDevice(0x0378u, 0x0A0001u, 1, 0, 1, 38400));
+		return sim;
+	}
+
+	//!*************************************************************************
+	//!  kill -USR1 <pid> prints the SPI statistics of the drivers
+	//!*************************************************************************
+	void onStatisticsSignal(int signal) {
+		(void)signal;
+		Demo_requestStatistics();
+	}
+
+	//!*************************************************************************
+	//!  Usage: Demonstrator_v1_0 [--spidev [speed_hz] | --sim [virtual] [spidev]] [--state-dir dir] [--pdlog file] [--trace]
+	//!    --spidev   use /dev/spidev0.x directly instead of wiringPiSPI
+	//!    --sim      simulated shield and devices, "virtual" runs it in
+	//!               virtual time as fast as possible, "spidev" passes the
+	//!               SPI through the spidev backend and a checking fake
+	//!    --state-dir directory of the saved port states, device cache and
+	//!               data storage blocks, default /var/lib/iolmaster. The
+	//!               simulation keeps them in memory and ignores it.
+	//!    --pdlog    log the process data of all ports to a binary ring
+	//!               file instead of printing, see tools/PDLogConvert
+	//!    --trace    record the last SPI frames, printed with SIGUSR1
+	//!  Builds without wiringPi (HARDWARE_SIM_ONLY) always use the simulation.
+	//!*************************************************************************
+	int main(int argc, char *argv[]){
+		HardwareBase *hardware;
+		char const *stateDirectory = nullptr;
+
+		if ((argc > 1) && (strcmp(argv[argc - 1], "--trace") == 0)) {
+			Demo_enableTrace();
+			argc--;
+		}
+		if ((argc > 2) && (strcmp(argv[argc - 2], "--pdlog") == 0)) {
+			Demo_enablePDLog(argv[argc - 1]);
+			argc = argc - 2;
+		}
+		if ((argc > 2) && (strcmp(argv[argc - 2], "--state-dir") == 0)) {
+			stateDirectory = argv[argc - 1];
+			argc = argc - 2;
+		}
+		signal(SIGUSR1, onStatisticsSignal);
+
+		if ((argc > 1) && (strcmp(argv[1], "--sim") == 0)) {
+			bool virtualTime = false;
+			bool spidev = false;
+			for (int i = 2; i < argc; i++) {
+				virtualTime = virtualTime || (strcmp(argv[i], "virtual") == 0);
+				spidev = spidev || (strcmp(argv[i], "spidev") == 0);
+			}
+			hardware = createSimulation(virtualTime);
+			if (spidev) {
+				hardware = new HardwareSpidevSim(hardware);
+			}
+		}
+	#ifndef HARDWARE_SIM_ONLY
+		else if ((argc > 1) && (strcmp(argv[1], "--spidev") == 0)) {
+			uint32_t speed_hz = (argc > 2) ? uint32_t(strtoul(argv[2], nullptr, 0)) : 500000u;
+			HardwareSpidev *spidevHardware = new HardwareSpidev(0, speed_hz);
+			if (stateDirectory != nullptr) {
+				spidevHardware->set_state_directory(stateDirectory);
+			}
+			hardware = spidevHardware;
+		}
+		else {
+			HardwareRaspberry *raspberry = new HardwareRaspberry();
+			if (stateDirectory != nullptr) {
+				raspberry->set_state_directory(stateDirectory);
+			}
+			hardware = raspberry;
+		}
+	#else
+		else {
+			(void)stateDirectory;
+			hardware = createSimulation(false);
+		}
+	#endif
+
+		Demo_setup(hardware);
 		while(1){
 			Demo_loop();
 		}
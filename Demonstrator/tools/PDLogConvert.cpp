@@ -0,0 +1,186 @@
+//!*****************************************************************************
+//!  \file      PDLogConvert.cpp
+//!*****************************************************************************
+//!
+//!  \brief		Converts the binary process data log of the demonstrator
+//!             (--pdlog, see IOLPDLog.h) to CSV or to a Matlab matrix. The
+//!             records are printed from the oldest to the newest.
+//!
+//!  \author    Markus Gafner (gnm7)
+//!
+//!  \date      2019-12-31
+//!
+//!*****************************************************************************
+//!
+//!	 Copyright 2019 Bern University of Applied Sciences and Balluff AG
+//!
+//!	 Licensed under the Apache License, Version 2.0 (the "License");
+//!  you may not use this file except in compliance with the License.
+//!  You may obtain a copy of the License at
+//!
+//!	     http://www.apache.org/licenses/LICENSE-2.0
+//!
+//!	 Unless required by applicable law or agreed to in writing, software
+//!	 distributed under the License is distributed on an "AS IS" BASIS,
+//!	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//!	 See the License for the specific language governing permissions and
+//!	 limitations under the License.
+//!
+//!*****************************************************************************
+
+//!**** Header-Files ************************************************************
+#include "IOLPDLog.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+//!**** Macros ******************************************************************
+constexpr int NO_PORT = -1;
+
+//!**** Data types **************************************************************
+
+//!**** Function prototypes *****************************************************
+static bool readLog(char const *path, PDLogHeader *pHeader, std::vector<PDLogRecord> *pRecords);
+static void printCsv(PDLogHeader const &header, std::vector<PDLogRecord> const &records);
+static void printMatlab(PDLogHeader const &header, std::vector<PDLogRecord> const &records);
+
+//!**** Data ********************************************************************
+
+//!**** Implementation **********************************************************
+
+//!*****************************************************************************
+//!  Read the header and the records in the order they were appended. A
+//!  file of another version or record size is rejected.
+//!*****************************************************************************
+static bool readLog(char const *path, PDLogHeader *pHeader, std::vector<PDLogRecord> *pRecords)
+{
+	FILE *file = fopen(path, "rb");
+	if (file == nullptr) {
+		fprintf(stderr, "%s: cannot open\n", path);
+		return false;
+	}
+	if ((fread(pHeader, sizeof(PDLogHeader), 1, file) != 1)
+			|| (memcmp(pHeader->magic, "IOLPDLOG", sizeof(pHeader->magic)) != 0)
+			|| (pHeader->version != PD_LOG_VERSION)
+			|| (pHeader->recordSize != sizeof(PDLogRecord))
+			|| (pHeader->recordCount == 0)) {
+		fprintf(stderr, "%s: not a process data log of version %u\n", path, unsigned(PD_LOG_VERSION));
+		fclose(file);
+		return false;
+	}
+
+	// Before the first wrap the ring starts with slot 0, afterwards with
+	// the slot of the oldest record
+	uint64_t count = (pHeader->head < pHeader->recordCount) ? pHeader->head : pHeader->recordCount;
+	uint64_t first = pHeader->head - count;
+	std::vector<PDLogRecord> ring(pHeader->recordCount);
+	size_t slots = fread(ring.data(), sizeof(PDLogRecord), ring.size(), file);
+	fclose(file);
+	if (slots != ring.size()) {
+		fprintf(stderr, "%s: truncated, %zu of %u records\n", path, slots, unsigned(pHeader->recordCount));
+		return false;
+	}
+	pRecords->clear();
+	pRecords->reserve(size_t(count));
+	for (uint64_t i = first; i < pHeader->head; i++) {
+		pRecords->push_back(ring[size_t(i % pHeader->recordCount)]);
+	}
+	return true;
+}
+
+//!*****************************************************************************
+//!  One line per record with a header line, times in nanoseconds of the
+//!  master clock, the octets (OD, PD and CKS) in hex
+//!*****************************************************************************
+static void printCsv(PDLogHeader const &header, std::vector<PDLogRecord> const &records)
+{
+	(void)header;
+	printf("port,sequence,time_ns,send_ns,valid,size,data\n");
+	for (PDLogRecord const &record : records) {
+		printf("%u,%lu,%llu,%llu,%u,%u,", unsigned(record.port), (unsigned long)record.sequence,
+				(unsigned long long)record.time_ns, (unsigned long long)record.send_ns,
+				unsigned(record.status & PD_LOG_STATUS_VALID), unsigned(record.size));
+		for (uint8_t i = 0; (i < record.size) && (i < PD_LOG_DATA_SIZE); i++) {
+			printf("%02x", unsigned(record.data[i]));
+		}
+		printf("\n");
+	}
+}
+
+//!*****************************************************************************
+//!  Numeric matrix for dlmread, separated by ';' like the text output of the
+//!  demonstrator: port, sequence, time since the log was opened and latency
+//!  in microseconds, valid, size and the octets in decimal. Shorter records
+//!  are padded with zeros to the longest one.
+//!*****************************************************************************
+static void printMatlab(PDLogHeader const &header, std::vector<PDLogRecord> const &records)
+{
+	uint8_t width = 0;
+	for (PDLogRecord const &record : records) {
+		if ((record.size > width) && (record.size <= PD_LOG_DATA_SIZE)) {
+			width = record.size;
+		}
+	}
+	for (PDLogRecord const &record : records) {
+		uint64_t time_us = (record.time_ns > header.created_ns) ? (record.time_ns - header.created_ns) / 1000u : 0;
+		uint64_t latency_us = (record.time_ns > record.send_ns) ? (record.time_ns - record.send_ns) / 1000u : 0;
+		printf("%u;%lu;%llu;%llu;%u;%u", unsigned(record.port), (unsigned long)record.sequence,
+				(unsigned long long)time_us, (unsigned long long)latency_us,
+				unsigned(record.status & PD_LOG_STATUS_VALID), unsigned(record.size));
+		for (uint8_t i = 0; i < width; i++) {
+			printf(";%u", (i < record.size) ? unsigned(record.data[i]) : 0u);
+		}
+		printf("\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	char const *path = nullptr;
+	bool matlab = false;
+	int port = NO_PORT;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--matlab") == 0) {
+			matlab = true;
+		}
+		else if ((strcmp(argv[i], "--port") == 0) && (i + 1 < argc)) {
+			port = atoi(argv[++i]);
+		}
+		else if ((argv[i][0] != '-') && (path == nullptr)) {
+			path = argv[i];
+		}
+		else {
+			path = nullptr;
+			break;
+		}
+	}
+	if (path == nullptr) {
+		fprintf(stderr, "Usage: %s [--matlab] [--port n] file\n", argv[0]);
+		return 1;
+	}
+
+	PDLogHeader header;
+	std::vector<PDLogRecord> records;
+	if (!readLog(path, &header, &records)) {
+		return 1;
+	}
+	if (port != NO_PORT) {
+		std::vector<PDLogRecord> selected;
+		for (PDLogRecord const &record : records) {
+			if (record.port == port) {
+				selected.push_back(record);
+			}
+		}
+		records.swap(selected);
+	}
+	if (matlab) {
+		printMatlab(header, records);
+	}
+	else {
+		printCsv(header, records);
+	}
+	return 0;
+}